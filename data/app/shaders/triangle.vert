@@ -1,14 +1,19 @@
 #version 330 core
 #extension GL_ARB_explicit_uniform_location : require
+#extension GL_ARB_shading_language_420pack : require
 
 layout(location = ATTRIB_POSITION_LOCATION) in vec3 in_Pos;
 layout(location = ATTRIB_UV_LOCATION) in vec2 in_Uv;
 
 out vec2 v_Uv;
 
-layout(location = UNIFORM_MVP_LOCATION) uniform mat4 u_MVP;
+#include "common/ubo/frame"
+
+layout(std140, binding = UBO_DRAW_CONSTANTS_BINDING) uniform DrawConstants {
+    highp mat4 u_Model;
+};
 
 void main() {
     v_Uv = in_Uv;
-    gl_Position = u_MVP * vec4(in_Pos, 1.0);
-} // main
\ No newline at end of file
+    gl_Position = u_ViewProj * u_Model * vec4(in_Pos, 1.0);
+} // main
@@ -16,13 +16,13 @@ float DiffuseIntensity(in vec3 normal, in vec3 lightDir) {
 }
 
 float SpecularIntensity(in vec3 normal, in vec3 lightDir, in vec3 viewDir) {
-#ifdef USE_PHONG
+#if USE_PHONG
     highp vec3 reflectDir = reflect(-lightDir, normal);
     highp float specularAngle = max(0.0, dot(reflectDir, viewDir));
     highp float specular = pow(specularAngle, u_Material.coefs.specularPower * 0.25);
 #else 
     // blinn phong
-    highp vec3 halfVec = normalize(lightdir + viewDir);
+    highp vec3 halfVec = normalize(lightDir + viewDir);
     highp float specularAngle = max(0.0, dot(halfVec, normal));
     highp float specular = pow(specularAngle, u_Material.coefs.specularPower);
 #endif // USE_PHONG
@@ -36,7 +36,7 @@ void main() {
     vec4 accumulatedLighting = u_Light.ambientIntensity;
     accumulatedLighting += u_Light.diffuseColor * DiffuseIntensity(normal, lightDir);
     out_FragColor = u_Material.diffuseColor * accumulatedLighting;
-#ifdef USE_SPECULAR
+#if USE_SPECULAR
     // don't use material color, get clean light's specular (as in Pixar uber shader)
     out_FragColor += u_Light.diffuseColor * SpecularIntensity(normal, lightDir, viewDir);
 #endif
@@ -1,10 +1,9 @@
 #version 330 core
 #extension GL_ARB_explicit_uniform_location : require
 
-in vec3 v_Color;
+in vec4 v_Color;
 layout(location=0) out vec4 out_FragColor;
 
 void main() {
-    out_FragColor.xyz = v_Color;
+    out_FragColor = v_Color;
 }
-
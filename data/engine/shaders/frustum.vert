@@ -7,7 +7,7 @@ layout(location = ATTRIB_OTHER_WEIGHTS) in vec3 in_NearFarInnerWeight;
 
 out vec3 v_Color;
 
-layout(location = UNIFORM_MVP) uniform mat4 u_MVP;
+uniform mat4 u_MVP;
 
 layout(std140, binding = UBO_FRUSTUM) uniform Ubo {
     vec4 u_LeftRightBottomTop;
@@ -1,5 +1,6 @@
 #version 330 core
 #extension GL_ARB_explicit_uniform_location : require
+#extension GL_ARB_shading_language_420pack : require
 
 layout(location = ATTRIB_POSITION) in vec3 in_Pos;
 layout(location = ATTRIB_UV) in vec2 in_Uv;
@@ -11,7 +12,9 @@ out vec2 v_Uv;
 out vec3 v_Normal;
 flat out int v_ColorIdx;
 
-layout(location = UNIFORM_MVP) uniform mat4 u_ViewProj;
+layout(std140, binding = UBO_DRAW_CONSTANTS_BINDING) uniform DrawConstants {
+    mat4 u_ViewProj;
+};
 
 void main() {
     v_Uv = in_Uv;
@@ -0,0 +1,19 @@
+#version 330 core
+#extension GL_ARB_explicit_uniform_location : require
+#extension GL_ARB_shading_language_420pack : require
+
+layout(location = ATTRIB_POSITION) in vec3 in_Pos;
+layout(location = ATTRIB_COLOR) in uint in_Color;
+
+out vec4 v_Color;
+
+layout(std140, binding = UBO_DRAW_CONSTANTS_BINDING) uniform DrawConstants {
+    mat4 u_ViewProj;
+};
+
+void main() {
+    // RGBA8, R in the lowest byte
+    uvec4 color = uvec4(in_Color, in_Color >> 8u, in_Color >> 16u, in_Color >> 24u) & 0xFFu;
+    v_Color = vec4(color) / 255.0;
+    gl_Position = u_ViewProj * vec4(in_Pos, 1.0);
+}
@@ -0,0 +1,32 @@
+#version 330 core
+#extension GL_ARB_explicit_uniform_location : require
+#extension GL_ARB_shading_language_420pack : require
+
+layout(location = ATTRIB_INSTANCE_POSITION) in vec3 in_InstancePos;
+layout(location = ATTRIB_INSTANCE_SCALE) in float in_InstanceScale;
+layout(location = ATTRIB_COLOR) in int in_ColorIdx;
+
+out vec2 v_Corner;
+out vec3 v_ViewCenter;
+out float v_Radius;
+flat out int v_ColorIdx;
+
+layout(std140, binding = UBO_DRAW_CONSTANTS_BINDING) uniform DrawConstants {
+    mat4 u_View;
+    mat4 u_Proj;
+};
+
+const vec2 VERTICES[] = vec2[](
+    vec2(-1.0, -1.0),
+    vec2(1.0, -1.0),
+    vec2(-1.0, 1.0),
+    vec2(1.0, 1.0)
+);
+
+void main() {
+    v_Corner = VERTICES[gl_VertexID];
+    v_ViewCenter = (u_View * vec4(in_InstancePos, 1.0)).xyz;
+    v_Radius = in_InstanceScale; // same extent as the box of a matrix point
+    v_ColorIdx = in_ColorIdx;
+    gl_Position = u_Proj * vec4(v_ViewCenter + vec3(v_Corner * v_Radius, 0.0), 1.0);
+}
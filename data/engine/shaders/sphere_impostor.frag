@@ -0,0 +1,31 @@
+#version 330 core
+#extension GL_ARB_explicit_uniform_location : require
+#extension GL_ARB_shading_language_420pack : require
+
+in vec2 v_Corner;
+in vec3 v_ViewCenter;
+in float v_Radius;
+flat in int v_ColorIdx;
+layout(location=0) out vec4 out_FragColor;
+
+#include "common/color_palette"
+
+layout(std140, binding = UBO_DRAW_CONSTANTS_BINDING) uniform DrawConstants {
+    mat4 u_View;
+    mat4 u_Proj;
+};
+
+void main() {
+    float distanceSq = dot(v_Corner, v_Corner);
+    if (distanceSq > 1.0) { discard; }
+
+    // NOTE: the quad faces the view plane, not the point, it's exact only near the center of the screen
+    vec3 normal = vec3(v_Corner, sqrt(1.0 - distanceSq));
+    vec4 clipSurface = u_Proj * vec4(v_ViewCenter + normal * v_Radius, 1.0);
+    float ndcDepth = clipSurface.z / clipSurface.w;
+    gl_FragDepth = 0.5 * (gl_DepthRange.diff * ndcDepth + gl_DepthRange.near + gl_DepthRange.far);
+
+    // lit from the camera, so the silhouette stays readable for any palette color
+    float diffuse = 0.35 + 0.65 * normal.z;
+    out_FragColor = vec4(COLORS[v_ColorIdx] * diffuse, 1.0);
+} // main
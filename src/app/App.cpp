@@ -1,5 +1,6 @@
 #include "app/App.hpp"
 
+#include "engine/AssetPack.hpp"
 #include "engine/BoxMesh.hpp"
 #include "engine/EngineLoop.hpp"
 #include "engine/IcosphereMesh.hpp"
@@ -7,6 +8,7 @@
 #include "engine/Unprojection.hpp"
 #include "engine/UvSphereMesh.hpp"
 #include "engine/gl/Common.hpp"
+#include "engine/gl/FrameConstants.hpp"
 #include "engine/gl/GpuBuffer.hpp"
 #include "engine/gl/ProceduralMeshes.hpp"
 #include "engine/gl/GpuProgramRegistry.hpp"
@@ -24,18 +26,40 @@
 
 namespace app {
 
-constexpr GLint ATTRIB_POSITION_LOCATION   = 0;
-constexpr GLint ATTRIB_UV_LOCATION         = 1;
-constexpr GLint ATTRIB_NORMAL_LOCATION     = 2;
-constexpr GLint UNIFORM_TEXTURE_LOCATION   = 0;
-constexpr GLint UNIFORM_TEXTURE_BINDING    = 0;
-constexpr GLint UNIFORM_MVP_LOCATION       = 10;
-constexpr GLint UBO_SAMPLER_TILING_BINDING = 4;
+constexpr GLint ATTRIB_POSITION_LOCATION        = 0;
+constexpr GLint ATTRIB_UV_LOCATION              = 1;
+constexpr GLint ATTRIB_NORMAL_LOCATION          = 2;
+constexpr GLint UNIFORM_TEXTURE_LOCATION        = 0;
+constexpr GLint UNIFORM_TEXTURE_BINDING         = 0;
+constexpr GLint UBO_SAMPLER_TILING_BINDING      = 4;
+constexpr std::string_view POINT_CLOUD_FILEPATH = "data/app/point_cloud.xpc";
+constexpr uint32_t PICKABLE_SPHERE               = 0U;
+constexpr uint32_t PICKABLE_LIGHT                = 1U;
+constexpr float LIGHT_ORBIT_PERIOD_SEC           = 2.3f;
+
+struct DrawConstants final {
+    alignas(16) glm::mat4 model{1.0f};
+};
+static_assert(engine::gl::Std140Block<DrawConstants>);
 
 Application::~Application() {
     XLOG("Disposing application");
     this->commonRenderers.Dispose(this->gl);
     this->flatRenderer.Dispose(this->gl);
+    if (this->pointCloud) { this->pointCloud->Dispose(this->gl); }
+    engine::gl::ReleaseProgram(this->gl, this->program);
+    this->gl.ShaderObjects().Clear();
+}
+
+// Watches files, which programs started to depend on since the previous call
+static void SubscribeNewShaderFiles(Application& app) {
+    std::shared_ptr<engine::gl::GpuProgramRegistry> shaderWatcher = app.gl.Programs();
+    for (auto const& filepath : shaderWatcher->TakeNewFilepathsToWatch()) {
+        if (filepath.empty()) { continue; }
+        if (!app.fileNotifier.SubscribeWatcher(shaderWatcher, filepath)) {
+            XLOGW("Failed to watch shader file {}", filepath);
+        }
+    }
 }
 
 static void ConfigureApplication(
@@ -43,32 +67,27 @@ static void ConfigureApplication(
     using namespace engine;
     glm::ivec2 maxScreenSize = windowCtx.WindowSize() * 4;
     app->gl.Initialize();
+    app->gl.ProgramBinaries().Initialize("cache/programs");
     gl::InitializeDebug(app->gl);
     assert(app->fileNotifier.Initialize());
-    std::shared_ptr<engine::gl::GpuProgramRegistry> shaderWatcher = app->gl.Programs();
-    // assert(app->fileNotifier.SubscribeWatcher(shaderWatcher, "data/app/shaders"));
 
     app->commonRenderers.Initialize(app->gl);
-    app->samplerNearestWrap = app->commonRenderers.CacheSampler(
-        "repeat/nearest",
-        gl::GpuSampler::Allocate(app->gl, "Sampler/NearestRepeat")
-            .WithLinearMagnify(false)
-            .WithLinearMinify(false)
-            .WithWrap(GL_REPEAT));
+    app->samplerNearestWrap =
+        app->commonRenderers.CacheSampler(app->gl, gl::SamplerDesc{.wrapS = GL_REPEAT}, "Sampler/NearestRepeat");
 
     std::vector<ShaderDefine> defines = {
         ShaderDefine::I32("ATTRIB_POSITION_LOCATION", ATTRIB_POSITION_LOCATION),
         ShaderDefine::I32("ATTRIB_UV_LOCATION", ATTRIB_UV_LOCATION),
-        ShaderDefine::I32("UNIFORM_MVP_LOCATION", UNIFORM_MVP_LOCATION),
+        ShaderDefine::UI32("UBO_FRAME_CONSTANTS_BINDING", gl::UBO_FRAME_CONSTANTS_BINDING),
+        ShaderDefine::UI32("UBO_DRAW_CONSTANTS_BINDING", gl::UBO_DRAW_CONSTANTS_BINDING),
         ShaderDefine::I32("UNIFORM_TEXTURE_LOCATION", UNIFORM_TEXTURE_LOCATION),
         ShaderDefine::I32("UNIFORM_TEXTURE_BINDING", UNIFORM_TEXTURE_BINDING),
         ShaderDefine::I32("UBO_SAMPLER_TILING_BINDING", UBO_SAMPLER_TILING_BINDING),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
+    app->program = LinkProgramFromFiles(
         app->gl, "data/app/shaders/triangle.vert", "data/app/shaders/texture.frag", std::move(defines), "Test program");
-    assert(maybeProgram);
-    app->program = std::move(*maybeProgram);
+    assert(app->program);
 
     app->boxMesh = gl::AllocateBoxMesh(
         app->gl, BoxMesh::Generate(VEC_ONES, true),
@@ -113,6 +132,49 @@ static void ConfigureApplication(
             .normalLocation   = ATTRIB_NORMAL_LOCATION,
         });
 
+    // NOTE: optional, built from a raw point array by "--build-point-cloud"
+    if (auto cloud = PointCloud::Open(POINT_CLOUD_FILEPATH)) {
+        app->pointCloud = gl::PointCloudRenderer::Allocate(app->gl, std::move(*cloud), {});
+    }
+
+    // the light orbits around the vertical axis, the orbit is rotated by an animation clip
+    float lightRadius   = 2.0f;
+    app->lightOrbitNode = app->transforms.Add(
+        TransformHierarchy::NO_PARENT,
+        Transform{.position = glm::vec3{0.0f}, .rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f}, .scale = VEC_ONES});
+    app->lightNode = app->transforms.Add(
+        app->lightOrbitNode,
+        Transform{
+            .position = glm::vec3{lightRadius, lightRadius, lightRadius + 1.0f},
+            .rotation = glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+            .scale    = VEC_ONES,
+        });
+    // a turn of the orbit is an animation clip with a single joint
+    {
+        constexpr size_t NUM_SAMPLES = 17U;
+        float times[NUM_SAMPLES];
+        glm::quat rotations[NUM_SAMPLES];
+        for (size_t i = 0; i < NUM_SAMPLES; ++i) {
+            float phase  = static_cast<float>(i) / static_cast<float>(NUM_SAMPLES - 1U);
+            times[i]     = phase * LIGHT_ORBIT_PERIOD_SEC;
+            rotations[i] = glm::angleAxis(phase * 2.0f * glm::pi<float>(), VEC_UP);
+        }
+        glm::vec3 const orbitCenter{0.0f};
+        std::ignore = app->lightOrbitClip.AddJoint(
+            CpuView<float const>{times, NUM_SAMPLES},
+            CpuView<glm::vec3 const>{&orbitCenter, 1},
+            CpuView<glm::quat const>{rotations, NUM_SAMPLES},
+            CpuView<glm::vec3 const>{&VEC_ONES, 1},
+            AnimationClip::Tolerance{});
+    }
+
+    // NOTE: the light box is refitted every frame
+    Aabb const pickables[] = {
+        Aabb{glm::vec3{-1.0f}, glm::vec3{1.0f}}, // PICKABLE_SPHERE
+        Aabb{glm::vec3{0.0f}, glm::vec3{0.0f}},  // PICKABLE_LIGHT
+    };
+    app->pickables.Build(CpuView<Aabb const>{pickables, std::size(pickables)});
+
     auto const& debugMesh = sphere;
     // app.debugPoints.SetColor(ColorCode::RED);
     // for (int32_t i = 0; i < debugMesh.vertexPositions.size(); ++i) {
@@ -131,10 +193,13 @@ static void ConfigureApplication(
     auto maybeTexture = gl::LoadTexture(
         app->gl,
         engine::gl::LoadTextureArgs{
-            .loader      = app->imageLoader,
-            .filepath    = "data/engine/textures/utils/uv_checker_8x8_bright.png",
-            .format      = GL_SRGB8,
-            .numChannels = 3,
+            .loader         = app->imageLoader,
+            .filepath       = "data/engine/textures/utils/uv_checker_8x8_bright.png",
+            .format         = GL_SRGB8,
+            .numChannels    = 3,
+            .withMips       = true,
+            .cacheDirectory = "cache/textures",
+            .compression    = BlockFormat::BC1,
         });
     assert(maybeTexture);
 
@@ -149,9 +214,10 @@ static void ConfigureApplication(
 
     // GL_RGB10_A2, GL_R11F_G11F_B10F, GL_RGBA16F, GL_RGBA8
     app->outputColor = gl::Texture::Allocate2D(
-        app->gl, GL_TEXTURE_2D, glm::ivec3(maxScreenSize.x, maxScreenSize.y, 0), GL_RGBA8, "Output/Color");
+        app->gl, GL_TEXTURE_2D, glm::ivec3(maxScreenSize.x, maxScreenSize.y, 0), GL_RGBA8, 1, "Output/Color");
     app->outputDepth = gl::Texture::Allocate2D(
-        app->gl, GL_TEXTURE_2D, glm::ivec3(maxScreenSize.x, maxScreenSize.y, 0), GL_DEPTH24_STENCIL8, "Output/Depth");
+        app->gl, GL_TEXTURE_2D, glm::ivec3(maxScreenSize.x, maxScreenSize.y, 0), GL_DEPTH24_STENCIL8, 1,
+        "Output/Depth");
     // app->renderbuffer      = gl::Renderbuffer::Allocate2D(maxScreenSize, GL_DEPTH24_STENCIL8, 0, "Test
     // renderbuffer");
     app->outputFramebuffer = gl::Framebuffer::Allocate(app->gl, "Main Pass FBO");
@@ -171,10 +237,7 @@ static void ConfigureApplication(
     //     XLOG("Changed file: {}", file);
     // });
 
-    for (auto it = shaderWatcher->FilepathsToWatchBegin(); it != shaderWatcher->FilepathsToWatchEnd(); ++it) {
-        if (it->size() == 0) { continue; }
-        assert(app->fileNotifier.SubscribeWatcher(shaderWatcher, *it));
-    }
+    SubscribeNewShaderFiles(*app);
 
     app->defaultRenderState = app->gl.RenderState().AddStateSetter("defaultState", [](){
         GLCALL(glDisable(GL_BLEND));
@@ -260,6 +323,17 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
 
     glm::mat4 camera = proj * view;
 
+    app->gl.UniformRing().BeginFrame(app->gl);
+    app->gl.UniformRing().PushAndBind(
+        gl::UBO_FRAME_CONSTANTS_BINDING,
+        gl::FrameConstants{
+            .view                = view,
+            .proj                = proj,
+            .viewProj            = camera,
+            .cameraWorldPosition = glm::vec4{cameraMovement.Position(), 1.0f},
+            .time                = glm::vec4{ctx.timeSec, ctx.prevFrametimeMs * 0.001f, 0.0f, 0.0f},
+        });
+
     if (app->debugMode == AppDebugMode::WIREFRAME) { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
 
     float rotationSpeed = ctx.timeSec * 0.5f;
@@ -284,9 +358,9 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
         app->commonRenderers.RenderAxes(app->gl, mvp, 0.4f, ColorCode::CYAN);
 
         constexpr GLint TEXTURE_SLOT = 0;
-        auto programGuard            = gl::UniformCtx(*app->program);
+        auto programGuard            = gl::UniformCtx(app->gl.Program(app->program));
         programGuard.SetUniformTexture(UNIFORM_TEXTURE_LOCATION, TEXTURE_SLOT);
-        programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(mvp));
+        app->gl.UniformRing().PushAndBind(gl::UBO_DRAW_CONSTANTS_BINDING, DrawConstants{.model = model});
         GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, UBO_SAMPLER_TILING_BINDING, app->uboSamplerTiling.Id()));
         app->gl.TextureUnits().Bind2D(TEXTURE_SLOT, app->texture.Id());
         // gl::GlTextureUnits::Bind2D(TEXTURE_SLOT, app->commonRenderers.TextureStubColor().Id());
@@ -299,7 +373,7 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
         model = glm::mat4(1.0f);
         model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
         model = glm::translate(model, VEC_ONES);
-        programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(camera * model));
+        app->gl.UniformRing().PushAndBind(gl::UBO_DRAW_CONSTANTS_BINDING, DrawConstants{.model = model});
 
         // if (windowCtx.IsMouseInsideWindow()) {
         //     gl::RenderVao(app->sphereMesh.Vao());
@@ -314,13 +388,33 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
         // lighted box
         GLCALL(glViewport(0, 0, renderSize.x, renderSize.y));
 
-        float lightRadius    = 2.0f;
-        glm::mat4 lightModel = glm::mat4{1.0f};
-        lightModel           = glm::rotate(lightModel, rotationSpeed * 5.5f, VEC_UP);
-        lightModel           = glm::translate(
-            lightModel, glm::vec3(lightRadius, lightRadius, lightRadius /* * glm::sin(ctx.timeSec) */ + 1.0f));
+        app->lightOrbitSampler.Sample(
+            app->lightOrbitClip, std::fmod(ctx.timeSec, app->lightOrbitClip.Duration()), app->lightOrbitPose);
+        ApplyPose(app->lightOrbitPose, CpuView<uint32_t const>{&app->lightOrbitNode, 1}, app->transforms);
+        app->transforms.Update();
+        glm::mat4 const& lightModel = app->transforms.WorldMatrix(app->lightNode);
         glm::vec3 lightPosition{gl::TransformOrigin(lightModel)};
 
+        app->pickables.SetObject(PICKABLE_LIGHT, Aabb{lightPosition - 0.2f, lightPosition + 0.2f});
+        app->pickables.Refit();
+        if (app->pickRequest) {
+            // a ray from the near plane to the far plane under the cursor
+            glm::vec2 ndc       = *app->pickRequest / glm::vec2{screenSize} * 2.0f - 1.0f;
+            ndc.y               = -ndc.y;
+            glm::mat4 invCamera = glm::inverse(camera);
+            glm::vec4 nearPoint = invCamera * glm::vec4{ndc, -1.0f, 1.0f};
+            glm::vec4 farPoint  = invCamera * glm::vec4{ndc, 1.0f, 1.0f};
+            glm::vec3 origin    = glm::vec3{nearPoint} / nearPoint.w;
+            glm::vec3 toFar     = glm::vec3{farPoint} / farPoint.w - origin;
+            auto hit            = app->pickables.RayCast(origin, glm::normalize(toFar), glm::length(toFar));
+            if (hit) {
+                XLOG("Picked object {} at distance {}", hit->objectIdx, hit->distance);
+            } else {
+                XLOG("Picked nothing", 0);
+            }
+            app->pickRequest = std::nullopt;
+        }
+
         glm::mat4 model = glm::mat4(1.0f);
         // model           = glm::rotate(model, glm::pi<float>() * 0.1f, glm::vec3(0.0f, 0.0f, 1.0f));
         // float modelScale = 1.0f;
@@ -370,6 +464,13 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
             });
     }
 
+    if (app->pointCloud) {
+        auto debugGroupGuard = gl::DebugGroupCtx(app->gl, "Point cloud pass");
+        app->gl.RenderState().DepthTestWrite();
+        app->pointCloud->Update(view, proj, static_cast<float>(renderSize.y));
+        app->pointCloud->Render(app->gl, camera);
+    }
+
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
     {
@@ -430,26 +531,35 @@ static void Render(engine::RenderCtx const& ctx, engine::WindowCtx const& window
         app->gl.RenderState().DepthTestWrite();
 
         auto debugGroupGuard = gl::DebugGroupCtx(app->gl, "Debug lines/points pass");
-        if (app->debugLines.IsDataDirty()) {
+        // NOTE: every producer of the frame is done by now, its per-thread buffers are merged without locks
+        app->debugDraw.Collect(app->debugLines, app->debugPoints);
+        // NOTE: when the last primitives expire, nothing is pushed, then an empty batch replaces the drawn one
+        if (app->debugLines.IsDataDirty() || app->hasDebugLinesOnGpu) {
+            app->hasDebugLinesOnGpu = app->debugLines.DataSize() > 0;
             app->commonRenderers.FlushLinesToGpu(app->debugLines.Data());
             app->debugLines.Clear();
         }
         app->commonRenderers.RenderLines(app->gl, camera);
 
-        if (app->debugPoints.IsDataDirty()) {
-            app->commonRenderers.FlushPointsToGpu(app->debugPoints.Data());
+        if (app->debugPoints.IsDataDirty() || app->hasDebugPointsOnGpu) {
+            app->hasDebugPointsOnGpu = app->debugPoints.DataSize() > 0 || app->debugPoints.CompactDataSize() > 0;
+            app->commonRenderers.FlushPointsToGpu(app->debugPoints.Data(), app->debugPoints.CompactData());
             app->debugPoints.Clear();
         }
-        app->commonRenderers.RenderPoints(app->gl, camera);
+        app->commonRenderers.RenderPoints(app->gl, view, proj);
     }
 
     app->commonRenderers.OnFrameEnd();
     app->gl.TextureUnits().RestoreState();
-
-    if (ctx.frameIdx % 100 == 0) {
-        bool filesChanged = app->fileNotifier.PollChanges();
-        if (filesChanged) { app->gl.Programs()->HotReloadPrograms(app->gl); }
-    }
+    app->gl.UniformRing().EndFrame();
+
+    // NOTE: hot reload and lazily compiled variants may depend on files, which weren't known before
+    SubscribeNewShaderFiles(*app);
+    // NOTE: changes are detected on a background thread, polling only drains its queue
+    bool filesChanged = app->fileNotifier.PollChanges();
+    if (filesChanged) { app->gl.Programs()->HotReloadPrograms(app->gl); }
+    app->gl.CompileScheduler().Poll(app->gl);
+    app->gl.ShaderObjects().EvictUnused();
 }
 
 static auto ConfigureWindow(engine::EngineHandle engine) {
@@ -546,6 +656,8 @@ static auto ConfigureWindow(engine::EngineHandle engine) {
             auto& windowCtx    = engine::GetWindowContext(engine);
             auto mousePosition = windowCtx.MousePosition();
             XLOG("LMB {} pos: {},{}", windowCtx.IsMouseInsideWindow(), mousePosition.x, mousePosition.y);
+            // NOTE: picked on the next frame, the render thread owns the scene
+            if (windowCtx.IsMouseInsideWindow()) { app->pickRequest = mousePosition; }
         });
 }
 
@@ -561,6 +673,9 @@ auto ColdStartApplication [[nodiscard]] (app::ApplicationState& destination) ->
     assert(!destination.app);
 
     XLOGW("ColdStartApplication");
+    // NOTE: missing pack isn't an error, assets are read from loose files then (see Main.cpp --pack-assets)
+    // In XDEBUG builds loose files override the pack, so hot reload keeps working after packing
+    std::ignore = engine::MountAssetPack("data.xpak");
 
     destination.app = std::make_unique<Application>();
     engine::SetApplicationData(destination.engine, &destination.app);
@@ -580,6 +695,7 @@ auto ColdStartApplication [[nodiscard]] (app::ApplicationState& destination) ->
 
 auto DestroyApplication(app::ApplicationState& destination) -> engine::EngineResult {
     destination.app.reset();
+    engine::UnmountAssetPacks();
     destination.engineData.reset();
     std::ignore = engine::DestroyEngine(destination.engine);
     return engine::EngineResult::SUCCESS;
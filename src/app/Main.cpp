@@ -1,7 +1,56 @@
 #include "app/App.hpp"
+#include "engine/AssetPack.hpp"
+#include "engine/Assets.hpp"
+#include "engine/BlockCompression.hpp"
 #include "engine/EngineLoop.hpp"
+#include "engine/PointCloud.hpp"
+
+namespace {
+
+auto MeasureCompression [[nodiscard]] (std::string_view imageFilepath) -> bool {
+    constexpr int32_t NUM_CHANNELS = 4;
+    engine::ImageLoader loader{};
+    auto image = loader.Load(imageFilepath, NUM_CHANNELS);
+    if (!image) {
+        XLOGE("Failed to load image {}: {}", imageFilepath, loader.LatestError());
+        return false;
+    }
+    auto pixels = loader.ImageData(image->loadedImageId);
+    for (auto format : {engine::BlockFormat::BC1, engine::BlockFormat::BC3, engine::BlockFormat::BC7}) {
+        for (auto quality : {engine::BlockCompressionQuality::FAST, engine::BlockCompressionQuality::NORMAL,
+                             engine::BlockCompressionQuality::SLOW}) {
+            auto stats = engine::MeasureBlockCompression(engine::BlockCompressionArgs{
+                .pixels      = pixels.data,
+                .size        = glm::ivec2{image->width, image->height},
+                .numChannels = NUM_CHANNELS,
+                .format      = format,
+                .quality     = quality,
+            });
+            XLOG(
+                "Format {} quality {}: PSNR={:.2f}dB, {:.1f} MPix/s", int(format), int(quality), stats.psnr,
+                stats.megapixelsPerSecond);
+        }
+    }
+    loader.Unpin(image->loadedImageId);
+    return true;
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int {
+    // NOTE: packs the data directory into a single file, which is mounted on start instead of loose files
+    if (argc > 1 && std::string_view{argv[1]} == "--pack-assets") {
+        return engine::AssetPack::Write("data.xpak", "data", /*compress*/ true) ? 0 : 1;
+    }
+    // NOTE: builds the octree of a raw array of engine::PointCloud::Point, see App for the path it's loaded from
+    if (argc > 3 && std::string_view{argv[1]} == "--build-point-cloud") {
+        return engine::PointCloud::Build(argv[3], argv[2]) ? 0 : 1;
+    }
+    // NOTE: measures CPU block compression of an image in every format and quality, no GPU is needed
+    if (argc > 2 && std::string_view{argv[1]} == "--measure-compression") {
+        return MeasureCompression(argv[2]) ? 0 : 1;
+    }
 
-auto main() -> int {
     // emulate context of hot reloading library CR
     cr_plugin crCtx{};
 
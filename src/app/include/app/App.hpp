@@ -1,8 +1,12 @@
 #pragma once
 
+#include "engine/Animation.hpp"
 #include "engine/Assets.hpp"
+#include "engine/Bvh.hpp"
+#include "engine/DebugDraw.hpp"
 #include "engine/EngineLoop.hpp"
 #include "engine/FirstPersonLocomotion.hpp"
+#include "engine/TransformHierarchy.hpp"
 #include "engine/gl/GlRenderStateRegistry.hpp"
 #include "engine/gl/GpuBuffer.hpp"
 #include "engine/gl/CommonRenderers.hpp"
@@ -12,6 +16,7 @@
 #include "engine/gl/GpuMesh.hpp"
 #include "engine/gl/GpuProgram.hpp"
 #include "engine/gl/GpuProgramRegistry.hpp"
+#include "engine/gl/PointCloudRenderer.hpp"
 #include "engine/gl/Renderbuffer.hpp"
 #include "engine/gl/SamplersCache.hpp"
 #include "engine/gl/Texture.hpp"
@@ -44,33 +49,45 @@ struct Application final {
     engine::FirstPersonLocomotion cameraMovement      = engine::FirstPersonLocomotion{};
     engine::FirstPersonLocomotion debugCameraMovement = engine::FirstPersonLocomotion{};
     // glm::vec3 cameraEulerRotation{0.0f, 0.0f, 0.0f};
-    glm::vec4 keyboardWasdPressed                          = glm::vec4{0.0f};
-    float keyboardShiftPressed                             = 0.0f;
-    float keyboardAltPressed                               = 0.0f;
-    bool controlDebugCamera                                = false;
-    bool controlDebugCameraSwitched                        = false;
-    engine::gl::GlContext gl                               = engine::gl::GlContext{};
-    engine::gl::GpuMesh boxMesh                            = engine::gl::GpuMesh{};
-    engine::gl::GpuMesh sphereMesh                         = engine::gl::GpuMesh{};
-    engine::gl::GpuMesh sphereMesh2                        = engine::gl::GpuMesh{};
-    engine::gl::GpuMesh planeMesh                          = engine::gl::GpuMesh{};
-    std::shared_ptr<engine::gl::GpuProgram> program        = {};
-    engine::gl::Texture texture                            = engine::gl::Texture{};
-    engine::gl::GpuBuffer uboSamplerTiling                 = engine::gl::GpuBuffer{};
-    UboDataSamplerTiling uboDataSamplerTiling              = {};
-    engine::gl::Framebuffer outputFramebuffer              = engine::gl::Framebuffer{};
-    engine::gl::Texture outputColor                        = engine::gl::Texture{};
-    engine::gl::Texture outputDepth                        = engine::gl::Texture{};
-    engine::gl::Texture backbufferColor                    = engine::gl::Texture{};
-    engine::gl::Texture backbufferDepth                    = engine::gl::Texture{};
-    engine::gl::Renderbuffer renderbuffer                  = engine::gl::Renderbuffer{};
-    engine::gl::CommonRenderers commonRenderers            = engine::gl::CommonRenderers{};
-    engine::gl::FlatRenderer flatRenderer                  = engine::gl::FlatRenderer{};
-    engine::gl::SamplersCache::CacheKey samplerNearestWrap = {};
-    engine::LineRendererInput debugLines                   = engine::LineRendererInput{};
-    engine::PointRendererInput debugPoints                 = engine::PointRendererInput{};
-    engine::ImageLoader imageLoader                        = engine::ImageLoader{};
-    AppDebugMode debugMode                                 = AppDebugMode::NONE;
+    glm::vec4 keyboardWasdPressed                            = glm::vec4{0.0f};
+    float keyboardShiftPressed                               = 0.0f;
+    float keyboardAltPressed                                 = 0.0f;
+    bool controlDebugCamera                                  = false;
+    bool controlDebugCameraSwitched                          = false;
+    engine::gl::GlContext gl                                 = engine::gl::GlContext{};
+    engine::gl::GpuMesh boxMesh                              = engine::gl::GpuMesh{};
+    engine::gl::GpuMesh sphereMesh                           = engine::gl::GpuMesh{};
+    engine::gl::GpuMesh sphereMesh2                          = engine::gl::GpuMesh{};
+    engine::gl::GpuMesh planeMesh                            = engine::gl::GpuMesh{};
+    engine::gl::GpuProgramHandle program                     = {};
+    engine::gl::Texture texture                              = engine::gl::Texture{};
+    engine::gl::GpuBuffer uboSamplerTiling                   = engine::gl::GpuBuffer{};
+    UboDataSamplerTiling uboDataSamplerTiling                = {};
+    engine::gl::Framebuffer outputFramebuffer                = engine::gl::Framebuffer{};
+    engine::gl::Texture outputColor                          = engine::gl::Texture{};
+    engine::gl::Texture outputDepth                          = engine::gl::Texture{};
+    engine::gl::Texture backbufferColor                      = engine::gl::Texture{};
+    engine::gl::Texture backbufferDepth                      = engine::gl::Texture{};
+    engine::gl::Renderbuffer renderbuffer                    = engine::gl::Renderbuffer{};
+    engine::gl::CommonRenderers commonRenderers              = engine::gl::CommonRenderers{};
+    engine::gl::FlatRenderer flatRenderer                    = engine::gl::FlatRenderer{};
+    engine::gl::SamplersCache::CacheKey samplerNearestWrap   = {};
+    engine::LineRendererInput debugLines                     = engine::LineRendererInput{};
+    engine::PointRendererInput debugPoints                   = engine::PointRendererInput{100'000};
+    engine::DebugDraw debugDraw                              = engine::DebugDraw{};
+    bool hasDebugLinesOnGpu                                  = false; // expired lines are replaced by an empty batch
+    bool hasDebugPointsOnGpu                                 = false;
+    std::optional<engine::gl::PointCloudRenderer> pointCloud = std::nullopt;
+    engine::Bvh pickables                                    = engine::Bvh{};
+    std::optional<glm::vec2> pickRequest                     = std::nullopt; // position of a click in the window
+    engine::TransformHierarchy transforms                    = engine::TransformHierarchy{};
+    uint32_t lightOrbitNode                                  = engine::TransformHierarchy::NO_PARENT;
+    uint32_t lightNode                                       = engine::TransformHierarchy::NO_PARENT;
+    engine::AnimationClip lightOrbitClip                     = engine::AnimationClip{};
+    engine::AnimationSampler lightOrbitSampler               = engine::AnimationSampler{};
+    engine::Pose lightOrbitPose                              = engine::Pose{};
+    engine::ImageLoader imageLoader                          = engine::ImageLoader{};
+    AppDebugMode debugMode                                   = AppDebugMode::NONE;
     engine::gl::RenderStateHandle defaultRenderState = {};
     engine::platform::FileChangeNotifier fileNotifier = engine::platform::FileChangeNotifier{};
     bool isInitialized                                = false;
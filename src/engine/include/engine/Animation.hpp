@@ -0,0 +1,147 @@
+#pragma once
+
+#include "engine/DualQuaternion.hpp"
+#include "engine/Precompiled.hpp"
+#include "engine/Transform.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+namespace engine {
+
+class TransformHierarchy;
+
+// Local transforms of joints in SoA, padded to a multiple of 4, so poses are sampled and blended 4 joints at once
+struct Pose final {
+    std::vector<float> positionX{};
+    std::vector<float> positionY{};
+    std::vector<float> positionZ{};
+    std::vector<float> rotationX{};
+    std::vector<float> rotationY{};
+    std::vector<float> rotationZ{};
+    std::vector<float> rotationW{};
+    std::vector<float> scaleX{};
+    std::vector<float> scaleY{};
+    std::vector<float> scaleZ{};
+    size_t numJoints{0U};
+
+    // New joints are identity transforms
+    void Resize(size_t newNumJoints);
+    void SetLocal(uint32_t joint, Transform const& local);
+    auto Local [[nodiscard]] (uint32_t joint) const -> Transform;
+};
+
+// Keyframe tracks of a skeleton, stored in SoA, each joint has position, rotation and scale tracks
+// Keys which are reproduced by interpolation of their neighbours within the tolerance of the track are removed,
+// rotations are quantized to 16 bits per component, so a clip takes a fraction of the raw samples
+class AnimationClip final {
+
+public:
+#define Self AnimationClip
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // Max error of the interpolated track, compared to the raw samples
+    struct Tolerance final {
+        float position = 0.001f;
+        float rotation = 0.001f; // radians
+        float scale    = 0.001f;
+    };
+
+    // Samples of one joint at increasing times, a track with a single sample is constant. Returns index of the joint
+    auto AddJoint [[nodiscard]] (
+        CpuView<float const> times,
+        CpuView<glm::vec3 const> positions,
+        CpuView<glm::quat const> rotations,
+        CpuView<glm::vec3 const> scales,
+        Tolerance const& tolerance) -> uint32_t;
+
+    // NOTE: storage of the keys, public for the sampling kernels
+    // Keys of all joints, one after another, keys of a joint are [keysBegin[joint], keysBegin[joint + 1])
+    struct Vec3Track final {
+        std::vector<uint32_t> keysBegin{0U};
+        std::vector<float> times{};
+        std::vector<float> x{};
+        std::vector<float> y{};
+        std::vector<float> z{};
+    };
+    struct QuatTrack final {
+        std::vector<uint32_t> keysBegin{0U};
+        std::vector<float> times{};
+        std::vector<int16_t> x{};
+        std::vector<int16_t> y{};
+        std::vector<int16_t> z{};
+        std::vector<int16_t> w{};
+    };
+
+    auto Duration [[nodiscard]] () const -> float { return duration_; }
+    auto NumJoints [[nodiscard]] () const -> size_t { return numJoints_; }
+    // Keys left after the reduction, of all tracks
+    auto NumKeys [[nodiscard]] () const -> size_t {
+        return positions_.times.size() + rotations_.times.size() + scales_.times.size();
+    }
+
+private:
+    friend class AnimationSampler;
+
+    Vec3Track positions_{};
+    QuatTrack rotations_{};
+    Vec3Track scales_{};
+    float duration_{0.0f};
+    size_t numJoints_{0U};
+};
+
+// Playback state of a clip for one actor, keeps a cursor per track, so sequential playback doesn't search for keys
+// NOTE: a sampler is used by one thread at a time, actors are sampled in parallel with a sampler each
+class AnimationSampler final {
+
+public:
+#define Self AnimationSampler
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // Evaluates all joints of the clip, time is clamped to the clip, e.g. fmod it for looping
+    void Sample(AnimationClip const& clip, float time, Pose& out);
+
+private:
+    // key at or before the last sampled time, per joint
+    std::vector<uint32_t> positionCursors_{};
+    std::vector<uint32_t> rotationCursors_{};
+    std::vector<uint32_t> scaleCursors_{};
+    // interpolated keys, per joint padded to a multiple of 4
+    std::vector<uint32_t> keysFrom_{};
+    std::vector<uint32_t> keysTo_{};
+    std::vector<float> alphas_{};
+};
+
+// NOTE: out may be one of the inputs, poses must have the same number of joints
+void BlendPoses(Pose const& from, Pose const& to, float weight, Pose& out);
+// Difference of pose from reference, in the local space of joints, to be applied on top of other poses
+void MakeAdditivePose(Pose const& pose, Pose const& reference, Pose& out);
+void ApplyAdditivePose(Pose const& base, Pose const& additive, float weight, Pose& out);
+
+// Sets local transforms of the nodes of the joints, nodeIds are per joint
+void ApplyPose(Pose const& pose, CpuView<uint32_t const> nodeIds, TransformHierarchy& hierarchy);
+// Skinning palettes, world * inverse bind matrix of each joint, from updated world matrices of the nodes
+void ComputeSkinningMatrices(
+    TransformHierarchy const& hierarchy,
+    CpuView<uint32_t const> nodeIds,
+    CpuView<glm::mat4 const> inverseBindMatrices,
+    CpuView<glm::mat4> outPalette);
+void ComputeSkinningDualQuats(
+    TransformHierarchy const& hierarchy,
+    CpuView<uint32_t const> nodeIds,
+    CpuView<glm::mat4 const> inverseBindMatrices,
+    CpuView<math::DualQuat> outPalette);
+
+} // namespace engine
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/platform/MappedFile.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+struct AssetPackEntry final {
+    CpuMemory<uint8_t const> storedData = CpuMemory<uint8_t const>{};
+    size_t numBytes                     = 0U; // uncompressed
+    bool isCompressed                   = false;
+};
+
+// Single file archive of assets, read through one memory mapping (no file opens or copies per asset)
+// File layout: header | entry index (sorted by path hash) | paths | entry 0 data | ... | entry N-1 data
+// NOTE: entry data is 64 bytes aligned, entries are optionally LZ compressed (see LzCompression)
+class AssetPack final {
+
+public:
+#define Self AssetPack
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // NOTE: returns nullopt if file is missing, corrupted or written by a different pack version
+    static auto Open [[nodiscard]] (std::string_view filepath) -> std::optional<AssetPack>;
+    // Packs every file under rootDirectory, paths are stored as rootDirectory/relative/path
+    // With compress, entries are stored compressed only if that saves at least 10% of their size
+    static auto Write [[nodiscard]] (std::string_view filepath, std::string_view rootDirectory, bool compress) -> bool;
+
+    // Binary search of the path hash, then comparison of the path itself
+    auto Find [[nodiscard]] (std::string_view assetPath) const -> std::optional<AssetPackEntry>;
+    auto NumEntries [[nodiscard]] () const -> size_t { return numEntries_; }
+    auto Filepath [[nodiscard]] () const -> std::string_view { return filepath_; }
+
+private:
+    platform::MappedFile file_{};
+    std::string filepath_{};
+    size_t numEntries_ = 0U;
+};
+
+// Bytes of an asset: either a view into a mounted pack, a mapped loose file, or a decompressed copy
+// NOTE: keeps its pack alive, so the memory stays valid even if the pack is unmounted meanwhile
+class AssetData final {
+
+public:
+#define Self AssetData
+    explicit Self(std::shared_ptr<AssetPack const> pack, CpuMemory<uint8_t const> bytes) noexcept
+        : pack_(std::move(pack))
+        , bytes_(bytes) { }
+    explicit Self(platform::MappedFile looseFile) noexcept
+        : looseFile_(std::move(looseFile))
+        , bytes_(looseFile_.Data()) { }
+    explicit Self(std::vector<uint8_t> decompressed) noexcept
+        : decompressed_(std::move(decompressed))
+        , bytes_(decompressed_.data(), decompressed_.size()) { }
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    auto Bytes [[nodiscard]] () const -> CpuMemory<uint8_t const> { return bytes_; }
+    auto Text [[nodiscard]] () const -> std::string_view {
+        return std::string_view{reinterpret_cast<char const*>(bytes_.data), bytes_.NumBytes()};
+    }
+    auto NumBytes [[nodiscard]] () const -> size_t { return bytes_.NumBytes(); }
+
+private:
+    std::shared_ptr<AssetPack const> pack_{};
+    platform::MappedFile looseFile_{};
+    std::vector<uint8_t> decompressed_{};
+    CpuMemory<uint8_t const> bytes_{};
+};
+
+// Mounted packs are searched from the latest mounted, asset paths are compared after normalization
+// ("./data\\a.png" is the same as "data/a.png")
+auto MountAssetPack [[nodiscard]] (std::string_view filepath) -> bool;
+void UnmountAssetPacks();
+// Reads from mounted packs, falls back to loose files (e.g. during development, when no pack is mounted)
+// In XDEBUG builds an existing loose file is read before the packs, so edits are picked up by hot reload
+// NOTE: thread-safe, loose files are mapped on each read, so their edits are visible
+auto ReadAsset [[nodiscard]] (std::string_view filepath) -> std::optional<AssetData>;
+
+} // namespace engine
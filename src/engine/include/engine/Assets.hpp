@@ -1,10 +1,16 @@
 #pragma once
 
+#include "engine/BlockCompression.hpp"
+#include "engine/MipGeneration.hpp"
 #include "engine/Precompiled.hpp"
 #include "engine/gl/Shader.hpp"
 
+#include <condition_variable>
 #include <fstream>
+#include <list>
+#include <mutex>
 #include <sstream>
+#include <string>
 #include <string_view>
 
 namespace engine {
@@ -20,15 +26,16 @@ auto LoadBinaryFile [[nodiscard]] (std::string_view const filepath, FileSizeCall
 
 using ImageLoaderHandle = int32_t;
 
+// Thread-safe cache of decoded images, bounded by a budget of decoded bytes (least recently used are freed first)
+// Loads from files are keyed by filepath + number of channels, so repeated loads of the same image are free.
+// Concurrent requests for the same image are deduplicated: only one thread decodes, others wait for its result.
+// NOTE: Load() returns a pinned image, its memory is never evicted until Unpin() is called with the same handle
 struct ImageLoader final {
 
 public:
 #define Self ImageLoader
-    explicit Self(size_t temporaryBufferNumBytes = 4 * 1024 * 1024) noexcept
-        : temporaryBuffer_(temporaryBufferNumBytes)
-        , loadedImages_{}
-        , nextImageId_{0}
-        , latestError_{} { }
+    explicit Self(size_t maxDecodedBytes = 256 * 1024 * 1024) noexcept
+        : maxDecodedBytes_(maxDecodedBytes) { }
     ~Self() noexcept;
     Self(Self const&)            = delete;
     Self& operator=(Self const&) = delete;
@@ -45,18 +52,57 @@ public:
         int32_t numChannelsDecoded = 0;
     };
 
-    auto Load(std::string_view const filepath, int32_t numDesiredChannels) -> std::optional<LoadInfo>;
-    auto Load(CpuMemory<uint8_t> encodedImageData, int32_t numDesiredChannels) -> std::optional<LoadInfo>;
+    struct Statistics {
+        int64_t numHits         = 0;
+        int64_t numMisses       = 0;
+        int64_t numEvictions    = 0;
+        int64_t numImages       = 0;
+        int64_t numPinnedImages = 0;
+        size_t numDecodedBytes  = 0U;
+    };
+
+    auto Load [[nodiscard]] (std::string_view const filepath, int32_t numDesiredChannels) -> std::optional<LoadInfo>;
+    auto Load [[nodiscard]] (CpuMemory<uint8_t> encodedImageData, int32_t numDesiredChannels)
+        -> std::optional<LoadInfo>;
 
-    auto ImageData(ImageLoaderHandle loadedImageId) const -> CpuView<uint8_t const>;
-    auto LatestError() const -> std::string_view { return latestError_; };
+    // Pinned image memory stays valid, until each Pin (including the one done by Load) is matched by Unpin
+    auto Pin [[nodiscard]] (ImageLoaderHandle loadedImageId) -> bool;
+    void Unpin(ImageLoaderHandle loadedImageId);
+
+    // NOTE: the returned memory is only valid while the image is pinned
+    auto ImageData [[nodiscard]] (ImageLoaderHandle loadedImageId) const -> CpuView<uint8_t const>;
+    auto LatestError [[nodiscard]] () const -> std::string_view;
+    auto GetStatistics [[nodiscard]] () const -> Statistics;
+    auto MaxDecodedBytes [[nodiscard]] () const -> size_t { return maxDecodedBytes_; }
+    void SetMaxDecodedBytes(size_t maxDecodedBytes);
+    // Frees all images which are not pinned
+    void Trim();
 
 private:
-    constexpr static int32_t MAX_LOADED_IMAGES                            = 32;
-    std::unordered_map<ImageLoaderHandle, CpuView<uint8_t>> loadedImages_ = {};
-    std::vector<uint8_t> temporaryBuffer_                                 = {};
-    ImageLoaderHandle nextImageId_                                        = 0;
-    std::string_view latestError_                                         = {};
+    struct CachedImage {
+        CpuView<uint8_t> data                              = CpuView<uint8_t>{};
+        LoadInfo info                                      = {};
+        std::string cacheKey                               = {};
+        std::list<ImageLoaderHandle>::iterator lruPosition = {};
+        int32_t numPins                                    = 0;
+        bool isDecoding                                    = false;
+    };
+    using KeyToImage = std::unordered_map<std::string, ImageLoaderHandle, StringHash, StringEqual>;
+
+    auto StoreDecoded(ImageLoaderHandle id, uint8_t* decodedImageData, LoadInfo const& info) -> LoadInfo;
+    void EvictUnpinnedImages(size_t maxDecodedBytes);
+    void TouchImage(CachedImage& image);
+
+    mutable std::mutex mutex_                                  = {};
+    std::condition_variable decodingFinished_                  = {};
+    std::unordered_map<ImageLoaderHandle, CachedImage> images_ = {};
+    KeyToImage keyToImage_                                     = {};
+    std::list<ImageLoaderHandle> lruImages_                    = {}; // front is the most recently used
+    size_t maxDecodedBytes_                                    = 0U;
+    size_t numDecodedBytes_                                    = 0U;
+    ImageLoaderHandle nextImageId_                             = 0;
+    Statistics statistics_                                     = {};
+    std::string_view latestError_                              = {};
 };
 
 } // namespace engine
@@ -65,9 +111,12 @@ namespace engine::gl {
 
 namespace shader {
 
-auto LoadShaderCode
-    [[nodiscard]] (std::string_view const filepath, ShaderType type, CpuView<ShaderDefine const> defines)
-    -> std::string;
+// NOTE: with includeGraph, it's filled with includes expanded into the shader (e.g. to know what to reload)
+auto LoadShaderCode [[nodiscard]] (
+    std::string_view const filepath, ShaderType type, CpuView<ShaderDefine const> defines,
+    IncludeGraph* includeGraph = nullptr) -> std::string;
+// Reads the include file again, for all includes loaded from it, returns false if no include uses the file
+auto ReloadShaderInclude [[nodiscard]] (std::string_view filepath) -> bool;
 } // namespace shader
 
 struct LoadTextureArgs final {
@@ -77,7 +126,19 @@ struct LoadTextureArgs final {
     int32_t numChannels             = 0;
     std::string_view name           = {};
     bool withMips                   = false;
+    // NOTE: empty directory disables the cache
+    std::string_view cacheDirectory = {};
+    // NOTE: falls back to uncompressed format, if GL doesn't support the block format
+    BlockFormat compression                    = BlockFormat::NONE;
+    BlockCompressionQuality compressionQuality = BlockCompressionQuality::NORMAL;
+    MipFilter mipFilter                        = MipFilter::KAISER;
+    // NOTE: decodes the compressed level 0 again to log its PSNR, for tuning only
+    bool logCompressionPsnr = false;
+    // NOTE: alpha test reference, which coverage is kept in mips (see MipGenerationArgs)
+    float alphaCoverageReference = -1.0f;
 };
+// With cacheDirectory, the first load bakes the texture with all its mips into a container file,
+// keyed by hash of the source file and the load args; next loads upload the mapped container without decoding
 auto LoadTexture [[nodiscard]] (GlContext& gl, LoadTextureArgs const& args) -> std::optional<Texture>;
 
 } // namespace engine::gl
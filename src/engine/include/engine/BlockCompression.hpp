@@ -0,0 +1,81 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+
+#include <glm/vec2.hpp>
+#include <vector>
+
+// NOTE: core profile GLAD doesn't define S3TC enums (EXT_texture_compression_s3tc, EXT_texture_sRGB)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace engine {
+
+// BC1 - RGB 4bpp (alpha is dropped)
+// BC3 - RGBA 8bpp (BC1 color + BC4 alpha)
+// BC7 - RGBA 8bpp, best quality (only mode 6 is produced: one subset, 7777.1 endpoints, 4 bit indices)
+enum class BlockFormat : uint8_t {
+    NONE = 0,
+    BC1,
+    BC3,
+    BC7,
+};
+
+// FAST - bounding box endpoints
+// NORMAL - principal axis endpoints + a least squares refinement
+// SLOW - more refinement iterations, BC7 also searches all p-bit combinations
+enum class BlockCompressionQuality : uint8_t {
+    FAST = 0,
+    NORMAL,
+    SLOW,
+};
+
+struct BlockCompressionArgs final {
+    uint8_t const* pixels           = nullptr; // tightly packed rows of 8 bit channels
+    glm::ivec2 size                 = glm::ivec2{0};
+    int32_t numChannels             = 4; // 1 and 2 are treated as gray and gray+alpha
+    BlockFormat format              = BlockFormat::BC7;
+    BlockCompressionQuality quality = BlockCompressionQuality::NORMAL;
+};
+
+// Number of bytes per 4x4 block
+auto BlockFormatBytes [[nodiscard]] (BlockFormat format) -> size_t;
+// NOTE: images are padded to whole blocks, by repeating edge pixels
+auto BlockCompressedSize [[nodiscard]] (BlockFormat format, glm::ivec2 size) -> size_t;
+auto GlCompressedFormat [[nodiscard]] (BlockFormat format, bool isSrgb) -> GLenum;
+
+// Encodes the image block by block, rows of blocks are spread over all cores (see ParallelFor)
+// Destination must have BlockCompressedSize bytes
+void CompressBlocks(BlockCompressionArgs const& args, CpuMemory<uint8_t> destination);
+auto CompressBlocks [[nodiscard]] (BlockCompressionArgs const& args) -> std::vector<uint8_t>;
+
+// Decodes into tightly packed RGBA8 destination of size.x * size.y * 4 bytes
+// NOTE: only BC7 mode 6 is decoded (other modes produce magenta), it's enough to verify the encoder
+void DecompressBlocks(
+    BlockFormat format, CpuMemory<uint8_t const> blocks, glm::ivec2 size, CpuMemory<uint8_t> destination);
+
+// Peak signal-to-noise ratio (dB) of the decoded blocks against the source image of args
+// Only channels that format preserves are compared (e.g. alpha is ignored for BC1)
+auto ComputeBlockCompressionPsnr [[nodiscard]] (BlockCompressionArgs const& args, CpuMemory<uint8_t const> blocks)
+    -> double;
+
+struct BlockCompressionStats final {
+    double psnr                = 0.0;
+    double megapixelsPerSecond = 0.0;
+};
+
+// Compresses the image, then decodes it to compute PSNR, only the compression is timed
+// NOTE: runs on CPU only, so the encoder can be tuned and tested without a GPU (see Main.cpp --measure-compression)
+auto MeasureBlockCompression [[nodiscard]] (BlockCompressionArgs const& args) -> BlockCompressionStats;
+
+} // namespace engine
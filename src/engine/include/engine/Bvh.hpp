@@ -0,0 +1,89 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/Unprojection.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace engine {
+
+struct Aabb final {
+    // NOTE: default is empty, any point grows it
+    glm::vec3 min = glm::vec3{std::numeric_limits<float>::max()};
+    glm::vec3 max = glm::vec3{std::numeric_limits<float>::lowest()};
+};
+
+// Bounding volume hierarchy over AABBs of objects, for culling, picking and overlap queries
+// Nodes are 4-wide: a node stores boxes of its 4 children in SoA, so one SIMD instruction tests all of them
+// Built top-down by binned SAH, big subtrees are built in parallel
+// Moving objects are updated by Refit, which keeps the topology, so boxes of nodes overlap more over time
+// When the SAH cost grows too much compared to the built tree, it's rebuilt from scratch
+class Bvh final {
+
+public:
+#define Self Bvh
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    static constexpr uint32_t WIDTH = 4U;
+
+    struct alignas(64) Node final {
+        float minX[WIDTH];
+        float minY[WIDTH];
+        float minZ[WIDTH];
+        float maxX[WIDTH];
+        float maxY[WIDTH];
+        float maxZ[WIDTH];
+        uint32_t child[WIDTH];      // index of a node, or of the first object of a leaf in ObjectsOrder()
+        uint32_t numObjects[WIDTH]; // 0 if the child is a node or the lane is empty
+    };
+    static_assert(sizeof(Node) == 128U); // 2 cache lines
+
+    struct RayHit final {
+        uint32_t objectIdx = 0U;
+        float distance     = 0.0f;
+    };
+
+    // Objects are referred by their index in the view
+    void Build(CpuView<Aabb const> objects);
+    // NOTE: nodes aren't updated until Refit, so all moved objects are processed at once
+    void SetObject(uint32_t objectIdx, Aabb const& box);
+    // Returns true if the tree was rebuilt instead
+    auto Refit() -> bool;
+
+    // Nearest object whose box is hit by the ray, direction doesn't need to be normalized
+    auto RayCast [[nodiscard]] (
+        glm::vec3 origin, glm::vec3 direction, float maxDistance = std::numeric_limits<float>::max()) const
+        -> std::optional<RayHit>;
+    // Appends objects whose boxes are at least partially inside the frustum
+    void QueryFrustum(FrustumPlanes const& planes, std::vector<uint32_t>& objects) const;
+    void QueryOverlap(Aabb const& box, std::vector<uint32_t>& objects) const;
+
+    auto Nodes [[nodiscard]] () const -> std::vector<Node> const& { return nodes_; }
+    auto ObjectsOrder [[nodiscard]] () const -> std::vector<uint32_t> const& { return objectsOrder_; }
+    auto NumObjects [[nodiscard]] () const -> size_t { return boxes_.size(); }
+    // Sum of surface areas of all child boxes, relative to the root box
+    auto Cost [[nodiscard]] () const -> float;
+
+private:
+    struct Builder;
+
+    void Rebuild();
+
+    std::vector<Node> nodes_{};              // a parent is always before its children
+    std::vector<uint32_t> parentSlots_{};    // node * WIDTH + lane in the parent, NO_SLOT for the root
+    std::vector<Aabb> boxes_{};
+    std::vector<uint32_t> objectsOrder_{};   // objects of a leaf are adjacent
+    std::vector<uint32_t> objectSlots_{};    // node * WIDTH + lane of the leaf of the object
+    std::vector<uint32_t> movedObjects_{};
+    std::vector<uint8_t> isNodeDirty_{};
+    float builtCost_ = 0.0f;
+};
+
+} // namespace engine
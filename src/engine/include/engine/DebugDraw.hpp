@@ -0,0 +1,62 @@
+#pragma once
+
+#include "engine/LineRendererInput.hpp"
+#include "engine/PointRendererInput.hpp"
+#include "engine/Precompiled.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace engine {
+
+// Debug lines and points, which any thread may push without locks (e.g. from ParallelFor tasks)
+// Each thread appends to its own buffer, the buffers are concatenated into renderer inputs once per frame
+// There's no color/transform state, unlike LineRendererInput, so threads don't interfere with each other
+// A primitive may live for several frames, then it's drawn each frame without pushing it again
+class DebugDraw final {
+
+public:
+#define Self DebugDraw
+    explicit Self() noexcept;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = delete;
+    Self& operator=(Self&&)      = delete;
+#undef Self
+
+    // NOTE: the first push of a thread takes a lock to register its buffer, the following pushes don't
+    void PushLine(glm::vec3 worldBegin, glm::vec3 worldEnd, ColorCode color, uint32_t numFrames = 1U);
+    void PushRay(glm::vec3 worldBegin, glm::vec3 worldDirection, ColorCode color, uint32_t numFrames = 1U);
+    void PushPoint(glm::vec3 worldPosition, float scale, ColorCode color, uint32_t numFrames = 1U);
+    void PushPoint(glm::mat4 const& transformToWorld, ColorCode color, uint32_t numFrames = 1U);
+
+    // Appends primitives of all threads to the inputs, drops the ones which lived their number of frames
+    // NOTE: must not run concurrently with pushes, call it on the render thread before flushing the inputs to GPU
+    void Collect(LineRendererInput& lines, PointRendererInput& points);
+    // Drops every primitive, including the ones, which should live for more frames
+    void Clear();
+
+private:
+    struct ThreadBuffer final {
+        std::vector<LineRendererInput::Line> lines                  = {};
+        std::vector<uint32_t> linesFramesLeft                       = {};
+        std::vector<PointRendererInput::Point> points               = {};
+        std::vector<uint32_t> pointsFramesLeft                      = {};
+        std::vector<PointRendererInput::CompactPoint> compactPoints = {};
+        std::vector<uint32_t> compactPointsFramesLeft               = {};
+        std::thread::id thread                                      = {};
+    };
+
+    auto LocalBuffer [[nodiscard]] () -> ThreadBuffer&;
+
+    std::mutex buffersMutex_                            = {}; // guards the list, not contents of buffers
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_ = {};
+    uint64_t instanceId_                                = 0U; // thread caches of a destroyed instance are stale
+
+    static std::atomic<uint64_t> nextInstanceId_;
+};
+
+} // namespace engine
@@ -1,14 +1,17 @@
 #pragma once
 
+#include "engine/Precompiled.hpp"
+
 #include <glm/gtc/quaternion.hpp>
 
 namespace engine::math {
 
-auto RotateByQuat(glm::vec3 vertex, glm::vec4 quat) -> glm::vec3{
-    //   glm::vec3 uv = glm::cross(quat.xyz, vertex);
-    //   glm::vec3 uuv = glm::cross(quat.xyz, uv);
-    //   return vertex + ((uv * quat.w) + uuv) * 2.0;
-};
+// quat is stored as (x, y, z, w), same as memory layout of glm::quat
+inline auto RotateByQuat(glm::vec3 vertex, glm::vec4 quat) -> glm::vec3 {
+    glm::vec3 uv  = glm::cross(glm::vec3{quat}, vertex);
+    glm::vec3 uuv = glm::cross(glm::vec3{quat}, uv);
+    return vertex + ((uv * quat.w) + uuv) * 2.0f;
+}
 
 struct DualNumber final {
     float real;
@@ -21,23 +24,53 @@ struct DualNumber final {
         };
     }
 
-    auto Add(DualNumber rhs) -> DualNumber {
+    auto Add(DualNumber rhs) const -> DualNumber {
         return DualNumber{
             .real = real + rhs.real,
             .dual = dual + rhs.dual,
         };
     }
 
-    auto Mul(DualNumber rhs) -> DualNumber {
+    auto Mul(DualNumber rhs) const -> DualNumber {
         return DualNumber{.real = real * rhs.real, .dual = dual * rhs.real + real * rhs.dual};
     }
 };
 
+// Rigid transform as r + epsilon * d, where r is rotation and d = 0.5 * t * r, t is translation
+// Unlike matrices, blending of dual quaternions keeps the result rigid, so skinned joints don't collapse
+// NOTE: memory layout is 8 floats: real (x, y, z, w), dual (x, y, z, w), the same as the GLSL include expects
 struct DualQuat final {
     glm::quat real;
     glm::quat dual;
 
-    auto Transform(glm::vec3 v) const -> glm::vec3 { }
+    static auto Identity() -> DualQuat {
+        return DualQuat{
+            .real = glm::quat{1.0f, 0.0f, 0.0f, 0.0f},
+            .dual = glm::quat{0.0f, 0.0f, 0.0f, 0.0f},
+        };
+    }
+
+    static auto FromRotationTranslation(glm::quat rotation, glm::vec3 translation) -> DualQuat {
+        return DualQuat{
+            .real = rotation,
+            .dual = glm::quat{0.0f, translation.x, translation.y, translation.z} * rotation * 0.5f,
+        };
+    }
+
+    // NOTE: expects a unit dual quaternion
+    auto Translation() const -> glm::vec3 {
+        glm::quat t = dual * glm::conjugate(real) * 2.0f;
+        return glm::vec3{t.x, t.y, t.z};
+    }
+
+    // NOTE: expects a unit dual quaternion
+    auto Transform(glm::vec3 v) const -> glm::vec3 {
+        return RotateByQuat(v, glm::vec4{real.x, real.y, real.z, real.w}) + Translation();
+    }
+
+    auto Rotate(glm::vec3 v) const -> glm::vec3 {
+        return RotateByQuat(v, glm::vec4{real.x, real.y, real.z, real.w});
+    }
 
     auto DualConjugate() const -> DualQuat {
         return DualQuat{
@@ -63,51 +96,72 @@ struct DualQuat final {
 
     auto MagnitudeReal() const -> float { return glm::dot(real, real); }
 
-    void Normalize() { Mul(1.0f / MagnitudeReal()); }
+    // Makes the real part unit, and the dual part orthogonal to it
+    void Normalize() {
+        float invLength = 1.0f / glm::sqrt(MagnitudeReal());
+        real            = real * invLength;
+        dual            = dual * invLength;
+        dual            = dual - real * glm::dot(real, dual);
+    }
+
+    auto Normalized() const -> DualQuat {
+        DualQuat result = *this;
+        result.Normalize();
+        return result;
+    }
 
     auto IsNormal() const -> bool {
         auto normSqr = MagnitudeSqr();
         return std::abs(normSqr.real - 1.0f) < 0.0001f && std::abs(normSqr.dual - 0.0f) < 0.0001f;
     }
 
-    auto Add(DualQuat rhs) -> DualQuat {
+    auto Add(DualQuat rhs) const -> DualQuat {
         return DualQuat{
             .real = real + rhs.real,
             .dual = dual + rhs.dual,
         };
     }
 
-    auto Mul(DualQuat rhs) -> DualQuat {
+    // Applies rhs first, same as for matrices
+    auto Mul(DualQuat rhs) const -> DualQuat {
         return DualQuat{
             .real = real * rhs.real,
             .dual = dual * rhs.real + real * rhs.dual,
         };
     }
 
-    auto Mul(float rhs) -> DualQuat {
+    auto Mul(float rhs) const -> DualQuat {
         return DualQuat{
             .real = real * rhs,
             .dual = dual * rhs,
         };
     }
 };
+static_assert(sizeof(DualQuat) == 8U * sizeof(float));
 
 struct DualQuatTransform final {
     // to convert into 4x4 matrix
     // the dual quat should be stored in form
-    // q = r + t * epsilon * r
+    // q = r + 0.5 * t * epsilon * r
     // https://en.wikipedia.org/wiki/Dual_quaternion#Dual_quaternions_and_4%C3%974_homogeneous_transforms
     glm::quat rotation;
     glm::vec3 translation;
 
-    explicit operator DualQuat() const {
-        return DualQuat{
-            .real = rotation,
-            .dual = glm::quat(0.0f, translation.x, translation.y, translation.z) * rotation,
-        };
-    }
+    explicit operator DualQuat() const { return DualQuat::FromRotationTranslation(rotation, translation); }
 
-    auto Transform(glm::vec3 v) const -> glm::vec3 { }
+    auto Transform(glm::vec3 v) const -> glm::vec3 {
+        return RotateByQuat(v, glm::vec4{rotation.x, rotation.y, rotation.z, rotation.w}) + translation;
+    }
 };
 
-} // namespace engine::math
\ No newline at end of file
+// NOTE: scale and shear of the matrix are lost, a dual quaternion is a rigid transform
+auto DualQuatFromMatrix [[nodiscard]] (glm::mat4 const& transform) -> DualQuat;
+auto DualQuatToMatrix [[nodiscard]] (DualQuat const& dq) -> glm::mat4;
+
+// Screw linear interpolation, moves along the shortest screw motion with constant speed
+auto ScLerp [[nodiscard]] (DualQuat const& from, DualQuat const& to, float t) -> DualQuat;
+// Dual quaternion linear blending, weighted sum which is normalized, the shortest paths are used
+// NOTE: approximates ScLerp, but much cheaper, and works with any number of dual quaternions
+auto BlendDlb [[nodiscard]] (CpuView<DualQuat const> dqs, CpuView<float const> weights) -> DualQuat;
+
+} // namespace engine::math
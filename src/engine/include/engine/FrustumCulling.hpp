@@ -0,0 +1,59 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/Unprojection.hpp"
+
+#include <vector>
+
+namespace engine {
+
+// Bounding volumes of many objects in SoA layout, so one SIMD register holds the same coordinate of 4 objects
+// Every object has a sphere and an AABB: the sphere test is done first for all planes, and only objects
+// which intersect a plane with their sphere are tested again with the tighter box
+// NOTE: the plane which culled a group of objects last time is tested first, objects rarely move between frames
+class CullingVolumes final {
+
+public:
+#define Self CullingVolumes
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // Returns index of the object, it's reported by Cull, the sphere is computed around the box
+    auto Push [[nodiscard]] (glm::vec3 boxMin, glm::vec3 boxMax) -> uint32_t;
+    void Set(uint32_t objectIdx, glm::vec3 boxMin, glm::vec3 boxMax);
+    void Clear();
+
+    // Returns sorted indices of objects which are at least partially inside the frustum, or touch it
+    // Large number of objects is split between threads of ParallelFor
+    // NOTE: planes must be normalized, see CameraToPlanes. The result is valid until the next call
+    auto Cull [[nodiscard]] (FrustumPlanes const& planes) -> CpuMemory<uint32_t const>;
+
+    auto NumObjects [[nodiscard]] () const -> size_t { return numObjects_; }
+
+private:
+    void CullGroups(glm::vec4 const* planes, size_t groupsBegin, size_t groupsEnd, uint32_t* visible, size_t& numVisible);
+
+    // padded to a multiple of 4 with empty volumes, which are always culled
+    std::vector<float> centerX_{};
+    std::vector<float> centerY_{};
+    std::vector<float> centerZ_{};
+    std::vector<float> radius_{};
+    std::vector<float> minX_{};
+    std::vector<float> minY_{};
+    std::vector<float> minZ_{};
+    std::vector<float> maxX_{};
+    std::vector<float> maxY_{};
+    std::vector<float> maxZ_{};
+    std::vector<uint8_t> lastCullingPlane_{}; // per group of 4 objects
+    size_t numObjects_{0U};
+
+    std::vector<uint32_t> visible_{};         // each chunk of threads writes at its offset, then it's compacted
+    std::vector<uint32_t> chunkNumVisible_{};
+};
+
+} // namespace engine
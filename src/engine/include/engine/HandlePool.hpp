@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+// Index into a HandlePool, with the generation of the slot it was given by, packed into 32 bits
+// A handle of a removed object is stale, the pool detects it instead of returning another object of the same slot
+// NOTE: Tag only makes handles of different pools incompatible types, it doesn't need to be complete
+template <typename Tag> struct Handle final {
+    static constexpr uint32_t NUM_INDEX_BITS      = 20U;
+    static constexpr uint32_t NUM_GENERATION_BITS = 32U - NUM_INDEX_BITS;
+    static constexpr uint32_t MAX_INDEX           = (1U << NUM_INDEX_BITS) - 1U;
+    static constexpr uint32_t MAX_GENERATION      = (1U << NUM_GENERATION_BITS) - 1U;
+
+    // NOTE: generation 0 is never given, so a zeroed handle is null
+    uint32_t bits = 0U;
+
+    static constexpr auto Make [[nodiscard]] (uint32_t index, uint32_t generation) -> Handle {
+        assert(index <= MAX_INDEX && generation <= MAX_GENERATION);
+        return Handle{.bits = index | (generation << NUM_INDEX_BITS)};
+    }
+    constexpr auto Index [[nodiscard]] () const -> uint32_t { return bits & MAX_INDEX; }
+    constexpr auto Generation [[nodiscard]] () const -> uint32_t { return bits >> NUM_INDEX_BITS; }
+    constexpr auto IsNull [[nodiscard]] () const -> bool { return bits == 0U; }
+    constexpr explicit operator bool() const { return bits != 0U; }
+    constexpr auto operator==(Handle const&) const -> bool = default;
+};
+
+// Owns objects in a dense array, addressed by generational handles, lookups are O(1) and don't touch other slots
+// Removal moves the last object into the gap, so iteration over Begin()/End() stays contiguous
+// NOTE: pointers given by Get are valid until the next Emplace or Remove, keep handles instead
+// NOTE: isn't thread-safe, handles are plain values and may be passed between threads
+template <typename T, typename Tag = T> class HandlePool final {
+
+public:
+    using HandleType = Handle<Tag>;
+
+#define Self HandlePool
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    template <typename... Args> auto Emplace [[nodiscard]] (Args&&... args) -> HandleType {
+        uint32_t slotIdx;
+        if (freeSlots_.empty()) {
+            slotIdx = static_cast<uint32_t>(slots_.size());
+            assert(slotIdx <= HandleType::MAX_INDEX && "HandlePool is out of handle indices");
+            slots_.push_back(Slot{});
+        } else {
+            slotIdx = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        auto& slot    = slots_[slotIdx];
+        slot.denseIdx = static_cast<uint32_t>(items_.size());
+        items_.emplace_back(std::forward<Args>(args)...);
+        denseToSlot_.push_back(slotIdx);
+        return HandleType::Make(slotIdx, slot.generation);
+    }
+
+    // Returns nullptr for a null or stale handle
+    auto Get [[nodiscard]] (HandleType handle) -> T* {
+        uint32_t denseIdx = DenseIdx(handle);
+        return denseIdx == INVALID_IDX ? nullptr : &items_[denseIdx];
+    }
+    auto Get [[nodiscard]] (HandleType handle) const -> T const* {
+        uint32_t denseIdx = DenseIdx(handle);
+        return denseIdx == INVALID_IDX ? nullptr : &items_[denseIdx];
+    }
+    auto Contains [[nodiscard]] (HandleType handle) const -> bool { return DenseIdx(handle) != INVALID_IDX; }
+
+    // Destroys the object, its handle and all copies of it become stale; returns false if it already was
+    auto Remove(HandleType handle) -> bool {
+        uint32_t denseIdx = DenseIdx(handle);
+        if (denseIdx == INVALID_IDX) { return false; }
+        uint32_t lastIdx = static_cast<uint32_t>(items_.size()) - 1U;
+        if (denseIdx != lastIdx) {
+            // NOTE: swapped instead of moved over, so the removed object is destroyed, not overwritten
+            std::swap(items_[denseIdx], items_[lastIdx]);
+            denseToSlot_[denseIdx]                  = denseToSlot_[lastIdx];
+            slots_[denseToSlot_[denseIdx]].denseIdx = denseIdx;
+        }
+        items_.pop_back();
+        denseToSlot_.pop_back();
+
+        auto& slot    = slots_[handle.Index()];
+        slot.denseIdx = INVALID_IDX;
+        // NOTE: a slot which used all generations is retired, otherwise an ancient handle could become valid again
+        if (slot.generation == HandleType::MAX_GENERATION) { return true; }
+        ++slot.generation;
+        freeSlots_.push_back(handle.Index());
+        return true;
+    }
+
+    void Clear() {
+        for (uint32_t slotIdx : denseToSlot_) {
+            auto& slot    = slots_[slotIdx];
+            slot.denseIdx = INVALID_IDX;
+            if (slot.generation == HandleType::MAX_GENERATION) { continue; }
+            ++slot.generation;
+            freeSlots_.push_back(slotIdx);
+        }
+        items_.clear();
+        denseToSlot_.clear();
+    }
+
+    auto NumItems [[nodiscard]] () const -> size_t { return items_.size(); }
+    auto Begin [[nodiscard]] () -> T* { return items_.data(); }
+    auto End [[nodiscard]] () -> T* { return items_.data() + items_.size(); }
+    auto Begin [[nodiscard]] () const -> T const* { return items_.data(); }
+    auto End [[nodiscard]] () const -> T const* { return items_.data() + items_.size(); }
+    // Handle of the object at the dense position, for iteration over Begin()/End()
+    auto HandleAt [[nodiscard]] (size_t denseIdx) const -> HandleType {
+        uint32_t slotIdx = denseToSlot_[denseIdx];
+        return HandleType::Make(slotIdx, slots_[slotIdx].generation);
+    }
+
+private:
+    static constexpr uint32_t INVALID_IDX = ~0U;
+
+    struct Slot final {
+        uint32_t denseIdx   = INVALID_IDX;
+        uint32_t generation = 1U;
+    };
+
+    auto DenseIdx [[nodiscard]] (HandleType handle) const -> uint32_t {
+        uint32_t slotIdx = handle.Index();
+        if (slotIdx >= slots_.size()) { return INVALID_IDX; }
+        auto const& slot = slots_[slotIdx];
+        return slot.generation == handle.Generation() ? slot.denseIdx : INVALID_IDX;
+    }
+
+    std::vector<T> items_              = {};
+    std::vector<uint32_t> denseToSlot_ = {};
+    std::vector<Slot> slots_           = {}; // by handle index
+    std::vector<uint32_t> freeSlots_   = {};
+};
+
+} // namespace engine
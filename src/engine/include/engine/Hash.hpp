@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace engine {
+
+// Non-cryptographic 64-bit hash of a byte range (MurmurHash64A), consumes 8 bytes per step
+auto HashBytes [[nodiscard]] (void const* data, size_t numBytes, uint64_t seed = 0U) -> uint64_t;
+
+// Order dependent mixing of two hash values
+constexpr auto HashCombine [[nodiscard]] (uint64_t seed, uint64_t value) -> uint64_t {
+    value *= 0xC6A4A7935BD1E995ULL;
+    value ^= value >> 47;
+    value *= 0xC6A4A7935BD1E995ULL;
+    seed ^= value;
+    return seed * 0xC6A4A7935BD1E995ULL + 0xE6546B64ULL;
+}
+
+} // namespace engine
@@ -39,15 +39,30 @@ public:
     void SetColor(ColorCode color);
     void PushLine(glm::vec3 worldBegin, glm::vec3 worldEnd);
     void PushRay(glm::vec3 worldBegin, glm::vec3 worldDirection);
+    // Lines are already in world space with their colors, current transform and color aren't applied
+    void PushLines(CpuView<Line const> lines);
     void Clear();
 
+    // Batches of lines with current transform and color, points are transformed 4 at a time (SSE if available)
+    // NOTE: the lines are written in place, after one resize of the storage
+    void PushLines(CpuView<glm::vec3 const> begins, CpuView<glm::vec3 const> ends);
+    void PushLineStrip(CpuView<glm::vec3 const> points, bool isClosed = false);
+    void PushWireBox(glm::vec3 boxMin, glm::vec3 boxMax);
+    // 3 circles around the axes
+    void PushWireSphere(glm::vec3 center, float radius, uint32_t numSegments = 24U);
+
 private:
+    // Appends numLines, and returns the first of them
+    auto AllocateLines [[nodiscard]] (size_t numLines) -> Line*;
+
     size_t maxLines_{};
     std::vector<Line> lines_{};
+    std::vector<glm::vec3> scratchPoints_{};
     glm::mat4 customTransform_{};
     ColorCode currentColor_{ColorCode::WHITE};
     bool isDirty_{false};
     bool hasTransform_{false};
+    bool isAffineTransform_{false}; // the homogeneous divide is skipped
 };
 
 } // namespace engine
\ No newline at end of file
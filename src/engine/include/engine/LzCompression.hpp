@@ -0,0 +1,23 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+
+#include <vector>
+
+namespace engine {
+
+// Byte-oriented LZ77 codec, the stream is compatible with LZ4 block format (no frame header, no checksum)
+// Greedy matching over a hash table of 4 byte sequences: fast to encode, decoding is just memory copies
+
+// Worst case size of compressed data (incompressible input grows slightly)
+auto LzCompressBound [[nodiscard]] (size_t numBytes) -> size_t;
+
+// Returns the number of bytes written, destination must have at least LzCompressBound bytes
+auto LzCompress [[nodiscard]] (CpuMemory<uint8_t const> source, CpuMemory<uint8_t> destination) -> size_t;
+auto LzCompress [[nodiscard]] (CpuMemory<uint8_t const> source) -> std::vector<uint8_t>;
+
+// Destination must have exactly the uncompressed number of bytes (it's not stored in the stream)
+// NOTE: every read and write is bounds checked, returns false on malformed or truncated input
+auto LzDecompress [[nodiscard]] (CpuMemory<uint8_t const> source, CpuMemory<uint8_t> destination) -> bool;
+
+} // namespace engine
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+// BOX - 2x2 average, fastest
+// KAISER - Kaiser windowed sinc (radius 3, alpha 4), sharp without visible ringing
+// LANCZOS - Lanczos3, sharpest, may ring on hard edges
+enum class MipFilter : uint8_t {
+    BOX = 0,
+    KAISER,
+    LANCZOS,
+};
+
+enum class MipPixelType : uint8_t {
+    UINT8 = 0,
+    FLOAT32,
+};
+
+struct MipGenerationArgs final {
+    void const* pixels     = nullptr; // level 0, tightly packed rows
+    glm::ivec2 size        = glm::ivec2{0};
+    int32_t numChannels    = 4; // NOTE: last channel of 2 and 4 channel images is alpha
+    MipPixelType pixelType = MipPixelType::UINT8;
+    // NOTE: only for UINT8, color channels are decoded to linear before filtering and encoded back after
+    bool isSrgb = false;
+    MipFilter filter = MipFilter::KAISER;
+    // NOTE: alpha test reference in [0, 1], alpha of each mip is scaled to keep the coverage of level 0
+    // (otherwise alpha tested foliage thins out with distance), negative value disables it
+    float alphaCoverageReference = -1.0f;
+    int32_t numLevels            = 0; // including level 0, 0 means the full chain down to 1x1
+};
+
+// Number of levels in a full mip chain, down to 1x1
+// NOTE: the only mip size helpers, textures and texture containers use them too
+auto MipChainLength [[nodiscard]] (glm::ivec2 size) -> int32_t;
+auto MipLevelSize [[nodiscard]] (glm::ivec2 size, int32_t level) -> glm::ivec2;
+
+// Filters every level from the previous one (kept in linear float, so there's no requantization drift)
+// Rows of each level are processed on all cores (see ParallelFor), the result doesn't depend on threading
+// Returns levels 1..numLevels-1 with tightly packed rows of the source pixelType, level 0 isn't copied
+auto GenerateMips [[nodiscard]] (MipGenerationArgs const& args) -> std::vector<std::vector<uint8_t>>;
+
+} // namespace engine
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace engine {
+
+using ParallelTask = std::function<void(size_t itemsBegin, size_t itemsEnd)>;
+
+// Number of threads which process ParallelFor tasks, including the calling thread
+auto NumParallelThreads [[nodiscard]] () -> int32_t;
+
+// Splits items [0, numItems) into chunks of itemsPerChunk and processes them on a pool of worker threads.
+// The calling thread processes chunks too, and returns only when all items are done.
+// NOTE: task is called concurrently and in no particular order, it may call ParallelFor itself
+void ParallelFor(size_t numItems, size_t itemsPerChunk, ParallelTask const& task);
+
+} // namespace engine
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/platform/MappedFile.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+// Point cloud split into an octree of chunks, read through one memory mapping, so it may be bigger than RAM
+// Each node stores a spatially uniform subsample of its subtree, children store the rest, no point is duplicated
+// So any cut of the tree from the root is a valid level of detail, and nodes are loaded independently
+// File layout: header | nodes (children of a node are adjacent, after it) | points of nodes
+class PointCloud final {
+
+public:
+#define Self PointCloud
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    struct Point final {
+        glm::vec3 position;
+        uint32_t color; // RGBA8, R in the lowest byte
+    };
+    static_assert(sizeof(Point) == 16U);
+
+    struct Node final {
+        glm::vec3 boundsMin  = glm::vec3{0.0f};
+        float size           = 0.0f; // nodes are cubes
+        uint64_t firstPoint  = 0U;
+        uint32_t numPoints   = 0U;
+        uint32_t firstChild  = 0U; // 0 for a leaf, the root is never a child
+        uint32_t numChildren = 0U;
+        uint32_t depth       = 0U;
+    };
+
+    // NOTE: returns nullopt if file is missing, corrupted or written by a different version
+    static auto Open [[nodiscard]] (std::string_view filepath) -> std::optional<PointCloud>;
+    // Builds the octree offline from a raw array of Point, e.g. converted from LAS or PLY
+    // NOTE: a source bigger than maxMemoryBytes is built out of core, through temporary files next to filepath
+    // (about 2x of the source on disk), fails if too many points are in 1/8^6 of the bounds to be sorted in budget
+    static auto Build [[nodiscard]] (
+        std::string_view filepath, std::string_view rawPointsFilepath, uint32_t maxPointsPerNode = 16'384U,
+        size_t maxMemoryBytes = size_t{1} << 30U) -> bool;
+
+    auto Nodes [[nodiscard]] () const -> std::vector<Node> const& { return nodes_; }
+    // NOTE: memory is mapped, the first touch of a node's points may read them from disk
+    auto NodePoints [[nodiscard]] (uint32_t nodeIdx) const -> CpuMemory<Point const>;
+    auto MaxPointsPerNode [[nodiscard]] () const -> uint32_t { return maxPointsPerNode_; }
+    auto NumPoints [[nodiscard]] () const -> uint64_t { return numPoints_; }
+    auto Filepath [[nodiscard]] () const -> std::string_view { return filepath_; }
+
+private:
+    platform::MappedFile file_{};
+    std::string filepath_{};
+    std::vector<Node> nodes_{};
+    uint64_t pointsOffset_     = 0U;
+    uint64_t numPoints_        = 0U;
+    uint32_t maxPointsPerNode_ = 0U;
+};
+
+} // namespace engine
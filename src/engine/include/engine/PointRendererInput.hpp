@@ -18,26 +18,47 @@ public:
     Self& operator=(Self&&)      = default;
 #undef Self
 
+    // Arbitrary transform, opt-in for points which aren't uniformly scaled or need an orientation
     struct Point final {
         glm::mat4 transform;
         int32_t colorIdx;
     };
 
+    // Position and uniform scale, the common case, 4x smaller than Point
+    struct CompactPoint final {
+        glm::vec3 position;
+        uint16_t halfScale; // half float, see glm::packHalf1x16
+        uint16_t colorIdx;
+    };
+    static_assert(sizeof(CompactPoint) == 16U);
+
+    static auto MakeCompactPoint [[nodiscard]] (glm::vec3 worldPosition, float scale, ColorCode color)
+        -> CompactPoint;
+
     auto IsDataDirty [[nodiscard]] () const -> bool { return isDirty_; }
     auto DataSize [[nodiscard]] () const -> int32_t { return points_.size(); }
     auto Data [[nodiscard]] () -> std::vector<Point> const& {
         isDirty_ = false;
         return points_;
     }
+    auto CompactDataSize [[nodiscard]] () const -> int32_t { return compactPoints_.size(); }
+    auto CompactData [[nodiscard]] () -> std::vector<CompactPoint> const& {
+        isDirty_ = false;
+        return compactPoints_;
+    }
     void SetColor(ColorCode color);
+    // NOTE: points given by position are compact, points given by matrix aren't
     void PushPoint(glm::vec3 worldPosition, float scale = 1.0f);
     void PushPoint(glm::vec3 worldPosition, float scale, ColorCode color);
     void PushPoint(glm::mat4 const& transformToWorld, ColorCode color);
+    void PushPoints(CpuView<Point const> points);
+    void PushPoints(CpuView<CompactPoint const> points);
     void Clear();
 
 private:
     size_t maxPoints_{};
     std::vector<Point> points_{};
+    std::vector<CompactPoint> compactPoints_{};
     ColorCode currentColor_{};
     bool isDirty_{false};
 };
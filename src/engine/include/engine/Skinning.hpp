@@ -0,0 +1,53 @@
+#pragma once
+
+#include "engine/DualQuaternion.hpp"
+#include "engine/Precompiled.hpp"
+
+#include <vector>
+
+namespace engine {
+
+// Bind pose of skinned vertices with up to 4 joint influences, in SoA, so 4 vertices are skinned at once by SIMD
+// Skinned positions and normals are written into strided views, e.g. of a mapped vertex buffer
+// Large meshes are split between threads of ParallelFor
+// NOTE: linear blending of matrices shrinks twisted joints (candy-wrapper), dual quaternions keep the volume
+class SkinnedVertices final {
+
+public:
+#define Self SkinnedVertices
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    static constexpr uint32_t MAX_INFLUENCES = 4U;
+
+    // NOTE: weights should sum up to 1, unused influences have weight 0
+    void Push(glm::vec3 position, glm::vec3 normal, glm::uvec4 joints, glm::vec4 weights);
+    void Clear();
+
+    // Joint matrices are bind-to-pose transforms, i.e. include the inverse bind matrix
+    void SkinLinearBlend(
+        CpuView<glm::mat4 const> jointMatrices, CpuView<glm::vec3> positions, CpuView<glm::vec3> normals) const;
+    void SkinDualQuat(
+        CpuView<math::DualQuat const> jointDualQuats, CpuView<glm::vec3> positions, CpuView<glm::vec3> normals) const;
+
+    auto NumVertices [[nodiscard]] () const -> size_t { return numVertices_; }
+
+private:
+    // padded to a multiple of 4 with vertices without influences
+    std::vector<float> positionX_{};
+    std::vector<float> positionY_{};
+    std::vector<float> positionZ_{};
+    std::vector<float> normalX_{};
+    std::vector<float> normalY_{};
+    std::vector<float> normalZ_{};
+    std::vector<uint16_t> joints_[MAX_INFLUENCES]{};
+    std::vector<float> weights_[MAX_INFLUENCES]{};
+    size_t numVertices_{0U};
+};
+
+} // namespace engine
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/platform/MappedFile.hpp"
+
+#include <glm/vec2.hpp>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+// NOTE: GL_NONE data format means that level data is already compressed in internalFormat
+struct TextureContainerDesc final {
+    GLenum internalFormat = GL_NONE;
+    GLenum dataFormat     = GL_NONE;
+    GLenum dataType       = GL_NONE;
+    glm::ivec2 size       = glm::ivec2{0};
+    int32_t numLevels     = 0;
+    uint64_t sourceHash   = 0U;
+    uint64_t argsHash     = 0U;
+};
+
+// Baked GPU-ready texture with the full mip chain (similar to KTX2), read through a memory mapping
+// File layout: header | level index | level 0 data | ... | level N-1 data, each level is 16 bytes aligned
+class TextureContainer final {
+
+public:
+#define Self TextureContainer
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // NOTE: returns nullopt if file is missing, corrupted or written by a different container version
+    static auto Open [[nodiscard]] (std::string_view filepath) -> std::optional<TextureContainer>;
+    // NOTE: writes into a temporary file first, so concurrent readers never observe a partially written container
+    static auto Write [[nodiscard]] (
+        std::string_view filepath, TextureContainerDesc const& desc,
+        std::vector<CpuMemory<uint8_t const>> const& levels) -> bool;
+
+    auto Desc [[nodiscard]] () const -> TextureContainerDesc const& { return desc_; }
+    auto IsCompressed [[nodiscard]] () const -> bool { return desc_.dataFormat == GL_NONE; }
+    auto LevelSize [[nodiscard]] (int32_t level) const -> glm::ivec2;
+    // NOTE: memory is valid for the lifetime of the container
+    auto LevelData [[nodiscard]] (int32_t level) const -> CpuMemory<uint8_t const>;
+
+private:
+    platform::MappedFile file_{};
+    TextureContainerDesc desc_{};
+    std::vector<CpuMemory<uint8_t const>> levels_{};
+};
+
+} // namespace engine
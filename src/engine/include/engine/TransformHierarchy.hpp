@@ -0,0 +1,79 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/Transform.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+namespace engine {
+
+// Tree of transforms, local TRS are stored in SoA sorted by depth in the tree, so parents precede children
+// Update recomputes world matrices level by level in linear sweeps, only for dirty nodes and their descendants
+// Nodes of one level don't depend on each other, so big levels are split between threads of ParallelFor
+// World matrices are contiguous, in the same sorted order, so they can be uploaded as instance data directly
+// NOTE: nodes are referred by ids, which are stable. Sorted order changes when nodes are added
+class TransformHierarchy final {
+
+public:
+#define Self TransformHierarchy
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    static constexpr uint32_t NO_PARENT = ~0U;
+
+    // Returns id of the node, the parent must be added before
+    auto Add [[nodiscard]] (uint32_t parentId, Transform const& local) -> uint32_t;
+    void SetLocal(uint32_t id, Transform const& local);
+    void SetPosition(uint32_t id, glm::vec3 position);
+    void SetRotation(uint32_t id, glm::quat rotation);
+    void SetScale(uint32_t id, glm::vec3 scale);
+    auto Local [[nodiscard]] (uint32_t id) const -> Transform;
+
+    // Recomputes world matrices of dirty nodes and of all their descendants
+    void Update();
+
+    // NOTE: world matrices are valid after Update
+    auto WorldMatrix [[nodiscard]] (uint32_t id) const -> glm::mat4 const& { return world_[idToIndex_[id]]; }
+    // Sorted by depth, use IndexOf to find a node in them
+    auto WorldMatrices [[nodiscard]] () const -> CpuMemory<glm::mat4 const> {
+        return CpuMemory<glm::mat4 const>{world_.data(), world_.size()};
+    }
+    auto IndexOf [[nodiscard]] (uint32_t id) const -> uint32_t { return idToIndex_[id]; }
+    auto NumNodes [[nodiscard]] () const -> size_t { return parent_.size(); }
+    auto NumLevels [[nodiscard]] () const -> size_t { return levelsBegin_.empty() ? 0U : levelsBegin_.size() - 1U; }
+
+private:
+    // Sorts new nodes into their levels
+    void SortByDepth();
+    void UpdateRange(size_t indexBegin, size_t indexEnd);
+
+    // indexed by sorted index
+    std::vector<float> positionX_{};
+    std::vector<float> positionY_{};
+    std::vector<float> positionZ_{};
+    std::vector<float> rotationX_{};
+    std::vector<float> rotationY_{};
+    std::vector<float> rotationZ_{};
+    std::vector<float> rotationW_{};
+    std::vector<float> scaleX_{};
+    std::vector<float> scaleY_{};
+    std::vector<float> scaleZ_{};
+    std::vector<uint32_t> parent_{}; // sorted index of the parent, NO_PARENT for roots
+    std::vector<uint32_t> depth_{};
+    std::vector<uint8_t> isDirty_{};
+    std::vector<glm::mat4> world_{};
+    std::vector<uint32_t> indexToId_{};
+
+    std::vector<uint32_t> idToIndex_{};
+    std::vector<uint32_t> levelsBegin_{}; // sorted index of the first node of each level, and the end
+    bool isSorted_{true};
+    bool isAnyDirty_{false};
+};
+
+} // namespace engine
@@ -23,14 +23,14 @@ public:
 
     static auto Allocate [[nodiscard]] (GlContext& gl) -> AxesRenderer;
     void Render(GlContext& gl, glm::mat4 const& mvp, float scale = 1.0f) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
     Vao vao_                            = Vao{};
     GpuBuffer attributeBuffer_          = GpuBuffer{};
     GpuBuffer indexBuffer_              = GpuBuffer{};
-    std::shared_ptr<GpuProgram> customizedProgram_ = {};
-    std::shared_ptr<GpuProgram> defaultProgram_    = {};
+    GpuProgramHandle customizedProgram_ = {};
+    GpuProgramHandle defaultProgram_    = {};
 };
 
 } // namespace engine::gl
@@ -31,11 +31,11 @@ public:
     // BillboardRenderer::DEFAULT_UNIFORM_TEXTURE_LOCATION
     static auto Allocate [[nodiscard]] (GlContext& gl, GLuint fragmentShader = GL_NONE) -> BillboardRenderer;
     void Render(GlContext& gl, BillboardRenderArgs const& args) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
-    std::shared_ptr<GpuProgram> customVaoProgram_ = {};
-    std::shared_ptr<GpuProgram> quadVaoProgram_ = {};
+    GpuProgramHandle customVaoProgram_ = {};
+    GpuProgramHandle quadVaoProgram_ = {};
     GpuBuffer ubo_ = GpuBuffer{};
 
     static GLint constexpr DEFAULT_UNIFORM_TEXTURE_LOCATION = 0;
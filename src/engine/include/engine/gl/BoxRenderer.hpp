@@ -22,13 +22,13 @@ public:
 
     static auto Allocate [[nodiscard]] (GlContext& gl) -> BoxRenderer;
     void Render(GlContext& gl, glm::mat4 const& centerMvp, glm::vec4 color) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
     Vao vao_;
     GpuBuffer attributeBuffer_;
     GpuBuffer indexBuffer_;
-    std::shared_ptr<GpuProgram> program_ = {};
+    GpuProgramHandle program_ = {};
 };
 
 } // namespace engine::gl
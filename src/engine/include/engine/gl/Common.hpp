@@ -3,6 +3,7 @@
 
 #include "engine/ShaderDefine.hpp"
 #include "engine/CpuView.hpp"
+#include "engine/HandlePool.hpp"
 
 #include <glad/gl.h>
 #include <glm/mat4x4.hpp>
@@ -83,19 +84,27 @@ struct GlContext;
 struct GpuProgram;
 struct Vao;
 
+// Programs are owned by GlContext, users keep handles, which stay valid across hot-reloads
+using GpuProgramHandle = Handle<GpuProgram>;
+
 auto CompileGlShader [[nodiscard]] (GLenum shaderType, std::string_view code, bool logFail) -> GLuint;
+// Logs info log of the shader, if it failed to compile (e.g. after its program failed to link)
+void LogShaderErrors(GLuint shader);
 void CompileShader(engine::gl::shader::ShaderCreateInfo& info, engine::CpuView<engine::ShaderDefine const> defines, bool logCode);
 
 auto LinkProgram [[nodiscard]] (
     GlContext& gl, shader::ShaderCreateInfo vertex, shader::ShaderCreateInfo fragment,
     engine::CpuView<engine::ShaderDefine const> defines, std::string_view name = {}, bool logCode = false) -> std::optional<GpuProgram>;
+// Returns a null handle, if the program fails to link
 auto LinkProgramFromFiles [[nodiscard]](
     GlContext& gl, std::string_view vertexFilepath, std::string_view fragmentFilepath,
     std::vector<ShaderDefine>&& defines, std::string_view name, bool logCode = false)
--> std::optional<std::shared_ptr<GpuProgram>>;
+-> GpuProgramHandle;
+// Deletes the program and stops its hot-reloading, copies of the handle become stale
+void ReleaseProgram(GlContext& gl, GpuProgramHandle program);
 
 auto RelinkProgram [[nodiscard]](
-    GlContext const& gl, shader::ShaderCreateInfo vertex, shader::ShaderCreateInfo fragment,
+    GlContext& gl, shader::ShaderCreateInfo vertex, shader::ShaderCreateInfo fragment,
     GpuProgram const& oldProgram, CpuView<ShaderDefine const> defines, bool logCode) -> bool;
 
 void RenderVao(Vao const&, GLenum primitive = GL_TRIANGLES);
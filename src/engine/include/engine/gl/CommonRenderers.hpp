@@ -29,7 +29,7 @@ public:
     Self& operator=(Self&&)      = delete;
 #undef Self
 
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
     void Initialize(GlContext& gl);
     auto IsInitialized [[nodiscard]] () const -> bool { return isInitialized_; }
@@ -45,8 +45,9 @@ public:
     void RenderBillboard(GlContext& gl, BillboardRenderArgs const& args) const;
     void RenderLines(GlContext& gl, glm::mat4 const& camera) const;
     void FlushLinesToGpu(std::vector<LineRendererInput::Line> const&);
-    void RenderPoints(GlContext& gl, glm::mat4 const& camera) const;
-    void FlushPointsToGpu(std::vector<PointRendererInput::Point> const&);
+    void RenderPoints(GlContext& gl, glm::mat4 const& view, glm::mat4 const& proj) const;
+    void FlushPointsToGpu(
+        std::vector<PointRendererInput::Point> const&, std::vector<PointRendererInput::CompactPoint> const&);
     void RenderEditorGrid(GlContext& gl, glm::vec3 cameraWorldPosition, glm::mat4 const& camera) const;
 
     void RenderFulscreenTriangle(GlContext& gl) const;
@@ -61,7 +62,9 @@ public:
         return samplersCache_.GetSampler(samplerLinearRepeat_);
     }
 
-    auto CacheSampler [[nodiscard]] (std::string_view name, GpuSampler&& sampler) -> SamplersCache::CacheKey;
+    // NOTE: samplers with the same parameters are shared, see SamplersCache
+    auto CacheSampler [[nodiscard]] (GlContext& gl, SamplerDesc const& desc, std::string_view name = {})
+        -> SamplersCache::CacheKey;
     auto FindSampler [[nodiscard]] (SamplersCache::CacheKey sampler) const -> GpuSampler const&;
 
 private:
@@ -76,13 +79,15 @@ private:
     LineRendererInput debugLines_ = LineRendererInput{MAX_LINES};
 
     constexpr static size_t MAX_POINTS = 10'000;
+    constexpr static size_t MAX_COMPACT_POINTS = 100'000;
     PointRenderer pointRenderer_ = PointRenderer{};
     int32_t pointsFirstExternalIdx_ = 0;
     int32_t pointsLimitInternal_ = 0;
     int32_t pointsLimitExternal_ = 0;
+    int32_t numCompactPoints_ = 0;
     PointRendererInput debugPoints_ = PointRendererInput{MAX_POINTS};
 
-    std::shared_ptr<GpuProgram> blitProgram_ = {};
+    GpuProgramHandle blitProgram_ = {};
     SamplersCache::CacheKey samplerNearest_ = {};
     SamplersCache::CacheKey samplerLinear_ = {};
     SamplersCache::CacheKey samplerLinearRepeat_ = {};
@@ -7,7 +7,12 @@
 #include "engine/gl/Vao.hpp"
 #include "engine/gl/GlExtensions.hpp"
 #include "engine/gl/TextureUnits.hpp"
+#include "engine/gl/GpuProgram.hpp"
 #include "engine/gl/GpuProgramRegistry.hpp"
+#include "engine/gl/ProgramBinaryCache.hpp"
+#include "engine/gl/ShaderCompileScheduler.hpp"
+#include "engine/gl/ShaderObjectCache.hpp"
+#include "engine/gl/UniformRingBuffer.hpp"
 #include <memory>
 
 namespace engine::gl {
@@ -33,7 +38,23 @@ public:
     auto Capabilities [[nodiscard]] () const -> GlCapabilities const& { return capabilities_; }
     auto TextureUnits [[nodiscard]] () -> GlTextureUnits& { return textureUnits_; }
     auto Programs [[nodiscard]] () const -> std::shared_ptr<GpuProgramRegistry> { return programsRegistry_; }
+    // NOTE: a program is replaced in place on hot-reload, so handles to it never change
+    auto ProgramPool [[nodiscard]] () -> HandlePool<GpuProgram>& { return programPool_; }
+    auto ProgramPool [[nodiscard]] () const -> HandlePool<GpuProgram> const& { return programPool_; }
+    auto Program [[nodiscard]] (GpuProgramHandle handle) const -> GpuProgram const& {
+        auto const* program = programPool_.Get(handle);
+        assert(program != nullptr && "GpuProgramHandle is null or stale");
+        return *program;
+    }
+    // NOTE: disabled until initialized with a cache directory
+    auto ProgramBinaries [[nodiscard]] () -> ProgramBinaryCache& { return programBinaryCache_; }
+    auto ProgramBinaries [[nodiscard]] () const -> ProgramBinaryCache const& { return programBinaryCache_; }
+    // NOTE: must be polled every frame, see ShaderCompileScheduler::Poll
+    auto CompileScheduler [[nodiscard]] () -> ShaderCompileScheduler& { return compileScheduler_; }
+    auto ShaderObjects [[nodiscard]] () -> ShaderObjectCache& { return shaderObjects_; }
     auto RenderState [[nodiscard]] () -> GlRenderStateRegistry& { return renderStateRegistry_; }
+    // NOTE: frames must be delimited by BeginFrame/EndFrame, see UniformRingBuffer
+    auto UniformRing [[nodiscard]] () -> UniformRingBuffer& { return uniformRing_; }
 
     auto VaoDatalessTriangle [[nodiscard]] () const -> Vao const& { return datalessTriangleVao_; }
     auto VaoDatalessQuad [[nodiscard]] () const -> Vao const& { return datalessQuadVao_; }
@@ -46,6 +67,11 @@ private:
     GlRenderStateRegistry renderStateRegistry_{};
     // NOTE: it's a shared ptr, because it's given by a weak ptr into filesystem watcher
     std::shared_ptr<GpuProgramRegistry> programsRegistry_ = {};
+    HandlePool<GpuProgram> programPool_ = HandlePool<GpuProgram>{};
+    ProgramBinaryCache programBinaryCache_{};
+    ShaderCompileScheduler compileScheduler_{};
+    ShaderObjectCache shaderObjects_{};
+    UniformRingBuffer uniformRing_{};
 
     Vao datalessTriangleVao_ = Vao{};
     Vao datalessQuadVao_ = Vao{};
@@ -31,10 +31,10 @@ public:
 
     static auto Allocate [[nodiscard]] (GlContext& gl) -> EditorGridRenderer;
     void Render(GlContext& gl, RenderArgs const&) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
-    std::shared_ptr<GpuProgram> program_ = {};
+    GpuProgramHandle program_ = {};
     GpuBuffer ubo_ = GpuBuffer{};
     GLint uboLocation_ = -1;
 #undef Self
@@ -5,6 +5,7 @@
 #include "engine/gl/Context.hpp"
 #include "engine/gl/IGlDisposable.hpp"
 #include "engine/gl/GpuProgram.hpp"
+#include "engine/gl/GpuProgramFamily.hpp"
 #include "engine/gl/Vao.hpp"
 #include <glm/mat4x4.hpp>
 
@@ -24,14 +25,13 @@ public:
     Self& operator=(Self&&)      = default;
 #undef Self
 
+    // NOTE: a variant is compiled on its first use, variants used by the last run are compiled here
     static auto Allocate [[nodiscard]] (GlContext& gl) -> FlatRenderer;
-    void Render(GlContext& gl, FlatRenderArgs const&) const;
-    void Dispose(GlContext const& gl) override;
+    void Render(GlContext& gl, FlatRenderArgs const&);
+    void Dispose(GlContext& gl) override;
 
 private:
-    std::shared_ptr<GpuProgram> program_ = {};
-    GpuBuffer ubo_ = GpuBuffer{};
-    GLint uboLocation_ = -1;
+    GpuProgramFamily programs_ = GpuProgramFamily{};
 };
 
 struct FlatRenderArgs {
@@ -42,6 +42,8 @@ struct FlatRenderArgs {
     float materialSpecularIntensity = 1.0f;
     float materialSpecularPower     = 128.0f;
     GLenum primitive                = GL_TRIANGLES;
+    bool useSpecular                = true;
+    bool usePhong                   = false; // Blinn-Phong otherwise
     Vao const& vaoWithNormal;
     glm::mat4 const& mvp;
     glm::mat4 const& modelToWorld;
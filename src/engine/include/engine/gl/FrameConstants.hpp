@@ -0,0 +1,30 @@
+#pragma once
+
+#include "engine/gl/UniformRingBuffer.hpp"
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <cstddef>
+
+namespace engine::gl {
+
+// Uniform block bindings reserved by the engine, shaders get them by defines of the same names
+// Per-draw blocks share one binding, each draw binds its own range of the UniformRingBuffer
+constexpr GLuint UBO_FRAME_CONSTANTS_BINDING = 1;
+constexpr GLuint UBO_DRAW_CONSTANTS_BINDING  = 2;
+
+// Matches "common/ubo/frame" block, pushed and bound once at the start of a frame
+struct FrameConstants final {
+    alignas(16) glm::mat4 view{1.0f};
+    alignas(16) glm::mat4 proj{1.0f};
+    alignas(16) glm::mat4 viewProj{1.0f};
+    alignas(16) glm::vec4 cameraWorldPosition{0.0f, 0.0f, 0.0f, 1.0f};
+    alignas(16) glm::vec4 time{0.0f}; // x - seconds since start, y - seconds since previous frame
+};
+static_assert(Std140Block<FrameConstants>);
+static_assert(offsetof(FrameConstants, proj) == 64U);
+static_assert(offsetof(FrameConstants, viewProj) == 128U);
+static_assert(offsetof(FrameConstants, cameraWorldPosition) == 192U);
+static_assert(offsetof(FrameConstants, time) == 208U);
+static_assert(sizeof(FrameConstants) == 224U);
+
+} // namespace engine::gl
@@ -25,13 +25,13 @@ public:
     void Render(
         GlContext& gl, glm::mat4 const& originMvp, Frustum const& frustum, glm::vec4 color = glm::vec4(1.0),
         float thickness = 0.015f) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
     Vao vao_ = Vao{};
     GpuBuffer attributeBuffer_ = GpuBuffer{};
     GpuBuffer indexBuffer_ = GpuBuffer{};
-    std::shared_ptr<GpuProgram> program_ = {};
+    GpuProgramHandle program_ = {};
     GpuBuffer ubo_ = GpuBuffer{};
     GLint uboLocation_ = -1;
 };
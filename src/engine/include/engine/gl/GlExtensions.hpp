@@ -30,6 +30,7 @@ public:
     enum Name {
         KHR_debug = 0,
         KHR_no_error,
+        KHR_parallel_shader_compile,
         KHR_shader_subgroup,
         KHR_texture_compression_astc_hdr,
         KHR_texture_compression_astc_ldr,
@@ -39,12 +40,16 @@ public:
         ARB_ES3_2_compatibility,
         ARB_invalidate_subdata,
         ARB_framebuffer_sRGB,
+        ARB_parallel_shader_compile,
         ARB_shading_language_include,
+        ARB_texture_compression_bptc,
         ARB_texture_filter_anisotropic,
         ARB_texture_storage,
         ARB_texture_storage_multisample,
         EXT_debug_label,
         EXT_debug_marker,
+        EXT_texture_compression_s3tc,
+        EXT_texture_sRGB,
         NUM_HARDCODED_EXTENSIONS
     };
 
@@ -2,6 +2,7 @@
 
 #include "engine/Precompiled.hpp"
 #include "engine/ShaderDefine.hpp"
+#include "engine/gl/GpuProgramReflection.hpp"
 
 namespace engine::gl {
 
@@ -20,17 +21,28 @@ public:
     static auto Allocate
         [[nodiscard]] (GlContext& gl, GLuint vertexShader, GLuint fragmentShader, std::string_view name = {})
         -> std::optional<GpuProgram>;
+    // NOTE: returns nullopt on a cache miss, then program needs to be compiled from code
+    static auto AllocateFromBinary [[nodiscard]] (GlContext& gl, uint64_t programKey, std::string_view name = {})
+        -> std::optional<GpuProgram>;
     auto LinkGraphical [[nodiscard]] (GLuint vertexShader, GLuint fragmentShader, bool isRecompile = false) const
         -> bool;
     auto Id [[nodiscard]] () const -> GLuint { return programId_; }
     auto Type [[nodiscard]] () const -> GpuProgramType { return type_; }
+    // NOTE: empty until the program is linked, a program which is still compiling is reflected on its first use
+    auto Reflection [[nodiscard]] () const -> GpuProgramReflection const& { return reflection_; }
 
 private:
     void Dispose();
-    GlHandle programId_ = GlHandle{GL_NONE};
-    enum GpuProgramType type_     = GpuProgramType::GRAPHICAL;
+    // Takes ownership of a linked program, the previous program is deleted
+    void ReplaceProgram(GLuint programId);
+    // NOTE: const, because a linked program is reflected when it's used by UniformCtx
+    void Reflect() const;
+    GlHandle programId_                      = GlHandle{GL_NONE};
+    enum GpuProgramType type_                = GpuProgramType::GRAPHICAL;
+    mutable GpuProgramReflection reflection_ = GpuProgramReflection{};
 
     friend class UniformCtx;
+    friend class ShaderCompileScheduler;
 };
 
 } // namespace engine::gl
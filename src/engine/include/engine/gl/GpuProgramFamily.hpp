@@ -0,0 +1,76 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+#include "engine/ShaderDefine.hpp"
+
+namespace engine::gl {
+
+class GpuProgram;
+
+// Variants of one program, which differ only by features (defines), e.g. specular on/off, a lighting model
+// Each feature axis takes a few bits of a variant key, a variant is compiled on its first use, or prewarmed
+// from the keys used by a previous run, so the full cross-product of features is never compiled
+class GpuProgramFamily final {
+
+public:
+    using VariantKey = uint64_t;
+
+    struct FeatureAxis final {
+        std::string_view name = {}; // NOTE: becomes a define, so it must outlive the family (e.g. a literal)
+        uint32_t numValues    = 2U; // 2 makes a boolean feature, its define is 0 or 1 (test it with #if, not #ifdef)
+    };
+
+#define Self GpuProgramFamily
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // NOTE: no program is compiled here, defines are shared by all variants
+    static auto Allocate [[nodiscard]] (
+        std::string_view vertexFilepath, std::string_view fragmentFilepath, std::vector<ShaderDefine>&& defines,
+        std::vector<FeatureAxis>&& axes, std::string_view name) -> GpuProgramFamily;
+
+    // Key bits of one feature value, keys of features of different axes are combined with |
+    auto Feature [[nodiscard]] (size_t axis, uint32_t value) const -> VariantKey;
+    auto IsValid [[nodiscard]] (VariantKey key) const -> bool;
+    // One hash lookup, the variant is compiled on a miss
+    // NOTE: without parallel compile, it's null if the variant failed to compile; a failed variant isn't cached,
+    // it's compiled again once the program registry reloads changed files. With parallel compile, the handle is
+    // returned while the program still links, so it's never null: its first use waits for the link, and a failed
+    // variant is rendered with the placeholder program, until hot reload relinks it as any other program
+    auto Variant [[nodiscard]] (GlContext& gl, VariantKey key) -> GpuProgramHandle;
+    // Compiles the variants, which aren't compiled yet, invalid keys (e.g. recorded with other axes) are skipped
+    void Prewarm(GlContext& gl, CpuView<VariantKey const> keys);
+    auto NumVariants [[nodiscard]] () const -> size_t { return usedVariants_.size(); }
+    // Releases programs of all variants, used variants are forgotten too, so they must be saved before
+    void Dispose(GlContext& gl);
+
+    // Keys of compiled variants in order of their first use, to be prewarmed on the next start
+    void SaveUsedVariants(std::string_view filepath) const;
+    static auto LoadUsedVariants [[nodiscard]] (std::string_view filepath) -> std::vector<VariantKey>;
+
+private:
+    auto FindSlot [[nodiscard]] (VariantKey key) const -> size_t;
+    void Grow();
+    auto Compile [[nodiscard]] (GlContext& gl, VariantKey key) const -> GpuProgramHandle;
+
+    std::string vertexFilepath_          = {};
+    std::string fragmentFilepath_        = {};
+    std::string name_                    = {};
+    std::vector<ShaderDefine> defines_   = {};
+    std::vector<FeatureAxis> axes_       = {};
+    std::vector<uint32_t> axisOffsets_   = {}; // first bit of each axis in a key
+    VariantKey validBits_                = 0U;
+    // open addressing with linear probing, capacity is a power of 2, empty slots have EMPTY_KEY
+    std::vector<VariantKey> slotKeys_           = {};
+    std::vector<GpuProgramHandle> slotVariants_ = {};
+    std::vector<VariantKey> usedVariants_       = {};
+    // variants which failed to compile, with GpuProgramRegistry::Generation at the time of the failure
+    std::vector<std::pair<VariantKey, uint64_t>> failedVariants_ = {};
+};
+
+} // namespace engine::gl
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace engine::gl {
+
+// FNV-1a of a resource name as GLSL declares it (without "[0]" of arrays), so lookup keys are computed at compile time
+constexpr auto ResourceNameHash [[nodiscard]] (std::string_view name) -> uint64_t {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// Active resources of a linked program, queried once after the link (and after every relink)
+// Resources are sorted by kind and name hash, lookups go through a hash index, they don't call GL
+// Values of default block uniforms are shadowed, so setting an unchanged value is skipped
+class GpuProgramReflection final {
+
+public:
+#define Self GpuProgramReflection
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    enum class ResourceKind : uint8_t {
+        UNIFORM = 0,
+        UNIFORM_BLOCK,
+        STORAGE_BLOCK,
+        ATTRIBUTE,
+    };
+
+    struct Resource final {
+        uint64_t nameHash   = 0U;
+        GLint location      = -1;      // location of a uniform or attribute, index of a block
+        GLint binding       = -1;      // binding point of a block
+        GLenum type         = GL_NONE; // GLSL type of a uniform or attribute
+        GLint arraySize     = 0;
+        GLint numBlockBytes = 0;
+        ResourceKind kind   = ResourceKind::UNIFORM;
+    };
+
+    // NOTE: must be called only when the program is linked, otherwise queries wait for parallel compilation
+    void Reflect(GLuint program);
+    void Clear();
+    auto IsReflected [[nodiscard]] () const -> bool { return isReflected_; }
+
+    auto Find [[nodiscard]] (ResourceKind kind, uint64_t nameHash) const -> Resource const*;
+    auto UniformLocation [[nodiscard]] (uint64_t nameHash) const -> GLint;
+    auto UniformBlockIndex [[nodiscard]] (uint64_t nameHash) const -> GLint;
+    auto StorageBlockIndex [[nodiscard]] (uint64_t nameHash) const -> GLint;
+    auto AttributeLocation [[nodiscard]] (uint64_t nameHash) const -> GLint;
+    auto Resources [[nodiscard]] () const -> std::vector<Resource> const& { return resources_; }
+
+    // Returns false if the value is the same as the last one set to the location, otherwise remembers it
+    // NOTE: arrays and unknown locations aren't shadowed, they are always set
+    auto UpdateShadow [[nodiscard]] (GLint location, void const* value, size_t numBytes) -> bool;
+    // Forgets values of consecutive locations, which were set bypassing UpdateShadow (e.g. as an array)
+    void InvalidateShadows(GLint location, size_t numLocations);
+
+private:
+    struct Shadow final {
+        uint32_t offset   = 0U;
+        uint16_t numBytes = 0U;
+        bool isSet        = false;
+    };
+
+    void BuildIndex();
+
+    std::vector<Resource> resources_   = {};
+    std::vector<uint16_t> index_       = {}; // open addressing, resource idx + 1, 0 is empty; capacity is a power of 2
+    std::vector<Shadow> shadows_       = {}; // by uniform location
+    std::vector<uint8_t> shadowValues_ = {};
+    bool isReflected_                  = false;
+};
+
+} // namespace engine::gl
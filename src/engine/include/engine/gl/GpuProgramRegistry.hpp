@@ -1,17 +1,22 @@
 #pragma once
 
 #include "engine/ShaderDefine.hpp"
+#include "engine/gl/Common.hpp"
 #include "engine/platform/IFileWatcher.hpp"
 #include <cstddef>
 #include <memory>
-#include <vector>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace engine::gl {
 
 class GlContext;
 class GpuProgram;
 
+// Programs compiled from files, which are recompiled when their shaders or included files change
+// NOTE: all paths are absolute (canonical), so one file is always known by one path
 class GpuProgramRegistry final : public engine::platform::IFileWatcher {
 
 public:
@@ -25,18 +30,22 @@ public:
 #undef Self
 
     struct ProgramEntry {
-        std::weak_ptr<GpuProgram> program           = {};
+        GpuProgramHandle program                      = {}; // null, when the entry is free
         constexpr static size_t MAX_NUM_SHADERS       = 4; // typically 2 for vertex-fragment pair, 1 for compute
         std::string shadersFilepaths[MAX_NUM_SHADERS] = {};
         std::vector<ShaderDefine> defines           = {};
+        std::vector<std::string> dependencies       = {}; // shader files and files of their includes
     };
 
-    void RegisterProgram (std::weak_ptr<GpuProgram> program,
+    void RegisterProgram (GpuProgramHandle program,
         std::string_view vertexFilepath, std::string_view fragmentFilepath,
         std::vector<ShaderDefine>&& defines);
-    void UnregisterProgram(GpuProgram const& program);
+    void UnregisterProgram(GpuProgramHandle program);
 
+    // Recompiles every program, which depends on files changed since the previous call, once
     void HotReloadPrograms(GlContext& gl);
+    // Incremented by each hot reload, which handled file changes, e.g. to retry programs which failed to compile
+    auto Generation [[nodiscard]] () const -> uint64_t { return generation_; }
 
     using FilepathsToWatch = std::unordered_set<std::string>;
     auto FilepathsToWatchBegin [[nodiscard]] () const -> FilepathsToWatch::const_iterator {
@@ -45,13 +54,27 @@ public:
     auto FilepathsToWatchEnd [[nodiscard]] () const -> FilepathsToWatch::const_iterator {
         return std::cend(filepathsToWatch_);
     }
+    // Paths first indexed since the previous call, e.g. an include added by an edit or shaders of a lazy variant
+    // NOTE: they need to be subscribed to a FileChangeNotifier, otherwise their edits are not noticed
+    auto TakeNewFilepathsToWatch [[nodiscard]] () -> std::vector<std::string> {
+        return std::exchange(newFilepathsToWatch_, {});
+    }
 
 private:
+    struct Dependents {
+        std::vector<size_t> programs = {}; // indices into programs_
+        bool isInclude               = false;
+    };
+
     void OnFileChanged(std::string const& path, bool isDirectory) override;
+    void IndexDependencies(size_t programIdx, std::vector<std::string>&& dependencies, size_t numShaders);
 
-    std::vector<ProgramEntry> programs_ = {};
-    std::vector<size_t> pendingHotReload_ = {};
-    FilepathsToWatch filepathsToWatch_ = {};
+    std::vector<ProgramEntry> programs_                     = {};
+    std::unordered_map<std::string, Dependents> dependents_ = {}; // reverse index, file -> programs
+    std::vector<std::string> pendingChanges_                = {}; // unique, changes of the same file are coalesced
+    FilepathsToWatch filepathsToWatch_                      = {};
+    std::vector<std::string> newFilepathsToWatch_           = {};
+    uint64_t generation_                                    = 0U;
 };
 
 } // namespace engine::gl
\ No newline at end of file
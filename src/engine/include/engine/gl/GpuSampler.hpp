@@ -5,6 +5,27 @@
 
 namespace engine::gl {
 
+// Every parameter of a sampler object, samplers with equal descriptions are interchangeable, see SamplersCache
+struct SamplerDesc final {
+    bool magnifyLinear    = false;
+    bool minifyLinear     = false;
+    bool minifyOverMips   = false;
+    bool mipsLinear       = false;
+    GLenum wrapS          = GL_REPEAT;
+    GLenum wrapT          = GL_REPEAT;
+    GLenum wrapR          = GL_REPEAT;
+    GLfloat minMip        = -1000.0f;
+    GLfloat maxMip        = 1000.0f;
+    GLfloat mipBias       = 0.0f;
+    GLfloat maxAnisotropy = 1.0f;
+    bool depthCompare     = false;
+    GLenum compareFunc    = GL_LEQUAL;
+    glm::vec4 borderColor = glm::vec4{0.0f};
+
+    auto Hash [[nodiscard]] () const -> uint64_t;
+    auto operator==(SamplerDesc const&) const -> bool = default;
+};
+
 class GpuSampler final {
 
 public:
@@ -18,6 +39,9 @@ public:
 #undef Self
 
     static auto Allocate [[nodiscard]] (GlContext& gl, std::string_view name = {}) -> GpuSampler;
+    // NOTE: sets every parameter, prefer SamplersCache::Acquire, which shares samplers with the same description
+    static auto Allocate [[nodiscard]] (GlContext& gl, SamplerDesc const& desc, std::string_view name = {})
+        -> GpuSampler;
     auto WithDepthCompare [[nodiscard]] (bool enable, GLenum compareFunc = GL_LEQUAL) && -> GpuSampler&&;
     auto WithBorderColor [[nodiscard]] (glm::vec4 color) && -> GpuSampler&&;
     auto WithLinearMagnify [[nodiscard]] (bool filterLinear) && -> GpuSampler&&;
@@ -29,11 +29,11 @@ public:
     // in vec2 v_Uv;
     static auto Allocate [[nodiscard]] (GlContext& gl, GLuint fragmentShader = GL_NONE) -> GrassRenderer;
     void Render(GlContext& gl, GrassRenderArgs const& args) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
-    std::shared_ptr<GpuProgram> customVaoProgram_ = {};
-    std::shared_ptr<GpuProgram> quadVaoProgram_ = {};
+    GpuProgramHandle customVaoProgram_ = {};
+    GpuProgramHandle quadVaoProgram_ = {};
     GpuBuffer ubo_ = GpuBuffer{};
 
     static GLint constexpr DEFAULT_UNIFORM_TEXTURE_LOCATION = 0;
@@ -7,9 +7,9 @@ namespace engine::gl {
 struct IGlDisposable {
 #define Self IGlDisposable
 public:
-    Self()                                    = default;
-    virtual ~Self()                           = default;
-    virtual void Dispose(GlContext const& gl) = 0;
+    Self()                              = default;
+    virtual ~Self()                     = default;
+    virtual void Dispose(GlContext& gl) = 0;
 
 protected:
     Self(Self const&)            = default;
@@ -25,14 +25,15 @@ public:
 #undef Self
 
     static auto Allocate [[nodiscard]] (GlContext& gl, size_t maxLines) -> LineRenderer;
-    void Fill(std::vector<LineRendererInput::Line> const& lines, size_t numLines, size_t numLinesOffset) const;
+    // Lines are drawn up to the last filled one, so filling fewer lines (even none) drops the rest
+    void Fill(std::vector<LineRendererInput::Line> const& lines, size_t numLines, size_t numLinesOffset);
     void Render(GlContext& gl, glm::mat4 const& camera) const;
-    void Dispose(GlContext const& gl) override;
+    void Dispose(GlContext& gl) override;
 
 private:
     Vao vao_ = Vao{};
     GpuBuffer attributeBuffer_ = GpuBuffer{};
-    std::shared_ptr<GpuProgram> program_ = {};
+    GpuProgramHandle program_ = {};
 };
 
 } // namespace engine::gl
\ No newline at end of file
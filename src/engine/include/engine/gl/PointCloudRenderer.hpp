@@ -0,0 +1,75 @@
+#pragma once
+
+#include "engine/PointCloud.hpp"
+#include "engine/Precompiled.hpp"
+#include "engine/gl/GpuBuffer.hpp"
+#include "engine/gl/GpuProgram.hpp"
+#include "engine/gl/IGlDisposable.hpp"
+#include "engine/gl/Vao.hpp"
+#include <glm/mat4x4.hpp>
+
+namespace engine::gl {
+
+// Draws a PointCloud of any size with a bounded GPU memory: nodes are streamed into pages of one GPU buffer
+// Each frame, nodes are selected from the root by their projected size, until the budget of points is reached
+// Selected nodes which aren't resident are uploaded (a few per frame), evicting least recently used pages
+// NOTE: the finest nodes appear a few frames later than the coarse ones, the cloud never has holes meanwhile
+class PointCloudRenderer final : public IGlDisposable {
+
+public:
+#define Self PointCloudRenderer
+    explicit Self() noexcept     = default;
+    ~Self() override             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    struct Settings final {
+        uint32_t maxRenderedPoints = 4'000'000U; // per frame, the GPU pool fits a bit more to keep a margin
+        uint32_t maxUploadedPoints = 500'000U;   // per frame, bounds the time spent reading the file
+        float minNodeSizePixels    = 200.0f;     // nodes projected smaller than this aren't refined
+        float pointSizePixels      = 2.0f;
+    };
+
+    static auto Allocate [[nodiscard]] (GlContext& gl, PointCloud cloud, Settings const& settings)
+        -> PointCloudRenderer;
+    // Selects nodes for the camera, and streams the missing ones to GPU
+    void Update(glm::mat4 const& view, glm::mat4 const& proj, float viewportHeightPixels);
+    void Render(GlContext& gl, glm::mat4 const& camera) const;
+    void Dispose(GlContext& gl) override;
+
+    auto Cloud [[nodiscard]] () const -> PointCloud const& { return cloud_; }
+    auto NumRenderedPoints [[nodiscard]] () const -> uint64_t { return numRenderedPoints_; }
+    auto NumResidentNodes [[nodiscard]] () const -> size_t { return pages_.size() - freePages_.size(); }
+
+private:
+    static constexpr uint32_t NO_PAGE = ~0U;
+    static constexpr uint32_t NO_NODE = ~0U;
+
+    struct Page final {
+        uint32_t nodeIdx       = NO_NODE;
+        uint64_t lastUsedFrame = 0U;
+    };
+
+    auto AcquirePage [[nodiscard]] () -> uint32_t;
+
+    PointCloud cloud_ = PointCloud{};
+    Settings settings_ = Settings{};
+    Vao vao_ = Vao{};
+    GpuBuffer pointsBuffer_ = GpuBuffer{};
+    GpuProgramHandle program_ = {};
+
+    std::vector<Page> pages_ = {};
+    std::vector<uint32_t> freePages_ = {};
+    std::vector<uint32_t> nodeToPage_ = {};
+    std::vector<std::pair<float, uint32_t>> traversal_ = {}; // heap of projected size and node idx
+    uint64_t frame_ = 0U;
+
+    std::vector<GLint> drawFirsts_ = {};
+    std::vector<GLsizei> drawCounts_ = {};
+    uint64_t numRenderedPoints_ = 0U;
+};
+
+} // namespace engine::gl
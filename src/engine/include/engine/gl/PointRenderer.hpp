@@ -11,6 +11,8 @@
 
 namespace engine::gl {
 
+// Draws matrix points as instanced boxes, and compact points as camera-facing quads shaded as spheres
+// NOTE: a compact point costs 16 bytes and 4 vertices, a matrix point 68 bytes and a box of 24 vertices
 class PointRenderer final : public IGlDisposable {
 
 public:
@@ -23,13 +25,18 @@ public:
     Self& operator=(Self&&)      = default;
 #undef Self
 
-    static auto Allocate [[nodiscard]] (GlContext& gl, size_t maxPoints) -> PointRenderer;
+    static auto Allocate [[nodiscard]] (GlContext& gl, size_t maxPoints, size_t maxCompactPoints) -> PointRenderer;
     void Fill(std::vector<PointRendererInput::Point> const&, int32_t numPoints, int32_t numPointsOffset);
+    void Fill(std::vector<PointRendererInput::CompactPoint> const&, int32_t numPoints, int32_t numPointsOffset);
     void LimitInstances(int32_t numInstances);
     void Render(
         GlContext& gl, glm::mat4 const& camera, int32_t firstInstance = 0,
         int32_t numInstances = std::numeric_limits<int32_t>::max()) const;
-    void Dispose(GlContext const& gl) override;
+    // NOTE: view and projection are separate, quads are expanded in view space, so they face the camera
+    void RenderSprites(
+        GlContext& gl, glm::mat4 const& view, glm::mat4 const& proj, int32_t firstInstance = 0,
+        int32_t numInstances = std::numeric_limits<int32_t>::max()) const;
+    void Dispose(GlContext& gl) override;
 
 private:
     Vao vao_ = Vao{};
@@ -37,8 +44,13 @@ private:
     GpuBuffer meshAttributesBuffer_ = GpuBuffer{};
     GpuBuffer instancesBuffer_ = GpuBuffer{};
     GpuBuffer indexBuffer_ = GpuBuffer{};
-    std::shared_ptr<GpuProgram> program_ = {};
+    GpuProgramHandle program_ = {};
     GLsizei lastInstance_ = 0;
+
+    Vao spriteVao_ = Vao{};
+    GpuBuffer compactInstancesBuffer_ = GpuBuffer{};
+    GpuProgramHandle spriteProgram_ = {};
+    GLsizei lastCompactInstance_ = 0;
 };
 
 } // namespace engine::gl
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine::gl {
+
+// Persistent cache of linked programs (ARB_get_program_binary, core since GL 4.1)
+// Programs are keyed by hash of their final preprocessed code (so defines and includes are accounted for),
+// entries of each driver (vendor, renderer, version) live in their own subdirectory, and entries of other
+// drivers are removed on Initialize, because binaries are never portable between drivers
+// NOTE: corrupted entries and entries rejected by driver are deleted, so the program is compiled and stored again
+class ProgramBinaryCache final {
+
+public:
+#define Self ProgramBinaryCache
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // NOTE: empty directory or a driver without binary formats disable the cache
+    void Initialize(std::string_view cacheDirectory);
+    auto IsEnabled [[nodiscard]] () const -> bool { return !directory_.empty(); }
+
+    auto ProgramKey [[nodiscard]] (std::string_view vertexCode, std::string_view fragmentCode) const -> uint64_t;
+    // Program must be created, but not linked yet, returns true if it's linked from the cached binary
+    auto Load [[nodiscard]] (GLuint program, uint64_t programKey) const -> bool;
+    // Program must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void Store(GLuint program, uint64_t programKey) const;
+
+private:
+    auto EntryFilepath [[nodiscard]] (uint64_t programKey) const -> std::string;
+
+    std::string directory_            = {};
+    uint64_t driverHash_              = 0U;
+    std::vector<GLint> binaryFormats_ = {};
+};
+
+} // namespace engine::gl
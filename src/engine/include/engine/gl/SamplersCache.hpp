@@ -1,12 +1,13 @@
 #pragma once
 
+#include "engine/HandlePool.hpp"
 #include "engine/Precompiled.hpp"
 #include "engine/gl/GpuSampler.hpp"
 
-#include <map>
-
 namespace engine::gl {
 
+// Sampler objects deduplicated by their parameters, acquiring an already known description returns its sampler
+// NOTE: a handful of distinct samplers is typical, they live until the cache is cleared
 class SamplersCache final {
 
 public:
@@ -19,22 +20,32 @@ public:
     Self& operator=(Self&&)      = delete;
 #undef Self
 
-    using CacheKey = size_t;
+    // NOTE: a key of a cleared cache is stale, it gives the NULL sampler instead of another cached one
+    using CacheKey = Handle<GpuSampler>;
 
-    auto FindSampler(std::string_view name) const -> GpuSampler const&;
+    // One hash lookup, the sampler is allocated on a miss; the name only labels a newly allocated sampler
+    auto Acquire [[nodiscard]] (GlContext& gl, SamplerDesc const& desc, std::string_view name = {}) -> CacheKey;
 
     auto GetSampler [[nodiscard]] (CacheKey id) const -> GpuSampler const&;
-
-    auto Store [[nodiscard]] (std::string_view name, GpuSampler&& sampler) -> CacheKey;
+    auto NumSamplers [[nodiscard]] () const -> size_t { return samplers_.NumItems(); }
 
     void Clear();
 
 private:
-    // TODO(a.larionov): std::unordered_map doens't support std::string_view lookup
-    std::map<std::string, CacheKey, std::less<>> nameToId_;
-    std::vector<GpuSampler> idToSampler_;
+    struct Entry final {
+        SamplerDesc desc = SamplerDesc{};
+        uint64_t hash    = 0U;
+        CacheKey key     = {};
+    };
+
+    auto FindSlot [[nodiscard]] (SamplerDesc const& desc, uint64_t hash) const -> size_t;
+    void Grow();
+
+    HandlePool<GpuSampler> samplers_ = HandlePool<GpuSampler>{};
+    std::vector<Entry> entries_      = {};
+    std::vector<uint32_t> slots_     = {}; // open addressing, entry idx + 1, 0 is empty; capacity is a power of 2
 
     ENGINE_STATIC static const GpuSampler nullSampler_;
 };
 
-} // namespace engine::gl
\ No newline at end of file
+} // namespace engine::gl
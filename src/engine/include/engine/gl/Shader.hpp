@@ -10,9 +10,11 @@ constexpr char const* FRAGMENT_FILE_EXTENSION = ".frag";
 constexpr char const* COMPUTE_FILE_EXTENSION  = ".comp";
 
 struct IncludeEntry final {
-    std::string text       = "/*NO_INCLUDE_TEXT*/";
-    int64_t recursionLimit = 0;
-    bool isMultiline       = true;
+    std::string text     = "/*NO_INCLUDE_TEXT*/";
+    std::string filepath = {}; // empty if text isn't loaded from a file
+    // NOTE: multiline includes are expanded once per shader (like #pragma once), with #line markers around them,
+    // single line includes are pasted as is on every use (e.g. expressions in the middle of a line)
+    bool isMultiline = true;
 };
 
 using IncludeRegistry = std::unordered_map<std::string, IncludeEntry, engine::StringHash, std::equal_to<>>;
@@ -21,27 +23,35 @@ void LoadVertexIncludes(IncludeRegistry& out);
 void LoadFragmentIncludes(IncludeRegistry& out);
 void LoadComputeCodegenComponents(IncludeRegistry& out);
 
-struct ShaderParsing final {
-    enum class PartType {
-        ORIGINAL_CODE,
-        INCLUDE_KEY,
-        DELIMITER,
+// Includes expanded while generating one shader, views point to keys of the IncludeRegistry
+struct IncludeGraph final {
+    struct Edge final {
+        std::string_view includer; // empty for includes of the shader code itself
+        std::string_view included;
     };
-    struct Part final {
-        std::string_view text;
-        PartType type;
-    };
-    std::vector<Part> parts;
-    int64_t numIncludes = 0;
+    std::vector<Edge> edges                = {};
+    std::vector<std::string_view> includes = {}; // unique, in order of the first expansion
+    std::vector<std::string_view> files    = {}; // unique IncludeEntry::filepath of the includes loaded from files
+
+    void Clear() {
+        edges.clear();
+        includes.clear();
+        files.clear();
+    }
 };
 
-auto ParseParts [[nodiscard]] (std::string_view code) -> ShaderParsing;
-
+// Single pass over the code: writes version line, defines, then the code with includes expanded depth first
+// Included text of include N gets line numbers from N * 1'000'000, so compilation errors point to the include
+// Defines which the code never mentions are dropped, so a stage shared by programs has the same code in all of them
+// NOTE: destination is cleared, but its capacity is reused; include cycles are reported and cut
+void GenerateCode(
+    std::string& destination, std::string_view originalCode, IncludeRegistry const& includeRegistry,
+    CpuView<ShaderDefine const> defines, IncludeGraph* includeGraph = nullptr);
 auto GenerateCode
     [[nodiscard]] (std::string_view originalCode, IncludeRegistry const& includeRegistry, CpuView<ShaderDefine const> defines)
     -> std::string;
 
 auto InjectDefines [[nodiscard]] (std::string_view code, CpuView<ShaderDefine const> defines) -> std::string;
-void InjectDefines(std::stringstream& destination, CpuView<ShaderDefine const> defines);
+void InjectDefines(std::string& destination, CpuView<ShaderDefine const> defines);
 
 } // namespace engine::gl::shader
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "engine/gl/Common.hpp"
+#include <glad/gl.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// NOTE: GLAD isn't generated with KHR_parallel_shader_compile (ARB_parallel_shader_compile has same enums)
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace engine::gl {
+
+class GlContext;
+class GlExtensions;
+class GpuProgram;
+
+// Compiles and links programs without stalling the frame
+// With KHR_parallel_shader_compile, all programs are handed to driver threads at once, and each frame Poll
+// only checks their GL_COMPLETION_STATUS_KHR. Otherwise, Poll compiles pending programs one by one,
+// until the frame time budget is spent, so that reloading many programs is spread over several frames
+class ShaderCompileScheduler final {
+
+public:
+#define Self ShaderCompileScheduler
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    void Initialize(GlExtensions const& extensions);
+    auto IsParallel [[nodiscard]] () const -> bool { return isParallel_; }
+    auto NumPending [[nodiscard]] () const -> size_t { return jobs_.size(); }
+
+    // Links the code into a new GL program, which replaces the program of target once it's linked successfully,
+    // until then the target is rendered with its previous program (a failed program is discarded)
+    // NOTE: target without a program (a new one) gets the program immediately in parallel mode,
+    // its first use waits only for its own compilation, while other programs keep compiling in background
+    // A newer submit for the same target cancels the pending one, a job of a released target is cancelled
+    void Submit(
+        GlContext& gl, GpuProgramHandle target, std::string&& vertexCode, std::string&& fragmentCode,
+        uint64_t programKey, std::string_view name = {});
+    // Finishes the programs, which are ready, should be called every frame
+    void Poll(GlContext& gl);
+    // Blocks until every pending program is finished
+    void WaitAll(GlContext& gl);
+
+private:
+    struct Job final {
+        GpuProgramHandle target          = {};
+        std::string vertexCode           = {}; // released, once the job is issued to driver
+        std::string fragmentCode         = {};
+        std::string name                 = {};
+        uint64_t programKey              = 0U; // see ProgramBinaryCache, 0 if the binary isn't cached
+        GLuint vertexShader              = GL_NONE;
+        GLuint fragmentShader            = GL_NONE;
+        GLuint program                   = GL_NONE;
+        bool isGivenAway                 = false; // program is owned by target, while still linking
+    };
+
+    void Issue(GlContext& gl, Job& job) const;
+    auto IsCompleted [[nodiscard]] (Job const& job) const -> bool;
+    void Finish(GlContext& gl, Job& job) const;
+    void Cancel(GlContext& gl, Job& job) const;
+
+    std::vector<Job> jobs_ = {};
+    bool isParallel_       = false;
+};
+
+} // namespace engine::gl
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glad/gl.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace engine::gl {
+
+// Compiled shader objects, shared by all programs which have the same stage code
+// Shaders are looked up by stage and hash of their final preprocessed code, and reference counted by programs being
+// linked. The code is kept and compared on lookup, so shaders with colliding hashes are never shared
+// NOTE: unreferenced shaders are kept until EvictUnused, so programs linked one after another still share them
+class ShaderObjectCache final {
+
+public:
+#define Self ShaderObjectCache
+    explicit Self() noexcept     = default;
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = default;
+    Self& operator=(Self&&)      = default;
+#undef Self
+
+    // Returns a shader with compilation at least started, the caller holds a reference until Release
+    // NOTE: compile status isn't queried (it would wait for parallel compilation), failures are reported on link
+    auto Acquire [[nodiscard]] (GLenum shaderType, std::string_view code) -> GLuint;
+    void Release(GLuint shader);
+    // Deletes shaders, which every program using them has released (e.g. once per frame)
+    void EvictUnused();
+    void Clear();
+    auto NumShaders [[nodiscard]] () const -> size_t { return entries_.size(); }
+
+private:
+    struct Entry final {
+        uint64_t key      = 0U;
+        GLenum shaderType = GL_NONE;
+        uint32_t numUsers = 0U;
+        std::string code  = {};
+    };
+
+    void EraseKey(GLuint shader, uint64_t key);
+
+    // shaders by the hash of the code, and entries by the shader, so Release doesn't search
+    std::unordered_multimap<uint64_t, GLuint> shadersByKey_ = {};
+    std::unordered_map<GLuint, Entry> entries_              = {};
+    size_t numUnused_                                       = 0U;
+};
+
+} // namespace engine::gl
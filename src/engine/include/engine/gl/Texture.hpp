@@ -18,9 +18,10 @@ public:
     Self& operator=(Self&&)      = default;
 #undef Self
 
+    // NOTE: storage for numLevels mip levels is allocated, the levels are left uninitialized
     static auto Allocate2D [[nodiscard]] (
-        GlContext& gl, GLenum slotTarget, glm::ivec2 size, GLenum internalFormat, std::string_view name = {})
-    -> Texture;
+        GlContext& gl, GLenum slotTarget, glm::ivec2 size, GLenum internalFormat, int32_t numLevels = 1,
+        std::string_view name = {}) -> Texture;
     // NOTE: sampleStencilOnly controls GL_DEPTH_STENCIL_TEXTURE_MODE parameter.
     // when true: stencil value is read in shader (depth value can't be retrieved)
     // when false: depth value is read in shader (stencil value can't be retrieved)
@@ -30,6 +31,8 @@ public:
 
     auto Id [[nodiscard]] () const -> GLuint { return textureId_; }
     auto Size [[nodiscard]] () const -> glm::ivec3 { return size_; }
+    auto NumLevels [[nodiscard]] () const -> int32_t { return numLevels_; }
+    auto LevelSize [[nodiscard]] (int32_t level) const -> glm::ivec3;
     auto TextureSlotTarget [[nodiscard]] () const -> GLenum { return target_; }
     auto Is1D() const -> bool { return target_ == GL_TEXTURE_1D | target_ == GL_TEXTURE_1D_ARRAY; }
     auto Is2D() const -> bool {
@@ -50,6 +53,7 @@ private:
     GLenum target_{GL_NONE};
     GLenum internalFormat_{GL_NONE};
     glm::ivec3 size_{};
+    int32_t numLevels_{0};
 
     friend class TextureCtx;
 };
@@ -81,6 +85,27 @@ public:
     auto Fill2D(FillArgs const& args) & -> TextureCtx&;
     auto Fill2D [[nodiscard]] (FillArgs const& args) && -> TextureCtx&&;
 
+    // NOTE: compressedFormat must be the internal format of the texture
+    struct FillCompressedArgs {
+        GLenum compressedFormat = GL_NONE;
+        uint8_t const* data     = nullptr;
+        GLsizei numBytes        = 0;
+        glm::ivec3 size         = glm::ivec3{0};
+        GLint mipLevel          = 0;
+    };
+    auto FillCompressed2D(FillCompressedArgs const& args) & -> TextureCtx&;
+    auto FillCompressed2D [[nodiscard]] (FillCompressedArgs const& args) && -> TextureCtx&&;
+
+    // NOTE: reads back the whole mip level, destination must fit it (tightly packed rows)
+    struct ReadArgs {
+        GLenum dataFormat              = GL_NONE;
+        GLenum dataType                = GL_NONE;
+        CpuMemory<uint8_t> destination = CpuMemory<uint8_t>{};
+        GLint mipLevel                 = 0;
+    };
+    auto Read2D(ReadArgs const& args) & -> TextureCtx&;
+    auto Read2D [[nodiscard]] (ReadArgs const& args) && -> TextureCtx&&;
+
 private:
     ENGINE_STATIC static GlHandle contextTexture_;
     ENGINE_STATIC static GLenum contextTarget_;
@@ -23,7 +23,10 @@ public:
     void Initialize(GlContext const& gl);
     auto IsInitialized [[nodiscard]] () const -> bool { return isInitialized_; };
 
+    // NOTE: the sampler isn't rebound, if it's already bound to the slot
     void BindSampler(size_t slotIdx, GLuint sampler);
+    // Drops the remembered bindings of a sampler name, e.g. when the name is given to a new sampler
+    void ForgetSampler(GLuint sampler);
     void Bind2D(size_t slotIdx, GLuint texture);
     void Bind2DArray(size_t slotIdx, GLuint texture);
     void BindCubemap(size_t slotIdx, GLuint texture);
@@ -22,6 +22,11 @@ public:
     static auto GetUboLocation [[nodiscard]] (GpuProgram const& program, std::string_view programUboName) -> GLint;
     auto GetUboLocation [[nodiscard]] (std::string_view programUboName) const -> GLint;
     void SetUbo(GLuint programBinding, GLuint bufferBindingIdx) const;
+    // Location of a default block uniform from the program reflection, -1 if it isn't active
+    // NOTE: the hash is usually precomputed, e.g. constexpr auto U_COLOR = ResourceNameHash("u_Color")
+    auto Location [[nodiscard]] (uint64_t uniformNameHash) const -> GLint;
+
+    // NOTE: setters skip values which are the same as the last ones set to the program, see GpuProgramReflection
 
     // NOTE: No CpuView wrapper used, because data length is guaranteed by function user
     void SetUniformMatrix2x2(
@@ -36,6 +41,7 @@ public:
     void SetUniformTexture(GLint location, GLint textureSlot);
 
     template <typename T> void SetUniformValue1(GLint location, T const value) {
+        if (!IsChanged(location, &value, sizeof(value))) { return; }
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform1i(location, value));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -55,6 +61,8 @@ public:
     }
 
     template <typename T> void SetUniformValue2(GLint location, T const value0, T const value1) {
+        T const values[] = {value0, value1};
+        if (!IsChanged(location, values, sizeof(values))) { return; }
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform2i(location, value0, value1));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -74,6 +82,8 @@ public:
     }
 
     template <typename T> void SetUniformValue3(GLint location, T const value0, T const value1, T const value2) {
+        T const values[] = {value0, value1, value2};
+        if (!IsChanged(location, values, sizeof(values))) { return; }
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform3i(location, value0, value1, value2));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -94,6 +104,8 @@ public:
 
     template <typename T>
     void SetUniformValue4(GLint location, T const value0, T const value1, T const value2, T const value3) {
+        T const values[] = {value0, value1, value2, value3};
+        if (!IsChanged(location, values, sizeof(values))) { return; }
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform4i(location, value0, value1, value2, value3));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -109,6 +121,7 @@ public:
 
     // NOTE: No CpuView wrapper used, because data length is guaranteed by function user
     template <typename T> void SetUniformArrayOf1(GLint location, T const* values, GLsizei numValues) {
+        InvalidateShadows(location, numValues);
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform1iv(location, numValues, values));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -122,6 +135,7 @@ public:
 
     // NOTE: No CpuView wrapper used, because data length is guaranteed by function user
     template <typename T> void SetUniformArrayOf2(GLint location, T const* values, GLsizei numValues) {
+        InvalidateShadows(location, numValues);
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform2iv(location, numValues, values));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -135,6 +149,7 @@ public:
 
     // NOTE: No CpuView wrapper used, because data length is guaranteed by function user
     template <typename T> void SetUniformArrayOf3(GLint location, T const* values, GLsizei numValues) {
+        InvalidateShadows(location, numValues);
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform3iv(location, numValues, values));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -148,6 +163,7 @@ public:
 
     // NOTE: No CpuView wrapper used, because data length is guaranteed by function user
     template <typename T> void SetUniformArrayOf4(GLint location, T const* values, GLsizei numValues) {
+        InvalidateShadows(location, numValues);
         if constexpr (std::is_same_v<T, GLint>) {
             GLCALL(glUniform4iv(location, numValues, values));
         } else if constexpr (std::is_same_v<T, GLuint>) {
@@ -160,7 +176,12 @@ public:
     }
 
 private:
+    auto IsChanged [[nodiscard]] (GLint location, void const* value, size_t numBytes) const -> bool;
+    // NOTE: elements of an array take consecutive locations, the setters of arrays overwrite the shadowed values
+    void InvalidateShadows(GLint location, GLsizei numLocations) const;
+
     static GlHandle contextProgram_;
+    static GpuProgram const* contextGpuProgram_;
     static bool hasInstances_;
 };
 
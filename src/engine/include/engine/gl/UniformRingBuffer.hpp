@@ -0,0 +1,72 @@
+#pragma once
+
+#include "engine/gl/Common.hpp"
+#include <glad/gl.h>
+#include <type_traits>
+
+namespace engine::gl {
+
+class GlContext;
+
+// Host copy of a std140 uniform block, it's uploaded as bytes. Members must be aligned as std140 requires
+// (e.g. alignas(16) on vec3, vec4, mat and structs), exact offsets are checked with static_assert next to the block
+template <typename T>
+concept Std140Block = std::is_standard_layout_v<T> && std::is_trivially_copyable_v<T> && sizeof(T) % 16U == 0U;
+
+struct UniformRange final {
+    GLuint buffer       = GL_NONE;
+    GLintptr offset     = 0;
+    GLsizeiptr numBytes = 0;
+};
+
+// Streaming uniform buffer for constants, which change every frame or draw
+// Blocks are suballocated from the region of the current frame and bound with glBindBufferRange, instead of
+// uploading each uniform. Regions of NUM_FRAMES frames are reused in turn, each one is fenced
+class UniformRingBuffer final {
+
+public:
+#define Self UniformRingBuffer
+    explicit Self() noexcept = default;
+    ~Self() noexcept { Dispose(); }
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    // NOTE: owns the mapping, fences and overflow buffers, which dtor releases, it lives in GlContext and never moves
+    Self(Self&&)            = delete;
+    Self& operator=(Self&&) = delete;
+#undef Self
+
+    static constexpr size_t NUM_FRAMES = 3U; // frames in flight, which GPU may still be reading
+
+    void Initialize(GlContext& gl, size_t numBytesPerFrame);
+    auto IsInitialized [[nodiscard]] () const -> bool { return buffer_ != GL_NONE; }
+    // NOTE: waits until GPU has finished the frame, which used the same region
+    // The ring grows here, if the previous frame pushed more than a region fits
+    void BeginFrame(GlContext const& gl);
+    void EndFrame();
+
+    template <Std140Block T> auto Push [[nodiscard]] (T const& block) -> UniformRange {
+        return PushBytes(&block, sizeof(T));
+    }
+    template <Std140Block T> void PushAndBind(GLuint binding, T const& block) { Bind(binding, Push(block)); }
+    // Copies the data into the current frame region. If the region is full, the block gets a one-off buffer
+    auto PushBytes [[nodiscard]] (void const* data, size_t numBytes) -> UniformRange;
+    static void Bind(GLuint binding, UniformRange range);
+
+private:
+    void Allocate(GlContext const& gl, size_t numBytesPerFrame);
+    void Dispose();
+    void DisposeOverflowBuffers();
+    auto PushOverflow [[nodiscard]] (void const* data, size_t numBytes) -> UniformRange;
+
+    GlHandle buffer_                     = GlHandle{GL_NONE};
+    uint8_t* mapped_                     = nullptr; // persistent mapping, null when uploaded by glBufferSubData
+    size_t numBytesPerFrame_             = 0U;
+    size_t frameIdx_                     = 0U;
+    size_t frameOffset_                  = 0U;
+    size_t offsetAlignment_              = 256U;
+    GLsync frameFences_[NUM_FRAMES]      = {};
+    size_t requiredBytesPerFrame_        = 0U; // non-zero when the current frame overflowed its region
+    std::vector<GLuint> overflowBuffers_ = {}; // blocks which didn't fit into the region, deleted next frame
+};
+
+} // namespace engine::gl
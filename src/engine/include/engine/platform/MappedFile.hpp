@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/Precompiled.hpp"
+
+#include <string_view>
+
+namespace engine::platform {
+
+// Read-only memory mapping of a whole file, the mapping is released in dtor
+// NOTE: the file content is paged in lazily by OS, so mapping a big file is cheap until its memory is touched
+class MappedFile final {
+
+public:
+#define Self MappedFile
+    explicit Self() noexcept = default;
+    ~Self() noexcept { Unmap(); }
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , numBytes_(std::exchange(other.numBytes_, 0U)) { }
+    Self& operator=(Self&& other) noexcept {
+        if (this == &other) { return *this; }
+        Unmap();
+        data_     = std::exchange(other.data_, nullptr);
+        numBytes_ = std::exchange(other.numBytes_, 0U);
+        return *this;
+    }
+#undef Self
+
+    // NOTE: without willReadWhole, OS is hinted the access is random, so it doesn't read far ahead of touched pages
+    static auto Map [[nodiscard]] (std::string_view filepath, bool willReadWhole = true) -> std::optional<MappedFile>;
+
+    auto Data [[nodiscard]] () const -> CpuMemory<uint8_t const> { return CpuMemory<uint8_t const>{data_, numBytes_}; }
+    auto NumBytes [[nodiscard]] () const -> size_t { return numBytes_; }
+    auto IsMapped [[nodiscard]] () const -> bool { return data_ != nullptr; }
+
+private:
+    void Unmap();
+
+    uint8_t const* data_ = nullptr;
+    size_t numBytes_     = 0U;
+};
+
+} // namespace engine::platform
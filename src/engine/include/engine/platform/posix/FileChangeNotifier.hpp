@@ -3,30 +3,53 @@
 #include "engine/Precompiled.hpp"
 #include "engine/platform/IFileWatcher.hpp"
 
+#include <chrono>
 #include <filesystem>
+#include <mutex>
 #include <sys/inotify.h>
+#include <thread>
 
 namespace engine::platform {
 
+// Watches parent directories of files with inotify on a background thread
+// Events of a file are debounced (editors write a file in several chunks on save), then the file is reported only
+// if its content hash changed. Directories are watched rather than files, because editors often save by writing
+// a temporary file and renaming it over the original, which would silently end a watch of the original inode
 class FileChangeNotifier final {
 
 public:
 #include "engine/platform/FileChangeNotifier.inc"
 
 private:
-    void CloseWatchDescriptor(int watchDescriptor);
-
     struct WatchedFile {
         std::vector<std::weak_ptr<IFileWatcher>> watchers = {};
-        std::filesystem::path filepath                    = {};
+        int directoryDescriptor                           = -1;
+        uint64_t contentHash                              = 0U; // latest reported content
+    };
+    struct WatchedDirectory {
+        std::filesystem::path path = {};
+        size_t numFiles            = 0U;
     };
-    int inotifyDescriptor_                                    = -1;
-    std::unordered_map<int, WatchedFile> descriptor2watchers_ = {};
-    std::unordered_map<std::string, int> filename2descriptor_ = {};
-    std::mutex fileWatchersMutex_                             = {};
 
-    constexpr static size_t EVENT_BUFFER_SIZE                      = 4096U;
-    alignas(inotify_event) uint8_t eventBuffer_[EVENT_BUFFER_SIZE] = {};
+    void WatchLoop();
+    void ReadEvents(std::unordered_map<std::string, std::chrono::steady_clock::time_point>& debounced);
+    void UnwatchFile(std::unordered_map<std::string, WatchedFile>::iterator file);
+    void Shutdown();
+
+    int inotifyDescriptor_ = -1;
+    int epollDescriptor_   = -1;
+    int wakeupDescriptor_  = -1; // eventfd, which stops the watch thread
+    std::thread watchThread_{};
+
+    // NOTE: guards the maps, they're used by both render and watch threads
+    std::mutex fileWatchersMutex_                          = {};
+    std::unordered_map<std::string, WatchedFile> files_    = {}; // absolute path -> watchers
+    std::unordered_map<int, WatchedDirectory> directories_ = {}; // watch descriptor -> directory
+    // NOTE: filled by the watch thread, drained by PollChanges once per frame
+    moodycamel::ConcurrentQueue<std::string> changedFiles_{};
+
+    constexpr static size_t EVENT_BUFFER_SIZE                      = 16U * 1024U;
+    alignas(inotify_event) uint8_t eventBuffer_[EVENT_BUFFER_SIZE] = {}; // used only by watch thread
 };
 
-} // namespace engine::platform
\ No newline at end of file
+} // namespace engine::platform
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace engine::private_ {
+
+// 4 lanes of floats, so SoA kernels are written once for SSE and for the scalar fallback
+#if defined(__SSE2__)
+
+struct F4 final {
+    __m128 v;
+
+    static auto Load(float const* values) -> F4 { return F4{_mm_loadu_ps(values)}; }
+    static auto Set(float value) -> F4 { return F4{_mm_set1_ps(value)}; }
+    // values[idx[lane] * stride] for each lane, converted to float
+    template <typename T, typename Index> static auto Gather(T const* values, size_t stride, Index const* idx) -> F4 {
+        return F4{_mm_setr_ps(
+            static_cast<float>(values[idx[0] * stride]),
+            static_cast<float>(values[idx[1] * stride]),
+            static_cast<float>(values[idx[2] * stride]),
+            static_cast<float>(values[idx[3] * stride]))};
+    }
+    void Store(float* values) const { _mm_storeu_ps(values, v); }
+};
+
+// Result of a lane-wise comparison, lanes are all ones or all zeros
+struct M4 final {
+    __m128 v;
+
+    static auto None() -> M4 { return M4{_mm_setzero_ps()}; }
+};
+
+inline auto operator+(F4 a, F4 b) -> F4 { return F4{_mm_add_ps(a.v, b.v)}; }
+inline auto operator-(F4 a, F4 b) -> F4 { return F4{_mm_sub_ps(a.v, b.v)}; }
+inline auto operator*(F4 a, F4 b) -> F4 { return F4{_mm_mul_ps(a.v, b.v)}; }
+inline auto operator/(F4 a, F4 b) -> F4 { return F4{_mm_div_ps(a.v, b.v)}; }
+inline auto InverseSqrt(F4 a) -> F4 { return F4{_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a.v))}; }
+// -1 for negative lanes, 1 otherwise
+inline auto Sign(F4 a) -> F4 {
+    return F4{_mm_or_ps(_mm_and_ps(a.v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f))};
+}
+inline auto Min(F4 a, F4 b) -> F4 { return F4{_mm_min_ps(a.v, b.v)}; }
+inline auto Max(F4 a, F4 b) -> F4 { return F4{_mm_max_ps(a.v, b.v)}; }
+
+inline auto operator<(F4 a, F4 b) -> M4 { return M4{_mm_cmplt_ps(a.v, b.v)}; }
+inline auto operator<=(F4 a, F4 b) -> M4 { return M4{_mm_cmple_ps(a.v, b.v)}; }
+inline auto operator&(M4 a, M4 b) -> M4 { return M4{_mm_and_ps(a.v, b.v)}; }
+inline auto operator|(M4 a, M4 b) -> M4 { return M4{_mm_or_ps(a.v, b.v)}; }
+// Lanes of a, which aren't set in b
+inline auto AndNot(M4 a, M4 b) -> M4 { return M4{_mm_andnot_ps(b.v, a.v)}; }
+// Lanes of a where the mask is set, lanes of b otherwise
+inline auto Select(M4 mask, F4 a, F4 b) -> F4 {
+    return F4{_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+}
+// Bit per lane, lane 0 is the lowest bit
+inline auto BitMask(M4 mask) -> uint32_t { return static_cast<uint32_t>(_mm_movemask_ps(mask.v)); }
+
+inline auto ReduceAdd(F4 a) -> float {
+    __m128 pairs = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+inline auto ReduceMin(F4 a) -> float {
+    __m128 pairs = _mm_min_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    return _mm_cvtss_f32(_mm_min_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+inline auto ReduceMax(F4 a) -> float {
+    __m128 pairs = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+#else
+
+struct F4 final {
+    float v[4];
+
+    static auto Load(float const* values) -> F4 { return F4{{values[0], values[1], values[2], values[3]}}; }
+    static auto Set(float value) -> F4 { return F4{{value, value, value, value}}; }
+    template <typename T, typename Index> static auto Gather(T const* values, size_t stride, Index const* idx) -> F4 {
+        return F4{{
+            static_cast<float>(values[idx[0] * stride]),
+            static_cast<float>(values[idx[1] * stride]),
+            static_cast<float>(values[idx[2] * stride]),
+            static_cast<float>(values[idx[3] * stride]),
+        }};
+    }
+    void Store(float* values) const {
+        for (size_t lane = 0; lane < 4U; ++lane) { values[lane] = v[lane]; }
+    }
+};
+
+struct M4 final {
+    bool v[4];
+
+    static auto None() -> M4 { return M4{{false, false, false, false}}; }
+};
+
+#define XF4_OPERATOR(op)                                                                     \
+    inline auto operator op(F4 a, F4 b) -> F4 {                                              \
+        return F4{{a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]}}; \
+    }
+XF4_OPERATOR(+)
+XF4_OPERATOR(-)
+XF4_OPERATOR(*)
+XF4_OPERATOR(/)
+#undef XF4_OPERATOR
+inline auto InverseSqrt(F4 a) -> F4 {
+    F4 result{};
+    for (size_t lane = 0; lane < 4U; ++lane) { result.v[lane] = 1.0f / std::sqrt(a.v[lane]); }
+    return result;
+}
+inline auto Sign(F4 a) -> F4 {
+    F4 result{};
+    for (size_t lane = 0; lane < 4U; ++lane) { result.v[lane] = std::signbit(a.v[lane]) ? -1.0f : 1.0f; }
+    return result;
+}
+// NOTE: the same as minps/maxps, b is returned when a lane is NaN
+inline auto Min(F4 a, F4 b) -> F4 {
+    F4 result{};
+    for (size_t lane = 0; lane < 4U; ++lane) { result.v[lane] = a.v[lane] < b.v[lane] ? a.v[lane] : b.v[lane]; }
+    return result;
+}
+inline auto Max(F4 a, F4 b) -> F4 {
+    F4 result{};
+    for (size_t lane = 0; lane < 4U; ++lane) { result.v[lane] = a.v[lane] > b.v[lane] ? a.v[lane] : b.v[lane]; }
+    return result;
+}
+
+#define XM4_OPERATOR(op, type)                                                               \
+    inline auto operator op(type a, type b) -> M4 {                                          \
+        return M4{{a.v[0] op b.v[0], a.v[1] op b.v[1], a.v[2] op b.v[2], a.v[3] op b.v[3]}}; \
+    }
+XM4_OPERATOR(<, F4)
+XM4_OPERATOR(<=, F4)
+#undef XM4_OPERATOR
+inline auto operator&(M4 a, M4 b) -> M4 {
+    return M4{{a.v[0] && b.v[0], a.v[1] && b.v[1], a.v[2] && b.v[2], a.v[3] && b.v[3]}};
+}
+inline auto operator|(M4 a, M4 b) -> M4 {
+    return M4{{a.v[0] || b.v[0], a.v[1] || b.v[1], a.v[2] || b.v[2], a.v[3] || b.v[3]}};
+}
+inline auto AndNot(M4 a, M4 b) -> M4 {
+    return M4{{a.v[0] && !b.v[0], a.v[1] && !b.v[1], a.v[2] && !b.v[2], a.v[3] && !b.v[3]}};
+}
+inline auto Select(M4 mask, F4 a, F4 b) -> F4 {
+    F4 result{};
+    for (size_t lane = 0; lane < 4U; ++lane) { result.v[lane] = mask.v[lane] ? a.v[lane] : b.v[lane]; }
+    return result;
+}
+inline auto BitMask(M4 mask) -> uint32_t {
+    uint32_t bits = 0U;
+    for (size_t lane = 0; lane < 4U; ++lane) { bits |= mask.v[lane] ? 1U << lane : 0U; }
+    return bits;
+}
+
+inline auto ReduceAdd(F4 a) -> float { return (a.v[0] + a.v[2]) + (a.v[1] + a.v[3]); }
+inline auto ReduceMin(F4 a) -> float { return std::min(std::min(a.v[0], a.v[2]), std::min(a.v[1], a.v[3])); }
+inline auto ReduceMax(F4 a) -> float { return std::max(std::max(a.v[0], a.v[2]), std::max(a.v[1], a.v[3])); }
+
+#endif
+
+struct F4x3 final {
+    F4 x;
+    F4 y;
+    F4 z;
+};
+
+inline auto Cross(F4x3 const& a, F4x3 const& b) -> F4x3 {
+    return F4x3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline auto Normalize(F4x3 const& a) -> F4x3 {
+    F4 invLength = InverseSqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+    return F4x3{a.x * invLength, a.y * invLength, a.z * invLength};
+}
+
+} // namespace engine::private_
@@ -0,0 +1,423 @@
+#include "engine/Animation.hpp"
+#include "engine/TransformHierarchy.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using engine::private_::F4;
+
+constexpr size_t LANES            = 4U;
+constexpr float QUANTIZATION      = 32767.0f;
+constexpr uint32_t INVALID_CURSOR = ~0U;
+
+auto PaddedSize(size_t numJoints) -> size_t { return (numJoints + LANES - 1U) / LANES * LANES; }
+
+auto Quantize(float value) -> int16_t {
+    return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * QUANTIZATION));
+}
+
+auto Dequantize(int16_t value) -> float { return static_cast<float>(value) / QUANTIZATION; }
+
+// Indices of samples kept as keys, every sample is within tolerance of the interpolation of the keys around it
+// isWithin(from, to, sample) checks the sample against interpolation of samples from and to
+template <typename Predicate> auto ReduceKeys(size_t numSamples, Predicate const& isWithin) -> std::vector<uint32_t> {
+    std::vector<uint32_t> keys{0U};
+    bool isConstant = true;
+    for (size_t sample = 1; sample < numSamples && isConstant; ++sample) { isConstant = isWithin(0U, 0U, sample); }
+    if (isConstant) { return keys; }
+
+    // NOTE: greedy, each key spans as many samples as the tolerance allows
+    size_t from = 0U;
+    while (from + 1U < numSamples) {
+        size_t to = from + 1U;
+        while (to + 1U < numSamples) {
+            bool canExtend = true;
+            for (size_t sample = from + 1U; sample <= to && canExtend; ++sample) {
+                canExtend = isWithin(from, to + 1U, sample);
+            }
+            if (!canExtend) { break; }
+            ++to;
+        }
+        keys.push_back(static_cast<uint32_t>(to));
+        from = to;
+    }
+    return keys;
+}
+
+auto Alpha(float const* times, size_t from, size_t to, float time) -> float {
+    if (from == to) { return 0.0f; }
+    return std::clamp((time - times[from]) / (times[to] - times[from]), 0.0f, 1.0f);
+}
+
+// Moves cursors of all joints to the key at or before time, and writes the keys to interpolate
+void FindKeys(
+    std::vector<uint32_t> const& keysBegin,
+    std::vector<float> const& times,
+    float time,
+    std::vector<uint32_t>& cursors,
+    std::vector<uint32_t>& keysFrom,
+    std::vector<uint32_t>& keysTo,
+    std::vector<float>& alphas) {
+    size_t numJoints = cursors.size();
+    for (size_t joint = 0; joint < numJoints; ++joint) {
+        uint32_t begin   = keysBegin[joint];
+        uint32_t end     = keysBegin[joint + 1U];
+        uint32_t& cursor = cursors[joint];
+        if (cursor < begin || cursor >= end || times[cursor] > time) {
+            // first sampling or time went back, e.g. the clip looped
+            auto const* after = std::upper_bound(times.data() + begin, times.data() + end, time);
+            auto afterIdx     = static_cast<uint32_t>(after - times.data());
+            cursor            = afterIdx == begin ? begin : afterIdx - 1U;
+        } else {
+            // sequential playback, the next key is usually the same or the following one
+            while (cursor + 1U < end && times[cursor + 1U] <= time) { ++cursor; }
+        }
+        keysFrom[joint] = cursor;
+        keysTo[joint]   = std::min(cursor + 1U, end - 1U);
+        alphas[joint]   = Alpha(times.data(), keysFrom[joint], keysTo[joint], time);
+    }
+}
+
+struct F4Quat final {
+    F4 x;
+    F4 y;
+    F4 z;
+    F4 w;
+
+    static auto Load(engine::Pose const& pose, size_t first) -> F4Quat {
+        return F4Quat{
+            F4::Load(pose.rotationX.data() + first),
+            F4::Load(pose.rotationY.data() + first),
+            F4::Load(pose.rotationZ.data() + first),
+            F4::Load(pose.rotationW.data() + first),
+        };
+    }
+
+    void Store(engine::Pose& pose, size_t first) const {
+        x.Store(pose.rotationX.data() + first);
+        y.Store(pose.rotationY.data() + first);
+        z.Store(pose.rotationZ.data() + first);
+        w.Store(pose.rotationW.data() + first);
+    }
+};
+
+inline auto Dot(F4Quat const& a, F4Quat const& b) -> F4 { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline auto Normalize(F4Quat const& q) -> F4Quat {
+    F4 invLength = InverseSqrt(Dot(q, q));
+    return F4Quat{q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength};
+}
+
+// Interpolates along the shorter arc, normalized linear interpolation is close enough to slerp between keys
+inline auto Nlerp(F4Quat const& from, F4Quat const& to, F4 alpha) -> F4Quat {
+    F4 fromWeight = F4::Set(1.0f) - alpha;
+    F4 toWeight   = alpha * Sign(Dot(from, to));
+    return Normalize(F4Quat{
+        from.x * fromWeight + to.x * toWeight,
+        from.y * fromWeight + to.y * toWeight,
+        from.z * fromWeight + to.z * toWeight,
+        from.w * fromWeight + to.w * toWeight,
+    });
+}
+
+// Same as glm, applies b first
+inline auto Mul(F4Quat const& a, F4Quat const& b) -> F4Quat {
+    return F4Quat{
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y + a.y * b.w + a.z * b.x - a.x * b.z,
+        a.w * b.z + a.z * b.w + a.x * b.y - a.y * b.x,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+    };
+}
+
+void SampleVec3(
+    engine::AnimationClip::Vec3Track const& track,
+    std::vector<uint32_t> const& keysFrom,
+    std::vector<uint32_t> const& keysTo,
+    std::vector<float> const& alphas,
+    std::vector<float>& outX,
+    std::vector<float>& outY,
+    std::vector<float>& outZ) {
+    for (size_t first = 0; first < keysFrom.size(); first += LANES) {
+        uint32_t const* from = keysFrom.data() + first;
+        uint32_t const* to   = keysTo.data() + first;
+        F4 alpha             = F4::Load(alphas.data() + first);
+        F4 fromWeight        = F4::Set(1.0f) - alpha;
+        (F4::Gather(track.x.data(), 1U, from) * fromWeight + F4::Gather(track.x.data(), 1U, to) * alpha)
+            .Store(outX.data() + first);
+        (F4::Gather(track.y.data(), 1U, from) * fromWeight + F4::Gather(track.y.data(), 1U, to) * alpha)
+            .Store(outY.data() + first);
+        (F4::Gather(track.z.data(), 1U, from) * fromWeight + F4::Gather(track.z.data(), 1U, to) * alpha)
+            .Store(outZ.data() + first);
+    }
+}
+
+void SampleQuat(
+    engine::AnimationClip::QuatTrack const& track,
+    std::vector<uint32_t> const& keysFrom,
+    std::vector<uint32_t> const& keysTo,
+    std::vector<float> const& alphas,
+    engine::Pose& out) {
+    F4 const scale = F4::Set(1.0f / QUANTIZATION);
+    for (size_t first = 0; first < keysFrom.size(); first += LANES) {
+        uint32_t const* from = keysFrom.data() + first;
+        uint32_t const* to   = keysTo.data() + first;
+        F4Quat fromKey{
+            F4::Gather(track.x.data(), 1U, from) * scale,
+            F4::Gather(track.y.data(), 1U, from) * scale,
+            F4::Gather(track.z.data(), 1U, from) * scale,
+            F4::Gather(track.w.data(), 1U, from) * scale,
+        };
+        F4Quat toKey{
+            F4::Gather(track.x.data(), 1U, to) * scale,
+            F4::Gather(track.y.data(), 1U, to) * scale,
+            F4::Gather(track.z.data(), 1U, to) * scale,
+            F4::Gather(track.w.data(), 1U, to) * scale,
+        };
+        Nlerp(fromKey, toKey, F4::Load(alphas.data() + first))
+            .Store(out, first);
+    }
+}
+
+void AddVec3Track(
+    engine::AnimationClip::Vec3Track& track,
+    engine::CpuView<float const> times,
+    engine::CpuView<glm::vec3 const> values,
+    float tolerance) {
+    size_t numSamples = values.NumElements();
+    assert((numSamples == 1U || numSamples == times.NumElements()) && "Bad call to AddJoint, a sample per time");
+    auto sample = [&](size_t idx) { return *values[idx]; };
+    auto keys   = ReduceKeys(numSamples, [&](size_t from, size_t to, size_t idx) {
+        float alpha = Alpha(times.Begin(), from, to, *times[idx]);
+        return glm::length(glm::mix(sample(from), sample(to), alpha) - sample(idx)) <= tolerance;
+    });
+    for (uint32_t key : keys) {
+        glm::vec3 value = sample(key);
+        track.times.push_back(numSamples == 1U ? 0.0f : *times[key]);
+        track.x.push_back(value.x);
+        track.y.push_back(value.y);
+        track.z.push_back(value.z);
+    }
+    track.keysBegin.push_back(static_cast<uint32_t>(track.times.size()));
+}
+
+void AddQuatTrack(
+    engine::AnimationClip::QuatTrack& track,
+    engine::CpuView<float const> times,
+    engine::CpuView<glm::quat const> values,
+    float tolerance) {
+    size_t numSamples = values.NumElements();
+    assert((numSamples == 1U || numSamples == times.NumElements()) && "Bad call to AddJoint, a sample per time");
+
+    // q and -q are the same rotation, neighbours are made to agree, so interpolation takes the shorter arc
+    std::vector<glm::quat> raw(numSamples);
+    std::vector<glm::quat> quantized(numSamples);
+    for (size_t idx = 0; idx < numSamples; ++idx) {
+        glm::quat rotation = glm::normalize(*values[idx]);
+        if (idx > 0U && glm::dot(raw[idx - 1U], rotation) < 0.0f) { rotation = rotation * -1.0f; }
+        raw[idx]       = rotation;
+        quantized[idx] = glm::quat{Dequantize(Quantize(rotation.w)), Dequantize(Quantize(rotation.x)),
+            Dequantize(Quantize(rotation.y)), Dequantize(Quantize(rotation.z))};
+    }
+    // NOTE: the error is measured with quantized keys, so the tolerance holds for what is sampled
+    auto keys = ReduceKeys(numSamples, [&](size_t from, size_t to, size_t idx) {
+        float alpha          = Alpha(times.Begin(), from, to, *times[idx]);
+        glm::quat lerped     = quantized[from] * (1.0f - alpha) + quantized[to] * alpha;
+        glm::quat normalized = lerped * (1.0f / std::sqrt(glm::dot(lerped, lerped)));
+        // angle from the chord between the quaternions, acos of their dot product is imprecise for small angles
+        glm::quat chord = glm::dot(normalized, raw[idx]) < 0.0f ? normalized + raw[idx] : normalized - raw[idx];
+        float angle     = 4.0f * std::asin(std::min(1.0f, 0.5f * std::sqrt(glm::dot(chord, chord))));
+        return angle <= tolerance;
+    });
+    for (uint32_t key : keys) {
+        track.times.push_back(numSamples == 1U ? 0.0f : *times[key]);
+        track.x.push_back(Quantize(raw[key].x));
+        track.y.push_back(Quantize(raw[key].y));
+        track.z.push_back(Quantize(raw[key].z));
+        track.w.push_back(Quantize(raw[key].w));
+    }
+    track.keysBegin.push_back(static_cast<uint32_t>(track.times.size()));
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT void Pose::Resize(size_t newNumJoints) {
+    size_t numPadded = PaddedSize(newNumJoints);
+    for (auto* values : {&positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ}) {
+        values->resize(numPadded, 0.0f);
+    }
+    for (auto* values : {&rotationW, &scaleX, &scaleY, &scaleZ}) { values->resize(numPadded, 1.0f); }
+    numJoints = newNumJoints;
+}
+
+ENGINE_EXPORT void Pose::SetLocal(uint32_t joint, Transform const& local) {
+    assert(joint < numJoints);
+    positionX[joint] = local.position.x;
+    positionY[joint] = local.position.y;
+    positionZ[joint] = local.position.z;
+    rotationX[joint] = local.rotation.x;
+    rotationY[joint] = local.rotation.y;
+    rotationZ[joint] = local.rotation.z;
+    rotationW[joint] = local.rotation.w;
+    scaleX[joint]    = local.scale.x;
+    scaleY[joint]    = local.scale.y;
+    scaleZ[joint]    = local.scale.z;
+}
+
+ENGINE_EXPORT auto Pose::Local(uint32_t joint) const -> Transform {
+    assert(joint < numJoints);
+    return Transform{
+        .position = glm::vec3{positionX[joint], positionY[joint], positionZ[joint]},
+        .rotation = glm::quat{rotationW[joint], rotationX[joint], rotationY[joint], rotationZ[joint]},
+        .scale    = glm::vec3{scaleX[joint], scaleY[joint], scaleZ[joint]},
+    };
+}
+
+ENGINE_EXPORT auto AnimationClip::AddJoint(
+    CpuView<float const> times,
+    CpuView<glm::vec3 const> positions,
+    CpuView<glm::quat const> rotations,
+    CpuView<glm::vec3 const> scales,
+    Tolerance const& tolerance) -> uint32_t {
+    assert(!times.IsEmpty() && "Bad call to AddJoint, a joint needs at least one sample");
+    assert(std::is_sorted(times.Begin(), times.End()) && "Bad call to AddJoint, times should increase");
+    AddVec3Track(positions_, times, positions, tolerance.position);
+    AddQuatTrack(rotations_, times, rotations, tolerance.rotation);
+    AddVec3Track(scales_, times, scales, tolerance.scale);
+    duration_ = std::max(duration_, *times[times.NumElements() - 1U]);
+    return static_cast<uint32_t>(numJoints_++);
+}
+
+ENGINE_EXPORT void AnimationSampler::Sample(AnimationClip const& clip, float time, Pose& out) {
+    size_t numJoints = clip.NumJoints();
+    time             = std::clamp(time, 0.0f, clip.Duration());
+    out.Resize(numJoints);
+    for (auto* cursors : {&positionCursors_, &rotationCursors_, &scaleCursors_}) {
+        if (cursors->size() != numJoints) { cursors->assign(numJoints, INVALID_CURSOR); }
+    }
+    // NOTE: padding lanes interpolate the first key with itself, their results aren't used
+    size_t numPadded = PaddedSize(numJoints);
+    keysFrom_.assign(numPadded, 0U);
+    keysTo_.assign(numPadded, 0U);
+    alphas_.assign(numPadded, 0.0f);
+    if (numJoints == 0U) { return; }
+
+    // cursors are advanced one track at a time, then keys of 4 joints are interpolated at once
+    FindKeys(clip.positions_.keysBegin, clip.positions_.times, time, positionCursors_, keysFrom_, keysTo_, alphas_);
+    SampleVec3(clip.positions_, keysFrom_, keysTo_, alphas_, out.positionX, out.positionY, out.positionZ);
+    FindKeys(clip.rotations_.keysBegin, clip.rotations_.times, time, rotationCursors_, keysFrom_, keysTo_, alphas_);
+    SampleQuat(clip.rotations_, keysFrom_, keysTo_, alphas_, out);
+    FindKeys(clip.scales_.keysBegin, clip.scales_.times, time, scaleCursors_, keysFrom_, keysTo_, alphas_);
+    SampleVec3(clip.scales_, keysFrom_, keysTo_, alphas_, out.scaleX, out.scaleY, out.scaleZ);
+}
+
+ENGINE_EXPORT void BlendPoses(Pose const& from, Pose const& to, float weight, Pose& out) {
+    assert(from.numJoints == to.numJoints && "Bad call to BlendPoses, poses of different skeletons");
+    out.Resize(from.numJoints);
+    F4 const toWeight   = F4::Set(weight);
+    F4 const fromWeight = F4::Set(1.0f - weight);
+    auto lerp = [&](std::vector<float> const& a, std::vector<float> const& b, std::vector<float>& result, size_t i) {
+        (F4::Load(a.data() + i) * fromWeight + F4::Load(b.data() + i) * toWeight).Store(result.data() + i);
+    };
+    for (size_t first = 0; first < out.positionX.size(); first += LANES) {
+        lerp(from.positionX, to.positionX, out.positionX, first);
+        lerp(from.positionY, to.positionY, out.positionY, first);
+        lerp(from.positionZ, to.positionZ, out.positionZ, first);
+        lerp(from.scaleX, to.scaleX, out.scaleX, first);
+        lerp(from.scaleY, to.scaleY, out.scaleY, first);
+        lerp(from.scaleZ, to.scaleZ, out.scaleZ, first);
+        Nlerp(F4Quat::Load(from, first), F4Quat::Load(to, first), toWeight).Store(out, first);
+    }
+}
+
+ENGINE_EXPORT void MakeAdditivePose(Pose const& pose, Pose const& reference, Pose& out) {
+    assert(pose.numJoints == reference.numJoints && "Bad call to MakeAdditivePose, poses of different skeletons");
+    out.Resize(pose.numJoints);
+    F4 const zero = F4::Set(0.0f);
+    for (size_t first = 0; first < out.positionX.size(); first += LANES) {
+        (F4::Load(pose.positionX.data() + first) - F4::Load(reference.positionX.data() + first))
+            .Store(out.positionX.data() + first);
+        (F4::Load(pose.positionY.data() + first) - F4::Load(reference.positionY.data() + first))
+            .Store(out.positionY.data() + first);
+        (F4::Load(pose.positionZ.data() + first) - F4::Load(reference.positionZ.data() + first))
+            .Store(out.positionZ.data() + first);
+        (F4::Load(pose.scaleX.data() + first) / F4::Load(reference.scaleX.data() + first))
+            .Store(out.scaleX.data() + first);
+        (F4::Load(pose.scaleY.data() + first) / F4::Load(reference.scaleY.data() + first))
+            .Store(out.scaleY.data() + first);
+        (F4::Load(pose.scaleZ.data() + first) / F4::Load(reference.scaleZ.data() + first))
+            .Store(out.scaleZ.data() + first);
+        // delta is applied in the local space of the joint: pose = reference * delta
+        F4Quat referenceRotation = F4Quat::Load(reference, first);
+        F4Quat inverseReference{
+            zero - referenceRotation.x, zero - referenceRotation.y, zero - referenceRotation.z, referenceRotation.w};
+        Normalize(Mul(inverseReference, F4Quat::Load(pose, first))).Store(out, first);
+    }
+}
+
+ENGINE_EXPORT void ApplyAdditivePose(Pose const& base, Pose const& additive, float weight, Pose& out) {
+    assert(base.numJoints == additive.numJoints && "Bad call to ApplyAdditivePose, poses of different skeletons");
+    out.Resize(base.numJoints);
+    F4 const one            = F4::Set(1.0f);
+    F4 const zero           = F4::Set(0.0f);
+    F4 const additiveWeight = F4::Set(weight);
+    F4Quat const identity{zero, zero, zero, one};
+    auto add = [&](std::vector<float> const& a, std::vector<float> const& delta, std::vector<float>& result, size_t i) {
+        (F4::Load(a.data() + i) + F4::Load(delta.data() + i) * additiveWeight).Store(result.data() + i);
+    };
+    // scale is multiplied by the delta scaled towards 1
+    auto mul = [&](std::vector<float> const& a, std::vector<float> const& delta, std::vector<float>& result, size_t i) {
+        F4 partialDelta = one + (F4::Load(delta.data() + i) - one) * additiveWeight;
+        (F4::Load(a.data() + i) * partialDelta).Store(result.data() + i);
+    };
+    for (size_t first = 0; first < out.positionX.size(); first += LANES) {
+        add(base.positionX, additive.positionX, out.positionX, first);
+        add(base.positionY, additive.positionY, out.positionY, first);
+        add(base.positionZ, additive.positionZ, out.positionZ, first);
+        mul(base.scaleX, additive.scaleX, out.scaleX, first);
+        mul(base.scaleY, additive.scaleY, out.scaleY, first);
+        mul(base.scaleZ, additive.scaleZ, out.scaleZ, first);
+        F4Quat delta = Nlerp(identity, F4Quat::Load(additive, first), additiveWeight);
+        Normalize(Mul(F4Quat::Load(base, first), delta)).Store(out, first);
+    }
+}
+
+ENGINE_EXPORT void ApplyPose(Pose const& pose, CpuView<uint32_t const> nodeIds, TransformHierarchy& hierarchy) {
+    assert(nodeIds.NumElements() >= pose.numJoints && "Bad call to ApplyPose, each joint needs a node");
+    for (uint32_t joint = 0; joint < pose.numJoints; ++joint) {
+        hierarchy.SetLocal(*nodeIds[joint], pose.Local(joint));
+    }
+}
+
+ENGINE_EXPORT void ComputeSkinningMatrices(
+    TransformHierarchy const& hierarchy,
+    CpuView<uint32_t const> nodeIds,
+    CpuView<glm::mat4 const> inverseBindMatrices,
+    CpuView<glm::mat4> outPalette) {
+    size_t numJoints = nodeIds.NumElements();
+    assert(inverseBindMatrices.NumElements() >= numJoints && outPalette.NumElements() >= numJoints);
+    for (size_t joint = 0; joint < numJoints; ++joint) {
+        *outPalette[joint] = hierarchy.WorldMatrix(*nodeIds[joint]) * *inverseBindMatrices[joint];
+    }
+}
+
+ENGINE_EXPORT void ComputeSkinningDualQuats(
+    TransformHierarchy const& hierarchy,
+    CpuView<uint32_t const> nodeIds,
+    CpuView<glm::mat4 const> inverseBindMatrices,
+    CpuView<math::DualQuat> outPalette) {
+    size_t numJoints = nodeIds.NumElements();
+    assert(inverseBindMatrices.NumElements() >= numJoints && outPalette.NumElements() >= numJoints);
+    for (size_t joint = 0; joint < numJoints; ++joint) {
+        *outPalette[joint]
+            = math::DualQuatFromMatrix(hierarchy.WorldMatrix(*nodeIds[joint]) * *inverseBindMatrices[joint]);
+    }
+}
+
+} // namespace engine
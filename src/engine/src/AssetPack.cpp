@@ -0,0 +1,317 @@
+#include "engine/AssetPack.hpp"
+#include "engine/Hash.hpp"
+#include "engine/LzCompression.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace {
+
+constexpr char PACK_MAGIC[8]       = {'X', 'A', 'S', 'S', 'E', 'T', 'P', 'K'};
+constexpr uint32_t PACK_VERSION    = 1U;
+constexpr uint64_t ENTRY_ALIGNMENT = 64U;
+constexpr uint32_t ENTRY_FLAG_LZ   = 1U << 0U;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numEntries;
+    uint64_t pathsOffset;
+    uint64_t pathsNumBytes;
+};
+
+struct FileEntry {
+    uint64_t pathHash;
+    uint64_t byteOffset;
+    uint64_t numStoredBytes;
+    uint64_t numBytes;
+    uint32_t pathOffset; // relative to FileHeader::pathsOffset
+    uint32_t pathLength;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct PackedFile {
+    std::string path                 = {};
+    uint64_t pathHash                = 0U;
+    engine::platform::MappedFile raw = engine::platform::MappedFile{};
+    std::vector<uint8_t> compressed  = {};
+};
+
+auto AlignUp [[nodiscard]] (uint64_t value, uint64_t alignment) -> uint64_t {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+
+auto NormalizeAssetPath [[nodiscard]] (std::string_view filepath) -> std::string {
+    std::string normalized{filepath};
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    while (normalized.starts_with("./")) { normalized.erase(0, 2); }
+    return normalized;
+}
+
+auto HashAssetPath [[nodiscard]] (std::string_view normalizedPath) -> uint64_t {
+    return engine::HashBytes(normalizedPath.data(), normalizedPath.size());
+}
+
+auto ReadFileEntry [[nodiscard]] (engine::CpuMemory<uint8_t const> fileData, size_t entryIdx) -> FileEntry {
+    FileEntry entry;
+    std::memcpy(&entry, fileData.data + sizeof(FileHeader) + entryIdx * sizeof(FileEntry), sizeof(entry));
+    return entry;
+}
+
+using MountedPacks = std::vector<std::shared_ptr<engine::AssetPack const>>;
+
+auto GetMountedPacks [[nodiscard]] () -> std::pair<MountedPacks&, std::mutex&> {
+    // NOTE: lives in engine library, so hot reloading of application code keeps the packs mounted
+    static MountedPacks mountedPacks{};
+    static std::mutex mountedPacksMutex{};
+    return {mountedPacks, mountedPacksMutex};
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto AssetPack::Open(std::string_view filepath) -> std::optional<AssetPack> {
+    std::error_code err;
+    if (!std::filesystem::exists(filepath, err)) { return std::nullopt; }
+
+    auto mappedFile = platform::MappedFile::Map(filepath);
+    if (!mappedFile) { return std::nullopt; }
+    auto fileData = mappedFile->Data();
+
+    FileHeader header;
+    if (fileData.NumBytes() < sizeof(header)) {
+        XLOGW("Asset pack is truncated: {}", filepath);
+        return std::nullopt;
+    }
+    std::memcpy(&header, fileData.data, sizeof(header));
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION) {
+        XLOGW("Asset pack has unknown format or version: {}", filepath);
+        return std::nullopt;
+    }
+
+    size_t indexEnd = sizeof(FileHeader) + static_cast<size_t>(header.numEntries) * sizeof(FileEntry);
+    if (fileData.NumBytes() < indexEnd || header.pathsOffset < indexEnd || header.pathsOffset > fileData.NumBytes()
+        || header.pathsNumBytes > fileData.NumBytes() - header.pathsOffset) {
+        XLOGW("Asset pack is truncated: {}", filepath);
+        return std::nullopt;
+    }
+
+    // NOTE: the index is validated once here, so lookups don't need bounds checks
+    for (size_t i = 0; i < header.numEntries; ++i) {
+        auto entry = ReadFileEntry(fileData, i);
+        if (entry.byteOffset < indexEnd || entry.byteOffset > fileData.NumBytes()
+            || entry.numStoredBytes > fileData.NumBytes() - entry.byteOffset
+            || static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header.pathsNumBytes
+            || (i > 0 && ReadFileEntry(fileData, i - 1).pathHash > entry.pathHash)) {
+            XLOGW("Asset pack has invalid entry {}: {}", i, filepath);
+            return std::nullopt;
+        }
+    }
+
+    AssetPack pack{};
+    pack.file_       = std::move(*mappedFile);
+    pack.filepath_   = std::string{filepath};
+    pack.numEntries_ = header.numEntries;
+    XLOG("Opened asset pack: {} ({} entries)", filepath, pack.numEntries_);
+    return pack;
+}
+
+ENGINE_EXPORT auto AssetPack::Write(std::string_view filepath, std::string_view rootDirectory, bool compress)
+    -> bool {
+    namespace fs = std::filesystem;
+    std::error_code err;
+    auto packPath = fs::path{filepath};
+
+    std::vector<PackedFile> files;
+    for (auto it = fs::recursive_directory_iterator{rootDirectory, err}; !err && it != fs::end(it);
+         it.increment(err)) {
+        // NOTE: separate error code, a failed check only skips the file, but mustn't stop the iteration
+        std::error_code fileErr;
+        if (!it->is_regular_file(fileErr) || fs::equivalent(it->path(), packPath, fileErr)) { continue; }
+        files.emplace_back(PackedFile{
+            .path = NormalizeAssetPath((fs::path{rootDirectory} / it->path().lexically_relative(rootDirectory))
+                                           .lexically_normal()
+                                           .generic_string()),
+        });
+    }
+    if (err) {
+        XLOGE("Failed to list asset directory: {} ({})", rootDirectory, err.message());
+        return false;
+    }
+
+    for (auto& file : files) {
+        file.pathHash = HashAssetPath(file.path);
+        auto raw      = platform::MappedFile::Map(file.path);
+        if (!raw) { return false; }
+        file.raw = std::move(*raw);
+        if (compress && file.raw.NumBytes() > 0U) {
+            file.compressed = LzCompress(file.raw.Data());
+            if (file.compressed.size() > file.raw.NumBytes() / 10U * 9U) { file.compressed = {}; }
+        }
+    }
+    std::sort(files.begin(), files.end(), [](PackedFile const& a, PackedFile const& b) {
+        return a.pathHash != b.pathHash ? a.pathHash < b.pathHash : a.path < b.path;
+    });
+
+    FileHeader header{
+        .version     = PACK_VERSION,
+        .numEntries  = static_cast<uint32_t>(files.size()),
+        .pathsOffset = sizeof(FileHeader) + files.size() * sizeof(FileEntry),
+    };
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+
+    std::vector<FileEntry> entries(files.size());
+    std::string paths;
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i].pathHash   = files[i].pathHash;
+        entries[i].pathOffset = static_cast<uint32_t>(paths.size());
+        entries[i].pathLength = static_cast<uint32_t>(files[i].path.size());
+        paths += files[i].path;
+    }
+    header.pathsNumBytes = paths.size();
+
+    uint64_t byteOffset  = AlignUp(header.pathsOffset + header.pathsNumBytes, ENTRY_ALIGNMENT);
+    uint64_t numBytesRaw = 0U;
+    for (size_t i = 0; i < files.size(); ++i) {
+        bool isCompressed         = !files[i].compressed.empty();
+        entries[i].byteOffset     = byteOffset;
+        entries[i].numBytes       = files[i].raw.NumBytes();
+        entries[i].numStoredBytes = isCompressed ? files[i].compressed.size() : files[i].raw.NumBytes();
+        entries[i].flags          = isCompressed ? ENTRY_FLAG_LZ : 0U;
+        entries[i].reserved       = 0U;
+        byteOffset                = AlignUp(byteOffset + entries[i].numStoredBytes, ENTRY_ALIGNMENT);
+        numBytesRaw += entries[i].numBytes;
+    }
+
+    if (packPath.has_parent_path()) { fs::create_directories(packPath.parent_path(), err); }
+    auto tmpPath = packPath;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            XLOGE("Failed to open asset pack for writing: {}", tmpPath.string());
+            return false;
+        }
+        constexpr char padding[ENTRY_ALIGNMENT] = {};
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(entries.data()), entries.size() * sizeof(FileEntry));
+        file.write(paths.data(), paths.size());
+        uint64_t position = header.pathsOffset + header.pathsNumBytes;
+        for (size_t i = 0; i < files.size(); ++i) {
+            auto stored = files[i].compressed.empty()
+                ? files[i].raw.Data()
+                : CpuMemory<uint8_t const>{files[i].compressed.data(), files[i].compressed.size()};
+            file.write(padding, entries[i].byteOffset - position);
+            file.write(reinterpret_cast<char const*>(stored.data), stored.NumBytes());
+            position = entries[i].byteOffset + stored.NumBytes();
+        }
+        if (!file) {
+            XLOGE("Failed to write asset pack: {}", tmpPath.string());
+            return false;
+        }
+    }
+
+    fs::rename(tmpPath, packPath, err);
+    if (err) {
+        XLOGE("Failed to move asset pack into place: {} ({})", packPath.string(), err.message());
+        fs::remove(tmpPath, err);
+        return false;
+    }
+    XLOG("Wrote asset pack: {} ({} entries, {} -> {} bytes)", filepath, files.size(), numBytesRaw, byteOffset);
+    return true;
+}
+
+ENGINE_EXPORT auto AssetPack::Find(std::string_view assetPath) const -> std::optional<AssetPackEntry> {
+    auto normalizedPath = NormalizeAssetPath(assetPath);
+    auto pathHash       = HashAssetPath(normalizedPath);
+    auto fileData       = file_.Data();
+
+    FileHeader header;
+    std::memcpy(&header, fileData.data, sizeof(header));
+
+    // lower bound of the hash, then linear scan over the (practically never) colliding hashes
+    size_t first = 0U;
+    size_t count = numEntries_;
+    while (count > 0U) {
+        size_t half = count / 2U;
+        if (ReadFileEntry(fileData, first + half).pathHash < pathHash) {
+            first += half + 1U;
+            count -= half + 1U;
+        } else {
+            count = half;
+        }
+    }
+    for (size_t i = first; i < numEntries_; ++i) {
+        auto entry = ReadFileEntry(fileData, i);
+        if (entry.pathHash != pathHash) { break; }
+        auto entryPath = std::string_view{
+            reinterpret_cast<char const*>(fileData.data + header.pathsOffset + entry.pathOffset), entry.pathLength};
+        if (entryPath != normalizedPath) { continue; }
+        return AssetPackEntry{
+            .storedData   = CpuMemory<uint8_t const>{fileData.data, entry.numStoredBytes,
+                                                   static_cast<ptrdiff_t>(entry.byteOffset)},
+            .numBytes     = entry.numBytes,
+            .isCompressed = (entry.flags & ENTRY_FLAG_LZ) != 0U,
+        };
+    }
+    return std::nullopt;
+}
+
+ENGINE_EXPORT auto MountAssetPack(std::string_view filepath) -> bool {
+    auto pack = AssetPack::Open(filepath);
+    if (!pack) { return false; }
+    auto [mountedPacks, mutex] = GetMountedPacks();
+    std::lock_guard const lock(mutex);
+    mountedPacks.emplace_back(std::make_shared<AssetPack const>(std::move(*pack)));
+    return true;
+}
+
+ENGINE_EXPORT void UnmountAssetPacks() {
+    auto [mountedPacks, mutex] = GetMountedPacks();
+    std::lock_guard const lock(mutex);
+    mountedPacks.clear();
+}
+
+ENGINE_EXPORT auto ReadAsset(std::string_view filepath) -> std::optional<AssetData> {
+#ifdef XDEBUG
+    // NOTE: in development, edited loose files win over their stale copies in the pack, so hot reload sees them
+    if (std::error_code err; std::filesystem::is_regular_file(filepath, err)) {
+        if (auto looseFile = platform::MappedFile::Map(filepath)) { return AssetData{std::move(*looseFile)}; }
+    }
+#endif // XDEBUG
+
+    std::shared_ptr<AssetPack const> pack{};
+    std::optional<AssetPackEntry> entry{};
+    {
+        auto [mountedPacks, mutex] = GetMountedPacks();
+        std::lock_guard const lock(mutex);
+        for (auto it = mountedPacks.rbegin(); it != mountedPacks.rend() && !entry; ++it) {
+            entry = (*it)->Find(filepath);
+            pack  = *it;
+        }
+    }
+
+    if (!entry) {
+        auto looseFile = platform::MappedFile::Map(filepath);
+        if (!looseFile) { return std::nullopt; }
+        return AssetData{std::move(*looseFile)};
+    }
+    if (!entry->isCompressed) { return AssetData{std::move(pack), entry->storedData}; }
+
+    std::vector<uint8_t> decompressed(entry->numBytes);
+    if (!LzDecompress(entry->storedData, CpuMemory<uint8_t>{decompressed.data(), decompressed.size()})) {
+        XLOGE("Failed to decompress asset: {} (pack {})", filepath, pack->Filepath());
+        return std::nullopt;
+    }
+    return AssetData{std::move(decompressed)};
+}
+
+} // namespace engine
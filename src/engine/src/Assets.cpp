@@ -1,104 +1,458 @@
+#include "engine/AssetPack.hpp"
 #include "engine/Assets.hpp"
+#include "engine/Hash.hpp"
+#include "engine/MipGeneration.hpp"
+#include "engine/TextureContainer.hpp"
 #include "engine/gl/Texture.hpp"
+#include "engine/platform/Filesystem.hpp"
 
 #include "engine_private/Prelude.hpp"
 
+#include <bit>
+#include <chrono>
+#include <cstring>
 #include <stb_image.h>
+#include <thread>
+
+namespace {
+
+constexpr uint64_t BAKED_TEXTURE_VERSION = 2U; // NOTE: bump to invalidate baked textures after loader changes
+
+using TextureLevels = std::vector<std::vector<uint8_t>>;
+
+auto DataFormatFromChannels [[nodiscard]] (int32_t numChannels) -> GLenum {
+    switch (numChannels) {
+    case 1:
+        return GL_RED;
+    case 2:
+        return GL_RG;
+    case 3:
+        return GL_RGB;
+    default:
+        return GL_RGBA;
+    }
+}
+
+auto IsSrgbFormat [[nodiscard]] (GLenum internalFormat) -> bool {
+    return internalFormat == GL_SRGB | internalFormat == GL_SRGB8 | internalFormat == GL_SRGB_ALPHA
+        | internalFormat == GL_SRGB8_ALPHA8;
+}
+
+// Requested block format if GL can sample it, otherwise NONE (texture stays uncompressed)
+auto SupportedCompression [[nodiscard]] (engine::gl::GlContext const& gl, engine::gl::LoadTextureArgs const& args)
+    -> engine::BlockFormat {
+    using engine::BlockFormat;
+    using engine::gl::GlExtensions;
+    auto const& extensions = gl.Extensions();
+    bool isSupported       = false;
+    switch (args.compression) {
+    case BlockFormat::BC1:
+    case BlockFormat::BC3:
+        isSupported = extensions.Supports(GlExtensions::EXT_texture_compression_s3tc)
+            && (!IsSrgbFormat(args.format) || extensions.Supports(GlExtensions::EXT_texture_sRGB));
+        break;
+    case BlockFormat::BC7:
+        isSupported = extensions.Supports(GlExtensions::ARB_texture_compression_bptc);
+        break;
+    default:
+        return BlockFormat::NONE;
+    }
+    if (!isSupported) {
+        XLOGW(
+            "Texture compression {} is not supported, {} is loaded uncompressed", int(args.compression),
+            args.filepath);
+        return BlockFormat::NONE;
+    }
+    return args.compression;
+}
+
+auto HashTextureArgs [[nodiscard]] (engine::gl::LoadTextureArgs const& args, engine::BlockFormat compression)
+    -> uint64_t {
+    uint64_t hash = BAKED_TEXTURE_VERSION;
+    hash          = engine::HashCombine(hash, args.format);
+    hash          = engine::HashCombine(hash, static_cast<uint64_t>(args.numChannels));
+    hash          = engine::HashCombine(hash, static_cast<uint64_t>(args.withMips));
+    hash          = engine::HashCombine(hash, static_cast<uint64_t>(compression));
+    hash          = engine::HashCombine(hash, static_cast<uint64_t>(args.compressionQuality));
+    hash          = engine::HashCombine(hash, static_cast<uint64_t>(args.mipFilter));
+    hash          = engine::HashCombine(hash, std::bit_cast<uint32_t>(args.alphaCoverageReference));
+    return hash;
+}
+
+auto BakedTextureFilepath [[nodiscard]] (std::string_view cacheDirectory, uint64_t sourceHash, uint64_t argsHash)
+    -> std::string {
+    char name[2 * 16 + 1] = {};
+    auto* nameEnd         = name;
+    for (uint64_t hash : {sourceHash, argsHash}) {
+        for (int32_t shift = 60; shift >= 0; shift -= 4) { *nameEnd++ = "0123456789abcdef"[(hash >> shift) & 0xFU]; }
+    }
+    auto filepath = std::string{cacheDirectory};
+    filepath += '/';
+    filepath += std::string_view{name, nameEnd};
+    filepath += ".xtex";
+    return filepath;
+}
+
+auto UploadTextureContainer [[nodiscard]] (
+    engine::gl::GlContext& gl, engine::TextureContainer const& container, std::string_view name)
+    -> engine::gl::Texture {
+    auto const& desc = container.Desc();
+    auto texture =
+        engine::gl::Texture::Allocate2D(gl, GL_TEXTURE_2D, desc.size, desc.internalFormat, desc.numLevels, name);
+    auto textureGuard = engine::gl::TextureCtx{texture};
+    for (int32_t level = 0; level < desc.numLevels; ++level) {
+        auto levelSize = glm::ivec3{container.LevelSize(level), 0};
+        auto levelData = container.LevelData(level);
+        if (container.IsCompressed()) {
+            textureGuard.FillCompressed2D(engine::gl::TextureCtx::FillCompressedArgs{
+                .compressedFormat = desc.internalFormat,
+                .data             = levelData.data,
+                .numBytes         = static_cast<GLsizei>(levelData.NumBytes()),
+                .size             = levelSize,
+                .mipLevel         = level,
+            });
+            continue;
+        }
+        textureGuard.Fill2D(engine::gl::TextureCtx::FillArgs{
+            .dataFormat = desc.dataFormat,
+            .dataType   = desc.dataType,
+            .data       = levelData.data,
+            .size       = levelSize,
+            .mipLevel   = level,
+        });
+    }
+    return texture;
+}
+
+// Mips are generated on CPU, so they don't depend on the driver and can be baked or block compressed
+auto GenerateMipLevels [[nodiscard]] (
+    engine::gl::LoadTextureArgs const& args, engine::CpuView<uint8_t const> image, glm::ivec2 size, int32_t numLevels,
+    int32_t numChannels) -> TextureLevels {
+    return engine::GenerateMips(engine::MipGenerationArgs{
+        .pixels                 = image.data,
+        .size                   = size,
+        .numChannels            = numChannels,
+        .pixelType              = engine::MipPixelType::UINT8,
+        .isSrgb                 = IsSrgbFormat(args.format),
+        .filter                 = args.mipFilter,
+        .alphaCoverageReference = args.alphaCoverageReference,
+        .numLevels              = numLevels,
+    });
+}
+
+// Block compresses every level on CPU, mips are levels 1..N-1 (see GenerateMipLevels)
+auto CompressLevels [[nodiscard]] (
+    engine::gl::LoadTextureArgs const& args, engine::BlockFormat compression, engine::CpuView<uint8_t const> image,
+    TextureLevels const& mips, glm::ivec2 size, int32_t numChannels) -> TextureLevels {
+    TextureLevels levels(mips.size() + 1U);
+    auto compressStart = std::chrono::steady_clock::now();
+    for (size_t level = 0; level < levels.size(); ++level) {
+        auto compressionArgs = engine::BlockCompressionArgs{
+            .pixels      = level == 0 ? image.data : mips[level - 1].data(),
+            .size        = engine::MipLevelSize(size, static_cast<int32_t>(level)),
+            .numChannels = numChannels,
+            .format      = compression,
+            .quality     = args.compressionQuality,
+        };
+        levels[level] = engine::CompressBlocks(compressionArgs);
+    }
+    // NOTE: throughput of the whole mip chain, relative to pixels of level 0
+    [[maybe_unused]] double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - compressStart).count();
+    XLOG(
+        "Compressed texture {} ({}x{}) to format {}: {:.1f} MPix/s", args.filepath, size.x, size.y, int(compression),
+        double(size.x) * size.y / std::max(seconds, 1e-9) * 1e-6);
+    if (args.logCompressionPsnr) {
+        [[maybe_unused]] double psnr = engine::ComputeBlockCompressionPsnr(
+            engine::BlockCompressionArgs{
+                .pixels      = image.data,
+                .size        = size,
+                .numChannels = numChannels,
+                .format      = compression,
+                .quality     = args.compressionQuality,
+            },
+            engine::CpuMemory<uint8_t const>{levels[0].data(), levels[0].size()});
+        XLOG("Compressed texture {} level 0 PSNR={:.2f}dB", args.filepath, psnr);
+    }
+    return levels;
+}
+
+void WriteBakedTexture(
+    engine::TextureContainerDesc const& desc, TextureLevels const& levels, std::string const& filepath) {
+    std::vector<engine::CpuMemory<uint8_t const>> levelViews;
+    levelViews.reserve(levels.size());
+    for (auto const& level : levels) { levelViews.emplace_back(level.data(), level.size()); }
+    if (!engine::TextureContainer::Write(filepath, desc, levelViews)) {
+        XLOGW("Failed to bake texture into cache: {}", filepath);
+        return;
+    }
+    XLOG("Baked texture into cache: {}", filepath);
+}
+
+auto DecodeImage [[nodiscard]] (
+    engine::CpuMemory<uint8_t const> encodedImageData, int32_t numDesiredChannels, engine::ImageLoader::LoadInfo& info,
+    std::string_view& error) -> uint8_t* {
+    if (int ok = stbi_info_from_memory(
+            encodedImageData.data, encodedImageData.NumElements(), &info.width, &info.height,
+            &info.numChannelsInFile);
+        ok == 0) {
+        error = stbi_failure_reason();
+        return nullptr;
+    }
+
+    auto* decodedImageData = stbi_load_from_memory(
+        encodedImageData.data, encodedImageData.NumElements(), &info.width, &info.height, &info.numChannelsInFile,
+        numDesiredChannels);
+    if (!decodedImageData) {
+        error = stbi_failure_reason();
+        return nullptr;
+    }
+
+    // NOTE: 0 desired channels means to decode all channels of the file
+    info.numChannelsDecoded = numDesiredChannels > 0 ? numDesiredChannels : info.numChannelsInFile;
+    info.numDecodedBytes    = info.width * info.height * info.numChannelsDecoded * sizeof(uint8_t);
+    return decodedImageData;
+}
+
+struct ShaderIncludes final {
+    engine::gl::shader::IncludeRegistry common   = {};
+    engine::gl::shader::IncludeRegistry vertex   = {};
+    engine::gl::shader::IncludeRegistry fragment = {};
+};
+
+// NOTE: loaded on the first use, files are read again only by ReloadShaderInclude
+auto LoadedShaderIncludes [[nodiscard]] () -> ShaderIncludes& {
+    using namespace engine::gl::shader;
+    static ShaderIncludes includes = [] {
+        ShaderIncludes loaded{};
+        LoadCommonIncludes(loaded.common);
+        loaded.vertex.insert(loaded.common.begin(), loaded.common.end());
+        LoadVertexIncludes(loaded.vertex);
+        loaded.fragment.insert(loaded.common.begin(), loaded.common.end());
+        LoadFragmentIncludes(loaded.fragment);
+        return loaded;
+    }();
+    return includes;
+}
+
+} // namespace
 
 namespace engine {
 
 ENGINE_EXPORT auto LoadTextFile(std::string_view const filepath) -> std::string {
-    std::ostringstream ss;
-    std::ifstream file(filepath.data());
-    if (!file.is_open()) {
+    auto asset = ReadAsset(filepath);
+    if (!asset) {
         XLOGE("Failed to load text file: {}", filepath);
         return "";
     }
-    ss << file.rdbuf();
-    file.close();
     XLOGD("Loaded text file: {}", filepath);
-    return ss.str();
+    return std::string{asset->Text()};
 }
 
 ENGINE_EXPORT auto LoadBinaryFile(std::string_view const filepath, FileSizeCallback sizeCallback) -> size_t {
-    std::ifstream file(filepath.data(), std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    auto asset = ReadAsset(filepath);
+    if (!asset) {
         XLOGE("Failed to load binary file: {}", filepath);
         return 0;
     }
 
-    size_t fileLength = file.tellg();
+    size_t fileLength = asset->NumBytes();
     if (fileLength == 0) {
         XLOGE("Failed to load binary file, it's empty: {}", filepath);
         return 0;
     }
     auto destination = sizeCallback(fileLength);
-
-    file.seekg(0, std::ios::beg);
-    file.read(reinterpret_cast<char*>(destination.data), destination.NumElements());
-    file.close();
+    std::memcpy(destination.data, asset->Bytes().data, std::min(fileLength, destination.NumBytes()));
 
     XLOG("Loaded binary file: {}", filepath);
     return fileLength;
 }
 
 ENGINE_EXPORT ImageLoader::~ImageLoader() noexcept {
-    for (auto decodedImage : loadedImages_) {
-        stbi_image_free(static_cast<void*>(decodedImage.second.data));
+    std::lock_guard const lock(mutex_);
+    for (auto& [id, image] : images_) {
+        assert(!image.isDecoding && "ImageLoader destroyed while an image is being decoded");
+        if (image.numPins > 0) { XLOGW("ImageLoader destroyed while image is pinned ID={}", id); }
+        stbi_image_free(static_cast<void*>(image.data.data));
     }
-    loadedImages_.clear();
+    images_.clear();
+    keyToImage_.clear();
+    lruImages_.clear();
+}
+
+ENGINE_EXPORT auto ImageLoader::ImageData(ImageLoaderHandle loadedImageId) const -> CpuView<uint8_t const> {
+    std::lock_guard const lock(mutex_);
+    auto find = images_.find(loadedImageId);
+    if (find == images_.cend() || find->second.isDecoding) { return CpuView<uint8_t const>{}; }
+    assert(find->second.numPins > 0 && "ImageLoader::ImageData of unpinned image, the memory may be evicted");
+    return find->second.data;
 }
 
-ENGINE_EXPORT auto ImageLoader::ImageData(int32_t loadedImageId) const -> CpuView<uint8_t const> {
-    auto find = loadedImages_.find(loadedImageId);
-    if (find == loadedImages_.cend()) { return CpuView<uint8_t>{}; }
-    return find->second;
+ENGINE_EXPORT auto ImageLoader::LatestError() const -> std::string_view {
+    std::lock_guard const lock(mutex_);
+    return latestError_;
+}
+
+ENGINE_EXPORT auto ImageLoader::GetStatistics() const -> Statistics {
+    std::lock_guard const lock(mutex_);
+    Statistics statistics      = statistics_;
+    statistics.numImages       = std::size(images_);
+    statistics.numDecodedBytes = numDecodedBytes_;
+    statistics.numPinnedImages = std::count_if(
+        images_.cbegin(), images_.cend(), [](auto const& kv) { return kv.second.numPins > 0; });
+    return statistics;
+}
+
+ENGINE_EXPORT void ImageLoader::SetMaxDecodedBytes(size_t maxDecodedBytes) {
+    std::lock_guard const lock(mutex_);
+    maxDecodedBytes_ = maxDecodedBytes;
+    EvictUnpinnedImages(maxDecodedBytes_);
+}
+
+ENGINE_EXPORT void ImageLoader::Trim() {
+    std::lock_guard const lock(mutex_);
+    EvictUnpinnedImages(0U);
+}
+
+ENGINE_EXPORT auto ImageLoader::Pin(ImageLoaderHandle loadedImageId) -> bool {
+    std::lock_guard const lock(mutex_);
+    auto find = images_.find(loadedImageId);
+    if (find == images_.end() || find->second.isDecoding) { return false; }
+    ++find->second.numPins;
+    TouchImage(find->second);
+    return true;
+}
+
+ENGINE_EXPORT void ImageLoader::Unpin(ImageLoaderHandle loadedImageId) {
+    std::lock_guard const lock(mutex_);
+    auto find = images_.find(loadedImageId);
+    if (find == images_.end()) {
+        XLOGW("ImageLoader::Unpin of unknown image ID={}", loadedImageId);
+        return;
+    }
+    assert(find->second.numPins > 0 && "ImageLoader::Unpin called more times than Pin");
+    --find->second.numPins;
+    // the budget could have been exceeded while the image was pinned
+    if (find->second.numPins == 0) { EvictUnpinnedImages(maxDecodedBytes_); }
 }
 
 ENGINE_EXPORT auto ImageLoader::Load(std::string_view const filepath, int32_t numDesiredChannels)
     -> std::optional<LoadInfo> {
-    auto numBytes = LoadBinaryFile(filepath, [&](size_t filesize) {
-        temporaryBuffer_.resize(filesize);
-        return CpuMemory{temporaryBuffer_.data(), filesize};
-    });
-    return Load(CpuMemory{temporaryBuffer_.data(), numBytes}, numDesiredChannels);
+    auto cacheKey = std::string{filepath} + '#' + std::to_string(numDesiredChannels);
+    ImageLoaderHandle id;
+    {
+        std::unique_lock lock(mutex_);
+        auto findImage = keyToImage_.find(cacheKey);
+        if (findImage != keyToImage_.end() && images_[findImage->second].isDecoding) {
+            // another thread decodes the same image right now, wait for it (it's removed from cache on failure)
+            decodingFinished_.wait(lock, [&] {
+                findImage = keyToImage_.find(cacheKey);
+                return findImage == keyToImage_.end() || !images_[findImage->second].isDecoding;
+            });
+            if (findImage == keyToImage_.end()) { return std::nullopt; }
+        }
+        if (findImage != keyToImage_.end()) {
+            auto& image = images_[findImage->second];
+            ++image.numPins;
+            ++statistics_.numHits;
+            TouchImage(image);
+            return std::optional{image.info};
+        }
+
+        // reserve the entry, so that concurrent loads of the same image wait instead of decoding it again
+        ++statistics_.numMisses;
+        id = nextImageId_++;
+        keyToImage_.emplace(cacheKey, id);
+        images_.emplace(id, CachedImage{.cacheKey = std::move(cacheKey), .numPins = 1, .isDecoding = true});
+    }
+
+    // NOTE: decoded straight from the mapped pack or file, the encoded bytes are never copied
+    LoadInfo info{};
+    std::string_view error    = {};
+    uint8_t* decodedImageData = nullptr;
+    if (auto encodedImage = ReadAsset(filepath); encodedImage && encodedImage->NumBytes() > 0) {
+        decodedImageData = DecodeImage(encodedImage->Bytes(), numDesiredChannels, info, error);
+    } else {
+        error = "Failed to read file";
+    }
+
+    std::lock_guard const lock(mutex_);
+    if (!decodedImageData) {
+        auto findImage = images_.find(id);
+        keyToImage_.erase(findImage->second.cacheKey);
+        images_.erase(findImage);
+        latestError_ = error;
+        decodingFinished_.notify_all();
+        return std::nullopt;
+    }
+    auto result = StoreDecoded(id, decodedImageData, info);
+    decodingFinished_.notify_all();
+    return std::optional{result};
 }
 
 ENGINE_EXPORT auto ImageLoader::Load(CpuMemory<uint8_t> encodedImageData, int32_t numDesiredChannels)
     -> std::optional<LoadInfo> {
-    LoadInfo result{};
-    if (int ok = stbi_info_from_memory(
-            encodedImageData.data, encodedImageData.NumElements(), &result.width, &result.height,
-            &result.numChannelsInFile);
-        ok == 0) {
-        latestError_ = stbi_failure_reason();
-        return std::nullopt;
-    }
+    // NOTE: images from memory have no cache key, they can't be deduplicated, but still count into the budget
+    LoadInfo info{};
+    std::string_view error    = {};
+    uint8_t* decodedImageData = DecodeImage(
+        CpuMemory<uint8_t const>{encodedImageData.data, encodedImageData.NumBytes()}, numDesiredChannels, info, error);
 
-    auto* decodedImageData = stbi_load_from_memory(
-        encodedImageData.data, encodedImageData.NumElements(), &result.width, &result.height, &result.numChannelsInFile,
-        numDesiredChannels);
+    std::lock_guard const lock(mutex_);
+    ++statistics_.numMisses;
     if (!decodedImageData) {
-        latestError_ = stbi_failure_reason();
+        latestError_ = error;
         return std::nullopt;
     }
+    ImageLoaderHandle id = nextImageId_++;
+    images_.emplace(id, CachedImage{.numPins = 1});
+    return std::optional{StoreDecoded(id, decodedImageData, info)};
+}
 
-    // limit number of alive images (free the oldest one)
-    // TODO: that's a very crude system, maybe store IDs in array
-    auto findRemoved = loadedImages_.find(nextImageId_ - MAX_LOADED_IMAGES);
-    if (findRemoved != loadedImages_.cend()) {
-        stbi_image_free(static_cast<void*>(findRemoved->second.data));
-        XLOGW("Unloaded CPU image data ID={}", findRemoved->first);
-        loadedImages_.erase(findRemoved);
-    }
+// NOTE: expects mutex_ to be locked
+ENGINE_EXPORT auto ImageLoader::StoreDecoded(ImageLoaderHandle id, uint8_t* decodedImageData, LoadInfo const& info)
+    -> LoadInfo {
+    auto& image              = images_[id];
+    image.info               = info;
+    image.info.loadedImageId = id;
+    image.data               = CpuView<uint8_t>{decodedImageData, static_cast<size_t>(info.numDecodedBytes)};
+    image.isDecoding         = false;
+    lruImages_.push_front(id);
+    image.lruPosition = lruImages_.begin();
+    numDecodedBytes_ += info.numDecodedBytes;
+    EvictUnpinnedImages(maxDecodedBytes_);
+    return image.info;
+}
 
-    auto numDecodedBytes        = result.width * result.height * result.numChannelsDecoded * sizeof(uint8_t);
-    loadedImages_[nextImageId_] = CpuView{decodedImageData, numDecodedBytes};
-    result.numChannelsDecoded   = numDesiredChannels;
-    result.numDecodedBytes      = numDecodedBytes;
-    result.loadedImageId        = nextImageId_;
-    ++nextImageId_;
-    return std::optional{result};
+// NOTE: expects mutex_ to be locked
+ENGINE_EXPORT void ImageLoader::TouchImage(CachedImage& image) {
+    if (image.isDecoding) { return; }
+    lruImages_.splice(lruImages_.begin(), lruImages_, image.lruPosition);
+}
+
+// NOTE: expects mutex_ to be locked
+ENGINE_EXPORT void ImageLoader::EvictUnpinnedImages(size_t maxDecodedBytes) {
+    auto it = lruImages_.end();
+    while (numDecodedBytes_ > maxDecodedBytes && it != lruImages_.begin()) {
+        --it;
+        auto findImage = images_.find(*it);
+        assert(findImage != images_.end());
+        auto& image = findImage->second;
+        if (image.numPins > 0) { continue; }
+
+        XLOGD("Unloaded CPU image data ID={} bytes={}", findImage->first, image.data.NumBytes());
+        stbi_image_free(static_cast<void*>(image.data.data));
+        numDecodedBytes_ -= image.data.NumBytes();
+        if (!image.cacheKey.empty()) { keyToImage_.erase(image.cacheKey); }
+        ++statistics_.numEvictions;
+        it = lruImages_.erase(it);
+        images_.erase(findImage);
+    }
+    if (numDecodedBytes_ > maxDecodedBytes) {
+        XLOGW(
+            "ImageLoader exceeds its budget, remaining images are pinned (bytes={} budget={})", numDecodedBytes_,
+            maxDecodedBytes);
+    }
 }
 
 } // namespace engine
@@ -107,24 +461,96 @@ namespace engine::gl {
 
 ENGINE_EXPORT auto LoadTexture [[nodiscard]] (GlContext& gl, LoadTextureArgs const& args)
 -> std::optional<Texture> {
+    auto compression = SupportedCompression(gl, args);
+
+    TextureContainerDesc bakedDesc{};
+    std::string bakedFilepath{};
+    if (!args.cacheDirectory.empty()) {
+        if (auto sourceFile = ReadAsset(args.filepath)) {
+            bakedDesc.sourceHash = HashBytes(sourceFile->Bytes().data, sourceFile->NumBytes());
+            bakedDesc.argsHash   = HashTextureArgs(args, compression);
+            bakedFilepath        = BakedTextureFilepath(args.cacheDirectory, bakedDesc.sourceHash, bakedDesc.argsHash);
+        }
+    }
+
+    if (!bakedFilepath.empty()) {
+        if (auto container = TextureContainer::Open(bakedFilepath);
+            container && container->Desc().sourceHash == bakedDesc.sourceHash
+            && container->Desc().argsHash == bakedDesc.argsHash) {
+            return UploadTextureContainer(gl, *container, args.name);
+        }
+    }
+
     auto cpuImageInfo = args.loader.Load(args.filepath, args.numChannels);
     if (!cpuImageInfo) {
         XLOGE("Failed to load texture: {}", args.loader.LatestError());
         return std::nullopt;
     }
     assert(cpuImageInfo);
-    auto texture = gl::Texture::Allocate2D(
-        gl, GL_TEXTURE_2D, glm::ivec3(cpuImageInfo->width, cpuImageInfo->height, 0), args.format, args.name);
-    auto cpuImage     = args.loader.ImageData(cpuImageInfo->loadedImageId);
-    auto textureGuard = gl::TextureCtx{texture}.Fill2D(gl::TextureCtx::FillArgs{
-        .dataFormat = GL_RGB,
-        .dataType   = GL_UNSIGNED_BYTE,
-        .data       = cpuImage.data,
-        .size       = texture.Size(),
-        .mipLevel   = 0,
-    });
+    auto size        = glm::ivec2(cpuImageInfo->width, cpuImageInfo->height);
+    auto numLevels   = args.withMips ? MipChainLength(size) : 1;
+    auto numChannels = cpuImageInfo->numChannelsDecoded;
+    auto dataFormat  = DataFormatFromChannels(numChannels);
+    auto cpuImage    = args.loader.ImageData(cpuImageInfo->loadedImageId);
 
-    if (args.withMips) { std::ignore = textureGuard.GenerateMipmaps(); }
+    // NOTE: mips are generated on a worker (which spreads rows of each level on all cores), while this thread
+    // allocates the texture and uploads level 0. Block compression needs all the levels, so it waits right away
+    TextureLevels mips{};
+    std::thread mipThread{};
+    if (numLevels > 1) {
+        mipThread = std::thread{[&] { mips = GenerateMipLevels(args, cpuImage, size, numLevels, numChannels); }};
+    }
+
+    Texture texture{};
+    TextureLevels bakedLevels{};
+    if (compression == BlockFormat::NONE) {
+        texture           = Texture::Allocate2D(gl, GL_TEXTURE_2D, size, args.format, numLevels, args.name);
+        auto textureGuard = TextureCtx{texture};
+        for (int32_t level = 0; level < numLevels; ++level) {
+            if (level == 1) { mipThread.join(); }
+            textureGuard.Fill2D(TextureCtx::FillArgs{
+                .dataFormat = dataFormat,
+                .dataType   = GL_UNSIGNED_BYTE,
+                .data       = level == 0 ? cpuImage.data : mips[level - 1].data(),
+                .size       = texture.LevelSize(level),
+                .mipLevel   = level,
+            });
+        }
+        if (!bakedFilepath.empty()) {
+            bakedLevels.reserve(numLevels);
+            bakedLevels.emplace_back(cpuImage.data, cpuImage.data + cpuImageInfo->numDecodedBytes);
+            std::move(mips.begin(), mips.end(), std::back_inserter(bakedLevels));
+        }
+        bakedDesc.internalFormat = args.format;
+        bakedDesc.dataFormat     = dataFormat;
+        bakedDesc.dataType       = GL_UNSIGNED_BYTE;
+    } else {
+        if (mipThread.joinable()) { mipThread.join(); }
+        auto levels           = CompressLevels(args, compression, cpuImage, mips, size, numChannels);
+        auto compressedFormat = GlCompressedFormat(compression, IsSrgbFormat(args.format));
+        texture           = Texture::Allocate2D(gl, GL_TEXTURE_2D, size, compressedFormat, numLevels, args.name);
+        auto textureGuard = TextureCtx{texture};
+        for (int32_t level = 0; level < numLevels; ++level) {
+            textureGuard.FillCompressed2D(TextureCtx::FillCompressedArgs{
+                .compressedFormat = compressedFormat,
+                .data             = levels[level].data(),
+                .numBytes         = static_cast<GLsizei>(levels[level].size()),
+                .size             = texture.LevelSize(level),
+                .mipLevel         = level,
+            });
+        }
+        bakedLevels              = std::move(levels);
+        bakedDesc.internalFormat = compressedFormat;
+        bakedDesc.dataFormat     = GL_NONE;
+        bakedDesc.dataType       = GL_NONE;
+    }
+    args.loader.Unpin(cpuImageInfo->loadedImageId);
+
+    if (!bakedFilepath.empty()) {
+        bakedDesc.size      = size;
+        bakedDesc.numLevels = numLevels;
+        WriteBakedTexture(bakedDesc, bakedLevels, bakedFilepath);
+    }
     return texture;
 }
 
@@ -133,23 +559,41 @@ ENGINE_EXPORT auto LoadTexture [[nodiscard]] (GlContext& gl, LoadTextureArgs con
 namespace engine::gl::shader {
 
 ENGINE_EXPORT auto LoadShaderCode(
-    std::string_view const filepath, ShaderType type, CpuView<ShaderDefine const> defines) -> std::string {
-    std::string code          = LoadTextFile(filepath);
-    static bool isInitialized = false;
-    static IncludeRegistry includeCommon{};
-    static IncludeRegistry includeVertex{};
-    static IncludeRegistry includeFragment{};
-    if (!isInitialized) {
-        LoadCommonIncludes(includeCommon);
-        includeVertex.insert(includeCommon.begin(), includeCommon.end());
-        LoadVertexIncludes(includeVertex);
-        includeFragment.insert(includeCommon.begin(), includeCommon.end());
-        LoadFragmentIncludes(includeFragment);
-        isInitialized = true;
-    };
-    auto const& includeRegistry = type == ShaderType::VERTEX ? includeVertex : includeFragment;
-    code                        = GenerateCode(code, includeRegistry, defines);
+    std::string_view const filepath, ShaderType type, CpuView<ShaderDefine const> defines, IncludeGraph* includeGraph)
+    -> std::string {
+    auto const& includes        = LoadedShaderIncludes();
+    auto const& includeRegistry = type == ShaderType::VERTEX ? includes.vertex : includes.fragment;
+
+    // NOTE: original code is read from the mapping without a copy, generated code is the only allocation
+    auto originalCode = ReadAsset(filepath);
+    if (!originalCode) {
+        XLOGE("Failed to load shader code: {}", filepath);
+        return "";
+    }
+    std::string code;
+    GenerateCode(code, originalCode->Text(), includeRegistry, defines, includeGraph);
     return code;
 }
 
+ENGINE_EXPORT auto ReloadShaderInclude(std::string_view filepath) -> bool {
+    std::error_code err;
+    auto absoluteFilepath = platform::AbsolutePath(filepath, err);
+    if (err) { return false; }
+
+    // NOTE: registries of stages have their own copies of common includes
+    auto& includes = LoadedShaderIncludes();
+    std::optional<std::string> text;
+    for (IncludeRegistry* registry : {&includes.common, &includes.vertex, &includes.fragment}) {
+        for (auto& [_, include] : *registry) {
+            if (include.filepath.empty() || platform::AbsolutePath(include.filepath, err) != absoluteFilepath) {
+                continue;
+            }
+            if (!text) { text = LoadTextFile(include.filepath); }
+            include.text = *text;
+        }
+    }
+    if (text) { XLOG("Reloaded shader include: {}", filepath); }
+    return text.has_value();
+}
+
 } // namespace engine::gl::shader
@@ -0,0 +1,706 @@
+#include "engine/BlockCompression.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+using engine::BlockCompressionArgs;
+using engine::BlockCompressionQuality;
+using engine::BlockFormat;
+using engine::private_::F4;
+using engine::private_::M4;
+
+constexpr int32_t BLOCK_DIM       = 4;
+constexpr int32_t BLOCK_PIXELS    = BLOCK_DIM * BLOCK_DIM;
+constexpr int32_t BLOCK_GROUPS    = BLOCK_PIXELS / 4; // of 4 pixels, one F4 each
+constexpr size_t BLOCK_ROWS_CHUNK = 4U;
+
+using BlockPixels = uint8_t[BLOCK_PIXELS][4];
+
+// Pixels of a block split by channel, so the encoding kernels process 4 pixels per F4
+struct BlockChannels {
+    alignas(16) float values[4][BLOCK_PIXELS];
+
+    auto Group [[nodiscard]] (int32_t channel, int32_t group) const -> F4 {
+        return F4::Load(values[channel] + group * 4);
+    }
+};
+
+constexpr int32_t BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+auto NumRefineIterations [[nodiscard]] (BlockCompressionQuality quality) -> int32_t {
+    switch (quality) {
+    case BlockCompressionQuality::FAST:
+        return 0;
+    case BlockCompressionQuality::NORMAL:
+        return 1;
+    default:
+        return 3;
+    }
+}
+
+void LoadBlock(BlockCompressionArgs const& args, int32_t blockX, int32_t blockY, BlockChannels& block) {
+    for (int32_t y = 0; y < BLOCK_DIM; ++y) {
+        int32_t srcY = std::min(blockY * BLOCK_DIM + y, args.size.y - 1);
+        for (int32_t x = 0; x < BLOCK_DIM; ++x) {
+            int32_t srcX       = std::min(blockX * BLOCK_DIM + x, args.size.x - 1);
+            uint8_t const* src = args.pixels + (static_cast<size_t>(srcY) * args.size.x + srcX) * args.numChannels;
+            int32_t i          = y * BLOCK_DIM + x;
+            auto& values       = block.values;
+            switch (args.numChannels) {
+            case 1:
+                values[0][i] = values[1][i] = values[2][i] = float(src[0]);
+                values[3][i]                               = 255.0f;
+                break;
+            case 2:
+                values[0][i] = values[1][i] = values[2][i] = float(src[0]);
+                values[3][i]                               = float(src[1]);
+                break;
+            case 3:
+                values[0][i] = float(src[0]), values[1][i] = float(src[1]), values[2][i] = float(src[2]);
+                values[3][i] = 255.0f;
+                break;
+            default:
+                values[0][i] = float(src[0]), values[1][i] = float(src[1]), values[2][i] = float(src[2]);
+                values[3][i] = float(src[3]);
+                break;
+            }
+        }
+    }
+}
+
+// Finds a line through the block colors (first numChannels channels), which endpoints lo and hi span all the pixels
+void FitEndpoints(
+    BlockChannels const& block, int32_t numChannels, BlockCompressionQuality quality, float (&lo)[4], float (&hi)[4]) {
+    float minimum[4] = {}, maximum[4] = {}, mean[4] = {};
+    for (int32_t c = 0; c < numChannels; ++c) {
+        F4 groupMin = block.Group(c, 0), groupMax = groupMin, groupSum = groupMin;
+        for (int32_t g = 1; g < BLOCK_GROUPS; ++g) {
+            F4 values = block.Group(c, g);
+            groupMin  = Min(groupMin, values);
+            groupMax  = Max(groupMax, values);
+            groupSum  = groupSum + values;
+        }
+        minimum[c] = ReduceMin(groupMin);
+        maximum[c] = ReduceMax(groupMax);
+        mean[c]    = ReduceAdd(groupSum) / float(BLOCK_PIXELS);
+    }
+
+    if (quality == BlockCompressionQuality::FAST) {
+        for (int32_t c = 0; c < numChannels; ++c) {
+            // NOTE: insetting the box reduces the error of the most common colors close to the center
+            float inset = (maximum[c] - minimum[c]) / 16.0f;
+            lo[c]       = minimum[c] + inset;
+            hi[c]       = maximum[c] - inset;
+        }
+        return;
+    }
+
+    F4 centered[4][BLOCK_GROUPS];
+    for (int32_t c = 0; c < numChannels; ++c) {
+        for (int32_t g = 0; g < BLOCK_GROUPS; ++g) { centered[c][g] = block.Group(c, g) - F4::Set(mean[c]); }
+    }
+    float covariance[4][4] = {};
+    for (int32_t r = 0; r < numChannels; ++r) {
+        for (int32_t c = r; c < numChannels; ++c) {
+            F4 sum = F4::Set(0.0f);
+            for (int32_t g = 0; g < BLOCK_GROUPS; ++g) { sum = sum + centered[r][g] * centered[c][g]; }
+            covariance[r][c] = covariance[c][r] = ReduceAdd(sum);
+        }
+    }
+
+    // power iteration, starting from the bounding box diagonal
+    float axis[4] = {};
+    for (int32_t c = 0; c < numChannels; ++c) { axis[c] = maximum[c] - minimum[c]; }
+    for (int32_t iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {};
+        float norm    = 0.0f;
+        for (int32_t r = 0; r < numChannels; ++r) {
+            for (int32_t c = 0; c < numChannels; ++c) { next[r] += covariance[r][c] * axis[c]; }
+            norm = std::max(norm, std::abs(next[r]));
+        }
+        if (norm < 1e-6f) { break; }
+        for (int32_t c = 0; c < numChannels; ++c) { axis[c] = next[c] / norm; }
+    }
+
+    float axisLengthSq = 0.0f;
+    for (int32_t c = 0; c < numChannels; ++c) { axisLengthSq += axis[c] * axis[c]; }
+    if (axisLengthSq < 1e-12f) {
+        // NOTE: solid block
+        for (int32_t c = 0; c < numChannels; ++c) { lo[c] = hi[c] = mean[c]; }
+        return;
+    }
+
+    F4 groupMinT = F4::Set(std::numeric_limits<float>::max());
+    F4 groupMaxT = F4::Set(std::numeric_limits<float>::lowest());
+    for (int32_t g = 0; g < BLOCK_GROUPS; ++g) {
+        F4 t = F4::Set(0.0f);
+        for (int32_t c = 0; c < numChannels; ++c) { t = t + centered[c][g] * F4::Set(axis[c]); }
+        groupMinT = Min(groupMinT, t);
+        groupMaxT = Max(groupMaxT, t);
+    }
+    float minT = ReduceMin(groupMinT) / axisLengthSq;
+    float maxT = ReduceMax(groupMaxT) / axisLengthSq;
+    for (int32_t c = 0; c < numChannels; ++c) {
+        lo[c] = std::clamp(mean[c] + minT * axis[c], 0.0f, 255.0f);
+        hi[c] = std::clamp(mean[c] + maxT * axis[c], 0.0f, 255.0f);
+    }
+}
+
+// Least squares fit of endpoints (numChannels channels from firstChannel), given interpolation weight of hi endpoint
+// for each pixel. Returns false if the system is degenerate (e.g. all pixels use the same weight)
+auto RefineEndpoints [[nodiscard]] (
+    BlockChannels const& block, int32_t firstChannel, int32_t numChannels, float const (&weights)[BLOCK_PIXELS],
+    float (&lo)[4], float (&hi)[4]) -> bool {
+    F4 const one = F4::Set(1.0f);
+    F4 loLo      = F4::Set(0.0f), loHi = loLo, hiHi = loLo;
+    F4 loX[4]    = {loLo, loLo, loLo, loLo}, hiX[4] = {loLo, loLo, loLo, loLo};
+    for (int32_t g = 0; g < BLOCK_GROUPS; ++g) {
+        F4 w   = F4::Load(weights + g * 4);
+        F4 loW = one - w;
+        loLo   = loLo + loW * loW;
+        loHi   = loHi + loW * w;
+        hiHi   = hiHi + w * w;
+        for (int32_t c = firstChannel; c < firstChannel + numChannels; ++c) {
+            F4 values = block.Group(c, g);
+            loX[c]    = loX[c] + loW * values;
+            hiX[c]    = hiX[c] + w * values;
+        }
+    }
+    float sumLoLo = ReduceAdd(loLo), sumLoHi = ReduceAdd(loHi), sumHiHi = ReduceAdd(hiHi);
+    float det     = sumLoLo * sumHiHi - sumLoHi * sumLoHi;
+    if (std::abs(det) < 1e-6f) { return false; }
+    for (int32_t c = firstChannel; c < firstChannel + numChannels; ++c) {
+        float sumLoX = ReduceAdd(loX[c]), sumHiX = ReduceAdd(hiX[c]);
+        lo[c]        = std::clamp((sumHiHi * sumLoX - sumLoHi * sumHiX) / det, 0.0f, 255.0f);
+        hi[c]        = std::clamp((sumLoLo * sumHiX - sumLoHi * sumLoX) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+// Picks the closest palette entry for each pixel, returns the total squared error
+// NOTE: errors are sums of squared byte differences, exact in float for a whole block
+template <int32_t NumEntries>
+auto SelectIndices(
+    BlockChannels const& block, int32_t firstChannel, int32_t numChannels, int32_t const (&palette)[NumEntries][4],
+    uint8_t (&indices)[BLOCK_PIXELS]) -> int32_t {
+    int32_t lastChannel = firstChannel + numChannels;
+    F4 entries[NumEntries][4];
+    for (int32_t e = 0; e < NumEntries; ++e) {
+        for (int32_t c = firstChannel; c < lastChannel; ++c) { entries[e][c] = F4::Set(float(palette[e][c])); }
+    }
+
+    F4 totalError = F4::Set(0.0f);
+    for (int32_t g = 0; g < BLOCK_GROUPS; ++g) {
+        F4 values[4];
+        for (int32_t c = firstChannel; c < lastChannel; ++c) { values[c] = block.Group(c, g); }
+        F4 bestError = F4::Set(std::numeric_limits<float>::max());
+        F4 bestIndex = F4::Set(0.0f);
+        for (int32_t e = 0; e < NumEntries; ++e) {
+            F4 error = F4::Set(0.0f);
+            for (int32_t c = firstChannel; c < lastChannel; ++c) {
+                F4 d  = values[c] - entries[e][c];
+                error = error + d * d;
+            }
+            // NOTE: strictly smaller, so ties keep the first entry
+            M4 isBetter = error < bestError;
+            bestError   = Select(isBetter, error, bestError);
+            bestIndex   = Select(isBetter, F4::Set(float(e)), bestIndex);
+        }
+        totalError = totalError + bestError;
+        float groupIndices[4];
+        bestIndex.Store(groupIndices);
+        for (int32_t lane = 0; lane < 4; ++lane) { indices[g * 4 + lane] = static_cast<uint8_t>(groupIndices[lane]); }
+    }
+    return static_cast<int32_t>(ReduceAdd(totalError));
+}
+
+// ---- BC1 color block ----
+
+auto PackRgb565 [[nodiscard]] (float const (&color)[4]) -> uint16_t {
+    auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+    auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+    auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void UnpackRgb565(uint16_t packed, int32_t (&color)[4]) {
+    int32_t r = (packed >> 11) & 0x1F, g = (packed >> 5) & 0x3F, b = packed & 0x1F;
+    color[0]  = (r << 3) | (r >> 2);
+    color[1]  = (g << 2) | (g >> 4);
+    color[2]  = (b << 3) | (b >> 2);
+    color[3]  = 255;
+}
+
+void Bc1Palette(uint16_t color0, uint16_t color1, bool alwaysFourColors, int32_t (&palette)[4][4]) {
+    UnpackRgb565(color0, palette[0]);
+    UnpackRgb565(color1, palette[1]);
+    if (color0 > color1 || alwaysFourColors) {
+        for (int32_t c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        palette[2][3] = palette[3][3] = 255;
+    } else {
+        for (int32_t c = 0; c < 3; ++c) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+}
+
+struct Bc1Candidate {
+    uint16_t color0               = 0U;
+    uint16_t color1               = 0U;
+    uint8_t indices[BLOCK_PIXELS] = {};
+    int32_t error                 = std::numeric_limits<int32_t>::max();
+};
+
+auto EvaluateBc1 [[nodiscard]] (BlockChannels const& block, float const (&lo)[4], float const (&hi)[4])
+    -> Bc1Candidate {
+    Bc1Candidate candidate{};
+    candidate.color0 = PackRgb565(hi);
+    candidate.color1 = PackRgb565(lo);
+    // NOTE: color0 > color1 selects 4 color mode, which BC3 decoders assume regardless of order
+    if (candidate.color0 < candidate.color1) { std::swap(candidate.color0, candidate.color1); }
+    int32_t palette[4][4];
+    Bc1Palette(candidate.color0, candidate.color1, false, palette);
+    if (candidate.color0 == candidate.color1) {
+        // solid color, index 0 is the same in both modes
+        int32_t const solid[1][4] = {{palette[0][0], palette[0][1], palette[0][2], palette[0][3]}};
+        candidate.error           = SelectIndices<1>(block, 0, 3, solid, candidate.indices);
+        return candidate;
+    }
+    candidate.error = SelectIndices<4>(block, 0, 3, palette, candidate.indices);
+    return candidate;
+}
+
+void EncodeBc1(BlockChannels const& block, BlockCompressionQuality quality, uint8_t* destination) {
+    float lo[4], hi[4];
+    FitEndpoints(block, 3, quality, lo, hi);
+    auto best = EvaluateBc1(block, lo, hi);
+
+    // interpolation weight of color0 for each index, color0 is made from hi
+    constexpr float WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    for (int32_t iteration = 0; iteration < NumRefineIterations(quality) && best.error > 0; ++iteration) {
+        float weights[BLOCK_PIXELS];
+        bool isSwapped = PackRgb565(hi) < PackRgb565(lo);
+        for (int32_t i = 0; i < BLOCK_PIXELS; ++i) {
+            weights[i] = isSwapped ? 1.0f - WEIGHTS[best.indices[i]] : WEIGHTS[best.indices[i]];
+        }
+        if (!RefineEndpoints(block, 0, 3, weights, lo, hi)) { break; }
+        auto candidate = EvaluateBc1(block, lo, hi);
+        if (candidate.error >= best.error) { break; }
+        best = candidate;
+    }
+
+    uint32_t indexBits = 0U;
+    for (int32_t i = 0; i < BLOCK_PIXELS; ++i) { indexBits |= uint32_t(best.indices[i]) << (2 * i); }
+    std::memcpy(destination, &best.color0, sizeof(uint16_t));
+    std::memcpy(destination + 2, &best.color1, sizeof(uint16_t));
+    std::memcpy(destination + 4, &indexBits, sizeof(uint32_t));
+}
+
+// ---- BC4 alpha block (as in BC3) ----
+
+void Bc4Palette(int32_t alpha0, int32_t alpha1, int32_t (&palette)[8][4]) {
+    palette[0][3] = alpha0;
+    palette[1][3] = alpha1;
+    if (alpha0 > alpha1) {
+        for (int32_t i = 1; i < 7; ++i) { palette[i + 1][3] = ((7 - i) * alpha0 + i * alpha1) / 7; }
+    } else {
+        for (int32_t i = 1; i < 5; ++i) { palette[i + 1][3] = ((5 - i) * alpha0 + i * alpha1) / 5; }
+        palette[6][3] = 0;
+        palette[7][3] = 255;
+    }
+}
+
+void EncodeBc4Alpha(BlockChannels const& block, BlockCompressionQuality quality, uint8_t* destination) {
+    F4 groupMin = block.Group(3, 0), groupMax = groupMin;
+    for (int32_t g = 1; g < BLOCK_GROUPS; ++g) {
+        groupMin = Min(groupMin, block.Group(3, g));
+        groupMax = Max(groupMax, block.Group(3, g));
+    }
+    auto minimum = static_cast<int32_t>(ReduceMin(groupMin));
+    auto maximum = static_cast<int32_t>(ReduceMax(groupMax));
+
+    auto evaluate = [&](int32_t alpha0, int32_t alpha1, uint8_t(&indices)[BLOCK_PIXELS]) {
+        int32_t palette[8][4];
+        Bc4Palette(alpha0, alpha1, palette);
+        return SelectIndices<8>(block, 3, 1, palette, indices);
+    };
+
+    int32_t alpha0 = maximum, alpha1 = minimum;
+    uint8_t indices[BLOCK_PIXELS];
+    int32_t error = evaluate(alpha0, alpha1, indices);
+
+    // interpolation weight of alpha0 for each index
+    constexpr float WEIGHTS[8] = {1.0f, 0.0f, 6.0f / 7, 5.0f / 7, 4.0f / 7, 3.0f / 7, 2.0f / 7, 1.0f / 7};
+    int32_t numIterations      = NumRefineIterations(quality);
+    for (int32_t iteration = 0; iteration < numIterations && error > 0 && alpha0 > alpha1; ++iteration) {
+        float weights[BLOCK_PIXELS];
+        for (int32_t i = 0; i < BLOCK_PIXELS; ++i) { weights[i] = WEIGHTS[indices[i]]; }
+        float refinedLo[4] = {}, refinedHi[4] = {};
+        if (!RefineEndpoints(block, 3, 1, weights, refinedLo, refinedHi)) { break; }
+        int32_t refined0 = static_cast<int32_t>(std::lround(refinedHi[3]));
+        int32_t refined1 = static_cast<int32_t>(std::lround(refinedLo[3]));
+        if (refined0 <= refined1) { break; }
+        uint8_t refinedIndices[BLOCK_PIXELS];
+        int32_t refinedError = evaluate(refined0, refined1, refinedIndices);
+        if (refinedError >= error) { break; }
+        alpha0 = refined0, alpha1 = refined1, error = refinedError;
+        std::memcpy(indices, refinedIndices, sizeof(indices));
+    }
+
+    uint64_t indexBits = 0U;
+    for (int32_t i = 0; i < BLOCK_PIXELS; ++i) { indexBits |= uint64_t(indices[i]) << (3 * i); }
+    destination[0] = static_cast<uint8_t>(alpha0);
+    destination[1] = static_cast<uint8_t>(alpha1);
+    for (int32_t i = 0; i < 6; ++i) { destination[2 + i] = static_cast<uint8_t>(indexBits >> (8 * i)); }
+}
+
+void EncodeBc3(BlockChannels const& block, BlockCompressionQuality quality, uint8_t* destination) {
+    EncodeBc4Alpha(block, quality, destination);
+    EncodeBc1(block, quality, destination + 8);
+}
+
+// ---- BC7 mode 6 ----
+
+struct Bc7BitWriter {
+    uint8_t* destination;
+    int32_t bitOffset = 0;
+
+    void Write(uint32_t value, int32_t numBits) {
+        for (int32_t i = 0; i < numBits; ++i, ++bitOffset) {
+            if ((value >> i) & 1U) { destination[bitOffset >> 3] |= static_cast<uint8_t>(1U << (bitOffset & 7)); }
+        }
+    }
+};
+
+struct Bc7BitReader {
+    uint8_t const* source;
+    int32_t bitOffset = 0;
+
+    auto Read [[nodiscard]] (int32_t numBits) -> uint32_t {
+        uint32_t value = 0U;
+        for (int32_t i = 0; i < numBits; ++i, ++bitOffset) {
+            value |= uint32_t((source[bitOffset >> 3] >> (bitOffset & 7)) & 1U) << i;
+        }
+        return value;
+    }
+};
+
+struct Bc7Candidate {
+    uint8_t endpoints[2][4]       = {}; // 7 bit per channel
+    uint8_t pbits[2]              = {};
+    uint8_t indices[BLOCK_PIXELS] = {};
+    int32_t error                 = std::numeric_limits<int32_t>::max();
+};
+
+void Bc7Palette(uint8_t const (&endpoints)[2][4], uint8_t const (&pbits)[2], int32_t (&palette)[16][4]) {
+    int32_t color0[4], color1[4];
+    for (int32_t c = 0; c < 4; ++c) {
+        color0[c] = (endpoints[0][c] << 1) | pbits[0];
+        color1[c] = (endpoints[1][c] << 1) | pbits[1];
+    }
+    for (int32_t i = 0; i < 16; ++i) {
+        for (int32_t c = 0; c < 4; ++c) {
+            palette[i][c] = ((64 - BC7_WEIGHTS4[i]) * color0[c] + BC7_WEIGHTS4[i] * color1[c] + 32) >> 6;
+        }
+    }
+}
+
+void QuantizeBc7Endpoint(float const (&color)[4], uint8_t pbit, uint8_t (&endpoint)[4]) {
+    for (int32_t c = 0; c < 4; ++c) {
+        endpoint[c] = static_cast<uint8_t>(std::clamp<long>(std::lround((color[c] - float(pbit)) * 0.5f), 0, 127));
+    }
+}
+
+auto QuantizationError [[nodiscard]] (float const (&color)[4], uint8_t const (&endpoint)[4], uint8_t pbit) -> float {
+    float error = 0.0f;
+    for (int32_t c = 0; c < 4; ++c) {
+        float d = float((endpoint[c] << 1) | pbit) - color[c];
+        error += d * d;
+    }
+    return error;
+}
+
+auto EvaluateBc7 [[nodiscard]] (
+    BlockChannels const& block, float const (&lo)[4], float const (&hi)[4], BlockCompressionQuality quality)
+    -> Bc7Candidate {
+    Bc7Candidate best{};
+    auto tryPbits = [&](uint8_t pbit0, uint8_t pbit1) {
+        Bc7Candidate candidate{};
+        candidate.pbits[0] = pbit0;
+        candidate.pbits[1] = pbit1;
+        QuantizeBc7Endpoint(lo, pbit0, candidate.endpoints[0]);
+        QuantizeBc7Endpoint(hi, pbit1, candidate.endpoints[1]);
+        int32_t palette[16][4];
+        Bc7Palette(candidate.endpoints, candidate.pbits, palette);
+        candidate.error = SelectIndices<16>(block, 0, 4, palette, candidate.indices);
+        if (candidate.error < best.error) { best = candidate; }
+    };
+
+    if (quality == BlockCompressionQuality::SLOW) {
+        for (uint8_t pbit0 = 0U; pbit0 < 2U; ++pbit0) {
+            for (uint8_t pbit1 = 0U; pbit1 < 2U; ++pbit1) { tryPbits(pbit0, pbit1); }
+        }
+        return best;
+    }
+    // NOTE: choose p-bits independently, by the smallest endpoint quantization error
+    auto choosePbit = [](float const(&color)[4]) -> uint8_t {
+        uint8_t endpoint0[4], endpoint1[4];
+        QuantizeBc7Endpoint(color, 0U, endpoint0);
+        QuantizeBc7Endpoint(color, 1U, endpoint1);
+        return QuantizationError(color, endpoint1, 1U) < QuantizationError(color, endpoint0, 0U) ? 1U : 0U;
+    };
+    tryPbits(choosePbit(lo), choosePbit(hi));
+    return best;
+}
+
+void EncodeBc7(BlockChannels const& block, BlockCompressionQuality quality, uint8_t* destination) {
+    float lo[4], hi[4];
+    FitEndpoints(block, 4, quality, lo, hi);
+    auto best = EvaluateBc7(block, lo, hi, quality);
+
+    for (int32_t iteration = 0; iteration < NumRefineIterations(quality) && best.error > 0; ++iteration) {
+        float weights[BLOCK_PIXELS];
+        for (int32_t i = 0; i < BLOCK_PIXELS; ++i) { weights[i] = float(BC7_WEIGHTS4[best.indices[i]]) / 64.0f; }
+        if (!RefineEndpoints(block, 0, 4, weights, lo, hi)) { break; }
+        auto candidate = EvaluateBc7(block, lo, hi, quality);
+        if (candidate.error >= best.error) { break; }
+        best = candidate;
+    }
+
+    // NOTE: the most significant index bit of pixel 0 is implicitly 0, swap endpoints to guarantee it
+    if (best.indices[0] >= 8U) {
+        std::swap(best.endpoints[0], best.endpoints[1]);
+        std::swap(best.pbits[0], best.pbits[1]);
+        for (auto& index : best.indices) { index = static_cast<uint8_t>(15U - index); }
+    }
+
+    std::memset(destination, 0, 16U);
+    Bc7BitWriter writer{destination};
+    writer.Write(1U << 6, 7); // mode 6
+    for (int32_t c = 0; c < 4; ++c) {
+        writer.Write(best.endpoints[0][c], 7);
+        writer.Write(best.endpoints[1][c], 7);
+    }
+    writer.Write(best.pbits[0], 1);
+    writer.Write(best.pbits[1], 1);
+    writer.Write(best.indices[0], 3);
+    for (int32_t i = 1; i < BLOCK_PIXELS; ++i) { writer.Write(best.indices[i], 4); }
+    assert(writer.bitOffset == 128);
+}
+
+// ---- decoding ----
+
+void DecodeBc1(uint8_t const* source, bool alwaysFourColors, BlockPixels& block) {
+    uint16_t color0, color1;
+    uint32_t indexBits;
+    std::memcpy(&color0, source, sizeof(uint16_t));
+    std::memcpy(&color1, source + 2, sizeof(uint16_t));
+    std::memcpy(&indexBits, source + 4, sizeof(uint32_t));
+    int32_t palette[4][4];
+    Bc1Palette(color0, color1, alwaysFourColors, palette);
+    for (int32_t i = 0; i < BLOCK_PIXELS; ++i) {
+        auto const& entry = palette[(indexBits >> (2 * i)) & 3U];
+        for (int32_t c = 0; c < 4; ++c) { block[i][c] = static_cast<uint8_t>(entry[c]); }
+    }
+}
+
+void DecodeBc4Alpha(uint8_t const* source, BlockPixels& block) {
+    int32_t palette[8][4];
+    Bc4Palette(source[0], source[1], palette);
+    uint64_t indexBits = 0U;
+    for (int32_t i = 0; i < 6; ++i) { indexBits |= uint64_t(source[2 + i]) << (8 * i); }
+    for (int32_t i = 0; i < BLOCK_PIXELS; ++i) {
+        block[i][3] = static_cast<uint8_t>(palette[(indexBits >> (3 * i)) & 7U][3]);
+    }
+}
+
+void DecodeBc7(uint8_t const* source, BlockPixels& block) {
+    Bc7BitReader reader{source};
+    if (reader.Read(7) != (1U << 6)) {
+        for (auto& pixel : block) { pixel[0] = 255U, pixel[1] = 0U, pixel[2] = 255U, pixel[3] = 255U; }
+        return;
+    }
+    uint8_t endpoints[2][4], pbits[2];
+    for (int32_t c = 0; c < 4; ++c) {
+        endpoints[0][c] = static_cast<uint8_t>(reader.Read(7));
+        endpoints[1][c] = static_cast<uint8_t>(reader.Read(7));
+    }
+    pbits[0] = static_cast<uint8_t>(reader.Read(1));
+    pbits[1] = static_cast<uint8_t>(reader.Read(1));
+    int32_t palette[16][4];
+    Bc7Palette(endpoints, pbits, palette);
+    for (int32_t i = 0; i < BLOCK_PIXELS; ++i) {
+        auto const& entry = palette[reader.Read(i == 0 ? 3 : 4)];
+        for (int32_t c = 0; c < 4; ++c) { block[i][c] = static_cast<uint8_t>(entry[c]); }
+    }
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto BlockFormatBytes(BlockFormat format) -> size_t {
+    switch (format) {
+    case BlockFormat::BC1:
+        return 8U;
+    case BlockFormat::BC3:
+    case BlockFormat::BC7:
+        return 16U;
+    default:
+        return 0U;
+    }
+}
+
+ENGINE_EXPORT auto BlockCompressedSize(BlockFormat format, glm::ivec2 size) -> size_t {
+    size_t numBlocksX = (size.x + BLOCK_DIM - 1) / BLOCK_DIM;
+    size_t numBlocksY = (size.y + BLOCK_DIM - 1) / BLOCK_DIM;
+    return numBlocksX * numBlocksY * BlockFormatBytes(format);
+}
+
+ENGINE_EXPORT auto GlCompressedFormat(BlockFormat format, bool isSrgb) -> GLenum {
+    switch (format) {
+    case BlockFormat::BC1:
+        return isSrgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+        return isSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC7:
+        return isSrgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    default:
+        return GL_NONE;
+    }
+}
+
+ENGINE_EXPORT void CompressBlocks(BlockCompressionArgs const& args, CpuMemory<uint8_t> destination) {
+    assert(args.pixels != nullptr);
+    assert(args.numChannels >= 1 && args.numChannels <= 4);
+    assert(destination.NumBytes() >= BlockCompressedSize(args.format, args.size));
+
+    int32_t numBlocksX = (args.size.x + BLOCK_DIM - 1) / BLOCK_DIM;
+    int32_t numBlocksY = (args.size.y + BLOCK_DIM - 1) / BLOCK_DIM;
+    size_t blockBytes  = BlockFormatBytes(args.format);
+    ParallelFor(numBlocksY, BLOCK_ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        BlockChannels block;
+        for (size_t blockY = rowsBegin; blockY < rowsEnd; ++blockY) {
+            uint8_t* rowDestination = destination.data + blockY * numBlocksX * blockBytes;
+            for (int32_t blockX = 0; blockX < numBlocksX; ++blockX) {
+                LoadBlock(args, blockX, static_cast<int32_t>(blockY), block);
+                uint8_t* blockDestination = rowDestination + blockX * blockBytes;
+                switch (args.format) {
+                case BlockFormat::BC1:
+                    EncodeBc1(block, args.quality, blockDestination);
+                    break;
+                case BlockFormat::BC3:
+                    EncodeBc3(block, args.quality, blockDestination);
+                    break;
+                case BlockFormat::BC7:
+                    EncodeBc7(block, args.quality, blockDestination);
+                    break;
+                default:
+                    assert(false && "Unsupported block format");
+                }
+            }
+        }
+    });
+}
+
+ENGINE_EXPORT auto CompressBlocks(BlockCompressionArgs const& args) -> std::vector<uint8_t> {
+    std::vector<uint8_t> blocks(BlockCompressedSize(args.format, args.size));
+    CompressBlocks(args, CpuMemory<uint8_t>{blocks.data(), blocks.size()});
+    return blocks;
+}
+
+ENGINE_EXPORT void DecompressBlocks(
+    BlockFormat format, CpuMemory<uint8_t const> blocks, glm::ivec2 size, CpuMemory<uint8_t> destination) {
+    assert(blocks.NumBytes() >= BlockCompressedSize(format, size));
+    assert(destination.NumBytes() >= static_cast<size_t>(size.x) * size.y * 4U);
+
+    int32_t numBlocksX = (size.x + BLOCK_DIM - 1) / BLOCK_DIM;
+    int32_t numBlocksY = (size.y + BLOCK_DIM - 1) / BLOCK_DIM;
+    size_t blockBytes  = BlockFormatBytes(format);
+    ParallelFor(numBlocksY, BLOCK_ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        BlockPixels block;
+        for (size_t blockY = rowsBegin; blockY < rowsEnd; ++blockY) {
+            for (int32_t blockX = 0; blockX < numBlocksX; ++blockX) {
+                uint8_t const* source = blocks.data + (blockY * numBlocksX + blockX) * blockBytes;
+                switch (format) {
+                case BlockFormat::BC1:
+                    DecodeBc1(source, false, block);
+                    break;
+                case BlockFormat::BC3:
+                    DecodeBc1(source + 8, true, block);
+                    DecodeBc4Alpha(source, block);
+                    break;
+                case BlockFormat::BC7:
+                    DecodeBc7(source, block);
+                    break;
+                default:
+                    assert(false && "Unsupported block format");
+                }
+                for (int32_t y = 0; y < BLOCK_DIM; ++y) {
+                    int32_t dstY = static_cast<int32_t>(blockY) * BLOCK_DIM + y;
+                    for (int32_t x = 0; x < BLOCK_DIM; ++x) {
+                        int32_t dstX = blockX * BLOCK_DIM + x;
+                        if (dstX >= size.x || dstY >= size.y) { continue; }
+                        std::memcpy(
+                            destination.data + (static_cast<size_t>(dstY) * size.x + dstX) * 4U,
+                            block[y * BLOCK_DIM + x], 4U);
+                    }
+                }
+            }
+        }
+    });
+}
+
+ENGINE_EXPORT auto ComputeBlockCompressionPsnr(BlockCompressionArgs const& args, CpuMemory<uint8_t const> blocks)
+    -> double {
+    size_t numPixels = static_cast<size_t>(args.size.x) * args.size.y;
+    std::vector<uint8_t> decoded(numPixels * 4U);
+    DecompressBlocks(args.format, blocks, args.size, CpuMemory<uint8_t>{decoded.data(), decoded.size()});
+
+    bool hasAlpha            = args.numChannels == 2 || args.numChannels == 4;
+    bool compareAlpha        = hasAlpha && args.format != BlockFormat::BC1;
+    int32_t numColorChannels = args.numChannels >= 3 ? 3 : 1;
+    int32_t numCompared      = numColorChannels + (compareAlpha ? 1 : 0);
+    double squaredError      = 0.0;
+    for (size_t i = 0; i < numPixels; ++i) {
+        uint8_t const* source = args.pixels + i * args.numChannels;
+        uint8_t const* result = decoded.data() + i * 4U;
+        for (int32_t c = 0; c < numColorChannels; ++c) {
+            double d = double(source[c]) - double(result[c]);
+            squaredError += d * d;
+        }
+        if (compareAlpha) {
+            double d = double(source[args.numChannels - 1]) - double(result[3]);
+            squaredError += d * d;
+        }
+    }
+    if (squaredError == 0.0) { return std::numeric_limits<double>::infinity(); }
+    double meanSquaredError = squaredError / (double(numPixels) * numCompared);
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+ENGINE_EXPORT auto MeasureBlockCompression(BlockCompressionArgs const& args) -> BlockCompressionStats {
+    auto compressStart = std::chrono::steady_clock::now();
+    auto blocks        = CompressBlocks(args);
+    double seconds     = std::chrono::duration<double>(std::chrono::steady_clock::now() - compressStart).count();
+    return BlockCompressionStats{
+        .psnr = ComputeBlockCompressionPsnr(args, CpuMemory<uint8_t const>{blocks.data(), blocks.size()}),
+        .megapixelsPerSecond = double(args.size.x) * args.size.y / std::max(seconds, 1e-9) * 1e-6,
+    };
+}
+
+} // namespace engine
@@ -0,0 +1,484 @@
+#include "engine/Bvh.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace {
+
+using Node = engine::Bvh::Node;
+using Aabb = engine::Aabb;
+using engine::private_::F4;
+using engine::private_::M4;
+
+constexpr uint32_t WIDTH                = engine::Bvh::WIDTH;
+constexpr uint32_t NO_SLOT              = ~0U;
+constexpr uint32_t MAX_LEAF_OBJECTS     = 4U;
+constexpr uint32_t NUM_BINS             = 16U;
+constexpr uint32_t MIN_OBJECTS_PARALLEL = 16U * 1024U; // smaller subtrees are built by one thread
+constexpr float REBUILD_COST_RATIO      = 1.5f;
+constexpr uint32_t INSIDE_BIT           = 1U << 31U; // a node on stack is fully inside, its objects aren't tested
+constexpr size_t STACK_CAPACITY         = 128U;
+
+struct RayEntry final {
+    uint32_t nodeIdx;
+    float distance;
+};
+
+// NOTE: a binned split may move a single object off a node, so the depth isn't bounded by log of objects
+// Stacks of traversal grow as needed, and are reused by the following queries of the thread
+thread_local std::vector<uint32_t> nodeStack{};
+thread_local std::vector<RayEntry> rayStack{};
+
+template <typename T> auto ResetStack [[nodiscard]] (std::vector<T>& stack) -> std::vector<T>& {
+    stack.clear();
+    stack.reserve(STACK_CAPACITY);
+    return stack;
+}
+
+auto Grow [[nodiscard]] (Aabb const& box, Aabb const& other) -> Aabb {
+    return Aabb{glm::min(box.min, other.min), glm::max(box.max, other.max)};
+}
+
+auto HalfArea [[nodiscard]] (Aabb const& box) -> float {
+    glm::vec3 size = glm::max(box.max - box.min, glm::vec3{0.0f});
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+auto Centroid [[nodiscard]] (Aabb const& box) -> glm::vec3 { return 0.5f * (box.min + box.max); }
+
+void SetLaneBox(Node& node, uint32_t lane, Aabb const& box) {
+    node.minX[lane] = box.min.x;
+    node.minY[lane] = box.min.y;
+    node.minZ[lane] = box.min.z;
+    node.maxX[lane] = box.max.x;
+    node.maxY[lane] = box.max.y;
+    node.maxZ[lane] = box.max.z;
+}
+
+auto LaneBox [[nodiscard]] (Node const& node, uint32_t lane) -> Aabb {
+    return Aabb{
+        glm::vec3{node.minX[lane], node.minY[lane], node.minZ[lane]},
+        glm::vec3{node.maxX[lane], node.maxY[lane], node.maxZ[lane]},
+    };
+}
+
+auto NodeBox [[nodiscard]] (Node const& node) -> Aabb {
+    Aabb box{};
+    for (uint32_t lane = 0; lane < WIDTH; ++lane) { box = Grow(box, LaneBox(node, lane)); }
+    return box;
+}
+
+// empty lanes have an inverted box, so every test rejects them
+void ClearNode(Node& node) {
+    for (uint32_t lane = 0; lane < WIDTH; ++lane) {
+        SetLaneBox(node, lane, Aabb{});
+        node.child[lane]      = NO_SLOT;
+        node.numObjects[lane] = 0U;
+    }
+}
+
+auto IsLaneUsed [[nodiscard]] (Node const& node, uint32_t lane) -> bool { return node.child[lane] != NO_SLOT; }
+
+// NOTE: zero components are replaced by tiny ones, so slabs never compute 0 * inf
+auto InverseDirection [[nodiscard]] (glm::vec3 direction) -> glm::vec3 {
+    constexpr float MIN_COMPONENT = 1e-20f;
+    glm::vec3 safe{};
+    for (int32_t axis = 0; axis < 3; ++axis) {
+        float d    = direction[axis];
+        safe[axis] = std::abs(d) < MIN_COMPONENT ? (d < 0.0f ? -MIN_COMPONENT : MIN_COMPONENT) : d;
+    }
+    return 1.0f / safe;
+}
+
+// NOTE: slabs are picked by the sign of the direction, so an inverted (empty) box is never hit
+auto RayBox [[nodiscard]] (Aabb const& box, glm::vec3 origin, glm::vec3 invDirection, float maxT, float& tNear)
+    -> bool {
+    auto isPositive = glm::greaterThanEqual(invDirection, glm::vec3{0.0f});
+    glm::vec3 tn    = (glm::mix(box.max, box.min, isPositive) - origin) * invDirection;
+    glm::vec3 tf    = (glm::mix(box.min, box.max, isPositive) - origin) * invDirection;
+    tNear           = std::max(std::max(tn.x, tn.y), std::max(tn.z, 0.0f));
+    float tFar      = std::min(std::min(tf.x, tf.y), std::min(tf.z, maxT));
+    return tNear <= tFar;
+}
+
+auto IsBoxOutside [[nodiscard]] (Aabb const& box, glm::vec4 const* planes) -> bool {
+    for (size_t p = 0; p < 6U; ++p) {
+        auto normal        = glm::vec3{planes[p]};
+        glm::vec3 farthest = glm::mix(box.min, box.max, glm::greaterThanEqual(normal, glm::vec3{0.0f}));
+        if (glm::dot(normal, farthest) + planes[p].w < 0.0f) { return true; }
+    }
+    return false;
+}
+
+auto Overlaps [[nodiscard]] (Aabb const& a, Aabb const& b) -> bool {
+    return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+// Returns mask of lanes hit by the ray, and distances to them
+auto RayLanes [[nodiscard]] (Node const& node, glm::vec3 origin, glm::vec3 invDirection, float maxT, float* tNear)
+    -> uint32_t {
+    F4 const minX = F4::Load(node.minX), maxX = F4::Load(node.maxX);
+    F4 const minY = F4::Load(node.minY), maxY = F4::Load(node.maxY);
+    F4 const minZ = F4::Load(node.minZ), maxZ = F4::Load(node.maxZ);
+    // NOTE: the near and far slabs are picked by the sign of the direction, same for all lanes
+    bool const px = invDirection.x >= 0.0f, py = invDirection.y >= 0.0f, pz = invDirection.z >= 0.0f;
+    auto slab     = [](F4 bound, float o, float i) { return (bound - F4::Set(o)) * F4::Set(i); };
+    F4 tn         = Max(
+        Max(slab(px ? minX : maxX, origin.x, invDirection.x), slab(py ? minY : maxY, origin.y, invDirection.y)),
+        Max(slab(pz ? minZ : maxZ, origin.z, invDirection.z), F4::Set(0.0f)));
+    F4 tf = Min(
+        Min(slab(px ? maxX : minX, origin.x, invDirection.x), slab(py ? maxY : minY, origin.y, invDirection.y)),
+        Min(slab(pz ? maxZ : minZ, origin.z, invDirection.z), F4::Set(maxT)));
+    tn.Store(tNear);
+    return BitMask(tn <= tf);
+}
+
+// Returns mask of lanes not outside of any plane, and mask of lanes inside all of them
+void FrustumLanes(Node const& node, glm::vec4 const* planes, uint32_t& visibleMask, uint32_t& insideMask) {
+    F4 const minX = F4::Load(node.minX), maxX = F4::Load(node.maxX);
+    F4 const minY = F4::Load(node.minY), maxY = F4::Load(node.maxY);
+    F4 const minZ = F4::Load(node.minZ), maxZ = F4::Load(node.maxZ);
+    M4 outside    = M4::None();
+    M4 crossing   = M4::None();
+    for (size_t p = 0; p < 6U; ++p) {
+        F4 const nx = F4::Set(planes[p].x), ny = F4::Set(planes[p].y), nz = F4::Set(planes[p].z);
+        F4 const d  = F4::Set(planes[p].w);
+        // NOTE: the farthest and the nearest corners along the normal are picked per plane, not per lane
+        bool const px = planes[p].x >= 0.0f, py = planes[p].y >= 0.0f, pz = planes[p].z >= 0.0f;
+        F4 farthest   = (nx * (px ? maxX : minX) + ny * (py ? maxY : minY)) + (nz * (pz ? maxZ : minZ) + d);
+        F4 nearest    = (nx * (px ? minX : maxX) + ny * (py ? minY : maxY)) + (nz * (pz ? minZ : maxZ) + d);
+        outside       = outside | (farthest < F4::Set(0.0f));
+        crossing      = crossing | (nearest < F4::Set(0.0f));
+    }
+    visibleMask = ~BitMask(outside) & 0xFU;
+    insideMask  = ~BitMask(crossing) & visibleMask;
+}
+
+auto OverlapLanes [[nodiscard]] (Node const& node, Aabb const& box) -> uint32_t {
+    M4 separated = (F4::Set(box.max.x) < F4::Load(node.minX)) | (F4::Load(node.maxX) < F4::Set(box.min.x));
+    separated    = separated | (F4::Set(box.max.y) < F4::Load(node.minY)) | (F4::Load(node.maxY) < F4::Set(box.min.y));
+    separated    = separated | (F4::Set(box.max.z) < F4::Load(node.minZ)) | (F4::Load(node.maxZ) < F4::Set(box.min.z));
+    return ~BitMask(separated) & 0xFU;
+}
+
+} // namespace
+
+namespace engine {
+
+struct Bvh::Builder final {
+    Bvh& bvh;
+    std::vector<glm::vec3> centroids{};
+    std::atomic<uint32_t> numNodes{0U};
+
+    // Returns the first object of the second part, objects of the range are reordered
+    auto Split [[nodiscard]] (uint32_t first, uint32_t count) -> uint32_t {
+        uint32_t* objects = bvh.objectsOrder_.data();
+        Aabb centroidBounds{};
+        for (uint32_t i = first; i < first + count; ++i) {
+            centroidBounds = Grow(centroidBounds, Aabb{centroids[objects[i]], centroids[objects[i]]});
+        }
+
+        struct Bin final {
+            Aabb box{};
+            uint32_t count = 0U;
+        };
+        float bestCost   = std::numeric_limits<float>::max();
+        int32_t bestAxis = -1;
+        uint32_t bestBin = 0U;
+        float bestScale  = 0.0f;
+        for (int32_t axis = 0; axis < 3; ++axis) {
+            float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+            if (extent <= 0.0f) { continue; }
+            float scale = static_cast<float>(NUM_BINS) * 0.9999f / extent;
+            Bin bins[NUM_BINS]{};
+            for (uint32_t i = first; i < first + count; ++i) {
+                uint32_t object = objects[i];
+                auto bin        = static_cast<uint32_t>((centroids[object][axis] - centroidBounds.min[axis]) * scale);
+                bins[bin].box   = Grow(bins[bin].box, bvh.boxes_[object]);
+                ++bins[bin].count;
+            }
+            // NOTE: cost of the split after bin i is area * count of both sides
+            float rightCosts[NUM_BINS]{};
+            Aabb rightBox{};
+            uint32_t rightCount = 0U;
+            for (uint32_t bin = NUM_BINS - 1U; bin > 0U; --bin) {
+                rightBox = Grow(rightBox, bins[bin].box);
+                rightCount += bins[bin].count;
+                rightCosts[bin] = HalfArea(rightBox) * static_cast<float>(rightCount);
+            }
+            Aabb leftBox{};
+            uint32_t leftCount = 0U;
+            for (uint32_t bin = 1U; bin < NUM_BINS; ++bin) {
+                leftBox = Grow(leftBox, bins[bin - 1U].box);
+                leftCount += bins[bin - 1U].count;
+                if (leftCount == 0U || leftCount == count) { continue; }
+                float cost = HalfArea(leftBox) * static_cast<float>(leftCount) + rightCosts[bin];
+                if (cost < bestCost) {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestBin   = bin;
+                    bestScale = scale;
+                }
+            }
+        }
+        // all centroids are the same, any split is as good
+        if (bestAxis < 0) { return first + count / 2U; }
+
+        float axisMin = centroidBounds.min[bestAxis];
+        auto* middle  = std::partition(objects + first, objects + first + count, [&](uint32_t object) {
+            return static_cast<uint32_t>((centroids[object][bestAxis] - axisMin) * bestScale) < bestBin;
+        });
+        return static_cast<uint32_t>(middle - objects);
+    }
+
+    void BuildNode(uint32_t nodeIdx, uint32_t first, uint32_t count) {
+        // NOTE: the biggest range is split, until there are 4 of them, so a node has up to 4 children
+        uint32_t rangeFirst[WIDTH]{first};
+        uint32_t rangeCount[WIDTH]{count};
+        uint32_t numRanges = 1U;
+        while (numRanges < WIDTH) {
+            uint32_t biggest = 0U;
+            for (uint32_t r = 1U; r < numRanges; ++r) {
+                if (rangeCount[r] > rangeCount[biggest]) { biggest = r; }
+            }
+            if (rangeCount[biggest] <= MAX_LEAF_OBJECTS) { break; }
+            uint32_t middle       = Split(rangeFirst[biggest], rangeCount[biggest]);
+            rangeFirst[numRanges] = middle;
+            rangeCount[numRanges] = rangeFirst[biggest] + rangeCount[biggest] - middle;
+            rangeCount[biggest]   = middle - rangeFirst[biggest];
+            ++numRanges;
+        }
+
+        Node& node = bvh.nodes_[nodeIdx];
+        ClearNode(node);
+        uint32_t innerLanes[WIDTH]{};
+        uint32_t numInnerLanes = 0U;
+        for (uint32_t lane = 0; lane < numRanges; ++lane) {
+            Aabb box{};
+            for (uint32_t i = rangeFirst[lane]; i < rangeFirst[lane] + rangeCount[lane]; ++i) {
+                box = Grow(box, bvh.boxes_[bvh.objectsOrder_[i]]);
+            }
+            SetLaneBox(node, lane, box);
+            uint32_t slot = nodeIdx * WIDTH + lane;
+            if (rangeCount[lane] <= MAX_LEAF_OBJECTS) {
+                node.child[lane]      = rangeFirst[lane];
+                node.numObjects[lane] = rangeCount[lane];
+                for (uint32_t i = rangeFirst[lane]; i < rangeFirst[lane] + rangeCount[lane]; ++i) {
+                    bvh.objectSlots_[bvh.objectsOrder_[i]] = slot;
+                }
+                continue;
+            }
+            // NOTE: nodes are reserved upfront, so threads allocate them without locks
+            uint32_t childIdx           = numNodes.fetch_add(1U, std::memory_order_relaxed);
+            node.child[lane]            = childIdx;
+            bvh.parentSlots_[childIdx]  = slot;
+            innerLanes[numInnerLanes++] = lane;
+        }
+
+        auto buildChild = [&](size_t innerBegin, size_t innerEnd) {
+            for (size_t i = innerBegin; i < innerEnd; ++i) {
+                uint32_t lane = innerLanes[i];
+                BuildNode(node.child[lane], rangeFirst[lane], rangeCount[lane]);
+            }
+        };
+        if (count >= MIN_OBJECTS_PARALLEL && numInnerLanes > 1U) {
+            ParallelFor(numInnerLanes, 1U, buildChild);
+        } else {
+            buildChild(0U, numInnerLanes);
+        }
+    }
+};
+
+ENGINE_EXPORT void Bvh::Build(CpuView<Aabb const> objects) {
+    boxes_.assign(objects.Begin(), objects.End());
+    Rebuild();
+}
+
+ENGINE_EXPORT void Bvh::Rebuild() {
+    auto numObjects = static_cast<uint32_t>(boxes_.size());
+    movedObjects_.clear();
+    objectsOrder_.resize(numObjects);
+    for (uint32_t i = 0; i < numObjects; ++i) { objectsOrder_[i] = i; }
+    objectSlots_.assign(numObjects, NO_SLOT);
+    builtCost_ = 0.0f;
+    if (numObjects == 0U) {
+        nodes_.clear();
+        parentSlots_.clear();
+        isNodeDirty_.clear();
+        return;
+    }
+    // a node has at least 2 children, so there are less nodes than objects
+    nodes_.resize(numObjects);
+    parentSlots_.assign(nodes_.size(), NO_SLOT);
+
+    Builder builder{.bvh = *this};
+    builder.centroids.resize(numObjects);
+    for (uint32_t i = 0; i < numObjects; ++i) { builder.centroids[i] = Centroid(boxes_[i]); }
+    builder.numNodes = 1U;
+    builder.BuildNode(0U, 0U, numObjects);
+
+    nodes_.resize(builder.numNodes.load());
+    nodes_.shrink_to_fit();
+    parentSlots_.resize(nodes_.size());
+    isNodeDirty_.assign(nodes_.size(), 0U);
+    builtCost_ = Cost();
+}
+
+ENGINE_EXPORT void Bvh::SetObject(uint32_t objectIdx, Aabb const& box) {
+    assert(objectIdx < boxes_.size());
+    boxes_[objectIdx] = box;
+    movedObjects_.push_back(objectIdx);
+}
+
+ENGINE_EXPORT auto Bvh::Refit() -> bool {
+    if (movedObjects_.empty()) { return false; }
+    for (uint32_t object : movedObjects_) {
+        uint32_t slot = objectSlots_[object];
+        Node& node    = nodes_[slot / WIDTH];
+        uint32_t lane = slot % WIDTH;
+        Aabb box{};
+        for (uint32_t i = node.child[lane]; i < node.child[lane] + node.numObjects[lane]; ++i) {
+            box = Grow(box, boxes_[objectsOrder_[i]]);
+        }
+        SetLaneBox(node, lane, box);
+        isNodeDirty_[slot / WIDTH] = 1U;
+    }
+    movedObjects_.clear();
+
+    // children are after parents, so a reverse pass updates the whole path to the root
+    for (size_t nodeIdx = nodes_.size(); nodeIdx-- > 0U;) {
+        if (!isNodeDirty_[nodeIdx]) { continue; }
+        isNodeDirty_[nodeIdx] = 0U;
+        uint32_t parentSlot   = parentSlots_[nodeIdx];
+        if (parentSlot == NO_SLOT) { continue; }
+        SetLaneBox(nodes_[parentSlot / WIDTH], parentSlot % WIDTH, NodeBox(nodes_[nodeIdx]));
+        isNodeDirty_[parentSlot / WIDTH] = 1U;
+    }
+
+    if (Cost() <= builtCost_ * REBUILD_COST_RATIO) { return false; }
+    Rebuild();
+    return true;
+}
+
+ENGINE_EXPORT auto Bvh::Cost() const -> float {
+    if (nodes_.empty()) { return 0.0f; }
+    float rootArea = HalfArea(NodeBox(nodes_[0]));
+    if (rootArea <= 0.0f) { return 0.0f; }
+    float area = 0.0f;
+    for (Node const& node : nodes_) {
+        for (uint32_t lane = 0; lane < WIDTH; ++lane) {
+            if (IsLaneUsed(node, lane)) { area += HalfArea(LaneBox(node, lane)); }
+        }
+    }
+    return area / rootArea;
+}
+
+ENGINE_EXPORT auto Bvh::RayCast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const
+    -> std::optional<RayHit> {
+    if (boxes_.empty()) { return std::nullopt; }
+    glm::vec3 invDirection = InverseDirection(direction);
+    std::optional<RayHit> hit;
+    float nearest = maxDistance;
+
+    auto& stack = ResetStack(rayStack);
+    stack.push_back(RayEntry{0U, 0.0f});
+    while (!stack.empty()) {
+        RayEntry entry = stack.back();
+        stack.pop_back();
+        if (entry.distance > nearest) { continue; }
+        Node const& node = nodes_[entry.nodeIdx];
+        float tNear[WIDTH];
+        uint32_t mask = RayLanes(node, origin, invDirection, nearest, tNear);
+
+        RayEntry children[WIDTH];
+        size_t numChildren = 0U;
+        while (mask != 0U) {
+            auto lane = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1U;
+            if (node.numObjects[lane] == 0U) {
+                children[numChildren++] = RayEntry{node.child[lane], tNear[lane]};
+                continue;
+            }
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + node.numObjects[lane]; ++i) {
+                float distance = 0.0f;
+                if (RayBox(boxes_[objectsOrder_[i]], origin, invDirection, nearest, distance)) {
+                    nearest = distance;
+                    hit     = RayHit{.objectIdx = objectsOrder_[i], .distance = distance};
+                }
+            }
+        }
+        // farther children are pushed first, so the nearest is visited first, and hits cut the rest
+        std::sort(children, children + numChildren, [](RayEntry a, RayEntry b) { return a.distance > b.distance; });
+        stack.insert(stack.end(), children, children + numChildren);
+    }
+    return hit;
+}
+
+ENGINE_EXPORT void Bvh::QueryFrustum(FrustumPlanes const& planes, std::vector<uint32_t>& objects) const {
+    if (boxes_.empty()) { return; }
+    glm::vec4 const planesArray[6] = {
+        planes.left, planes.right, planes.bottom, planes.top, planes.near, planes.far,
+    };
+
+    auto& stack = ResetStack(nodeStack);
+    stack.push_back(0U);
+    while (!stack.empty()) {
+        uint32_t entry = stack.back();
+        stack.pop_back();
+        bool isInside        = (entry & INSIDE_BIT) != 0U;
+        Node const& node     = nodes_[entry & ~INSIDE_BIT];
+        uint32_t visibleMask = 0U;
+        uint32_t insideMask  = 0U;
+        if (isInside) {
+            for (uint32_t lane = 0; lane < WIDTH; ++lane) {
+                if (IsLaneUsed(node, lane)) { visibleMask |= 1U << lane; }
+            }
+            insideMask = visibleMask;
+        } else {
+            FrustumLanes(node, planesArray, visibleMask, insideMask);
+        }
+
+        while (visibleMask != 0U) {
+            auto lane = static_cast<uint32_t>(std::countr_zero(visibleMask));
+            visibleMask &= visibleMask - 1U;
+            bool isLaneInside = (insideMask >> lane) & 1U;
+            if (node.numObjects[lane] == 0U) {
+                stack.push_back(node.child[lane] | (isLaneInside ? INSIDE_BIT : 0U));
+                continue;
+            }
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + node.numObjects[lane]; ++i) {
+                uint32_t object = objectsOrder_[i];
+                if (isLaneInside || !IsBoxOutside(boxes_[object], planesArray)) { objects.push_back(object); }
+            }
+        }
+    }
+}
+
+ENGINE_EXPORT void Bvh::QueryOverlap(Aabb const& box, std::vector<uint32_t>& objects) const {
+    if (boxes_.empty()) { return; }
+    auto& stack = ResetStack(nodeStack);
+    stack.push_back(0U);
+    while (!stack.empty()) {
+        Node const& node = nodes_[stack.back()];
+        stack.pop_back();
+        uint32_t mask = OverlapLanes(node, box);
+        while (mask != 0U) {
+            auto lane = static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1U;
+            if (node.numObjects[lane] == 0U) {
+                stack.push_back(node.child[lane]);
+                continue;
+            }
+            for (uint32_t i = node.child[lane]; i < node.child[lane] + node.numObjects[lane]; ++i) {
+                if (Overlaps(boxes_[objectsOrder_[i]], box)) { objects.push_back(objectsOrder_[i]); }
+            }
+        }
+    }
+}
+
+} // namespace engine
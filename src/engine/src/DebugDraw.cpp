@@ -0,0 +1,117 @@
+#include "engine/DebugDraw.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr size_t THREAD_BUFFER_CAPACITY = 1024U;
+
+// Buffer of the last DebugDraw the thread pushed to, an instance id is never reused, unlike an address
+struct ThreadCache final {
+    uint64_t instanceId = 0U;
+    void* buffer        = nullptr;
+};
+thread_local ThreadCache threadCache{};
+
+// Moves the primitives, which live one more frame, to the front, the rest is erased
+template <typename T> void AgeBuffer(std::vector<T>& items, std::vector<uint32_t>& framesLeft) {
+    size_t numAlive = 0U;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (--framesLeft[i] == 0U) { continue; }
+        items[numAlive]      = items[i];
+        framesLeft[numAlive] = framesLeft[i];
+        ++numAlive;
+    }
+    items.resize(numAlive);
+    framesLeft.resize(numAlive);
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_STATIC std::atomic<uint64_t> DebugDraw::nextInstanceId_{1U};
+
+ENGINE_EXPORT DebugDraw::DebugDraw() noexcept
+    : instanceId_(nextInstanceId_.fetch_add(1U, std::memory_order_relaxed)) { }
+
+ENGINE_EXPORT auto DebugDraw::LocalBuffer() -> ThreadBuffer& {
+    if (threadCache.instanceId == instanceId_) { return *static_cast<ThreadBuffer*>(threadCache.buffer); }
+    auto thread = std::this_thread::get_id();
+    std::lock_guard lock{buffersMutex_};
+    // the thread may have pushed to another instance since, then it has a buffer here already
+    auto found = std::find_if(buffers_.begin(), buffers_.end(), [&](auto const& b) { return b->thread == thread; });
+    if (found == buffers_.end()) {
+        auto buffer    = std::make_unique<ThreadBuffer>();
+        buffer->thread = thread;
+        buffer->lines.reserve(THREAD_BUFFER_CAPACITY);
+        buffer->linesFramesLeft.reserve(THREAD_BUFFER_CAPACITY);
+        buffer->points.reserve(THREAD_BUFFER_CAPACITY);
+        buffer->pointsFramesLeft.reserve(THREAD_BUFFER_CAPACITY);
+        buffer->compactPoints.reserve(THREAD_BUFFER_CAPACITY);
+        buffer->compactPointsFramesLeft.reserve(THREAD_BUFFER_CAPACITY);
+        buffers_.push_back(std::move(buffer));
+        found = buffers_.end() - 1;
+    }
+    threadCache = ThreadCache{.instanceId = instanceId_, .buffer = found->get()};
+    return **found;
+}
+
+ENGINE_EXPORT void DebugDraw::PushLine(glm::vec3 worldBegin, glm::vec3 worldEnd, ColorCode color, uint32_t numFrames) {
+    if (numFrames == 0U) { return; }
+    auto& buffer     = LocalBuffer();
+    int32_t colorIdx = static_cast<int32_t>(color);
+    buffer.lines.push_back(LineRendererInput::Line{
+        .begin = LineRendererInput::Vertex{worldBegin, colorIdx},
+        .end   = LineRendererInput::Vertex{worldEnd, colorIdx},
+    });
+    buffer.linesFramesLeft.push_back(numFrames);
+}
+
+ENGINE_EXPORT void DebugDraw::PushRay(
+    glm::vec3 worldBegin, glm::vec3 worldDirection, ColorCode color, uint32_t numFrames) {
+    PushLine(worldBegin, worldBegin + worldDirection, color, numFrames);
+}
+
+ENGINE_EXPORT void DebugDraw::PushPoint(glm::vec3 worldPosition, float scale, ColorCode color, uint32_t numFrames) {
+    if (numFrames == 0U) { return; }
+    auto& buffer = LocalBuffer();
+    buffer.compactPoints.push_back(PointRendererInput::MakeCompactPoint(worldPosition, scale, color));
+    buffer.compactPointsFramesLeft.push_back(numFrames);
+}
+
+ENGINE_EXPORT void DebugDraw::PushPoint(glm::mat4 const& transformToWorld, ColorCode color, uint32_t numFrames) {
+    if (numFrames == 0U) { return; }
+    auto& buffer = LocalBuffer();
+    buffer.points.push_back(
+        PointRendererInput::Point{.transform = transformToWorld, .colorIdx = static_cast<int32_t>(color)});
+    buffer.pointsFramesLeft.push_back(numFrames);
+}
+
+ENGINE_EXPORT void DebugDraw::Collect(LineRendererInput& lines, PointRendererInput& points) {
+    std::lock_guard lock{buffersMutex_};
+    for (auto& buffer : buffers_) {
+        lines.PushLines(CpuView{buffer->lines.data(), buffer->lines.size()});
+        points.PushPoints(CpuView{buffer->points.data(), buffer->points.size()});
+        points.PushPoints(CpuView{buffer->compactPoints.data(), buffer->compactPoints.size()});
+        AgeBuffer(buffer->lines, buffer->linesFramesLeft);
+        AgeBuffer(buffer->points, buffer->pointsFramesLeft);
+        AgeBuffer(buffer->compactPoints, buffer->compactPointsFramesLeft);
+    }
+}
+
+ENGINE_EXPORT void DebugDraw::Clear() {
+    std::lock_guard lock{buffersMutex_};
+    for (auto& buffer : buffers_) {
+        buffer->lines.clear();
+        buffer->linesFramesLeft.clear();
+        buffer->points.clear();
+        buffer->pointsFramesLeft.clear();
+        buffer->compactPoints.clear();
+        buffer->compactPointsFramesLeft.clear();
+    }
+}
+
+} // namespace engine
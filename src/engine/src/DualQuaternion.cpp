@@ -0,0 +1,74 @@
+#include "engine/DualQuaternion.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+namespace engine::math {
+
+ENGINE_EXPORT auto DualQuatFromMatrix(glm::mat4 const& transform) -> DualQuat {
+    glm::mat3 rotation{
+        glm::normalize(glm::vec3{transform[0]}),
+        glm::normalize(glm::vec3{transform[1]}),
+        glm::normalize(glm::vec3{transform[2]}),
+    };
+    return DualQuat::FromRotationTranslation(glm::normalize(glm::quat_cast(rotation)), glm::vec3{transform[3]});
+}
+
+ENGINE_EXPORT auto DualQuatToMatrix(DualQuat const& dq) -> glm::mat4 {
+    DualQuat unit    = dq.Normalized();
+    glm::mat4 result = glm::mat4_cast(unit.real);
+    result[3]        = glm::vec4{unit.Translation(), 1.0f};
+    return result;
+}
+
+ENGINE_EXPORT auto ScLerp(DualQuat const& from, DualQuat const& to, float t) -> DualQuat {
+    // NOTE: q and -q are the same transform, the one closer to from is the shortest path
+    DualQuat target = glm::dot(from.real, to.real) < 0.0f ? to.Mul(-1.0f) : to;
+    // motion from "from" to "to", the inverse of a unit dual quaternion is its quaternion conjugate
+    DualQuat delta = from.QuatConjugate().Mul(target);
+
+    // delta is a screw: rotation by angle around the line (direction, moment) and translation by pitch along it
+    glm::vec3 realVector{delta.real.x, delta.real.y, delta.real.z};
+    float sinHalf = glm::length(realVector);
+    if (sinHalf < 1e-6f) {
+        // no rotation, the screw is a translation, so linear interpolation has constant speed already
+        return from.Mul(1.0f - t).Add(target.Mul(t)).Normalized();
+    }
+    float halfAngle     = std::atan2(sinHalf, delta.real.w);
+    glm::vec3 direction = realVector / sinHalf;
+    float pitch         = -2.0f * delta.dual.w / sinHalf;
+    glm::vec3 moment    = (glm::vec3{delta.dual.x, delta.dual.y, delta.dual.z}
+                        - direction * (0.5f * pitch * delta.real.w))
+        / sinHalf;
+
+    // delta^t is the same screw, with angle and pitch scaled by t
+    float sinT         = std::sin(t * halfAngle);
+    float cosT         = std::cos(t * halfAngle);
+    float pitchT       = t * pitch;
+    glm::vec3 dualPart = moment * sinT + direction * (0.5f * pitchT * cosT);
+    DualQuat deltaT{
+        .real = glm::quat{cosT, direction.x * sinT, direction.y * sinT, direction.z * sinT},
+        .dual = glm::quat{-0.5f * pitchT * sinT, dualPart.x, dualPart.y, dualPart.z},
+    };
+    return from.Mul(deltaT);
+}
+
+ENGINE_EXPORT auto BlendDlb(CpuView<DualQuat const> dqs, CpuView<float const> weights) -> DualQuat {
+    assert(dqs.NumElements() == weights.NumElements() && "Bad call to BlendDlb, every dual quat needs a weight");
+    size_t numDqs = std::min(dqs.NumElements(), weights.NumElements());
+    if (numDqs == 0U) { return DualQuat::Identity(); }
+
+    glm::quat pivot = dqs[0]->real;
+    DualQuat sum{
+        .real = glm::quat{0.0f, 0.0f, 0.0f, 0.0f},
+        .dual = glm::quat{0.0f, 0.0f, 0.0f, 0.0f},
+    };
+    for (size_t i = 0; i < numDqs; ++i) {
+        DualQuat const& dq = *dqs[i];
+        float weight       = glm::dot(dq.real, pivot) < 0.0f ? -*weights[i] : *weights[i];
+        sum                = sum.Add(dq.Mul(weight));
+    }
+    if (sum.MagnitudeReal() < 1e-12f) { return DualQuat::Identity(); }
+    return sum.Normalized();
+}
+
+} // namespace engine::math
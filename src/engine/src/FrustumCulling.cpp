@@ -0,0 +1,160 @@
+#include "engine/FrustumCulling.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+
+using engine::private_::F4;
+using engine::private_::M4;
+
+constexpr size_t LANES                = 4U;
+constexpr size_t NUM_PLANES           = 6U;
+constexpr size_t GROUPS_PER_CHUNK     = 1024U;
+constexpr size_t MIN_OBJECTS_PARALLEL = 16U * 1024U; // below it, waking up workers costs more than culling
+
+auto NumGroups [[nodiscard]] (size_t numObjects) -> size_t { return (numObjects + LANES - 1U) / LANES; }
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto CullingVolumes::Push(glm::vec3 boxMin, glm::vec3 boxMax) -> uint32_t {
+    auto objectIdx = static_cast<uint32_t>(numObjects_);
+    ++numObjects_;
+    size_t const numPadded = NumGroups(numObjects_) * LANES;
+    if (numPadded > centerX_.size()) {
+        // NOTE: an empty volume has a negative infinite radius, so it's outside of any plane
+        constexpr float EMPTY_RADIUS = -std::numeric_limits<float>::infinity();
+        for (auto* coords : {&centerX_, &centerY_, &centerZ_, &minX_, &minY_, &minZ_, &maxX_, &maxY_, &maxZ_}) {
+            coords->resize(numPadded, 0.0f);
+        }
+        radius_.resize(numPadded, EMPTY_RADIUS);
+        lastCullingPlane_.resize(numPadded / LANES, 0U);
+    }
+    Set(objectIdx, boxMin, boxMax);
+    return objectIdx;
+}
+
+ENGINE_EXPORT void CullingVolumes::Set(uint32_t objectIdx, glm::vec3 boxMin, glm::vec3 boxMax) {
+    assert(objectIdx < numObjects_);
+    glm::vec3 center    = 0.5f * (boxMin + boxMax);
+    centerX_[objectIdx] = center.x;
+    centerY_[objectIdx] = center.y;
+    centerZ_[objectIdx] = center.z;
+    radius_[objectIdx]  = glm::length(boxMax - center);
+    minX_[objectIdx]    = boxMin.x;
+    minY_[objectIdx]    = boxMin.y;
+    minZ_[objectIdx]    = boxMin.z;
+    maxX_[objectIdx]    = boxMax.x;
+    maxY_[objectIdx]    = boxMax.y;
+    maxZ_[objectIdx]    = boxMax.z;
+}
+
+ENGINE_EXPORT void CullingVolumes::Clear() {
+    for (auto* coords : {&centerX_, &centerY_, &centerZ_, &radius_, &minX_, &minY_, &minZ_, &maxX_, &maxY_, &maxZ_}) {
+        coords->clear();
+    }
+    lastCullingPlane_.clear();
+    numObjects_ = 0U;
+}
+
+ENGINE_EXPORT auto CullingVolumes::Cull(FrustumPlanes const& planes) -> CpuMemory<uint32_t const> {
+    glm::vec4 const planesArray[NUM_PLANES] = {
+        planes.left, planes.right, planes.bottom, planes.top, planes.near, planes.far,
+    };
+    size_t const numGroups = NumGroups(numObjects_);
+    visible_.resize(numGroups * LANES);
+    if (numObjects_ < MIN_OBJECTS_PARALLEL) {
+        size_t numVisible = 0U;
+        CullGroups(planesArray, 0U, numGroups, visible_.data(), numVisible);
+        return CpuMemory<uint32_t const>{visible_.data(), numVisible};
+    }
+
+    size_t const numChunks = (numGroups + GROUPS_PER_CHUNK - 1U) / GROUPS_PER_CHUNK;
+    chunkNumVisible_.assign(numChunks, 0U);
+    ParallelFor(numGroups, GROUPS_PER_CHUNK, [&](size_t groupsBegin, size_t groupsEnd) {
+        // NOTE: chunks start at multiples of GROUPS_PER_CHUNK, so each one owns its range of visible_
+        size_t numVisible = 0U;
+        CullGroups(planesArray, groupsBegin, groupsEnd, visible_.data() + groupsBegin * LANES, numVisible);
+        chunkNumVisible_[groupsBegin / GROUPS_PER_CHUNK] = static_cast<uint32_t>(numVisible);
+    });
+
+    // chunks are moved only to the left, so the ranges which aren't moved yet stay intact
+    size_t numVisible = chunkNumVisible_[0];
+    for (size_t chunk = 1U; chunk < numChunks; ++chunk) {
+        std::memmove(
+            visible_.data() + numVisible, visible_.data() + chunk * GROUPS_PER_CHUNK * LANES,
+            chunkNumVisible_[chunk] * sizeof(uint32_t));
+        numVisible += chunkNumVisible_[chunk];
+    }
+    return CpuMemory<uint32_t const>{visible_.data(), numVisible};
+}
+
+ENGINE_EXPORT void CullingVolumes::CullGroups(
+    glm::vec4 const* planes, size_t groupsBegin, size_t groupsEnd, uint32_t* visible, size_t& numVisible) {
+    constexpr uint32_t ALL_LANES = (1U << LANES) - 1U;
+    // NOTE: the vertex of a box farthest along the plane normal is picked per plane, not per object
+    bool pickMax[NUM_PLANES][3];
+    F4 planeCoefficients[NUM_PLANES][4];
+    for (size_t p = 0; p < NUM_PLANES; ++p) {
+        for (int32_t axis = 0; axis < 3; ++axis) { pickMax[p][axis] = planes[p][axis] >= 0.0f; }
+        for (int32_t c = 0; c < 4; ++c) { planeCoefficients[p][c] = F4::Set(planes[p][c]); }
+    }
+    auto distance = [&](size_t p, F4 x, F4 y, F4 z) {
+        auto const& plane = planeCoefficients[p];
+        return plane[0] * x + plane[1] * y + (plane[2] * z + plane[3]);
+    };
+
+    for (size_t group = groupsBegin; group < groupsEnd; ++group) {
+        size_t const first = group * LANES;
+        F4 const cx        = F4::Load(centerX_.data() + first);
+        F4 const cy        = F4::Load(centerY_.data() + first);
+        F4 const cz        = F4::Load(centerZ_.data() + first);
+        F4 const r         = F4::Load(radius_.data() + first);
+        F4 const minR      = F4::Set(0.0f) - r;
+        M4 culled          = M4::None();
+        M4 intersected     = M4::None();
+
+        size_t const firstPlane = lastCullingPlane_[group];
+        for (size_t i = 0; i < NUM_PLANES; ++i) {
+            size_t const p    = (firstPlane + i) % NUM_PLANES;
+            F4 centerDistance = distance(p, cx, cy, cz);
+            culled            = culled | (centerDistance < minR);
+            intersected       = intersected | (centerDistance < r);
+            if (BitMask(culled) == ALL_LANES) {
+                lastCullingPlane_[group] = static_cast<uint8_t>(p);
+                break;
+            }
+        }
+
+        // spheres are loose for long boxes, so spheres on the border of the frustum are tested again with boxes
+        M4 const refine = AndNot(intersected, culled);
+        if (BitMask(refine) != 0U) {
+            F4 const minX = F4::Load(minX_.data() + first), maxX = F4::Load(maxX_.data() + first);
+            F4 const minY = F4::Load(minY_.data() + first), maxY = F4::Load(maxY_.data() + first);
+            F4 const minZ = F4::Load(minZ_.data() + first), maxZ = F4::Load(maxZ_.data() + first);
+            M4 boxCulled  = M4::None();
+            for (size_t p = 0; p < NUM_PLANES; ++p) {
+                F4 farthest = distance(
+                    p, pickMax[p][0] ? maxX : minX, pickMax[p][1] ? maxY : minY, pickMax[p][2] ? maxZ : minZ);
+                boxCulled = boxCulled | (farthest < F4::Set(0.0f));
+            }
+            culled = culled | (refine & boxCulled);
+        }
+
+        uint32_t visibleMask = ~BitMask(culled) & ALL_LANES;
+        while (visibleMask != 0U) {
+            uint32_t lane = static_cast<uint32_t>(std::countr_zero(visibleMask));
+            // NOTE: padding lanes are never visible, their radius is negative infinity
+            visible[numVisible++] = static_cast<uint32_t>(first + lane);
+            visibleMask &= visibleMask - 1U;
+        }
+    }
+}
+
+} // namespace engine
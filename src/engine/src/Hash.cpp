@@ -0,0 +1,44 @@
+#include "engine/Hash.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <cstring>
+
+namespace engine {
+
+ENGINE_EXPORT auto HashBytes(void const* data, size_t numBytes, uint64_t seed) -> uint64_t {
+    constexpr uint64_t MULTIPLIER = 0xC6A4A7935BD1E995ULL;
+    constexpr int SHIFT           = 47;
+
+    auto const* bytes = static_cast<uint8_t const*>(data);
+    uint64_t hash     = seed ^ (numBytes * MULTIPLIER);
+    size_t numBlocks  = numBytes / sizeof(uint64_t);
+    for (size_t i = 0; i < numBlocks; ++i) {
+        uint64_t block;
+        // NOTE: memcpy compiles to a single (possibly unaligned) load
+        std::memcpy(&block, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+        block *= MULTIPLIER;
+        block ^= block >> SHIFT;
+        block *= MULTIPLIER;
+        hash ^= block;
+        hash *= MULTIPLIER;
+    }
+
+    auto const* tail = bytes + numBlocks * sizeof(uint64_t);
+    switch (numBytes & 7U) {
+    case 7: hash ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+    case 6: hash ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+    case 5: hash ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+    case 4: hash ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+    case 3: hash ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+    case 2: hash ^= uint64_t(tail[1]) << 8; [[fallthrough]];
+    case 1: hash ^= uint64_t(tail[0]); hash *= MULTIPLIER;
+    }
+
+    hash ^= hash >> SHIFT;
+    hash *= MULTIPLIER;
+    hash ^= hash >> SHIFT;
+    return hash;
+}
+
+} // namespace engine
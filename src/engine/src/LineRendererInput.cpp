@@ -1,7 +1,70 @@
 #include "engine/LineRendererInput.hpp"
 
+#include "engine_private/Float4.hpp"
 #include "engine_private/Prelude.hpp"
 
+namespace {
+
+using Line = engine::LineRendererInput::Line;
+using engine::private_::F4;
+
+auto IsAffine [[nodiscard]] (glm::mat4 const& transform) -> bool {
+    return transform[0][3] == 0.0f && transform[1][3] == 0.0f && transform[2][3] == 0.0f && transform[3][3] == 1.0f;
+}
+
+auto TransformPoint [[nodiscard]] (glm::mat4 const& transform, bool isAffine, glm::vec3 point) -> glm::vec3 {
+    glm::vec4 homo = transform * glm::vec4{point, 1.0f};
+    return isAffine ? glm::vec3{homo} : glm::vec3{homo} / homo.w;
+}
+
+auto PointAt [[nodiscard]] (engine::CpuView<glm::vec3 const> const& points, size_t idx) -> glm::vec3 const& {
+    return *reinterpret_cast<glm::vec3 const*>(points.data + idx * points.byteStride);
+}
+
+// Writes transformed points into positions of line vertices, the destination is strided by Line
+// NOTE: vertices are AoS, so points are transposed into SoA of 4, transformed, and transposed back
+void TransformPoints(
+    glm::mat4 const& transform, bool isAffine, engine::CpuView<glm::vec3 const> points, glm::vec3* destination) {
+    auto* destinationBytes = reinterpret_cast<uint8_t*>(destination);
+    F4 m[4][4];
+    for (int32_t column = 0; column < 4; ++column) {
+        for (int32_t row = 0; row < 4; ++row) { m[column][row] = F4::Set(transform[column][row]); }
+    }
+    size_t numPoints = points.NumElements();
+    float xs[4], ys[4], zs[4];
+    for (size_t i = 0; i < numPoints; i += 4U) {
+        // NOTE: lanes past the end repeat the last point, they aren't stored
+        size_t numLanes = std::min<size_t>(4U, numPoints - i);
+        for (size_t lane = 0; lane < 4U; ++lane) {
+            auto const& point = PointAt(points, i + std::min(lane, numLanes - 1U));
+            xs[lane]          = point.x;
+            ys[lane]          = point.y;
+            zs[lane]          = point.z;
+        }
+        F4 x  = F4::Load(xs);
+        F4 y  = F4::Load(ys);
+        F4 z  = F4::Load(zs);
+        F4 rx = m[0][0] * x + m[1][0] * y + (m[2][0] * z + m[3][0]);
+        F4 ry = m[0][1] * x + m[1][1] * y + (m[2][1] * z + m[3][1]);
+        F4 rz = m[0][2] * x + m[1][2] * y + (m[2][2] * z + m[3][2]);
+        if (!isAffine) {
+            F4 invW = F4::Set(1.0f) / (m[0][3] * x + m[1][3] * y + (m[2][3] * z + m[3][3]));
+            rx      = rx * invW;
+            ry      = ry * invW;
+            rz      = rz * invW;
+        }
+        rx.Store(xs);
+        ry.Store(ys);
+        rz.Store(zs);
+        for (size_t lane = 0; lane < numLanes; ++lane) {
+            *reinterpret_cast<glm::vec3*>(destinationBytes + (i + lane) * sizeof(Line)) =
+                glm::vec3{xs[lane], ys[lane], zs[lane]};
+        }
+    }
+}
+
+} // namespace
+
 namespace engine {
 
 ENGINE_EXPORT LineRendererInput::LineRendererInput(size_t maxLines) noexcept
@@ -18,8 +81,9 @@ ENGINE_EXPORT void LineRendererInput::Clear() {
 }
 
 ENGINE_EXPORT void LineRendererInput::SetTransform(glm::mat4 const& transform) {
-    customTransform_ = transform;
-    hasTransform_    = true;
+    customTransform_   = transform;
+    hasTransform_      = true;
+    isAffineTransform_ = IsAffine(transform);
 }
 
 ENGINE_EXPORT void LineRendererInput::SetTransform() { hasTransform_ = false; }
@@ -34,17 +98,111 @@ ENGINE_EXPORT void LineRendererInput::PushLine(glm::vec3 worldBegin, glm::vec3 w
     }
     int32_t colorIdx = static_cast<int32_t>(currentColor_);
     if (hasTransform_) {
-        glm::vec4 homo = customTransform_ * glm::vec4{worldBegin, 1.0f};
-        worldBegin     = glm::vec3{homo} / homo.w;
-        homo           = customTransform_ * glm::vec4{worldEnd, 1.0f};
-        worldEnd       = glm::vec3{homo} / homo.w;
+        worldBegin = TransformPoint(customTransform_, isAffineTransform_, worldBegin);
+        worldEnd   = TransformPoint(customTransform_, isAffineTransform_, worldEnd);
     }
     lines_.emplace_back(Line{Vertex{worldBegin, colorIdx}, Vertex{worldEnd, colorIdx}});
     isDirty_ = true;
 }
 
+ENGINE_EXPORT void LineRendererInput::PushLines(CpuView<Line const> lines) {
+    if (lines.Begin() == lines.End()) { return; }
+    lines_.insert(lines_.end(), lines.Begin(), lines.End());
+    isDirty_ = true;
+}
+
 ENGINE_EXPORT void LineRendererInput::PushRay(glm::vec3 worldBegin, glm::vec3 worldDirection) {
     PushLine(worldBegin, worldBegin + worldDirection);
 }
 
+ENGINE_EXPORT auto LineRendererInput::AllocateLines(size_t numLines) -> Line* {
+    size_t firstLine = std::size(lines_);
+    if (firstLine + numLines > maxLines_) {
+        XLOGW("LineRendererInput too many lines are added {}", firstLine + numLines);
+    }
+    lines_.resize(firstLine + numLines);
+    isDirty_ = true;
+    return lines_.data() + firstLine;
+}
+
+ENGINE_EXPORT void LineRendererInput::PushLines(CpuView<glm::vec3 const> begins, CpuView<glm::vec3 const> ends) {
+    assert(begins.NumElements() == ends.NumElements() && "Bad call to PushLines, every line needs both ends");
+    size_t numLines = std::min(begins.NumElements(), ends.NumElements());
+    if (numLines == 0U) { return; }
+    Line* lines      = AllocateLines(numLines);
+    int32_t colorIdx = static_cast<int32_t>(currentColor_);
+    for (size_t i = 0; i < numLines; ++i) {
+        lines[i].begin.colorIdx = colorIdx;
+        lines[i].end.colorIdx   = colorIdx;
+    }
+    if (hasTransform_) {
+        TransformPoints(customTransform_, isAffineTransform_, begins, &lines->begin.position);
+        TransformPoints(customTransform_, isAffineTransform_, ends, &lines->end.position);
+        return;
+    }
+    for (size_t i = 0; i < numLines; ++i) {
+        lines[i].begin.position = PointAt(begins, i);
+        lines[i].end.position   = PointAt(ends, i);
+    }
+}
+
+ENGINE_EXPORT void LineRendererInput::PushLineStrip(CpuView<glm::vec3 const> points, bool isClosed) {
+    size_t numPoints = points.NumElements();
+    if (numPoints < 2U) { return; }
+    // NOTE: the views overlap, the end of a line is the begin of the next one
+    auto begins = CpuView<glm::vec3 const>{points.data, numPoints - 1U, 0, points.byteStride};
+    auto ends   = CpuView<glm::vec3 const>{points.data, numPoints - 1U, static_cast<ptrdiff_t>(points.byteStride),
+                                           points.byteStride};
+    PushLines(begins, ends);
+    if (isClosed) {
+        PushLines(
+            CpuView<glm::vec3 const>{&PointAt(points, numPoints - 1U), 1U},
+            CpuView<glm::vec3 const>{&PointAt(points, 0U), 1U});
+    }
+}
+
+ENGINE_EXPORT void LineRendererInput::PushWireBox(glm::vec3 boxMin, glm::vec3 boxMax) {
+    glm::vec3 const corners[8] = {
+        {boxMin.x, boxMin.y, boxMin.z},
+        {boxMax.x, boxMin.y, boxMin.z},
+        {boxMin.x, boxMax.y, boxMin.z},
+        {boxMax.x, boxMax.y, boxMin.z},
+        {boxMin.x, boxMin.y, boxMax.z},
+        {boxMax.x, boxMin.y, boxMax.z},
+        {boxMin.x, boxMax.y, boxMax.z},
+        {boxMax.x, boxMax.y, boxMax.z},
+    };
+    // corner index bits are x, y, z, an edge connects corners which differ in one bit
+    constexpr uint8_t EDGES[12][2] = {
+        {0, 1}, {2, 3}, {4, 5}, {6, 7}, // along x
+        {0, 2}, {1, 3}, {4, 6}, {5, 7}, // along y
+        {0, 4}, {1, 5}, {2, 6}, {3, 7}, // along z
+    };
+    glm::vec3 begins[12];
+    glm::vec3 ends[12];
+    for (size_t i = 0; i < std::size(EDGES); ++i) {
+        begins[i] = corners[EDGES[i][0]];
+        ends[i]   = corners[EDGES[i][1]];
+    }
+    PushLines(CpuView<glm::vec3 const>{begins, std::size(begins)}, CpuView<glm::vec3 const>{ends, std::size(ends)});
+}
+
+ENGINE_EXPORT void LineRendererInput::PushWireSphere(glm::vec3 center, float radius, uint32_t numSegments) {
+    if (numSegments < 3U) { return; }
+    scratchPoints_.resize(numSegments);
+    auto strip = CpuView<glm::vec3 const>{scratchPoints_.data(), scratchPoints_.size()};
+    for (uint32_t axis = 0; axis < 3U; ++axis) {
+        for (uint32_t i = 0; i < numSegments; ++i) {
+            float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(numSegments);
+            float u     = radius * glm::cos(angle);
+            float v     = radius * glm::sin(angle);
+            glm::vec3 offset{0.0f};
+            offset[(axis + 1U) % 3U] = u;
+            offset[(axis + 2U) % 3U] = v;
+            scratchPoints_[i]        = center + offset;
+        }
+        PushLineStrip(strip, /*isClosed*/ true);
+    }
+}
+
 } // namespace engine
@@ -0,0 +1,158 @@
+#include "engine/LzCompression.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t MIN_MATCH         = 4U;
+constexpr size_t MAX_OFFSET        = 65535U;
+constexpr size_t HASH_LOG          = 14U;
+constexpr size_t LAST_LITERALS     = 5U;  // NOTE: LZ4 format requires the last 5 bytes to be literals
+constexpr size_t MATCH_SAFE_MARGIN = 12U; // and the last match to start at least 12 bytes before the end
+constexpr uint8_t RUN_MASK         = 15U;
+
+auto Read32 [[nodiscard]] (uint8_t const* ptr) -> uint32_t {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+auto HashSequence [[nodiscard]] (uint32_t sequence) -> uint32_t {
+    return (sequence * 2654435761U) >> (32U - HASH_LOG);
+}
+
+// Lengths above 15 continue in extra bytes: 255 means there are more bytes, anything else ends the length
+auto WriteLength(uint8_t* out, size_t length) -> uint8_t* {
+    for (; length >= 255U; length -= 255U) { *out++ = 255U; }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+auto ReadLength [[nodiscard]] (uint8_t const*& in, uint8_t const* inEnd, size_t& length) -> bool {
+    uint8_t byte;
+    do {
+        if (in >= inEnd) { return false; }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255U);
+    return true;
+}
+
+auto WriteSequence(uint8_t* out, uint8_t const* literals, size_t numLiterals, size_t offset, size_t matchLength)
+    -> uint8_t* {
+    uint8_t* token = out++;
+    *token         = static_cast<uint8_t>(std::min<size_t>(numLiterals, RUN_MASK) << 4U);
+    if (numLiterals >= RUN_MASK) { out = WriteLength(out, numLiterals - RUN_MASK); }
+    std::memcpy(out, literals, numLiterals);
+    out += numLiterals;
+    if (matchLength == 0U) { return out; } // last sequence is literals only
+
+    *out++ = static_cast<uint8_t>(offset & 0xFFU);
+    *out++ = static_cast<uint8_t>(offset >> 8U);
+    matchLength -= MIN_MATCH;
+    *token |= static_cast<uint8_t>(std::min<size_t>(matchLength, RUN_MASK));
+    if (matchLength >= RUN_MASK) { out = WriteLength(out, matchLength - RUN_MASK); }
+    return out;
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto LzCompressBound(size_t numBytes) -> size_t { return numBytes + numBytes / 255U + 16U; }
+
+ENGINE_EXPORT auto LzCompress(CpuMemory<uint8_t const> source, CpuMemory<uint8_t> destination) -> size_t {
+    assert(destination.NumBytes() >= LzCompressBound(source.NumBytes()));
+    uint8_t const* const begin = source.data;
+    uint8_t const* const end   = source.dataEnd;
+    uint8_t* out               = destination.data;
+    uint8_t const* anchor      = begin;
+
+    if (source.NumBytes() > MATCH_SAFE_MARGIN) {
+        // NOTE: positions are stored relative to begin, 0 is a valid position (it's checked by offset anyway)
+        std::vector<uint32_t> table(1U << HASH_LOG, 0U);
+        uint8_t const* const matchLimit = end - MATCH_SAFE_MARGIN;
+        uint8_t const* const copyLimit  = end - LAST_LITERALS;
+        uint8_t const* in               = begin + 1;
+
+        while (in < matchLimit) {
+            uint32_t sequence  = Read32(in);
+            uint32_t& slot     = table[HashSequence(sequence)];
+            uint8_t const* ref = begin + slot;
+            slot               = static_cast<uint32_t>(in - begin);
+            if (ref >= in || static_cast<size_t>(in - ref) > MAX_OFFSET || Read32(ref) != sequence) {
+                // NOTE: skip faster over incompressible data, the step grows with the number of misses
+                in += 1U + ((in - anchor) >> 6U);
+                continue;
+            }
+
+            // extend the match backwards over pending literals and forwards until mismatch
+            while (in > anchor && ref > begin && in[-1] == ref[-1]) {
+                --in;
+                --ref;
+            }
+            size_t offset           = in - ref;
+            uint8_t const* matchEnd = in + MIN_MATCH;
+            while (matchEnd < copyLimit && *matchEnd == *(matchEnd - offset)) { ++matchEnd; }
+
+            out    = WriteSequence(out, anchor, in - anchor, offset, matchEnd - in);
+            in     = matchEnd;
+            anchor = in;
+            if (in < matchLimit) { table[HashSequence(Read32(in - 2))] = static_cast<uint32_t>(in - 2 - begin); }
+        }
+    }
+
+    out = WriteSequence(out, anchor, end - anchor, 0U, 0U);
+    return out - destination.data;
+}
+
+ENGINE_EXPORT auto LzCompress(CpuMemory<uint8_t const> source) -> std::vector<uint8_t> {
+    std::vector<uint8_t> compressed(LzCompressBound(source.NumBytes()));
+    compressed.resize(LzCompress(source, CpuMemory<uint8_t>{compressed.data(), compressed.size()}));
+    return compressed;
+}
+
+ENGINE_EXPORT auto LzDecompress(CpuMemory<uint8_t const> source, CpuMemory<uint8_t> destination) -> bool {
+    uint8_t const* in          = source.data;
+    uint8_t const* const inEnd = source.dataEnd;
+    uint8_t* out               = destination.data;
+    uint8_t* const outEnd      = destination.dataEnd;
+
+    while (in < inEnd) {
+        uint8_t token      = *in++;
+        size_t numLiterals = token >> 4U;
+        if (numLiterals == RUN_MASK && !ReadLength(in, inEnd, numLiterals)) { return false; }
+        if (numLiterals > static_cast<size_t>(inEnd - in) || numLiterals > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+        std::memcpy(out, in, numLiterals);
+        in += numLiterals;
+        out += numLiterals;
+        if (in == inEnd) { break; } // last sequence has no match
+
+        if (inEnd - in < 2) { return false; }
+        size_t offset = in[0] | (in[1] << 8U);
+        in += 2;
+        size_t matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK && !ReadLength(in, inEnd, matchLength)) { return false; }
+        matchLength += MIN_MATCH;
+        if (offset == 0U || offset > static_cast<size_t>(out - destination.data)
+            || matchLength > static_cast<size_t>(outEnd - out)) {
+            return false;
+        }
+
+        // NOTE: match may overlap the bytes it produces (offset < length repeats a pattern), copy byte by byte then
+        uint8_t const* match = out - offset;
+        if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) { *out++ = *match++; }
+        }
+    }
+    return out == outEnd;
+}
+
+} // namespace engine
@@ -0,0 +1,326 @@
+#include "engine/MipGeneration.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+using engine::MipFilter;
+using engine::MipGenerationArgs;
+using engine::MipPixelType;
+using engine::private_::F4;
+
+constexpr float PI                   = 3.14159265358979f;
+constexpr float KAISER_ALPHA         = 4.0f;
+constexpr float WINDOWED_SINC_RADIUS = 3.0f;
+constexpr size_t ROWS_CHUNK          = 16U;
+constexpr int32_t LINEAR_TO_SRGB_LUT = 8192;
+
+auto SrgbToLinear [[nodiscard]] (float value) -> float {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+auto LinearToSrgb [[nodiscard]] (float value) -> float {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// NOTE: tables keep conversions cheap and deterministic, pow() is only used to build them
+auto SrgbDecodeTable [[nodiscard]] () -> std::array<float, 256> const& {
+    static std::array<float, 256> const table = [] {
+        std::array<float, 256> t{};
+        for (int32_t i = 0; i < 256; ++i) { t[i] = SrgbToLinear(float(i) / 255.0f); }
+        return t;
+    }();
+    return table;
+}
+
+auto SrgbEncodeTable [[nodiscard]] () -> std::array<uint8_t, LINEAR_TO_SRGB_LUT + 1> const& {
+    static std::array<uint8_t, LINEAR_TO_SRGB_LUT + 1> const table = [] {
+        std::array<uint8_t, LINEAR_TO_SRGB_LUT + 1> t{};
+        for (int32_t i = 0; i <= LINEAR_TO_SRGB_LUT; ++i) {
+            t[i] = static_cast<uint8_t>(std::lround(LinearToSrgb(float(i) / LINEAR_TO_SRGB_LUT) * 255.0f));
+        }
+        return t;
+    }();
+    return table;
+}
+
+auto Sinc [[nodiscard]] (float x) -> float {
+    if (std::abs(x) < 1e-6f) { return 1.0f; }
+    x *= PI;
+    return std::sin(x) / x;
+}
+
+auto BesselI0 [[nodiscard]] (float x) -> float {
+    float sum = 1.0f, term = 1.0f;
+    for (int32_t k = 1; k < 32; ++k) {
+        float factor = x / (2.0f * float(k));
+        term *= factor * factor;
+        sum += term;
+        if (term < sum * 1e-8f) { break; }
+    }
+    return sum;
+}
+
+// Radius in destination pixels
+auto FilterRadius [[nodiscard]] (MipFilter filter) -> float {
+    return filter == MipFilter::BOX ? 0.5f : WINDOWED_SINC_RADIUS;
+}
+
+auto FilterWeight [[nodiscard]] (MipFilter filter, float t) -> float {
+    t = std::abs(t);
+    switch (filter) {
+    case MipFilter::BOX:
+        return t <= 0.5f ? 1.0f : 0.0f;
+    case MipFilter::KAISER: {
+        if (t >= WINDOWED_SINC_RADIUS) { return 0.0f; }
+        float x = t / WINDOWED_SINC_RADIUS;
+        return Sinc(t) * BesselI0(KAISER_ALPHA * std::sqrt(1.0f - x * x)) / BesselI0(KAISER_ALPHA);
+    }
+    case MipFilter::LANCZOS:
+        return t >= WINDOWED_SINC_RADIUS ? 0.0f : Sinc(t) * Sinc(t / WINDOWED_SINC_RADIUS);
+    }
+    return 0.0f;
+}
+
+// Precomputed normalized weights of a 1D resampling, source indices are clamped to the edge
+// NOTE: destination pixels are interleaved in groups of 4, so tap k of a group is one F4 (see Index)
+struct FilterTaps {
+    int32_t numTaps              = 0; // per destination pixel, unused taps have zero weight
+    std::vector<int32_t> sources = {};
+    std::vector<float> weights   = {};
+
+    auto Index [[nodiscard]] (int32_t dst, int32_t k) const -> size_t {
+        return (static_cast<size_t>(dst / 4) * numTaps + k) * 4U + dst % 4;
+    }
+};
+
+auto ComputeFilterTaps [[nodiscard]] (MipFilter filter, int32_t srcSize, int32_t dstSize) -> FilterTaps {
+    float scale  = float(srcSize) / float(dstSize);
+    float radius = FilterRadius(filter) * scale;
+
+    FilterTaps taps{};
+    taps.numTaps = static_cast<int32_t>(std::ceil(2.0f * radius)) + 1;
+    // NOTE: the last group is padded with zero weights of source 0
+    size_t numGroups = static_cast<size_t>(dstSize + 3) / 4U;
+    taps.sources.resize(numGroups * taps.numTaps * 4U, 0);
+    taps.weights.resize(numGroups * taps.numTaps * 4U, 0.0f);
+    for (int32_t dst = 0; dst < dstSize; ++dst) {
+        float center  = (float(dst) + 0.5f) * scale;
+        int32_t first = static_cast<int32_t>(std::floor(center - radius));
+        float sum     = 0.0f;
+        for (int32_t k = 0; k < taps.numTaps; ++k) {
+            int32_t src       = first + k;
+            size_t tap        = taps.Index(dst, k);
+            taps.sources[tap] = std::clamp(src, 0, srcSize - 1);
+            taps.weights[tap] = FilterWeight(filter, (float(src) + 0.5f - center) / scale);
+            sum += taps.weights[tap];
+        }
+        if (std::abs(sum) < 1e-6f) {
+            // NOTE: shouldn't happen with the filters above, fallback to the nearest pixel
+            for (int32_t k = 0; k < taps.numTaps; ++k) { taps.weights[taps.Index(dst, k)] = 0.0f; }
+            taps.sources[taps.Index(dst, 0)] = std::clamp(static_cast<int32_t>(center), 0, srcSize - 1);
+            taps.weights[taps.Index(dst, 0)] = 1.0f;
+            continue;
+        }
+        for (int32_t k = 0; k < taps.numTaps; ++k) { taps.weights[taps.Index(dst, k)] /= sum; }
+    }
+    return taps;
+}
+
+auto AlphaChannel [[nodiscard]] (int32_t numChannels) -> int32_t {
+    return (numChannels == 2 || numChannels == 4) ? numChannels - 1 : -1;
+}
+
+// Level 0 in linear float
+auto DecodeLevel [[nodiscard]] (MipGenerationArgs const& args) -> std::vector<float> {
+    size_t numValues = static_cast<size_t>(args.size.x) * args.size.y * args.numChannels;
+    std::vector<float> linear(numValues);
+    if (args.pixelType == MipPixelType::FLOAT32) {
+        std::memcpy(linear.data(), args.pixels, numValues * sizeof(float));
+        return linear;
+    }
+
+    auto const* source    = static_cast<uint8_t const*>(args.pixels);
+    auto const& srgbTable = SrgbDecodeTable();
+    int32_t alphaChannel  = AlphaChannel(args.numChannels);
+    size_t rowValues      = static_cast<size_t>(args.size.x) * args.numChannels;
+    engine::ParallelFor(args.size.y, ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        for (size_t i = rowsBegin * rowValues; i < rowsEnd * rowValues; ++i) {
+            bool isColor = args.isSrgb && static_cast<int32_t>(i % args.numChannels) != alphaChannel;
+            linear[i]    = isColor ? srgbTable[source[i]] : float(source[i]) * (1.0f / 255.0f);
+        }
+    });
+    return linear;
+}
+
+// Separable resampling: horizontal pass into a temporary image, then vertical pass
+auto Downsample [[nodiscard]] (
+    std::vector<float> const& source, glm::ivec2 srcSize, glm::ivec2 dstSize, int32_t numChannels, MipFilter filter)
+    -> std::vector<float> {
+    auto tapsX = ComputeFilterTaps(filter, srcSize.x, dstSize.x);
+    auto tapsY = ComputeFilterTaps(filter, srcSize.y, dstSize.y);
+
+    size_t srcRowValues = static_cast<size_t>(srcSize.x) * numChannels;
+    size_t dstRowValues = static_cast<size_t>(dstSize.x) * numChannels;
+    std::vector<float> horizontal(dstRowValues * srcSize.y);
+    engine::ParallelFor(srcSize.y, ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        for (size_t y = rowsBegin; y < rowsEnd; ++y) {
+            float const* srcRow = source.data() + y * srcRowValues;
+            float* dstRow       = horizontal.data() + y * dstRowValues;
+            // NOTE: a channel of 4 destination pixels per F4, sources are gathered, as pixels are interleaved
+            for (int32_t x = 0; x < dstSize.x; x += 4) {
+                int32_t numLanes = std::min(4, dstSize.x - x);
+                for (int32_t c = 0; c < numChannels; ++c) {
+                    F4 sum = F4::Set(0.0f);
+                    for (int32_t k = 0; k < tapsX.numTaps; ++k) {
+                        size_t tap   = tapsX.Index(x, k);
+                        F4 weights   = F4::Load(tapsX.weights.data() + tap);
+                        F4 srcValues = F4::Gather(srcRow + c, numChannels, tapsX.sources.data() + tap);
+                        sum          = sum + weights * srcValues;
+                    }
+                    float lanes[4];
+                    sum.Store(lanes);
+                    for (int32_t lane = 0; lane < numLanes; ++lane) {
+                        dstRow[(x + lane) * numChannels + c] = lanes[lane];
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<float> result(dstRowValues * dstSize.y, 0.0f);
+    size_t numVectorValues = dstRowValues / 4U * 4U;
+    engine::ParallelFor(dstSize.y, ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        for (size_t y = rowsBegin; y < rowsEnd; ++y) {
+            float* dstRow = result.data() + y * dstRowValues;
+            for (int32_t k = 0; k < tapsY.numTaps; ++k) {
+                size_t tap          = tapsY.Index(static_cast<int32_t>(y), k);
+                float weight        = tapsY.weights[tap];
+                float const* srcRow = horizontal.data() + tapsY.sources[tap] * dstRowValues;
+                // NOTE: contiguous multiply-add over the whole row, the hottest loop
+                size_t i = 0U;
+                for (; i < numVectorValues; i += 4U) {
+                    (F4::Load(dstRow + i) + F4::Set(weight) * F4::Load(srcRow + i)).Store(dstRow + i);
+                }
+                for (; i < dstRowValues; ++i) { dstRow[i] += weight * srcRow[i]; }
+            }
+        }
+    });
+    return result;
+}
+
+auto AlphaCoverage [[nodiscard]] (
+    std::vector<float> const& level, int32_t numChannels, float alphaScale, float reference) -> float {
+    int32_t alphaChannel = AlphaChannel(numChannels);
+    size_t numPixels     = level.size() / numChannels;
+    size_t numCovered    = 0U;
+    for (size_t i = 0; i < numPixels; ++i) {
+        numCovered += level[i * numChannels + alphaChannel] * alphaScale > reference ? 1U : 0U;
+    }
+    return float(numCovered) / float(numPixels);
+}
+
+// Binary search of alpha scale, which makes the level coverage closest to the target
+auto AlphaCoverageScale [[nodiscard]] (
+    std::vector<float> const& level, int32_t numChannels, float targetCoverage, float reference) -> float {
+    float minScale = 0.0f, maxScale = 4.0f;
+    for (int32_t iteration = 0; iteration < 12; ++iteration) {
+        float scale = 0.5f * (minScale + maxScale);
+        if (AlphaCoverage(level, numChannels, scale, reference) < targetCoverage) {
+            minScale = scale;
+        } else {
+            maxScale = scale;
+        }
+    }
+    return 0.5f * (minScale + maxScale);
+}
+
+auto EncodeLevel [[nodiscard]] (
+    MipGenerationArgs const& args, std::vector<float> const& linear, glm::ivec2 size, float alphaScale)
+    -> std::vector<uint8_t> {
+    int32_t alphaChannel = AlphaChannel(args.numChannels);
+    size_t rowValues     = static_cast<size_t>(size.x) * args.numChannels;
+    if (args.pixelType == MipPixelType::FLOAT32) {
+        std::vector<uint8_t> encoded(linear.size() * sizeof(float));
+        std::memcpy(encoded.data(), linear.data(), encoded.size());
+        if (alphaScale != 1.0f) {
+            auto* values = reinterpret_cast<float*>(encoded.data());
+            for (size_t i = alphaChannel; i < linear.size(); i += args.numChannels) {
+                values[i] = std::clamp(values[i] * alphaScale, 0.0f, 1.0f);
+            }
+        }
+        return encoded;
+    }
+
+    std::vector<uint8_t> encoded(linear.size());
+    auto const& srgbTable = SrgbEncodeTable();
+    engine::ParallelFor(size.y, ROWS_CHUNK, [&](size_t rowsBegin, size_t rowsEnd) {
+        for (size_t i = rowsBegin * rowValues; i < rowsEnd * rowValues; ++i) {
+            float value  = std::clamp(linear[i], 0.0f, 1.0f);
+            bool isAlpha = static_cast<int32_t>(i % args.numChannels) == alphaChannel;
+            if (isAlpha) {
+                encoded[i] = static_cast<uint8_t>(std::lround(std::min(value * alphaScale, 1.0f) * 255.0f));
+            } else if (args.isSrgb) {
+                encoded[i] = srgbTable[static_cast<size_t>(std::lround(value * LINEAR_TO_SRGB_LUT))];
+            } else {
+                encoded[i] = static_cast<uint8_t>(std::lround(value * 255.0f));
+            }
+        }
+    });
+    return encoded;
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto MipChainLength(glm::ivec2 size) -> int32_t {
+    int32_t maxSide   = std::max(size.x, size.y);
+    int32_t numLevels = 1;
+    while (maxSide > 1) {
+        maxSide >>= 1;
+        ++numLevels;
+    }
+    return numLevels;
+}
+
+ENGINE_EXPORT auto MipLevelSize(glm::ivec2 size, int32_t level) -> glm::ivec2 {
+    return glm::ivec2{std::max(1, size.x >> level), std::max(1, size.y >> level)};
+}
+
+ENGINE_EXPORT auto GenerateMips(MipGenerationArgs const& args) -> std::vector<std::vector<uint8_t>> {
+    assert(args.pixels != nullptr);
+    assert(args.numChannels >= 1 && args.numChannels <= 4);
+    int32_t maxNumLevels = MipChainLength(args.size);
+    int32_t numLevels    = args.numLevels > 0 ? std::min(args.numLevels, maxNumLevels) : maxNumLevels;
+    if (numLevels <= 1) { return {}; }
+
+    bool preserveCoverage = args.alphaCoverageReference >= 0.0f && AlphaChannel(args.numChannels) >= 0;
+    auto linear           = DecodeLevel(args);
+    float targetCoverage  = 0.0f;
+    if (preserveCoverage) {
+        targetCoverage = AlphaCoverage(linear, args.numChannels, 1.0f, args.alphaCoverageReference);
+    }
+
+    std::vector<std::vector<uint8_t>> levels{};
+    levels.reserve(numLevels - 1);
+    for (int32_t level = 1; level < numLevels; ++level) {
+        auto srcSize     = MipLevelSize(args.size, level - 1);
+        auto dstSize     = MipLevelSize(args.size, level);
+        linear           = Downsample(linear, srcSize, dstSize, args.numChannels, args.filter);
+        float alphaScale = 1.0f;
+        if (preserveCoverage) {
+            alphaScale = AlphaCoverageScale(linear, args.numChannels, targetCoverage, args.alphaCoverageReference);
+        }
+        levels.push_back(EncodeLevel(args, linear, dstSize, alphaScale));
+    }
+    return levels;
+}
+
+} // namespace engine
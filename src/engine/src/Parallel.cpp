@@ -0,0 +1,129 @@
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct ParallelJob {
+    engine::ParallelTask const* task = nullptr;
+    size_t numItems                  = 0U;
+    size_t itemsPerChunk             = 0U;
+    std::atomic<size_t> nextItem     = 0U;
+    int32_t numActiveWorkers         = 0; // guarded by WorkerPool::mutex_
+
+    auto HasItems [[nodiscard]] () const -> bool { return nextItem.load(std::memory_order_relaxed) < numItems; }
+    void Drain() {
+        while (true) {
+            size_t begin = nextItem.fetch_add(itemsPerChunk, std::memory_order_relaxed);
+            if (begin >= numItems) { return; }
+            (*task)(begin, std::min(begin + itemsPerChunk, numItems));
+        }
+    }
+};
+
+// Workers sleep until a job is submitted, then steal chunks of it until nothing is left
+class WorkerPool final {
+
+public:
+#define Self WorkerPool
+    explicit Self(int32_t numWorkers) noexcept {
+        workers_.reserve(numWorkers);
+        for (int32_t i = 0; i < numWorkers; ++i) { workers_.emplace_back([this] { WorkerLoop(); }); }
+    }
+    ~Self() noexcept {
+        {
+            std::lock_guard lock{mutex_};
+            isStopping_ = true;
+        }
+        jobSubmitted_.notify_all();
+        for (auto& worker : workers_) { worker.join(); }
+    }
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = delete;
+    Self& operator=(Self&&)      = delete;
+#undef Self
+
+    auto NumWorkers [[nodiscard]] () const -> int32_t { return static_cast<int32_t>(workers_.size()); }
+
+    void Run(ParallelJob& job) {
+        {
+            std::lock_guard lock{mutex_};
+            jobs_.push_back(&job);
+        }
+        jobSubmitted_.notify_all();
+        job.Drain();
+
+        std::unique_lock lock{mutex_};
+        // NOTE: after removal no worker can pick the job, wait for those that still process its chunks
+        std::erase(jobs_, &job);
+        jobFinished_.wait(lock, [&] { return job.numActiveWorkers == 0; });
+    }
+
+private:
+    void WorkerLoop() {
+        while (true) {
+            ParallelJob* job = nullptr;
+            {
+                std::unique_lock lock{mutex_};
+                jobSubmitted_.wait(lock, [&] {
+                    if (isStopping_) { return true; }
+                    auto found = std::find_if(jobs_.begin(), jobs_.end(), [](auto* j) { return j->HasItems(); });
+                    job        = found != jobs_.end() ? *found : nullptr;
+                    return job != nullptr;
+                });
+                if (isStopping_) { return; }
+                ++job->numActiveWorkers;
+            }
+            job->Drain();
+            {
+                std::lock_guard lock{mutex_};
+                --job->numActiveWorkers;
+            }
+            jobFinished_.notify_all();
+        }
+    }
+
+    std::mutex mutex_                     = {};
+    std::condition_variable jobSubmitted_ = {};
+    std::condition_variable jobFinished_  = {};
+    std::vector<ParallelJob*> jobs_       = {};
+    std::vector<std::thread> workers_     = {};
+    bool isStopping_                      = false;
+};
+
+auto GetWorkerPool [[nodiscard]] () -> WorkerPool& {
+    // NOTE: the calling thread is also a worker
+    static WorkerPool pool{std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1)};
+    return pool;
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto NumParallelThreads() -> int32_t { return GetWorkerPool().NumWorkers() + 1; }
+
+ENGINE_EXPORT void ParallelFor(size_t numItems, size_t itemsPerChunk, ParallelTask const& task) {
+    if (numItems == 0U) { return; }
+    itemsPerChunk = std::max<size_t>(itemsPerChunk, 1U);
+    // NOTE: not worth waking up the workers
+    if (numItems <= itemsPerChunk) {
+        task(0U, numItems);
+        return;
+    }
+
+    ParallelJob job{};
+    job.task          = &task;
+    job.numItems      = numItems;
+    job.itemsPerChunk = itemsPerChunk;
+    GetWorkerPool().Run(job);
+}
+
+} // namespace engine
@@ -0,0 +1,536 @@
+#include "engine/PointCloud.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+using Point = engine::PointCloud::Point;
+using Node  = engine::PointCloud::Node;
+using engine::CpuMemory;
+
+constexpr char CLOUD_MAGIC[8]       = {'X', 'P', 'C', 'L', 'O', 'U', 'D', 'S'};
+constexpr uint32_t CLOUD_VERSION    = 1U;
+constexpr uint64_t POINTS_ALIGNMENT = 64U;
+// NOTE: Morton codes have 21 bits per axis, a node at this depth can't be split further
+constexpr uint32_t MAX_DEPTH        = 21U;
+// NOTE: 8^6 cells, in which the source is counted to split it into buckets which fit the memory budget
+constexpr uint32_t HISTOGRAM_DEPTH  = 6U;
+constexpr size_t BUCKET_BUFFER_SIZE  = 4096U; // points
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numNodes;
+    uint64_t numPoints;
+    uint64_t pointsOffset;
+    uint32_t maxPointsPerNode;
+    uint32_t reserved;
+};
+static_assert(sizeof(Node) == 40U, "Node is written to file as is");
+
+struct SortKey {
+    uint64_t mortonCode;
+    uint64_t pointIdx;
+};
+// NOTE: loaded points, their sort keys, the sorted copy and Morton codes, while a subtree is built in memory
+constexpr size_t BUILD_BYTES_PER_POINT = 2U * sizeof(Point) + sizeof(SortKey) + sizeof(uint64_t);
+
+auto AlignUp [[nodiscard]] (uint64_t value, uint64_t alignment) -> uint64_t {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+
+// Spreads 21 bits, so there are 2 zero bits between each of them
+auto SpreadBits3 [[nodiscard]] (uint64_t value) -> uint64_t {
+    value &= 0x1FFFFFULL;
+    value = (value | value << 32U) & 0x1F00000000FFFFULL;
+    value = (value | value << 16U) & 0x1F0000FF0000FFULL;
+    value = (value | value << 8U) & 0x100F00F00F00F00FULL;
+    value = (value | value << 4U) & 0x10C30C30C30C30C3ULL;
+    value = (value | value << 2U) & 0x1249249249249249ULL;
+    return value;
+}
+
+// Octant of a child is the 3 bits of the depth, x is the highest of them
+auto MortonCode [[nodiscard]] (glm::vec3 position, glm::vec3 boundsMin, float boundsSize) -> uint64_t {
+    constexpr float MAX_CELL = static_cast<float>((1U << MAX_DEPTH) - 1U);
+    glm::vec3 cell = glm::clamp((position - boundsMin) / boundsSize * (MAX_CELL + 1.0f), 0.0f, MAX_CELL);
+    return SpreadBits3(static_cast<uint64_t>(cell.x)) << 2U | SpreadBits3(static_cast<uint64_t>(cell.y)) << 1U
+        | SpreadBits3(static_cast<uint64_t>(cell.z));
+}
+
+auto Octant [[nodiscard]] (uint64_t mortonCode, uint32_t parentDepth) -> uint32_t {
+    return static_cast<uint32_t>(mortonCode >> (3U * (MAX_DEPTH - 1U - parentDepth))) & 0x7U;
+}
+
+auto AsPoints [[nodiscard]] (engine::platform::MappedFile const& file) -> CpuMemory<Point const> {
+    return CpuMemory<Point const>{reinterpret_cast<Point const*>(file.Data().data), file.NumBytes() / sizeof(Point)};
+}
+
+// Removes temporary files of a build, however it ends
+struct TempFiles {
+    std::vector<std::filesystem::path> paths = {};
+
+    ~TempFiles() {
+        std::error_code err;
+        for (auto const& path : paths) { std::filesystem::remove(path, err); }
+    }
+};
+
+// Input of a node, which subtree isn't built yet
+struct FileItem {
+    uint32_t nodeIdx                          = 0U;
+    std::vector<std::filesystem::path> inputs = {}; // concatenated, they are the points of the subtree
+    uint64_t numPoints                        = 0U;
+    bool isSorted                             = false; // otherwise each input is sorted on its own when read
+    bool isTemporary                          = false; // inputs are removed after they are consumed
+};
+
+// Builds the tree out of core: a subtree which fits the memory budget is loaded and built at once, a bigger node
+// streams its Morton ordered points, keeps its subsample and writes the rest into a temporary file per child.
+// The source itself is first distributed into buckets of Morton order, each of them fits the budget to be sorted
+class CloudBuilder final {
+
+public:
+#define Self CloudBuilder
+    explicit Self(std::filesystem::path const& cloudPath, uint32_t maxPointsPerNode, uint64_t maxLoadedPoints) noexcept
+        : cloudPath_(cloudPath)
+        , maxPointsPerNode_(maxPointsPerNode)
+        , maxLoadedPoints_(maxLoadedPoints) { }
+    ~Self() noexcept             = default;
+    Self(Self const&)            = delete;
+    Self& operator=(Self const&) = delete;
+    Self(Self&&)                 = delete;
+    Self& operator=(Self&&)      = delete;
+#undef Self
+
+    auto Build [[nodiscard]] (std::string_view rawPointsFilepath) -> bool {
+        auto source = engine::platform::MappedFile::Map(rawPointsFilepath);
+        if (!source) { return false; }
+        if (source->NumBytes() % sizeof(Point) != 0U) {
+            XLOGW("Raw point cloud size isn't a multiple of a point, the tail is ignored: {}", rawPointsFilepath);
+        }
+        auto points = AsPoints(*source);
+        if (points.NumElements() == 0U) {
+            XLOGE("Raw point cloud is empty: {}", rawPointsFilepath);
+            return false;
+        }
+
+        glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+        glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+        for (Point const* point = points.Begin(); point != points.End(); ++point) {
+            boundsMin = glm::min(boundsMin, point->position);
+            boundsMax = glm::max(boundsMax, point->position);
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        boundsMin_       = boundsMin;
+        boundsSize_      = std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-6f));
+
+        auto pointsPath = TempPath(".points.tmp");
+        output_.open(pointsPath, std::ios::binary | std::ios::trunc);
+        if (!output_) {
+            XLOGE("Failed to open temporary file: {}", pointsPath.string());
+            return false;
+        }
+
+        nodes_.push_back(Node{.boundsMin = boundsMin_, .size = boundsSize_});
+        FileItem root{.nodeIdx = 0U, .numPoints = points.NumElements()};
+        if (root.numPoints <= maxLoadedPoints_) {
+            root.inputs.emplace_back(rawPointsFilepath);
+        } else if (!DistributeIntoBuckets(points, root)) {
+            return false;
+        }
+        source.reset();
+
+        queue_.push_back(std::move(root));
+        // NOTE: children of a node are created together, so they are adjacent wherever their subtrees are built
+        for (size_t head = 0; head < queue_.size(); ++head) {
+            auto item = std::move(queue_[head]);
+            bool isOk = item.numPoints <= maxLoadedPoints_ ? BuildLoaded(item) : SplitStreamed(item);
+            if (!isOk) { return false; }
+            if (item.isTemporary) {
+                std::error_code err;
+                for (auto const& input : item.inputs) { std::filesystem::remove(input, err); }
+            }
+        }
+        output_.close();
+        if (!output_) {
+            XLOGE("Failed to write temporary file: {}", pointsPath.string());
+            return false;
+        }
+        return WriteCloud(pointsPath);
+    }
+
+private:
+    auto TempPath [[nodiscard]] (std::string_view suffix) -> std::filesystem::path {
+        auto path = cloudPath_;
+        path += suffix;
+        tempFiles_.paths.push_back(path);
+        return path;
+    }
+
+    auto Code [[nodiscard]] (Point const& point) const -> uint64_t {
+        return MortonCode(point.position, boundsMin_, boundsSize_);
+    }
+
+    void SortByCode(std::vector<Point>& points) const {
+        std::vector<SortKey> keys(points.size());
+        for (size_t i = 0; i < points.size(); ++i) { keys[i] = SortKey{.mortonCode = Code(points[i]), .pointIdx = i}; }
+        std::sort(keys.begin(), keys.end(), [](SortKey const& a, SortKey const& b) {
+            return a.mortonCode < b.mortonCode;
+        });
+        std::vector<Point> sorted(points.size());
+        for (size_t i = 0; i < keys.size(); ++i) { sorted[i] = points[keys[i].pointIdx]; }
+        points = std::move(sorted);
+    }
+
+    void WritePoints(Point const* points, size_t numPoints) {
+        output_.write(reinterpret_cast<char const*>(points), numPoints * sizeof(Point));
+        numWrittenPoints_ += numPoints;
+    }
+
+    // Splits the source by cells of the histogram depth, consecutive cells are grouped up to the budget
+    auto DistributeIntoBuckets [[nodiscard]] (CpuMemory<Point const> points, FileItem& root) -> bool {
+        constexpr uint32_t cellShift = 3U * (MAX_DEPTH - HISTOGRAM_DEPTH);
+        std::vector<uint64_t> cellCounts(size_t{1} << (3U * HISTOGRAM_DEPTH), 0U);
+        for (Point const* point = points.Begin(); point != points.End(); ++point) {
+            ++cellCounts[Code(*point) >> cellShift];
+        }
+
+        std::vector<uint32_t> cellBuckets(cellCounts.size());
+        std::vector<uint64_t> bucketSizes{0U};
+        for (size_t cell = 0; cell < cellCounts.size(); ++cell) {
+            if (cellCounts[cell] > maxLoadedPoints_) {
+                XLOGE(
+                    "Point cloud is too dense for the memory budget, {} points are in 1/{} of the bounds, the budget "
+                    "fits {} points",
+                    cellCounts[cell], cellCounts.size(), maxLoadedPoints_);
+                return false;
+            }
+            if (bucketSizes.back() + cellCounts[cell] > maxLoadedPoints_) { bucketSizes.push_back(0U); }
+            bucketSizes.back() += cellCounts[cell];
+            cellBuckets[cell] = static_cast<uint32_t>(bucketSizes.size() - 1U);
+        }
+
+        for (size_t bucket = 0; bucket < bucketSizes.size(); ++bucket) {
+            root.inputs.push_back(TempPath(".bucket" + std::to_string(bucket) + ".tmp"));
+        }
+        root.isTemporary = true;
+        XLOG("Point cloud doesn't fit the memory budget, it's sorted in {} buckets", bucketSizes.size());
+
+        // NOTE: buffered, so the number of buckets isn't limited by the number of open files
+        std::vector<std::vector<Point>> buffers(bucketSizes.size());
+        auto flush = [&](size_t bucket) {
+            std::ofstream file{root.inputs[bucket], std::ios::binary | std::ios::app};
+            file.write(
+                reinterpret_cast<char const*>(buffers[bucket].data()), buffers[bucket].size() * sizeof(Point));
+            buffers[bucket].clear();
+            return static_cast<bool>(file);
+        };
+        for (Point const* point = points.Begin(); point != points.End(); ++point) {
+            uint32_t bucket = cellBuckets[Code(*point) >> cellShift];
+            buffers[bucket].push_back(*point);
+            if (buffers[bucket].size() == BUCKET_BUFFER_SIZE && !flush(bucket)) {
+                XLOGE("Failed to write temporary file: {}", root.inputs[bucket].string());
+                return false;
+            }
+        }
+        for (size_t bucket = 0; bucket < buffers.size(); ++bucket) {
+            if (!buffers[bucket].empty() && !flush(bucket)) {
+                XLOGE("Failed to write temporary file: {}", root.inputs[bucket].string());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto BuildLoaded [[nodiscard]] (FileItem const& item) -> bool {
+        std::vector<Point> points;
+        points.reserve(item.numPoints);
+        for (auto const& input : item.inputs) {
+            auto file = engine::platform::MappedFile::Map(input.string());
+            if (!file) { return false; }
+            auto inputPoints = AsPoints(*file);
+            size_t numPoints = std::min<size_t>(inputPoints.NumElements(), item.numPoints - points.size());
+            points.insert(points.end(), inputPoints.Begin(), inputPoints.Begin() + numPoints);
+        }
+        if (!item.isSorted) { SortByCode(points); }
+        std::vector<uint64_t> codes(points.size());
+        for (size_t i = 0; i < points.size(); ++i) { codes[i] = Code(points[i]); }
+        BuildSubtree(points, codes, item.nodeIdx);
+        return true;
+    }
+
+    // Builds the whole subtree of a node from its points in Morton order
+    void BuildSubtree(std::vector<Point>& points, std::vector<uint64_t>& codes, uint32_t rootNodeIdx) {
+        struct BuildItem {
+            uint32_t nodeIdx;
+            size_t begin;
+            size_t end;
+        };
+        std::vector<BuildItem> queue{BuildItem{.nodeIdx = rootNodeIdx, .begin = 0U, .end = points.size()}};
+        std::vector<Point> kept;
+        kept.reserve(maxPointsPerNode_);
+
+        // breadth first, so coarse nodes of the subtree are at the start of its points
+        for (size_t head = 0; head < queue.size(); ++head) {
+            auto item        = queue[head];
+            size_t numPoints = item.end - item.begin;
+            Node node        = nodes_[item.nodeIdx];
+            node.firstPoint  = numWrittenPoints_;
+            if (numPoints <= maxPointsPerNode_ || node.depth >= MAX_DEPTH) {
+                if (numPoints > maxPointsPerNode_) {
+                    XLOGW(
+                        "Point cloud node at max depth is too dense, {} points are dropped",
+                        numPoints - maxPointsPerNode_);
+                    numPoints = maxPointsPerNode_;
+                }
+                WritePoints(points.data() + item.begin, numPoints);
+                node.numPoints       = static_cast<uint32_t>(numPoints);
+                nodes_[item.nodeIdx] = node;
+                continue;
+            }
+
+            // NOTE: every k-th point of Morton order is spread evenly over the node, the rest stays sorted for children
+            size_t numLeft = 0U;
+            kept.clear();
+            for (size_t i = 0; i < numPoints; ++i) {
+                size_t srcIdx = item.begin + i;
+                if (kept.size() < maxPointsPerNode_ && i == kept.size() * numPoints / maxPointsPerNode_) {
+                    kept.push_back(points[srcIdx]);
+                    continue;
+                }
+                points[item.begin + numLeft] = points[srcIdx];
+                codes[item.begin + numLeft]  = codes[srcIdx];
+                ++numLeft;
+            }
+            WritePoints(kept.data(), kept.size());
+            node.numPoints  = static_cast<uint32_t>(kept.size());
+            node.firstChild = static_cast<uint32_t>(nodes_.size());
+
+            size_t childBegin  = item.begin;
+            size_t childrenEnd = item.begin + numLeft;
+            while (childBegin < childrenEnd) {
+                uint32_t octant = Octant(codes[childBegin], node.depth);
+                size_t childEnd = childBegin;
+                while (childEnd < childrenEnd && Octant(codes[childEnd], node.depth) == octant) { ++childEnd; }
+                queue.push_back(BuildItem{.nodeIdx = AddChild(node, octant), .begin = childBegin, .end = childEnd});
+                childBegin = childEnd;
+            }
+            nodes_[item.nodeIdx] = node;
+        }
+    }
+
+    // Streams the points of a node too big to be loaded, its children are written into temporary files
+    auto SplitStreamed [[nodiscard]] (FileItem const& item) -> bool {
+        Node node       = nodes_[item.nodeIdx];
+        node.firstPoint = numWrittenPoints_;
+        std::vector<Point> kept;
+        kept.reserve(maxPointsPerNode_);
+        std::ofstream children[8];
+        std::filesystem::path childPaths[8] = {};
+        uint64_t childNumPoints[8]          = {};
+        uint64_t pointIdx                   = 0U;
+        uint64_t numDropped                 = 0U;
+        for (auto const& input : item.inputs) {
+            auto file = engine::platform::MappedFile::Map(input.string());
+            if (!file) { return false; }
+            auto inputPoints = AsPoints(*file);
+            std::vector<Point> sorted;
+            if (!item.isSorted) {
+                // NOTE: a bucket fits the budget, the items are never unsorted otherwise
+                sorted.assign(inputPoints.Begin(), inputPoints.End());
+                SortByCode(sorted);
+                inputPoints = CpuMemory<Point const>{sorted.data(), sorted.size()};
+            }
+            size_t numPoints = std::min<size_t>(inputPoints.NumElements(), item.numPoints - pointIdx);
+            for (size_t i = 0; i < numPoints; ++i, ++pointIdx) {
+                auto const& point = inputPoints.Begin()[i];
+                if (kept.size() < maxPointsPerNode_ && pointIdx == kept.size() * item.numPoints / maxPointsPerNode_) {
+                    kept.push_back(point);
+                    continue;
+                }
+                if (node.depth >= MAX_DEPTH) {
+                    ++numDropped;
+                    continue;
+                }
+                uint32_t octant = Octant(Code(point), node.depth);
+                if (childPaths[octant].empty()) {
+                    auto suffix        = ".node" + std::to_string(item.nodeIdx) + "_" + std::to_string(octant) + ".tmp";
+                    childPaths[octant] = TempPath(suffix);
+                    children[octant].open(childPaths[octant], std::ios::binary | std::ios::trunc);
+                }
+                children[octant].write(reinterpret_cast<char const*>(&point), sizeof(Point));
+                ++childNumPoints[octant];
+            }
+        }
+        if (numDropped > 0U) { XLOGW("Point cloud node at max depth is too dense, {} points are dropped", numDropped); }
+
+        WritePoints(kept.data(), kept.size());
+        node.numPoints  = static_cast<uint32_t>(kept.size());
+        node.firstChild = static_cast<uint32_t>(nodes_.size());
+        for (uint32_t octant = 0; octant < 8U; ++octant) {
+            if (childPaths[octant].empty()) { continue; }
+            children[octant].close();
+            if (!children[octant]) {
+                XLOGE("Failed to write temporary file: {}", childPaths[octant].string());
+                return false;
+            }
+            queue_.push_back(FileItem{
+                .nodeIdx     = AddChild(node, octant),
+                .inputs      = {childPaths[octant]},
+                .numPoints   = childNumPoints[octant],
+                .isSorted    = true,
+                .isTemporary = true,
+            });
+        }
+        nodes_[item.nodeIdx] = node;
+        return true;
+    }
+
+    auto AddChild [[nodiscard]] (Node& parent, uint32_t octant) -> uint32_t {
+        float childSize = parent.size * 0.5f;
+        auto offset     = glm::vec3((octant >> 2U) & 1U, (octant >> 1U) & 1U, octant & 1U) * childSize;
+        nodes_.push_back(Node{.boundsMin = parent.boundsMin + offset, .size = childSize, .depth = parent.depth + 1U});
+        ++parent.numChildren;
+        return static_cast<uint32_t>(nodes_.size() - 1U);
+    }
+
+    auto WriteCloud [[nodiscard]] (std::filesystem::path const& pointsPath) -> bool {
+        FileHeader header{
+            .version          = CLOUD_VERSION,
+            .numNodes         = static_cast<uint32_t>(nodes_.size()),
+            .numPoints        = numWrittenPoints_,
+            .pointsOffset     = AlignUp(sizeof(FileHeader) + nodes_.size() * sizeof(Node), POINTS_ALIGNMENT),
+            .maxPointsPerNode = maxPointsPerNode_,
+        };
+        std::memcpy(header.magic, CLOUD_MAGIC, sizeof(CLOUD_MAGIC));
+
+        auto points = engine::platform::MappedFile::Map(pointsPath.string());
+        if (!points) { return false; }
+        auto tmpPath = TempPath(".tmp");
+        {
+            std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+            if (!file) {
+                XLOGE("Failed to open point cloud for writing: {}", tmpPath.string());
+                return false;
+            }
+            constexpr char padding[POINTS_ALIGNMENT] = {};
+            size_t nodesEnd                          = sizeof(FileHeader) + nodes_.size() * sizeof(Node);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            file.write(reinterpret_cast<char const*>(nodes_.data()), nodes_.size() * sizeof(Node));
+            file.write(padding, header.pointsOffset - nodesEnd);
+            file.write(reinterpret_cast<char const*>(points->Data().data), points->NumBytes());
+            if (!file) {
+                XLOGE("Failed to write point cloud: {}", tmpPath.string());
+                return false;
+            }
+        }
+
+        std::error_code err;
+        std::filesystem::rename(tmpPath, cloudPath_, err);
+        if (err) {
+            XLOGE("Failed to move point cloud into place: {} ({})", cloudPath_.string(), err.message());
+            return false;
+        }
+        XLOG("Wrote point cloud: {} ({} points, {} nodes)", cloudPath_.string(), numWrittenPoints_, nodes_.size());
+        return true;
+    }
+
+    // NOTE: the first member, so files are removed after all of them are closed
+    TempFiles tempFiles_             = {};
+    std::filesystem::path cloudPath_ = {};
+    uint32_t maxPointsPerNode_       = 0U;
+    uint64_t maxLoadedPoints_        = 0U;
+    glm::vec3 boundsMin_             = glm::vec3{0.0f};
+    float boundsSize_                = 0.0f;
+    std::vector<Node> nodes_         = {};
+    std::vector<FileItem> queue_     = {};
+    std::ofstream output_            = {};
+    uint64_t numWrittenPoints_       = 0U;
+};
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto PointCloud::Open(std::string_view filepath) -> std::optional<PointCloud> {
+    std::error_code err;
+    if (!std::filesystem::exists(filepath, err)) { return std::nullopt; }
+
+    // NOTE: nodes are read in the order of camera movement, reading ahead the whole file would only evict pages
+    auto mappedFile = platform::MappedFile::Map(filepath, /*willReadWhole*/ false);
+    if (!mappedFile) { return std::nullopt; }
+    auto fileData = mappedFile->Data();
+
+    FileHeader header;
+    if (fileData.NumBytes() < sizeof(header)) {
+        XLOGW("Point cloud is truncated: {}", filepath);
+        return std::nullopt;
+    }
+    std::memcpy(&header, fileData.data, sizeof(header));
+    if (std::memcmp(header.magic, CLOUD_MAGIC, sizeof(CLOUD_MAGIC)) != 0 || header.version != CLOUD_VERSION) {
+        XLOGW("Point cloud has unknown format or version: {}", filepath);
+        return std::nullopt;
+    }
+
+    size_t nodesEnd = sizeof(FileHeader) + static_cast<size_t>(header.numNodes) * sizeof(Node);
+    if (header.numNodes == 0U || fileData.NumBytes() < nodesEnd || header.pointsOffset < nodesEnd
+        || header.pointsOffset > fileData.NumBytes()
+        || header.numPoints > (fileData.NumBytes() - header.pointsOffset) / sizeof(Point)) {
+        XLOGW("Point cloud is truncated: {}", filepath);
+        return std::nullopt;
+    }
+
+    PointCloud cloud{};
+    cloud.nodes_.resize(header.numNodes);
+    std::memcpy(cloud.nodes_.data(), fileData.data + sizeof(FileHeader), header.numNodes * sizeof(Node));
+    // NOTE: the tree is validated once here, so traversal doesn't need bounds checks
+    for (uint32_t i = 0; i < header.numNodes; ++i) {
+        auto const& node = cloud.nodes_[i];
+        if (node.firstPoint > header.numPoints || node.numPoints > header.numPoints - node.firstPoint
+            || node.numPoints > header.maxPointsPerNode
+            || (node.numChildren > 0U && (node.firstChild <= i || node.firstChild > header.numNodes
+                                          || node.numChildren > header.numNodes - node.firstChild))) {
+            XLOGW("Point cloud has invalid node {}: {}", i, filepath);
+            return std::nullopt;
+        }
+    }
+
+    cloud.file_             = std::move(*mappedFile);
+    cloud.filepath_         = std::string{filepath};
+    cloud.pointsOffset_     = header.pointsOffset;
+    cloud.numPoints_        = header.numPoints;
+    cloud.maxPointsPerNode_ = header.maxPointsPerNode;
+    XLOG("Opened point cloud: {} ({} points, {} nodes)", filepath, cloud.numPoints_, cloud.nodes_.size());
+    return cloud;
+}
+
+ENGINE_EXPORT auto PointCloud::Build(
+    std::string_view filepath, std::string_view rawPointsFilepath, uint32_t maxPointsPerNode, size_t maxMemoryBytes)
+    -> bool {
+    namespace fs = std::filesystem;
+    assert(maxPointsPerNode > 0U && "Bad call to PointCloud::Build, nodes must have points");
+    assert(
+        maxMemoryBytes >= maxPointsPerNode * BUILD_BYTES_PER_POINT
+        && "Bad call to PointCloud::Build, memory budget must fit a node");
+
+    std::error_code err;
+    auto cloudPath = fs::path{filepath};
+    if (cloudPath.has_parent_path()) { fs::create_directories(cloudPath.parent_path(), err); }
+    auto builder = CloudBuilder{cloudPath, maxPointsPerNode, maxMemoryBytes / BUILD_BYTES_PER_POINT};
+    return builder.Build(rawPointsFilepath);
+}
+
+ENGINE_EXPORT auto PointCloud::NodePoints(uint32_t nodeIdx) const -> CpuMemory<Point const> {
+    auto const& node = nodes_[nodeIdx];
+    return CpuMemory<Point const>{
+        reinterpret_cast<Point const*>(file_.Data().data), node.numPoints,
+        static_cast<ptrdiff_t>(pointsOffset_ + node.firstPoint * sizeof(Point))};
+}
+
+} // namespace engine
@@ -2,20 +2,33 @@
 
 #include "engine_private/Prelude.hpp"
 
+#include <glm/gtc/packing.hpp>
+
 namespace engine {
 
 ENGINE_EXPORT PointRendererInput::PointRendererInput(size_t maxPoints) noexcept
     : maxPoints_(maxPoints) {
-    points_.reserve(maxPoints_);
+    // NOTE: matrix points are expected to be rare, their storage grows on demand
+    compactPoints_.reserve(maxPoints_);
     Clear();
 }
 
 ENGINE_EXPORT void PointRendererInput::Clear() {
     points_.clear();
+    compactPoints_.clear();
     currentColor_ = ColorCode::WHITE;
     isDirty_      = false;
 }
 
+ENGINE_EXPORT auto PointRendererInput::MakeCompactPoint(glm::vec3 worldPosition, float scale, ColorCode color)
+    -> CompactPoint {
+    return CompactPoint{
+        .position  = worldPosition,
+        .halfScale = glm::packHalf1x16(scale),
+        .colorIdx  = static_cast<uint16_t>(color),
+    };
+}
+
 ENGINE_EXPORT void PointRendererInput::SetColor(ColorCode color) { currentColor_ = color; }
 
 ENGINE_EXPORT void PointRendererInput::PushPoint(glm::vec3 worldPosition, float scale) {
@@ -23,7 +36,11 @@ ENGINE_EXPORT void PointRendererInput::PushPoint(glm::vec3 worldPosition, float
 }
 
 ENGINE_EXPORT void PointRendererInput::PushPoint(glm::vec3 worldPosition, float scale, ColorCode color) {
-    PushPoint(glm::scale(glm::translate(glm::mat4{1.0f}, worldPosition), glm::vec3{scale}), color);
+    if (std::size(compactPoints_) >= maxPoints_) {
+        XLOGW("PointRendererInput too many points are pushed {}", std::size(compactPoints_));
+    }
+    compactPoints_.push_back(MakeCompactPoint(worldPosition, scale, color));
+    isDirty_ = true;
 }
 
 ENGINE_EXPORT void PointRendererInput::PushPoint(glm::mat4 const& transformToWorld, ColorCode color) {
@@ -37,4 +54,16 @@ ENGINE_EXPORT void PointRendererInput::PushPoint(glm::mat4 const& transformToWor
     isDirty_ = true;
 }
 
+ENGINE_EXPORT void PointRendererInput::PushPoints(CpuView<Point const> points) {
+    if (points.Begin() == points.End()) { return; }
+    points_.insert(points_.end(), points.Begin(), points.End());
+    isDirty_ = true;
+}
+
+ENGINE_EXPORT void PointRendererInput::PushPoints(CpuView<CompactPoint const> points) {
+    if (points.Begin() == points.End()) { return; }
+    compactPoints_.insert(compactPoints_.end(), points.Begin(), points.End());
+    isDirty_ = true;
+}
+
 } // namespace engine
@@ -0,0 +1,194 @@
+#include "engine/Skinning.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Float4.hpp"
+#include "engine_private/Prelude.hpp"
+
+namespace {
+
+using engine::private_::F4;
+using engine::private_::F4x3;
+
+constexpr size_t LANES                 = 4U;
+constexpr size_t BLOCKS_PER_CHUNK      = 512U;
+constexpr size_t MIN_VERTICES_PARALLEL = 16U * 1024U; // smaller meshes are skinned by the calling thread
+
+// Writes lanes of the block which are real vertices
+void StoreBlock(F4x3 const& values, engine::CpuView<glm::vec3> destination, size_t first, size_t numVertices) {
+    alignas(16) float x[LANES];
+    alignas(16) float y[LANES];
+    alignas(16) float z[LANES];
+    values.x.Store(x);
+    values.y.Store(y);
+    values.z.Store(z);
+    for (size_t lane = 0; lane < LANES && first + lane < numVertices; ++lane) {
+        *reinterpret_cast<glm::vec3*>(destination.data + (first + lane) * destination.byteStride) =
+            glm::vec3{x[lane], y[lane], z[lane]};
+    }
+}
+
+void RunBlocks(size_t numVertices, std::function<void(size_t blocksBegin, size_t blocksEnd)> const& kernel) {
+    size_t numBlocks = (numVertices + LANES - 1U) / LANES;
+    if (numVertices < MIN_VERTICES_PARALLEL) {
+        kernel(0U, numBlocks);
+        return;
+    }
+    engine::ParallelFor(numBlocks, BLOCKS_PER_CHUNK, kernel);
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT void SkinnedVertices::Push(glm::vec3 position, glm::vec3 normal, glm::uvec4 joints, glm::vec4 weights) {
+    size_t vertexIdx = numVertices_;
+    ++numVertices_;
+    size_t numPadded = (numVertices_ + LANES - 1U) / LANES * LANES;
+    if (numPadded > positionX_.size()) {
+        for (auto* values : {&positionX_, &positionY_, &positionZ_, &normalX_, &normalY_, &normalZ_}) {
+            values->resize(numPadded, 0.0f);
+        }
+        for (uint32_t k = 0; k < MAX_INFLUENCES; ++k) {
+            joints_[k].resize(numPadded, 0U);
+            weights_[k].resize(numPadded, 0.0f);
+        }
+    }
+    positionX_[vertexIdx] = position.x;
+    positionY_[vertexIdx] = position.y;
+    positionZ_[vertexIdx] = position.z;
+    normalX_[vertexIdx]   = normal.x;
+    normalY_[vertexIdx]   = normal.y;
+    normalZ_[vertexIdx]   = normal.z;
+    for (uint32_t k = 0; k < MAX_INFLUENCES; ++k) {
+        assert(joints[k] <= std::numeric_limits<uint16_t>::max());
+        joints_[k][vertexIdx]  = static_cast<uint16_t>(joints[k]);
+        weights_[k][vertexIdx] = weights[k];
+    }
+}
+
+ENGINE_EXPORT void SkinnedVertices::Clear() {
+    for (auto* values : {&positionX_, &positionY_, &positionZ_, &normalX_, &normalY_, &normalZ_}) { values->clear(); }
+    for (uint32_t k = 0; k < MAX_INFLUENCES; ++k) {
+        joints_[k].clear();
+        weights_[k].clear();
+    }
+    numVertices_ = 0U;
+}
+
+ENGINE_EXPORT void SkinnedVertices::SkinLinearBlend(
+    CpuView<glm::mat4 const> jointMatrices, CpuView<glm::vec3> positions, CpuView<glm::vec3> normals) const {
+    assert(jointMatrices.IsContiguous() && "Bad call to SkinLinearBlend, joint matrices are gathered by index");
+    assert(positions.NumElements() >= numVertices_);
+    assert(!normals || normals.NumElements() >= numVertices_);
+    auto const* joints = reinterpret_cast<float const*>(jointMatrices.Begin());
+    constexpr size_t MATRIX_STRIDE = 16U;
+
+    RunBlocks(numVertices_, [&](size_t blocksBegin, size_t blocksEnd) {
+        for (size_t block = blocksBegin; block < blocksEnd; ++block) {
+            size_t const first = block * LANES;
+            // affine part of the blended matrix, column major: 4 columns of xyz
+            F4 m[12];
+            for (auto& value : m) { value = F4::Set(0.0f); }
+            for (uint32_t k = 0; k < MAX_INFLUENCES; ++k) {
+                F4 weight           = F4::Load(weights_[k].data() + first);
+                uint16_t const* idx = joints_[k].data() + first;
+                for (size_t column = 0; column < 4U; ++column) {
+                    for (size_t row = 0; row < 3U; ++row) {
+                        m[column * 3U + row] = m[column * 3U + row]
+                            + weight * F4::Gather(joints + column * 4U + row, MATRIX_STRIDE, idx);
+                    }
+                }
+            }
+
+            F4 const px = F4::Load(positionX_.data() + first);
+            F4 const py = F4::Load(positionY_.data() + first);
+            F4 const pz = F4::Load(positionZ_.data() + first);
+            F4x3 skinned{
+                m[0] * px + m[3] * py + m[6] * pz + m[9],
+                m[1] * px + m[4] * py + m[7] * pz + m[10],
+                m[2] * px + m[5] * py + m[8] * pz + m[11],
+            };
+            StoreBlock(skinned, positions, first, numVertices_);
+            if (!normals) { continue; }
+
+            // NOTE: assumes no non-uniform scale, otherwise normals need the inverse transpose
+            F4 const nx = F4::Load(normalX_.data() + first);
+            F4 const ny = F4::Load(normalY_.data() + first);
+            F4 const nz = F4::Load(normalZ_.data() + first);
+            F4x3 normal{
+                m[0] * nx + m[3] * ny + m[6] * nz,
+                m[1] * nx + m[4] * ny + m[7] * nz,
+                m[2] * nx + m[5] * ny + m[8] * nz,
+            };
+            StoreBlock(Normalize(normal), normals, first, numVertices_);
+        }
+    });
+}
+
+ENGINE_EXPORT void SkinnedVertices::SkinDualQuat(
+    CpuView<math::DualQuat const> jointDualQuats, CpuView<glm::vec3> positions, CpuView<glm::vec3> normals) const {
+    assert(jointDualQuats.IsContiguous() && "Bad call to SkinDualQuat, joint dual quats are gathered by index");
+    assert(positions.NumElements() >= numVertices_);
+    assert(!normals || normals.NumElements() >= numVertices_);
+    // NOTE: glm::quat is stored as (x, y, z, w)
+    auto const* joints = reinterpret_cast<float const*>(jointDualQuats.Begin());
+    constexpr size_t DQ_STRIDE = 8U;
+
+    RunBlocks(numVertices_, [&](size_t blocksBegin, size_t blocksEnd) {
+        for (size_t block = blocksBegin; block < blocksEnd; ++block) {
+            size_t const first = block * LANES;
+            // DLB: weighted sum, with signs flipped to the hemisphere of the first influence
+            F4 pivot[4];
+            for (size_t c = 0; c < 4U; ++c) { pivot[c] = F4::Gather(joints + c, DQ_STRIDE, joints_[0].data() + first); }
+            F4 blended[8];
+            for (auto& value : blended) { value = F4::Set(0.0f); }
+            for (uint32_t k = 0; k < MAX_INFLUENCES; ++k) {
+                uint16_t const* idx = joints_[k].data() + first;
+                F4 dq[8];
+                for (size_t c = 0; c < 8U; ++c) { dq[c] = F4::Gather(joints + c, DQ_STRIDE, idx); }
+                F4 hemisphere = dq[0] * pivot[0] + dq[1] * pivot[1] + dq[2] * pivot[2] + dq[3] * pivot[3];
+                F4 weight     = F4::Load(weights_[k].data() + first) * Sign(hemisphere);
+                for (size_t c = 0; c < 8U; ++c) { blended[c] = blended[c] + weight * dq[c]; }
+            }
+            F4 invLength = InverseSqrt(
+                blended[0] * blended[0] + blended[1] * blended[1] + blended[2] * blended[2] + blended[3] * blended[3]);
+            // NOTE: unlike math::DualQuat::Normalize, the dual part isn't orthogonalized, its component along the
+            // real part cancels out of the translation below, so skinned positions are the same
+            for (auto& value : blended) { value = value * invLength; }
+
+            F4x3 const real{blended[0], blended[1], blended[2]};
+            F4 const realW = blended[3];
+            F4x3 const dual{blended[4], blended[5], blended[6]};
+            F4 const dualW = blended[7];
+            F4 const two   = F4::Set(2.0f);
+            // v + 2 * cross(r, cross(r, v) + w * v), same as math::RotateByQuat
+            auto rotate = [&](F4x3 const& v) {
+                F4x3 c = Cross(real, v);
+                F4x3 t = Cross(real, F4x3{c.x + realW * v.x, c.y + realW * v.y, c.z + realW * v.z});
+                return F4x3{v.x + two * t.x, v.y + two * t.y, v.z + two * t.z};
+            };
+
+            F4x3 position = rotate(F4x3{
+                F4::Load(positionX_.data() + first),
+                F4::Load(positionY_.data() + first),
+                F4::Load(positionZ_.data() + first),
+            });
+            // translation is 2 * dual * conjugate(real)
+            F4x3 rd = Cross(real, dual);
+            position.x = position.x + two * (realW * dual.x - dualW * real.x + rd.x);
+            position.y = position.y + two * (realW * dual.y - dualW * real.y + rd.y);
+            position.z = position.z + two * (realW * dual.z - dualW * real.z + rd.z);
+            StoreBlock(position, positions, first, numVertices_);
+            if (!normals) { continue; }
+
+            F4x3 normal = rotate(F4x3{
+                F4::Load(normalX_.data() + first),
+                F4::Load(normalY_.data() + first),
+                F4::Load(normalZ_.data() + first),
+            });
+            StoreBlock(normal, normals, first, numVertices_);
+        }
+    });
+}
+
+} // namespace engine
@@ -0,0 +1,238 @@
+#include "engine/TextureContainer.hpp"
+#include "engine/BlockCompression.hpp"
+#include "engine/MipGeneration.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr char CONTAINER_MAGIC[8]    = {'X', 'T', 'E', 'X', 'B', 'A', 'K', 'E'};
+// NOTE: version 1 containers could be baked from an unbound texture, they are rejected
+constexpr uint32_t CONTAINER_VERSION = 2U;
+constexpr uint64_t LEVEL_ALIGNMENT   = 16U;
+constexpr int32_t MAX_LEVELS         = 32;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t internalFormat;
+    uint32_t dataFormat;
+    uint32_t dataType;
+    int32_t width;
+    int32_t height;
+    int32_t numLevels;
+    uint32_t reserved;
+    uint64_t sourceHash;
+    uint64_t argsHash;
+};
+
+struct FileLevel {
+    uint64_t byteOffset;
+    uint64_t numBytes;
+};
+
+auto AlignUp [[nodiscard]] (uint64_t value, uint64_t alignment) -> uint64_t {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+
+// Size of a tightly packed level, the same amount GL reads when the level is uploaded
+// NOTE: returns 0 for formats which are never baked
+auto LevelNumBytes [[nodiscard]] (FileHeader const& header, glm::ivec2 levelSize) -> uint64_t {
+    auto width  = static_cast<uint64_t>(levelSize.x);
+    auto height = static_cast<uint64_t>(levelSize.y);
+    if (header.dataFormat == GL_NONE) {
+        uint64_t numBlocks = ((width + 3U) / 4U) * ((height + 3U) / 4U);
+        switch (header.internalFormat) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            return numBlocks * 8U;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return numBlocks * 16U;
+        default:
+            return 0U;
+        }
+    }
+
+    uint64_t numChannels = 0U;
+    switch (header.dataFormat) {
+    case GL_RED:
+        numChannels = 1U;
+        break;
+    case GL_RG:
+        numChannels = 2U;
+        break;
+    case GL_RGB:
+        numChannels = 3U;
+        break;
+    case GL_RGBA:
+        numChannels = 4U;
+        break;
+    default:
+        return 0U;
+    }
+    uint64_t channelBytes = 0U;
+    switch (header.dataType) {
+    case GL_UNSIGNED_BYTE:
+        channelBytes = 1U;
+        break;
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        channelBytes = 2U;
+        break;
+    case GL_FLOAT:
+        channelBytes = 4U;
+        break;
+    default:
+        return 0U;
+    }
+    return width * height * numChannels * channelBytes;
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto TextureContainer::Open(std::string_view filepath) -> std::optional<TextureContainer> {
+    std::error_code err;
+    if (!std::filesystem::exists(filepath, err)) { return std::nullopt; }
+
+    auto mappedFile = platform::MappedFile::Map(filepath);
+    if (!mappedFile) { return std::nullopt; }
+    auto fileData = mappedFile->Data();
+
+    FileHeader header;
+    if (fileData.NumBytes() < sizeof(header)) {
+        XLOGW("Texture container is truncated: {}", filepath);
+        return std::nullopt;
+    }
+    std::memcpy(&header, fileData.data, sizeof(header));
+    if (std::memcmp(header.magic, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC)) != 0
+        || header.version != CONTAINER_VERSION) {
+        XLOGW("Texture container has unknown format or version: {}", filepath);
+        return std::nullopt;
+    }
+    if (header.numLevels <= 0 | header.numLevels > MAX_LEVELS | header.width <= 0 | header.height <= 0
+        || header.numLevels > MipChainLength(glm::ivec2{header.width, header.height})) {
+        XLOGW("Texture container has invalid header: {}", filepath);
+        return std::nullopt;
+    }
+
+    size_t levelIndexEnd = sizeof(FileHeader) + header.numLevels * sizeof(FileLevel);
+    if (fileData.NumBytes() < levelIndexEnd) {
+        XLOGW("Texture container is truncated: {}", filepath);
+        return std::nullopt;
+    }
+
+    TextureContainer container{};
+    container.levels_.reserve(header.numLevels);
+    for (int32_t level = 0; level < header.numLevels; ++level) {
+        FileLevel fileLevel;
+        std::memcpy(&fileLevel, fileData.data + sizeof(FileHeader) + level * sizeof(FileLevel), sizeof(fileLevel));
+        if (fileLevel.byteOffset < levelIndexEnd || fileLevel.byteOffset > fileData.NumBytes()
+            || fileLevel.numBytes > fileData.NumBytes() - fileLevel.byteOffset) {
+            XLOGW("Texture container has out of bounds mip level {}: {}", level, filepath);
+            return std::nullopt;
+        }
+        // NOTE: GL reads the whole level on upload, a short level would be read past its end
+        auto levelSize = MipLevelSize(glm::ivec2{header.width, header.height}, level);
+        if (fileLevel.numBytes != LevelNumBytes(header, levelSize)) {
+            XLOGW("Texture container has mip level {} of unexpected size: {}", level, filepath);
+            return std::nullopt;
+        }
+        container.levels_.emplace_back(fileData.data, fileLevel.numBytes, fileLevel.byteOffset);
+    }
+
+    container.desc_ = TextureContainerDesc{
+        .internalFormat = header.internalFormat,
+        .dataFormat     = header.dataFormat,
+        .dataType       = header.dataType,
+        .size           = glm::ivec2{header.width, header.height},
+        .numLevels      = header.numLevels,
+        .sourceHash     = header.sourceHash,
+        .argsHash       = header.argsHash,
+    };
+    container.file_ = std::move(*mappedFile);
+    return container;
+}
+
+ENGINE_EXPORT auto TextureContainer::Write(
+    std::string_view filepath, TextureContainerDesc const& desc, std::vector<CpuMemory<uint8_t const>> const& levels)
+    -> bool {
+    assert(desc.numLevels == static_cast<int32_t>(levels.size()));
+    assert(desc.numLevels > 0 && desc.numLevels <= MAX_LEVELS);
+
+    FileHeader header{
+        .version        = CONTAINER_VERSION,
+        .internalFormat = desc.internalFormat,
+        .dataFormat     = desc.dataFormat,
+        .dataType       = desc.dataType,
+        .width          = desc.size.x,
+        .height         = desc.size.y,
+        .numLevels      = desc.numLevels,
+        .reserved       = 0U,
+        .sourceHash     = desc.sourceHash,
+        .argsHash       = desc.argsHash,
+    };
+    std::memcpy(header.magic, CONTAINER_MAGIC, sizeof(CONTAINER_MAGIC));
+
+    std::vector<FileLevel> fileLevels(levels.size());
+    uint64_t byteOffset = AlignUp(sizeof(FileHeader) + levels.size() * sizeof(FileLevel), LEVEL_ALIGNMENT);
+    for (size_t level = 0; level < levels.size(); ++level) {
+        fileLevels[level] = FileLevel{.byteOffset = byteOffset, .numBytes = levels[level].NumBytes()};
+        byteOffset        = AlignUp(byteOffset + levels[level].NumBytes(), LEVEL_ALIGNMENT);
+    }
+
+    std::error_code err;
+    auto path = std::filesystem::path{filepath};
+    if (path.has_parent_path()) { std::filesystem::create_directories(path.parent_path(), err); }
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            XLOGE("Failed to open texture container for writing: {}", tmpPath.string());
+            return false;
+        }
+        constexpr char padding[LEVEL_ALIGNMENT] = {};
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(fileLevels.data()), fileLevels.size() * sizeof(FileLevel));
+        uint64_t position = sizeof(header) + fileLevels.size() * sizeof(FileLevel);
+        for (size_t level = 0; level < levels.size(); ++level) {
+            file.write(padding, fileLevels[level].byteOffset - position);
+            file.write(reinterpret_cast<char const*>(levels[level].data), levels[level].NumBytes());
+            position = fileLevels[level].byteOffset + levels[level].NumBytes();
+        }
+        if (!file) {
+            XLOGE("Failed to write texture container: {}", tmpPath.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, err);
+    if (err) {
+        XLOGE("Failed to move texture container into place: {} ({})", path.string(), err.message());
+        std::filesystem::remove(tmpPath, err);
+        return false;
+    }
+    return true;
+}
+
+ENGINE_EXPORT auto TextureContainer::LevelSize(int32_t level) const -> glm::ivec2 {
+    assert(level >= 0 && level < desc_.numLevels);
+    return MipLevelSize(desc_.size, level);
+}
+
+ENGINE_EXPORT auto TextureContainer::LevelData(int32_t level) const -> CpuMemory<uint8_t const> {
+    assert(level >= 0 && level < desc_.numLevels);
+    return levels_[level];
+}
+
+} // namespace engine
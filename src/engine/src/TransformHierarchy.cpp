@@ -0,0 +1,167 @@
+#include "engine/TransformHierarchy.hpp"
+#include "engine/Parallel.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr size_t NODES_PER_CHUNK    = 4096U;
+constexpr size_t MIN_NODES_PARALLEL = 16U * 1024U; // smaller levels are updated by the calling thread
+
+template <typename T> void Permute(std::vector<T>& values, std::vector<uint32_t> const& order) {
+    std::vector<T> permuted(values.size());
+    for (size_t i = 0; i < order.size(); ++i) { permuted[i] = values[order[i]]; }
+    values.swap(permuted);
+}
+
+} // namespace
+
+namespace engine {
+
+ENGINE_EXPORT auto TransformHierarchy::Add(uint32_t parentId, Transform const& local) -> uint32_t {
+    auto id    = static_cast<uint32_t>(idToIndex_.size());
+    auto index = static_cast<uint32_t>(parent_.size());
+    if (parentId == NO_PARENT) {
+        parent_.push_back(NO_PARENT);
+        depth_.push_back(0U);
+    } else {
+        assert(parentId < idToIndex_.size() && "Bad call to TransformHierarchy::Add, parent isn't added");
+        uint32_t parentIndex = idToIndex_[parentId];
+        parent_.push_back(parentIndex);
+        depth_.push_back(depth_[parentIndex] + 1U);
+    }
+    for (auto* values : {&positionX_, &positionY_, &positionZ_, &rotationX_, &rotationY_, &rotationZ_, &rotationW_,
+                         &scaleX_, &scaleY_, &scaleZ_}) {
+        values->push_back(0.0f);
+    }
+    isDirty_.push_back(1U);
+    world_.emplace_back(1.0f);
+    indexToId_.push_back(id);
+    idToIndex_.push_back(index);
+    SetLocal(id, local);
+    // NOTE: the node is appended, it's moved into its level by the next Update
+    isSorted_ = false;
+    return id;
+}
+
+ENGINE_EXPORT void TransformHierarchy::SetLocal(uint32_t id, Transform const& local) {
+    SetPosition(id, local.position);
+    SetRotation(id, local.rotation);
+    SetScale(id, local.scale);
+}
+
+ENGINE_EXPORT void TransformHierarchy::SetPosition(uint32_t id, glm::vec3 position) {
+    uint32_t index    = idToIndex_[id];
+    positionX_[index] = position.x;
+    positionY_[index] = position.y;
+    positionZ_[index] = position.z;
+    isDirty_[index]   = 1U;
+    isAnyDirty_       = true;
+}
+
+ENGINE_EXPORT void TransformHierarchy::SetRotation(uint32_t id, glm::quat rotation) {
+    uint32_t index    = idToIndex_[id];
+    rotationX_[index] = rotation.x;
+    rotationY_[index] = rotation.y;
+    rotationZ_[index] = rotation.z;
+    rotationW_[index] = rotation.w;
+    isDirty_[index]   = 1U;
+    isAnyDirty_       = true;
+}
+
+ENGINE_EXPORT void TransformHierarchy::SetScale(uint32_t id, glm::vec3 scale) {
+    uint32_t index  = idToIndex_[id];
+    scaleX_[index]  = scale.x;
+    scaleY_[index]  = scale.y;
+    scaleZ_[index]  = scale.z;
+    isDirty_[index] = 1U;
+    isAnyDirty_     = true;
+}
+
+ENGINE_EXPORT auto TransformHierarchy::Local(uint32_t id) const -> Transform {
+    uint32_t index = idToIndex_[id];
+    return Transform{
+        .position = glm::vec3{positionX_[index], positionY_[index], positionZ_[index]},
+        .rotation = glm::quat{rotationW_[index], rotationX_[index], rotationY_[index], rotationZ_[index]},
+        .scale    = glm::vec3{scaleX_[index], scaleY_[index], scaleZ_[index]},
+    };
+}
+
+ENGINE_EXPORT void TransformHierarchy::SortByDepth() {
+    size_t numNodes   = parent_.size();
+    uint32_t maxDepth = 0U;
+    for (uint32_t depth : depth_) { maxDepth = std::max(maxDepth, depth); }
+
+    // counting sort, stable, so order of nodes within a level is kept
+    levelsBegin_.assign(maxDepth + 2U, 0U);
+    for (uint32_t depth : depth_) { ++levelsBegin_[depth + 1U]; }
+    for (size_t level = 1U; level < levelsBegin_.size(); ++level) { levelsBegin_[level] += levelsBegin_[level - 1U]; }
+    std::vector<uint32_t> order(numNodes);    // old index of each new index
+    std::vector<uint32_t> newIndex(numNodes); // new index of each old index
+    std::vector<uint32_t> levelsEnd{levelsBegin_.begin(), levelsBegin_.end() - 1};
+    for (uint32_t oldIndex = 0; oldIndex < numNodes; ++oldIndex) {
+        uint32_t index     = levelsEnd[depth_[oldIndex]]++;
+        order[index]       = oldIndex;
+        newIndex[oldIndex] = index;
+    }
+
+    for (auto* values : {&positionX_, &positionY_, &positionZ_, &rotationX_, &rotationY_, &rotationZ_, &rotationW_,
+                         &scaleX_, &scaleY_, &scaleZ_}) {
+        Permute(*values, order);
+    }
+    Permute(parent_, order);
+    Permute(depth_, order);
+    Permute(isDirty_, order);
+    Permute(world_, order);
+    Permute(indexToId_, order);
+    for (uint32_t& parent : parent_) {
+        if (parent != NO_PARENT) { parent = newIndex[parent]; }
+    }
+    for (uint32_t index = 0; index < numNodes; ++index) { idToIndex_[indexToId_[index]] = index; }
+    isSorted_ = true;
+}
+
+ENGINE_EXPORT void TransformHierarchy::Update() {
+    if (!isAnyDirty_) { return; }
+    if (!isSorted_) { SortByDepth(); }
+    for (size_t level = 0; level + 1U < levelsBegin_.size(); ++level) {
+        size_t levelBegin = levelsBegin_[level];
+        size_t levelEnd   = levelsBegin_[level + 1U];
+        if (levelEnd - levelBegin < MIN_NODES_PARALLEL) {
+            UpdateRange(levelBegin, levelEnd);
+            continue;
+        }
+        // NOTE: parents are in the previous levels, which are done, so nodes of a level are independent
+        ParallelFor(levelEnd - levelBegin, NODES_PER_CHUNK, [&](size_t begin, size_t end) {
+            UpdateRange(levelBegin + begin, levelBegin + end);
+        });
+    }
+    std::fill(isDirty_.begin(), isDirty_.end(), 0U);
+    isAnyDirty_ = false;
+}
+
+ENGINE_EXPORT void TransformHierarchy::UpdateRange(size_t indexBegin, size_t indexEnd) {
+    for (size_t i = indexBegin; i < indexEnd; ++i) {
+        uint32_t parent = parent_[i];
+        // dirtiness is inherited, so a moved node moves its whole subtree
+        if (parent != NO_PARENT) { isDirty_[i] |= isDirty_[parent]; }
+        if (!isDirty_[i]) { continue; }
+
+        // same as translate * mat4_cast(rotation) * scale, but straight from the SoA
+        float x = rotationX_[i], y = rotationY_[i], z = rotationZ_[i], w = rotationW_[i];
+        float xx = x * x, yy = y * y, zz = z * z;
+        float xy = x * y, xz = x * z, yz = y * z;
+        float wx = w * x, wy = w * y, wz = w * z;
+        glm::mat4 local{
+            glm::vec4{1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f} * scaleX_[i],
+            glm::vec4{2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f} * scaleY_[i],
+            glm::vec4{2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f} * scaleZ_[i],
+            glm::vec4{positionX_[i], positionY_[i], positionZ_[i], 1.0f},
+        };
+        world_[i] = parent == NO_PARENT ? local : world_[parent] * local;
+    }
+}
+
+} // namespace engine
@@ -9,55 +9,21 @@ namespace engine {
 ENGINE_EXPORT FrustumPlanes CameraToPlanes(glm::mat4 const& mvp, bool normalize) {
     FrustumPlanes planes;
 
-    planes.left = glm::vec4{
-        mvp[3][0] + mvp[0][0],
-        mvp[3][1] + mvp[0][1],
-        mvp[3][2] + mvp[0][2],
-        mvp[3][3] + mvp[0][3],
-    };
-
-    planes.right = glm::vec4{
-        mvp[3][0] - mvp[0][0],
-        mvp[3][1] - mvp[0][1],
-        mvp[3][2] - mvp[0][2],
-        mvp[3][3] - mvp[0][3],
-    };
-
-    planes.bottom = glm::vec4{
-        mvp[3][0] + mvp[1][0],
-        mvp[3][1] + mvp[1][1],
-        mvp[3][2] + mvp[1][2],
-        mvp[3][3] + mvp[1][3],
-    };
+    // NOTE: glm is column major, so row i of the matrix is (mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i])
+    auto row = [&mvp](int32_t i) { return glm::vec4{mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]}; };
 
-    planes.top = glm::vec4{
-        mvp[3][0] - mvp[1][0],
-        mvp[3][1] - mvp[1][1],
-        mvp[3][2] - mvp[1][2],
-        mvp[3][3] - mvp[1][3],
-    };
-
-    planes.near = glm::vec4{
-        mvp[3][0] + mvp[2][0],
-        mvp[3][1] + mvp[2][1],
-        mvp[3][2] + mvp[2][2],
-        mvp[3][3] + mvp[2][3],
-    };
-
-    planes.far = glm::vec4{
-        mvp[3][0] - mvp[2][0],
-        mvp[3][1] - mvp[2][1],
-        mvp[3][2] - mvp[2][2],
-        mvp[3][3] - mvp[2][3],
-    };
+    planes.left   = row(3) + row(0);
+    planes.right  = row(3) - row(0);
+    planes.bottom = row(3) + row(1);
+    planes.top    = row(3) - row(1);
+    planes.near   = row(3) + row(2);
+    planes.far    = row(3) - row(2);
 
     if (normalize) {
-        planes.left   = glm::normalize(planes.left);
-        planes.right  = glm::normalize(planes.right);
-        planes.bottom = glm::normalize(planes.bottom);
-        planes.top    = glm::normalize(planes.top);
-        planes.near   = glm::normalize(planes.near);
-        planes.far    = glm::normalize(planes.far);
+        // the normal becomes unit, so the plane equation gives a signed distance
+        for (auto* plane : {&planes.left, &planes.right, &planes.bottom, &planes.top, &planes.near, &planes.far}) {
+            *plane /= glm::length(glm::vec3{*plane});
+        }
     }
 
     return planes;
@@ -145,29 +145,28 @@ ENGINE_EXPORT auto AxesRenderer::Allocate(GlContext& gl) -> AxesRenderer {
         ShaderDefine::I32("UNIFORM_SCALE", UNIFORM_SCALE_LOCATION),
     };
 
-    auto makeProgram = [&](std::shared_ptr<GpuProgram>& out, std::string_view name) {
+    auto makeProgram = [&](GpuProgramHandle& out, std::string_view name) {
         auto definesClone = defines;
-        auto maybeProgram = gl::LinkProgramFromFiles(
+        out = gl::LinkProgramFromFiles(
             gl, "data/engine/shaders/axes.vert", "data/engine/shaders/color_palette.frag", std::move(definesClone),
             name);
-        assert(maybeProgram);
-        out = std::move(*maybeProgram);
+        assert(out);
     };
 
     makeProgram(renderer.customizedProgram_, "AxesRenderer");
     makeProgram(renderer.defaultProgram_, "AxesRenderer/Default");
-    gl::UniformCtx{*renderer.defaultProgram_}.SetUniformValue3(UNIFORM_SCALE_LOCATION, 1.0f, 1.0f, 1.0f);
+    gl::UniformCtx{gl.Program(renderer.defaultProgram_)}.SetUniformValue3(UNIFORM_SCALE_LOCATION, 1.0f, 1.0f, 1.0f);
 
     return renderer;
 }
 
-ENGINE_EXPORT void AxesRenderer::Dispose(GlContext const& gl) {
+ENGINE_EXPORT void AxesRenderer::Dispose(GlContext& gl) {
 
 }
 
 ENGINE_EXPORT void AxesRenderer::Render(GlContext& gl, glm::mat4 const& mvp, float scale) const {
-    bool isCustom            = scale != 1.0f;
-    auto const& program = isCustom ? *customizedProgram_ : *defaultProgram_;
+    bool isCustom       = scale != 1.0f;
+    auto const& program = gl.Program(isCustom ? customizedProgram_ : defaultProgram_);
 
     auto programGuard = gl::UniformCtx{program};
     programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(mvp));
@@ -27,11 +27,10 @@ ENGINE_EXPORT auto BillboardRenderer::Allocate(GlContext& gl, GLuint fragmentSha
             ShaderDefine::I32("UBO_BINDING", UBO_CONTEXT_BINDING),
             ShaderDefine::I32("UNIFORM_TEXTURE_LOCATION", DEFAULT_UNIFORM_TEXTURE_LOCATION),
         };
-        auto maybeProgram = LinkProgramFromFiles(
+        renderer.quadVaoProgram_ = LinkProgramFromFiles(
             gl, "data/engine/shaders/billboard_quad.vert", "data/engine/shaders/uv.frag", std::move(defines),
             "BillboardRenderer - Quad");
-        assert(maybeProgram);
-        renderer.quadVaoProgram_ = std::move(*maybeProgram);
+        assert(renderer.quadVaoProgram_);
     }
 
     {
@@ -41,11 +40,10 @@ ENGINE_EXPORT auto BillboardRenderer::Allocate(GlContext& gl, GLuint fragmentSha
             ShaderDefine::I32("ATTRIB_POSITION", ATTRIB_POSITION_LOCATION),
             ShaderDefine::I32("ATTRIB_UV", ATTRIB_UV_LOCATION),
         };
-        auto maybeProgram = LinkProgramFromFiles(
+        renderer.customVaoProgram_ = LinkProgramFromFiles(
             gl, "data/engine/shaders/billboard_mesh.vert", "data/engine/shaders/uv.frag", std::move(defines),
             "BillboardRenderer - CustomVao");
-        assert(maybeProgram);
-        renderer.customVaoProgram_ = std::move(*maybeProgram);
+        assert(renderer.customVaoProgram_);
     }
 
     renderer.ubo_ = gl::GpuBuffer::Allocate(
@@ -56,11 +54,11 @@ ENGINE_EXPORT auto BillboardRenderer::Allocate(GlContext& gl, GLuint fragmentSha
     return renderer;
 }
 
-ENGINE_EXPORT void BillboardRenderer::Dispose(GlContext const& gl) { }
+ENGINE_EXPORT void BillboardRenderer::Dispose(GlContext& gl) { }
 
 ENGINE_EXPORT void BillboardRenderer::Render(GlContext& gl, BillboardRenderArgs const& args) const {
-    auto const& program = args.isCustomVao ? customVaoProgram_ : quadVaoProgram_;
-    auto programGuard         = gl::UniformCtx(*program);
+    auto program      = args.isCustomVao ? customVaoProgram_ : quadVaoProgram_;
+    auto programGuard = gl::UniformCtx(gl.Program(program));
 
     ubo_.Fill(CpuMemory<GLvoid const>{&args.shaderArgs, sizeof(args.shaderArgs)});
     GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, UBO_CONTEXT_BINDING, ubo_.Id()));
@@ -3,6 +3,7 @@
 #include "engine/Assets.hpp"
 #include "engine/ShaderDefine.hpp"
 #include "engine/gl/Framebuffer.hpp"
+#include "engine/gl/FrameConstants.hpp"
 #include "engine/gl/Shader.hpp"
 #include "engine/gl/Uniform.hpp"
 
@@ -102,9 +103,17 @@ constexpr uint8_t indices[] = {
 };
 // clang-format on
 
-constexpr GLint UNIFORM_MVP_LOCATION       = 0;
-constexpr GLint UNIFORM_THICKNESS_LOCATION = 1;
-constexpr GLint UNIFORM_COLOR_LOCATION     = 2;
+struct DrawConstants final {
+    alignas(16) glm::mat4 centerMvp{1.0f};
+    alignas(16) glm::vec4 color{1.0f};
+    float innerThickness = THICKNESS;
+    float __pad0         = 0.0f;
+    float __pad1         = 0.0f;
+    float __pad2         = 0.0f;
+};
+static_assert(engine::gl::Std140Block<DrawConstants>);
+static_assert(offsetof(DrawConstants, color) == 64U);
+static_assert(offsetof(DrawConstants, innerThickness) == 80U);
 
 } // namespace
 
@@ -140,28 +149,22 @@ ENGINE_EXPORT auto BoxRenderer::Allocate(GlContext& gl) -> BoxRenderer {
     std::vector<ShaderDefine> defines = {
         ShaderDefine::I32("ATTRIB_POSITION_LOCATION", ATTRIB_POSITION_LOCATION),
         ShaderDefine::I32("ATTRIB_INNER_MARKER_LOCATION", ATTRIB_INNER_MARKER_LOCATION),
-        ShaderDefine::I32("UNIFORM_MVP_LOCATION", UNIFORM_MVP_LOCATION),
-        ShaderDefine::I32("UNIFORM_THICKNESS_LOCATION", UNIFORM_THICKNESS_LOCATION),
-        ShaderDefine::I32("UNIFORM_COLOR_LOCATION", UNIFORM_COLOR_LOCATION),
+        ShaderDefine::UI32("UBO_DRAW_CONSTANTS_BINDING", UBO_DRAW_CONSTANTS_BINDING),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
-        gl, "data/engine/shaders/box.vert", "data/engine/shaders/constant.frag", std::move(defines), "BoxRenderer");
-    assert(maybeProgram);
-    renderer.program_ = std::move(*maybeProgram);
-
-    auto programGuard = UniformCtx{*renderer.program_};
-    programGuard.SetUniformValue1(UNIFORM_THICKNESS_LOCATION, THICKNESS);
+    renderer.program_ = LinkProgramFromFiles(
+        gl, "data/engine/shaders/box.vert", "data/engine/shaders/color_varying.frag", std::move(defines),
+        "BoxRenderer");
+    assert(renderer.program_);
 
     return renderer;
 }
 
-ENGINE_EXPORT void BoxRenderer::Dispose(GlContext const& gl) { }
+ENGINE_EXPORT void BoxRenderer::Dispose(GlContext& gl) { }
 
 ENGINE_EXPORT void BoxRenderer::Render(GlContext& gl, glm::mat4 const& centerMvp, glm::vec4 color) const {
-    auto programGuard = gl::UniformCtx(*program_);
-    programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(centerMvp));
-    programGuard.SetUniformValue4(UNIFORM_COLOR_LOCATION, glm::value_ptr(color));
+    gl.UniformRing().PushAndBind(UBO_DRAW_CONSTANTS_BINDING, DrawConstants{.centerMvp = centerMvp, .color = color});
+    auto programGuard = gl::UniformCtx(gl.Program(program_));
 
     gl.RenderState().CullNone();
     gl.RenderState().DepthTestWrite();
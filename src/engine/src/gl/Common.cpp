@@ -27,6 +27,65 @@ auto AllocateGraphicalShaders
     return {vertexShader, fragmentShader};
 }
 
+// Replaces filepath of the shader by its final preprocessed code
+void PreprocessShader(
+    engine::gl::shader::ShaderCreateInfo& info, engine::CpuView<engine::ShaderDefine const> defines, bool logCode) {
+    using engine::gl::shader::ShaderCreateInfo;
+    if (info.compilationStage != ShaderCreateInfo::FILEPATH) { return; }
+    info.compilationStage = ShaderCreateInfo::CODE;
+    info.source = engine::gl::shader::LoadShaderCode(std::get<std::string_view>(info.source), info.shaderType, defines);
+    LogShaderCode("Compiling shader", std::get<std::string>(info.source), info.shaderType, logCode);
+}
+
+// NOTE: returns 0 if binary cache is disabled or code of any shader is unknown (it's already compiled)
+auto ProgramBinaryKey [[nodiscard]] (
+    engine::gl::ProgramBinaryCache const& binaryCache, engine::gl::shader::ShaderCreateInfo const& vertex,
+    engine::gl::shader::ShaderCreateInfo const& fragment) -> uint64_t {
+    using engine::gl::shader::ShaderCreateInfo;
+    if (!binaryCache.IsEnabled() || vertex.compilationStage != ShaderCreateInfo::CODE
+        || fragment.compilationStage != ShaderCreateInfo::CODE) {
+        return 0U;
+    }
+    return binaryCache.ProgramKey(std::get<std::string>(vertex.source), std::get<std::string>(fragment.source));
+}
+
+// Returns the program immediately, it's either loaded from binary cache, or still being linked by driver threads
+auto SubmitProgram [[nodiscard]] (
+    engine::gl::GlContext& gl, engine::gl::shader::ShaderCreateInfo vertex,
+    engine::gl::shader::ShaderCreateInfo fragment, engine::CpuView<engine::ShaderDefine const> defines,
+    std::string_view name, bool logCode)
+    -> engine::gl::GpuProgramHandle {
+    using engine::gl::GpuProgram;
+    PreprocessShader(vertex, defines, logCode);
+    PreprocessShader(fragment, defines, logCode);
+    auto programKey = ProgramBinaryKey(gl.ProgramBinaries(), vertex, fragment);
+    if (programKey != 0U) {
+        if (auto maybeProgram = GpuProgram::AllocateFromBinary(gl, programKey, name)) {
+            return gl.ProgramPool().Emplace(std::move(*maybeProgram));
+        }
+    }
+    auto program = gl.ProgramPool().Emplace();
+    gl.CompileScheduler().Submit(
+        gl, program, std::move(std::get<std::string>(vertex.source)), std::move(std::get<std::string>(fragment.source)),
+        programKey, name);
+    return program;
+}
+
+// Shaders given by code are shared through ShaderObjectCache, compiled ones are owned by the caller
+auto AcquireShader
+    [[nodiscard]] (engine::gl::GlContext& gl, engine::gl::shader::ShaderCreateInfo const& info) -> GLuint {
+    using engine::gl::shader::ShaderCreateInfo;
+    if (info.compilationStage == ShaderCreateInfo::CODE) {
+        return gl.ShaderObjects().Acquire(static_cast<GLenum>(info.shaderType), std::get<std::string>(info.source));
+    }
+    return std::get<GLuint>(info.source);
+}
+
+void ReleaseShader(engine::gl::GlContext& gl, engine::gl::shader::ShaderCreateInfo const& info, GLuint shader) {
+    using engine::gl::shader::ShaderCreateInfo;
+    if (info.compilationStage == ShaderCreateInfo::CODE) { gl.ShaderObjects().Release(shader); }
+}
+
 } // namespace
 
 namespace engine::gl {
@@ -55,14 +114,21 @@ ENGINE_EXPORT auto CompileGlShader(GLenum shaderType, std::string_view code, boo
     return GL_NONE;
 }
 
+ENGINE_EXPORT void LogShaderErrors(GLuint shader) {
+    GLint isCompiled = GL_FALSE;
+    GLCALL(glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled));
+    if (isCompiled == GL_TRUE) { return; }
+    static char infoLog[512];
+    GLCALL(glGetShaderInfoLog(shader, 512, nullptr, infoLog));
+    XLOGE("Failed to compile shader:\n{}", infoLog);
+}
+
 ENGINE_EXPORT void CompileShader(shader::ShaderCreateInfo& info, CpuView<ShaderDefine const> defines, bool logCode) {
     using shader::ShaderCreateInfo;
     GLuint shader_id = GL_NONE;
     switch (info.compilationStage) {
         case ShaderCreateInfo::FILEPATH:
-            info.compilationStage = ShaderCreateInfo::CODE;
-            info.source = LoadShaderCode(std::get<std::string_view>(info.source), info.shaderType, defines);
-            LogShaderCode("Compiling shader", std::get<std::string>(info.source), info.shaderType, logCode);
+            PreprocessShader(info, defines, logCode);
             CompileShader(info, defines, logCode);
             break;
         case ShaderCreateInfo::CODE:
@@ -82,46 +148,72 @@ ENGINE_EXPORT auto LinkProgram(GlContext& gl, shader::ShaderCreateInfo vertex, s
     engine::CpuView<engine::ShaderDefine const> defines, std::string_view name, bool logCode)
     -> std::optional<GpuProgram> {
 
-    CompileShader(vertex, defines, logCode);
-    CompileShader(fragment, defines, logCode);
+    PreprocessShader(vertex, defines, logCode);
+    PreprocessShader(fragment, defines, logCode);
+    auto programKey = ProgramBinaryKey(gl.ProgramBinaries(), vertex, fragment);
+    if (programKey != 0U) {
+        // warm start, no shader is compiled at all
+        if (auto maybeProgram = GpuProgram::AllocateFromBinary(gl, programKey, name)) { return maybeProgram; }
+    }
 
-    auto vertGl = std::get<GLuint>(vertex.source);
-    auto fragGl = std::get<GLuint>(fragment.source);
+    // NOTE: stages shared with programs linked earlier aren't compiled again
+    auto vertGl = AcquireShader(gl, vertex);
+    auto fragGl = AcquireShader(gl, fragment);
     auto maybeProgram = GpuProgram::Allocate(gl, vertGl, fragGl, name);
+    ReleaseShader(gl, vertex, vertGl);
+    ReleaseShader(gl, fragment, fragGl);
     if (!maybeProgram) { return std::nullopt; }
+    if (programKey != 0U) { gl.ProgramBinaries().Store(maybeProgram->Id(), programKey); }
 
     return std::optional{std::move(*maybeProgram)};
 }
 
 ENGINE_EXPORT auto LinkProgramFromFiles(
     GlContext& gl, std::string_view vertexFilepath, std::string_view fragmentFilepath,
-    std::vector<ShaderDefine>&& defines, std::string_view name, bool logCode) -> std::optional<std::shared_ptr<GpuProgram>> {
+    std::vector<ShaderDefine>&& defines, std::string_view name, bool logCode) -> GpuProgramHandle {
     auto vert = shader::ShaderCreateInfo(vertexFilepath, shader::ShaderType::VERTEX);
     auto frag = shader::ShaderCreateInfo(fragmentFilepath, shader::ShaderType::FRAGMENT);
     auto definesView = CpuView{defines.data(), std::size(defines)};
+    if (gl.CompileScheduler().IsParallel()) {
+        // NOTE: all programs of the startup are linked concurrently, each waits only when it's used first time
+        auto program = SubmitProgram(gl, vert, frag, definesView, name, logCode);
+        gl.Programs()->RegisterProgram(program, vertexFilepath, fragmentFilepath, std::move(defines));
+        return program;
+    }
     auto maybeProgram = LinkProgram(gl, vert, frag, definesView, name, logCode);
     vert.Dispose();
     frag.Dispose();
     if (!maybeProgram) {
-        return std::nullopt;
+        return GpuProgramHandle{};
     }
-    auto program = std::make_shared<GpuProgram>(std::move(*maybeProgram));
+    auto program = gl.ProgramPool().Emplace(std::move(*maybeProgram));
     gl.Programs()->RegisterProgram(program, vertexFilepath, fragmentFilepath, std::move(defines));
-    return std::optional{program};
+    return program;
+}
+
+ENGINE_EXPORT void ReleaseProgram(GlContext& gl, GpuProgramHandle program) {
+    if (!gl.ProgramPool().Contains(program)) { return; }
+    // NOTE: a pending compilation of the program is cancelled by the scheduler, once it finds the handle stale
+    gl.Programs()->UnregisterProgram(program);
+    gl.ProgramPool().Remove(program);
 }
 
 ENGINE_EXPORT auto RelinkProgram(
-    GlContext const& gl, shader::ShaderCreateInfo vertex, shader::ShaderCreateInfo fragment,
+    GlContext& gl, shader::ShaderCreateInfo vertex, shader::ShaderCreateInfo fragment,
     GpuProgram const& oldProgram, CpuView<ShaderDefine const> defines, bool logCode) -> bool {
-    CompileShader(vertex, defines, logCode);
-    CompileShader(fragment, defines, logCode);
-    auto vertGl = std::get<GLuint>(vertex.source);
-    auto fragGl = std::get<GLuint>(fragment.source);
-    if (vertGl <= 0 || fragGl <= 0) {
-        return false;
-    }
+    PreprocessShader(vertex, defines, logCode);
+    PreprocessShader(fragment, defines, logCode);
+    auto programKey = ProgramBinaryKey(gl.ProgramBinaries(), vertex, fragment);
+
+    auto vertGl = AcquireShader(gl, vertex);
+    auto fragGl = AcquireShader(gl, fragment);
     constexpr bool isRecompile = true;
-    return oldProgram.LinkGraphical(vertGl, fragGl, isRecompile);
+    bool isLinked = oldProgram.LinkGraphical(vertGl, fragGl, isRecompile);
+    ReleaseShader(gl, vertex, vertGl);
+    ReleaseShader(gl, fragment, fragGl);
+    // NOTE: the next start won't have to compile the reloaded program
+    if (isLinked && programKey != 0U) { gl.ProgramBinaries().Store(oldProgram.Id(), programKey); }
+    return isLinked;
 }
 
 ENGINE_EXPORT void RenderVao(Vao const& vao, GLenum primitive) {
@@ -17,7 +17,7 @@ constexpr GLint BLIT_UNIFORM_UV_SCALE_LOCATION = 1;
 constexpr GLint BLIT_TEXTURE_SLOT              = 0; // TODO: 1 and above slots don't work
 constexpr int32_t POINTS_FIRST_EXTERNAL        = 64;
 
-auto AllocateBlitter [[nodiscard]](engine::gl::GlContext& gl) -> std::shared_ptr<engine::gl::GpuProgram> {
+auto AllocateBlitter [[nodiscard]](engine::gl::GlContext& gl) -> engine::gl::GpuProgramHandle {
     using namespace engine;
 
     std::vector<ShaderDefine> defines = {
@@ -25,13 +25,12 @@ auto AllocateBlitter [[nodiscard]](engine::gl::GlContext& gl) -> std::shared_ptr
         ShaderDefine::I32("UNIFORM_UV_SCALE", BLIT_UNIFORM_UV_SCALE_LOCATION),
     };
 
-    auto maybeProgram = engine::gl::LinkProgramFromFiles(
+    auto blitProgram = engine::gl::LinkProgramFromFiles(
         gl, "data/engine/shaders/triangle_fullscreen.vert", "data/engine/shaders/blit.frag", std::move(defines),
         "Blit");
-    assert(maybeProgram);
-    auto blitProgram = std::move(*maybeProgram);
+    assert(blitProgram);
 
-    auto programGuard = gl::UniformCtx(*blitProgram);
+    auto programGuard = gl::UniformCtx(gl.Program(blitProgram));
     programGuard.SetUniformTexture(BLIT_UNIFORM_TEXTURE_LOCATION, BLIT_TEXTURE_SLOT);
     programGuard.SetUniformValue2(BLIT_UNIFORM_UV_SCALE_LOCATION, 1.0f, 1.0f);
 
@@ -42,7 +41,7 @@ auto AllocateBlitter [[nodiscard]](engine::gl::GlContext& gl) -> std::shared_ptr
 
 namespace engine::gl {
 
-ENGINE_EXPORT void CommonRenderers::Dispose(GlContext const& gl) {
+ENGINE_EXPORT void CommonRenderers::Dispose(GlContext& gl) {
     for (auto toDispose : toBeDisposed_) {
         toDispose->Dispose(gl);
     }
@@ -65,32 +64,34 @@ ENGINE_EXPORT void CommonRenderers::Initialize(GlContext& gl) {
 
     lineRenderer_  = LineRenderer::Allocate(gl, MAX_LINES);
     toBeDisposed_.push_back(&lineRenderer_);
-    pointRenderer_ = PointRenderer::Allocate(gl, MAX_POINTS);
+    pointRenderer_ = PointRenderer::Allocate(gl, MAX_POINTS, MAX_COMPACT_POINTS);
     toBeDisposed_.push_back(&pointRenderer_);
 
     isInitialized_ = true;
     blitProgram_   = AllocateBlitter(gl);
 
-    samplerNearest_ = samplersCache_.Store(
-        "clamp/nearest",
-        gl::GpuSampler::Allocate(gl, "Sampler/Nearset")
-            .WithLinearMagnify(false)
-            .WithLinearMinify(false)
-            .WithWrap(GL_CLAMP_TO_EDGE));
-    samplerLinear_ = samplersCache_.Store(
-        "clamp/linear",
-        gl::GpuSampler::Allocate(gl, "Sampler/Linear")
-            .WithLinearMagnify(true)
-            .WithLinearMinify(true)
-            .WithWrap(GL_CLAMP_TO_EDGE));
-    samplerLinearRepeat_ = samplersCache_.Store(
-        "repeat/linear",
-        gl::GpuSampler::Allocate(gl, "Sampler/LinearRepeat")
-            .WithLinearMagnify(true)
-            .WithLinearMinify(true)
-            .WithWrap(GL_REPEAT));
-
-    stubColorTexture_ = gl::Texture::Allocate2D(gl, GL_TEXTURE_2D, glm::ivec3(1, 1, 0), GL_RGB8, "Stub color");
+    samplerNearest_ = samplersCache_.Acquire(
+        gl,
+        SamplerDesc{
+            .wrapS = GL_CLAMP_TO_EDGE,
+            .wrapT = GL_CLAMP_TO_EDGE,
+            .wrapR = GL_CLAMP_TO_EDGE,
+        },
+        "Sampler/Nearest");
+    samplerLinear_ = samplersCache_.Acquire(
+        gl,
+        SamplerDesc{
+            .magnifyLinear = true,
+            .minifyLinear  = true,
+            .wrapS         = GL_CLAMP_TO_EDGE,
+            .wrapT         = GL_CLAMP_TO_EDGE,
+            .wrapR         = GL_CLAMP_TO_EDGE,
+        },
+        "Sampler/Linear");
+    samplerLinearRepeat_ = samplersCache_.Acquire(
+        gl, SamplerDesc{.magnifyLinear = true, .minifyLinear = true}, "Sampler/LinearRepeat");
+
+    stubColorTexture_ = gl::Texture::Allocate2D(gl, GL_TEXTURE_2D, glm::ivec3(1, 1, 0), GL_RGB8, 1, "Stub color");
     constexpr uint8_t TEXTURE_DATA_STUB_COLOR[] = {
         255,
         42,
@@ -157,13 +158,16 @@ ENGINE_EXPORT void CommonRenderers::FlushLinesToGpu(std::vector<LineRendererInpu
     }
 }
 
-ENGINE_EXPORT void CommonRenderers::RenderPoints(GlContext& gl, glm::mat4 const& camera) const {
+ENGINE_EXPORT void CommonRenderers::RenderPoints(GlContext& gl, glm::mat4 const& view, glm::mat4 const& proj) const {
     assert(IsInitialized() && "Bad call to RenderPoints, CommonRenderers isn't initialized");
     pointRenderer_.Render(gl, glm::mat4{1.0f}, 0, pointsLimitInternal_);
-    pointRenderer_.Render(gl, camera, POINTS_FIRST_EXTERNAL, pointsLimitExternal_);
+    pointRenderer_.Render(gl, proj * view, POINTS_FIRST_EXTERNAL, pointsLimitExternal_);
+    pointRenderer_.RenderSprites(gl, view, proj, 0, numCompactPoints_);
 }
 
-ENGINE_EXPORT void CommonRenderers::FlushPointsToGpu(std::vector<PointRendererInput::Point> const& points) {
+ENGINE_EXPORT void CommonRenderers::FlushPointsToGpu(
+    std::vector<PointRendererInput::Point> const& points,
+    std::vector<PointRendererInput::CompactPoint> const& compactPoints) {
     assert(IsInitialized() && "Bad call to FlushPointsToGpu, CommonRenderers isn't initialized");
     {
         if (debugPoints_.IsDataDirty()) {
@@ -176,6 +180,10 @@ ENGINE_EXPORT void CommonRenderers::FlushPointsToGpu(std::vector<PointRendererIn
         pointRenderer_.Fill(points, std::size(points), POINTS_FIRST_EXTERNAL);
         pointsLimitExternal_ = POINTS_FIRST_EXTERNAL + std::size(points);
     }
+    {
+        pointRenderer_.Fill(compactPoints, std::size(compactPoints), 0);
+        numCompactPoints_ = std::min(std::size(compactPoints), MAX_COMPACT_POINTS);
+    }
 }
 
 ENGINE_EXPORT void CommonRenderers::RenderEditorGrid(GlContext& gl, glm::vec3 cameraWorldPosition, glm::mat4 const& camera) const {
@@ -191,7 +199,7 @@ ENGINE_EXPORT void CommonRenderers::RenderEditorGrid(GlContext& gl, glm::vec3 ca
 
 ENGINE_EXPORT void CommonRenderers::Blit2D(GlContext& gl, GLuint srcTexture, glm::vec2 uvScale) const {
     assert(IsInitialized() && "Bad call to Blit2D, CommonRenderers isn't initialized");
-    auto programGuard = gl::UniformCtx(*blitProgram_);
+    auto programGuard = gl::UniformCtx(gl.Program(blitProgram_));
     programGuard.SetUniformValue2(BLIT_UNIFORM_UV_SCALE_LOCATION, uvScale.x, uvScale.y);
     gl.TextureUnits().Bind2D(BLIT_TEXTURE_SLOT, srcTexture);
     // auto depthGuard = gl::GlGuardDepth(false);
@@ -202,9 +210,9 @@ ENGINE_EXPORT void CommonRenderers::Blit2D(GlContext& gl, GLuint srcTexture, glm
     RenderFulscreenTriangle(gl);
 }
 
-ENGINE_EXPORT auto CommonRenderers::CacheSampler(std::string_view name, GpuSampler&& sampler)
+ENGINE_EXPORT auto CommonRenderers::CacheSampler(GlContext& gl, SamplerDesc const& desc, std::string_view name)
     -> SamplersCache::CacheKey {
-    return samplersCache_.Store(name, std::move(sampler));
+    return samplersCache_.Acquire(gl, desc, name);
 }
 
 ENGINE_EXPORT auto CommonRenderers::FindSampler(SamplersCache::CacheKey sampler) const -> GpuSampler const& {
@@ -2,12 +2,20 @@
 #include "engine/gl/GpuProgramRegistry.hpp"
 #include "engine_private/Prelude.hpp"
 
+namespace {
+
+constexpr size_t UNIFORM_RING_BYTES_PER_FRAME = 256U * 1024U;
+
+} // namespace
+
 namespace engine::gl {
 
 ENGINE_EXPORT void GlContext::Initialize() {
     extensions_.Initialize();
     capabilities_.Initialize();
     textureUnits_.Initialize(*this); // NOTE: capabilities must be initilized by now
+    compileScheduler_.Initialize(extensions_);
+    uniformRing_.Initialize(*this, UNIFORM_RING_BYTES_PER_FRAME);
     programsRegistry_ = std::make_shared<GpuProgramRegistry>();
 
     datalessTriangleVao_ = Vao::Allocate(*this, "Dataless Triangle VAO");
@@ -26,21 +26,20 @@ ENGINE_EXPORT auto EditorGridRenderer::Allocate(GlContext& gl) -> EditorGridRend
         ShaderDefine::I32("UBO_BINDING", UBO_BINDING),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
+    renderer.program_ = LinkProgramFromFiles(
         gl, "data/engine/shaders/editor_grid.vert", "data/engine/shaders/editor_grid.frag", std::move(defines),
         "Editor grid");
-    assert(maybeProgram);
-    renderer.program_ = std::move(*maybeProgram);
+    assert(renderer.program_);
 
     renderer.ubo_ = gl::GpuBuffer::Allocate(
         gl, GL_UNIFORM_BUFFER, gl::GpuBuffer::CLIENT_UPDATE, CpuMemory<void const>{nullptr, sizeof(UboData)},
         "EditorGridRenderer UBO");
-    renderer.uboLocation_ = UniformCtx::GetUboLocation(*renderer.program_, "Ubo");
+    renderer.uboLocation_ = UniformCtx::GetUboLocation(gl.Program(renderer.program_), "Ubo");
 
     return renderer;
 }
 
-ENGINE_EXPORT void EditorGridRenderer::Dispose(GlContext const& gl) { }
+ENGINE_EXPORT void EditorGridRenderer::Dispose(GlContext& gl) { }
 
 ENGINE_EXPORT void EditorGridRenderer::Render(GlContext& gl, EditorGridRenderer::RenderArgs const& args) const {
     UboData data{
@@ -53,7 +52,7 @@ ENGINE_EXPORT void EditorGridRenderer::Render(GlContext& gl, EditorGridRenderer:
     ubo_.Fill(CpuMemory<GLvoid const>{&data, sizeof(data)});
     GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING, ubo_.Id()));
 
-    auto programGuard = gl::UniformCtx(*program_);
+    auto programGuard = gl::UniformCtx(gl.Program(program_));
     GLCALL(glEnable(GL_BLEND));
     GLCALL(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO));
     RenderVao(gl.VaoDatalessQuad(), GL_TRIANGLE_STRIP);
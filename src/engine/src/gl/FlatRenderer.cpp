@@ -1,6 +1,7 @@
 
 #include "engine/gl/FlatRenderer.hpp"
 #include "engine/Assets.hpp"
+#include "engine/gl/FrameConstants.hpp"
 #include "engine/gl/Shader.hpp"
 #include "engine/gl/Uniform.hpp"
 
@@ -42,12 +43,23 @@ struct UboData final {
     alignas(16) Material material{};
     alignas(16) LightData lights[1]{};
 };
+static_assert(engine::gl::Std140Block<UboData>);
+static_assert(offsetof(UboData, normalToWorld) == 128U);
+static_assert(offsetof(UboData, eyeWorldDirection) == 176U);
+static_assert(offsetof(UboData, material) == 192U);
+static_assert(offsetof(UboData, lights) == 224U);
+static_assert(sizeof(UboData) == 288U);
 
 constexpr static int32_t ATTRIB_POSITION_LOCATION = 0;
 constexpr static int32_t ATTRIB_UV_LOCATION       = 1;
 constexpr static int32_t ATTRIB_NORMAL_LOCATION   = 2;
 
-constexpr GLint UBO_BINDING = 5; // global for GL
+enum FeatureAxis : size_t {
+    AXIS_SPECULAR = 0,
+    AXIS_PHONG    = 1,
+};
+
+constexpr char const* USED_VARIANTS_FILEPATH = "cache/variants/flat.txt";
 
 } // namespace
 
@@ -60,28 +72,32 @@ ENGINE_EXPORT auto FlatRenderer::Allocate(GlContext& gl) -> FlatRenderer {
         ShaderDefine::I32("ATTRIB_POSITION", ATTRIB_POSITION_LOCATION),
         ShaderDefine::I32("ATTRIB_UV", ATTRIB_UV_LOCATION),
         ShaderDefine::I32("ATTRIB_NORMAL", ATTRIB_NORMAL_LOCATION),
-        ShaderDefine::I32("UBO_BINDING", UBO_BINDING),
-        ShaderDefine::B8("USE_SPECULAR", true),
-        ShaderDefine::B8("USE_PHONG", false),
+        ShaderDefine::UI32("UBO_BINDING", UBO_DRAW_CONSTANTS_BINDING),
     };
-
-    auto maybeProgram = LinkProgramFromFiles(
-        gl, "data/engine/shaders/blinn_phong.vert", "data/engine/shaders/blinn_phong.frag", std::move(defines),
-        "Lambert diffuse");
-    assert(maybeProgram);
-    renderer.program_ = std::move(*maybeProgram);
-
-    renderer.ubo_ = gl::GpuBuffer::Allocate(
-        gl, GL_UNIFORM_BUFFER, gl::GpuBuffer::CLIENT_UPDATE, CpuMemory<void const>{nullptr, sizeof(UboData)},
-        "FlatRenderer UBO");
-    renderer.uboLocation_ = UniformCtx::GetUboLocation(*renderer.program_, "Ubo");
+    std::vector<GpuProgramFamily::FeatureAxis> axes = {
+        {.name = "USE_SPECULAR"},
+        {.name = "USE_PHONG"},
+    };
+    renderer.programs_ = GpuProgramFamily::Allocate(
+        "data/engine/shaders/blinn_phong.vert", "data/engine/shaders/blinn_phong.frag", std::move(defines),
+        std::move(axes), "Lambert diffuse");
+    auto usedVariants = GpuProgramFamily::LoadUsedVariants(USED_VARIANTS_FILEPATH);
+    renderer.programs_.Prewarm(gl, CpuView{usedVariants.data(), usedVariants.size()});
 
     return renderer;
 }
 
-ENGINE_EXPORT void FlatRenderer::Dispose(GlContext const& gl) { }
+ENGINE_EXPORT void FlatRenderer::Dispose(GlContext& gl) {
+    programs_.SaveUsedVariants(USED_VARIANTS_FILEPATH);
+    programs_.Dispose(gl);
+}
+
+ENGINE_EXPORT void FlatRenderer::Render(GlContext& gl, FlatRenderArgs const& args) {
+    auto variantKey = programs_.Feature(AXIS_SPECULAR, args.useSpecular ? 1U : 0U)
+        | programs_.Feature(AXIS_PHONG, args.usePhong ? 1U : 0U);
+    auto program = programs_.Variant(gl, variantKey);
+    if (!program) { return; }
 
-ENGINE_EXPORT void FlatRenderer::Render(GlContext& gl, FlatRenderArgs const& args) const {
     glm::mat3x4 normalToWorld = glm::transpose(glm::inverse(args.modelToWorld));
 
     UboData data{
@@ -106,10 +122,9 @@ ENGINE_EXPORT void FlatRenderer::Render(GlContext& gl, FlatRenderArgs const& arg
                      .radius = 1.0f,
              }}}};
 
-    ubo_.Fill(CpuMemory<GLvoid const>{&data, sizeof(data)});
-    GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING, ubo_.Id()));
+    gl.UniformRing().PushAndBind(UBO_DRAW_CONSTANTS_BINDING, data);
 
-    auto programGuard = gl::UniformCtx(*program_);
+    auto programGuard = gl::UniformCtx(gl.Program(program));
     RenderVao(args.vaoWithNormal, args.primitive);
 }
 
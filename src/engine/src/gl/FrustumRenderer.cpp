@@ -9,9 +9,10 @@
 
 namespace {
 
-constexpr GLint UNIFORM_MVP_LOCATION   = 0;
-constexpr GLint UBO_BINDING            = 0; // global for GL
-constexpr GLint UNIFORM_COLOR_LOCATION = 100;
+constexpr GLint UBO_BINDING = 0; // global for GL
+// NOTE: locations are assigned by the linker and found in the program reflection
+constexpr uint64_t UNIFORM_MVP   = engine::gl::ResourceNameHash("u_MVP");
+constexpr uint64_t UNIFORM_COLOR = engine::gl::ResourceNameHash("u_ConstantColor");
 
 constexpr float OUT_BEGIN = 0.5f;
 constexpr float OUT_END   = 1.0f;
@@ -169,17 +170,14 @@ ENGINE_EXPORT auto FrustumRenderer::Allocate(GlContext& gl) -> FrustumRenderer {
     std::vector<ShaderDefine> defines = {
         ShaderDefine::I32("ATTRIB_FRUSTUM_WEIGHTS", ATTRIB_FRUSTUM_WEIGHTS_LOCATION),
         ShaderDefine::I32("ATTRIB_OTHER_WEIGHTS", ATTRIB_OTHER_WEIGHTS_LOCATION),
-        ShaderDefine::I32("UNIFORM_MVP", UNIFORM_MVP_LOCATION),
         ShaderDefine::I32("UBO_FRUSTUM", UBO_BINDING),
-        ShaderDefine::I32("UNIFORM_COLOR_LOCATION", UNIFORM_COLOR_LOCATION),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
+    renderer.program_ = LinkProgramFromFiles(
         gl, "data/engine/shaders/frustum.vert", "data/engine/shaders/constant.frag", std::move(defines),
         "FrustumRenderer");
-    assert(maybeProgram);
-    renderer.program_     = std::move(*maybeProgram);
-    renderer.uboLocation_ = UniformCtx::GetUboLocation(*renderer.program_, "Ubo");
+    assert(renderer.program_);
+    renderer.uboLocation_ = UniformCtx::GetUboLocation(gl.Program(renderer.program_), "Ubo");
 
     renderer.ubo_ = gl::GpuBuffer::Allocate(
         gl, GL_UNIFORM_BUFFER, gl::GpuBuffer::CLIENT_UPDATE, CpuMemory<void const>{nullptr, sizeof(UboData)},
@@ -188,13 +186,13 @@ ENGINE_EXPORT auto FrustumRenderer::Allocate(GlContext& gl) -> FrustumRenderer {
     return renderer;
 }
 
-ENGINE_EXPORT void FrustumRenderer::Dispose(GlContext const& gl) {
+ENGINE_EXPORT void FrustumRenderer::Dispose(GlContext& gl) {
 
 }
 
 ENGINE_EXPORT void FrustumRenderer::Render(
     GlContext& gl, glm::mat4 const& originMvp, Frustum const& frustum, glm::vec4 color, float thickness) const {
-    auto programGuard = gl::UniformCtx(*program_);
+    auto programGuard = gl::UniformCtx(gl.Program(program_));
     UboData data{
         .leftRightBottomTop = {frustum.left, frustum.right, frustum.bottom, frustum.top},
         .nearFarThickness   = {frustum.near, frustum.far, thickness * 2.0f, 0.0},
@@ -203,8 +201,8 @@ ENGINE_EXPORT void FrustumRenderer::Render(
     GLCALL(glBindBufferBase(GL_UNIFORM_BUFFER, UBO_BINDING, ubo_.Id()));
     // programGuard.SetUbo(uboLocation_, UBO_BINDING);
 
-    programGuard.SetUniformValue4(UNIFORM_COLOR_LOCATION, glm::value_ptr(color));
-    programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(originMvp));
+    programGuard.SetUniformValue4(programGuard.Location(UNIFORM_COLOR), glm::value_ptr(color));
+    programGuard.SetUniformMatrix4x4(programGuard.Location(UNIFORM_MVP), glm::value_ptr(originMvp));
 
     gl.RenderState().CullNone();
     gl.RenderState().DepthTestWrite();
@@ -26,6 +26,7 @@ ENGINE_EXPORT void GlExtensions::Initialize() {
     constexpr bool OK                                      = true;
     hardcodedExtensions_[KHR_debug]                        = supports("GL_KHR_debug", glGetObjectLabel != nullptr);
     hardcodedExtensions_[KHR_no_error]                     = supports("GL_KHR_no_error", OK);
+    hardcodedExtensions_[KHR_parallel_shader_compile]      = supports("GL_KHR_parallel_shader_compile", OK);
     hardcodedExtensions_[KHR_shader_subgroup]              = supports("GL_KHR_shader_subgroup", OK);
     hardcodedExtensions_[KHR_texture_compression_astc_hdr] = supports("GL_KHR_texture_compression_astc_hdr", OK);
     hardcodedExtensions_[KHR_texture_compression_astc_ldr] = supports("GL_KHR_texture_compression_astc_ldr", OK);
@@ -36,16 +37,20 @@ ENGINE_EXPORT void GlExtensions::Initialize() {
     hardcodedExtensions_[ARB_ES3_2_compatibility] = supports("GL_ARB_ES3_2_compatibility", OK);
     hardcodedExtensions_[ARB_invalidate_subdata] =
         supports("GL_ARB_invalidate_subdata", glInvalidateFramebuffer != nullptr);
-    hardcodedExtensions_[ARB_framebuffer_sRGB] = supports("GL_ARB_framebuffer_sRGB", OK);
+    hardcodedExtensions_[ARB_framebuffer_sRGB]        = supports("GL_ARB_framebuffer_sRGB", OK);
+    hardcodedExtensions_[ARB_parallel_shader_compile] = supports("GL_ARB_parallel_shader_compile", OK);
     hardcodedExtensions_[ARB_shading_language_include] =
         supports("GL_ARB_shading_language_include", glNamedStringARB != nullptr);
+    hardcodedExtensions_[ARB_texture_compression_bptc]   = supports("GL_ARB_texture_compression_bptc", OK);
     hardcodedExtensions_[ARB_texture_filter_anisotropic] = supports("GL_ARB_texture_filter_anisotropic", OK);
     hardcodedExtensions_[ARB_texture_storage] = supports("GL_ARB_texture_storage", glTexStorage2D != nullptr);
     hardcodedExtensions_[ARB_texture_storage_multisample] =
         supports("GL_ARB_texture_storage_multisample", glTexStorage2DMultisample != nullptr);
     hardcodedExtensions_[EXT_debug_label]  = supports("GL_EXT_debug_label", glLabelObjectEXT != nullptr);
     hardcodedExtensions_[EXT_debug_marker] = supports("GL_EXT_debug_marker", glPushGroupMarkerEXT != nullptr);
-    isInitialized_                         = true;
+    hardcodedExtensions_[EXT_texture_compression_s3tc] = supports("GL_EXT_texture_compression_s3tc", OK);
+    hardcodedExtensions_[EXT_texture_sRGB]             = supports("GL_EXT_texture_sRGB", OK);
+    isInitialized_                                     = true;
 }
 
 } // namespace engine::gl
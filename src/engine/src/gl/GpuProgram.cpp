@@ -1,4 +1,5 @@
 #include "engine/gl/GpuProgram.hpp"
+#include "engine/gl/ProgramBinaryCache.hpp"
 
 #include "engine_private/Prelude.hpp"
 #include <optional>
@@ -9,6 +10,8 @@ auto LinkGraphicalProgram(GLuint program, GLuint vertexShader, GLuint fragmentSh
     GLCALL(glAttachShader(program, vertexShader));
     GLCALL(glAttachShader(program, fragmentShader));
 
+    // NOTE: allows to store the linked program into ProgramBinaryCache
+    GLCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
     GLCALL(glLinkProgram(program));
     GLint isLinked;
     GLCALL(glGetProgramiv(program, GL_LINK_STATUS, &isLinked));
@@ -18,6 +21,10 @@ auto LinkGraphicalProgram(GLuint program, GLuint vertexShader, GLuint fragmentSh
 
     if (isLinked == GL_TRUE) { return true; }
 
+    // NOTE: compile status of shaders isn't checked before linking, see ShaderObjectCache
+    engine::gl::LogShaderErrors(vertexShader);
+    engine::gl::LogShaderErrors(fragmentShader);
+
     static char infoLog[512];
     GLCALL(glGetProgramInfoLog(program, 512, nullptr, infoLog));
     XLOGE("Failed to link graphics program:\n{}", infoLog);
@@ -34,13 +41,26 @@ ENGINE_EXPORT void GpuProgram::Dispose() {
     XLOG("GpuProgram was disposed: 0x{:08X}", GLuint(programId_));
     GLCALL(glDeleteProgram(programId_));
     programId_.UnsafeReset();
+    reflection_.Clear();
+}
+
+ENGINE_EXPORT void GpuProgram::ReplaceProgram(GLuint programId) {
+    if (programId_ == programId) { return; }
+    if (programId_ != GL_NONE) { GLCALL(glDeleteProgram(programId_)); }
+    programId_.UnsafeReset();
+    programId_ = programId;
+    reflection_.Clear();
 }
 
+ENGINE_EXPORT void GpuProgram::Reflect() const { reflection_.Reflect(programId_); }
+
 ENGINE_EXPORT auto GpuProgram::LinkGraphical(GLuint vertexShader, GLuint fragmentShader, bool isRecompile) const
     -> bool {
     if (!isRecompile) {
         // first compilation
-        return LinkGraphicalProgram(programId_, vertexShader, fragmentShader);
+        bool ok = LinkGraphicalProgram(programId_, vertexShader, fragmentShader);
+        if (ok) { Reflect(); }
+        return ok;
     }
     // attempt to hot-reload
     // compile into temporary program, if it fails, don't recompile the existing program
@@ -49,6 +69,8 @@ ENGINE_EXPORT auto GpuProgram::LinkGraphical(GLuint vertexShader, GLuint fragmen
     bool ok = LinkGraphicalProgram(tmpProgramId, vertexShader, fragmentShader);
     GLCALL(glDeleteProgram(tmpProgramId));
     if (ok) { ok = LinkGraphicalProgram(programId_, vertexShader, fragmentShader); }
+    // NOTE: relinking resets uniform values, their shadows are reset too
+    if (ok) { Reflect(); }
     return ok;
 }
 
@@ -73,4 +95,25 @@ ENGINE_EXPORT auto GpuProgram::Allocate(
     return std::optional{std::move(program)};
 }
 
-} // namespace engine::gl
\ No newline at end of file
+ENGINE_EXPORT auto GpuProgram::AllocateFromBinary(GlContext& gl, uint64_t programKey, std::string_view name)
+    -> std::optional<GpuProgram> {
+    auto program = GpuProgram();
+    GLuint programId;
+    GLCALL(programId = glCreateProgram());
+    program.programId_ = programId;
+
+    if (!gl.ProgramBinaries().Load(program.programId_, programKey)) {
+        GLCALL(glDeleteProgram(program.programId_));
+        program.programId_.UnsafeReset();
+        return std::nullopt;
+    }
+    program.Reflect();
+
+    if (!name.empty()) {
+        DebugLabel(gl, program, name);
+        LogDebugLabel(gl, program, "GpuProgram was loaded from binary cache");
+    }
+    return std::optional{std::move(program)};
+}
+
+} // namespace engine::gl
@@ -0,0 +1,191 @@
+#include "engine/gl/GpuProgramFamily.hpp"
+#include "engine/gl/Common.hpp"
+#include "engine/gl/GpuProgram.hpp"
+#include "engine/gl/GpuProgramRegistry.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+using VariantKey = engine::gl::GpuProgramFamily::VariantKey;
+
+// NOTE: all key bits are never used, total width of axes is below 64 bits
+constexpr VariantKey EMPTY_KEY         = ~VariantKey{0U};
+constexpr size_t MIN_CAPACITY          = 8U;
+constexpr uint64_t FIBONACCI_HASH_MULT = 0x9E3779B97F4A7C15ULL;
+
+auto AxisWidth [[nodiscard]] (uint32_t numValues) -> uint32_t {
+    return static_cast<uint32_t>(std::bit_width(numValues - 1U));
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT auto GpuProgramFamily::Allocate(
+    std::string_view vertexFilepath, std::string_view fragmentFilepath, std::vector<ShaderDefine>&& defines,
+    std::vector<FeatureAxis>&& axes, std::string_view name) -> GpuProgramFamily {
+    GpuProgramFamily family;
+    family.vertexFilepath_   = std::string{vertexFilepath};
+    family.fragmentFilepath_ = std::string{fragmentFilepath};
+    family.name_             = std::string{name};
+    family.defines_          = std::move(defines);
+    family.axes_             = std::move(axes);
+
+    uint32_t offset = 0U;
+    family.axisOffsets_.reserve(family.axes_.size());
+    for (auto const& axis : family.axes_) {
+        assert(axis.numValues >= 2U && "GpuProgramFamily axis must have at least 2 values");
+        family.axisOffsets_.push_back(offset);
+        offset += AxisWidth(axis.numValues);
+    }
+    assert(offset < 64U && "GpuProgramFamily axes don't fit into a variant key");
+    family.validBits_ = (VariantKey{1U} << offset) - 1U;
+
+    family.slotKeys_.assign(MIN_CAPACITY, EMPTY_KEY);
+    family.slotVariants_.resize(MIN_CAPACITY);
+    return family;
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::Feature(size_t axis, uint32_t value) const -> VariantKey {
+    assert(axis < axes_.size() && value < axes_[axis].numValues);
+    return VariantKey{value} << axisOffsets_[axis];
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::IsValid(VariantKey key) const -> bool {
+    if ((key & ~validBits_) != 0U) { return false; }
+    for (size_t i = 0; i < axes_.size(); ++i) {
+        VariantKey mask = (VariantKey{1U} << AxisWidth(axes_[i].numValues)) - 1U;
+        if (((key >> axisOffsets_[i]) & mask) >= axes_[i].numValues) { return false; }
+    }
+    return true;
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::Variant(GlContext& gl, VariantKey key) -> GpuProgramHandle {
+    assert(IsValid(key));
+    size_t slot = FindSlot(key);
+    if (slotKeys_[slot] == key) { return slotVariants_[slot]; }
+
+    // NOTE: a broken variant is compiled again only after files change, not on every use
+    uint64_t generation = gl.Programs()->Generation();
+    auto failed         = std::find_if(failedVariants_.begin(), failedVariants_.end(), [&](auto const& f) {
+        return f.first == key;
+    });
+    if (failed != failedVariants_.end() && failed->second == generation) { return GpuProgramHandle{}; }
+
+    auto program = Compile(gl, key);
+    if (!program) {
+        if (failed != failedVariants_.end()) {
+            failed->second = generation;
+        } else {
+            failedVariants_.emplace_back(key, generation);
+        }
+        return program;
+    }
+    if (failed != failedVariants_.end()) { failedVariants_.erase(failed); }
+
+    // keep load factor at most 1/2, probe sequences stay short
+    if (2U * (usedVariants_.size() + 1U) > slotKeys_.size()) {
+        Grow();
+        slot = FindSlot(key);
+    }
+    slotKeys_[slot]     = key;
+    slotVariants_[slot] = program;
+    usedVariants_.push_back(key);
+    return program;
+}
+
+ENGINE_EXPORT void GpuProgramFamily::Prewarm(GlContext& gl, CpuView<VariantKey const> keys) {
+    for (VariantKey const* key = keys.Begin(); key != keys.End(); ++key) {
+        if (!IsValid(*key)) {
+            XLOGW("GpuProgramFamily '{}' skips invalid variant 0x{:X}", name_, *key);
+            continue;
+        }
+        std::ignore = Variant(gl, *key);
+    }
+}
+
+ENGINE_EXPORT void GpuProgramFamily::Dispose(GlContext& gl) {
+    for (size_t slot = 0; slot < slotKeys_.size(); ++slot) {
+        if (slotKeys_[slot] != EMPTY_KEY) { ReleaseProgram(gl, slotVariants_[slot]); }
+    }
+    slotKeys_.assign(MIN_CAPACITY, EMPTY_KEY);
+    slotVariants_.clear();
+    slotVariants_.resize(MIN_CAPACITY);
+    usedVariants_.clear();
+    failedVariants_.clear();
+}
+
+ENGINE_EXPORT void GpuProgramFamily::SaveUsedVariants(std::string_view filepath) const {
+    namespace fs = std::filesystem;
+    std::error_code err;
+    auto path = fs::path{filepath};
+    if (path.has_parent_path()) { fs::create_directories(path.parent_path(), err); }
+    if (err) {
+        XLOGE("GpuProgramFamily failed to create directory: {} ({})", path.parent_path().string(), err.message());
+        return;
+    }
+    std::ofstream file{path, std::ios::trunc};
+    for (VariantKey key : usedVariants_) { file << std::hex << key << '\n'; }
+    if (!file) { XLOGE("GpuProgramFamily failed to write used variants: {}", filepath); }
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::LoadUsedVariants(std::string_view filepath) -> std::vector<VariantKey> {
+    std::vector<VariantKey> keys;
+    std::ifstream file{std::string{filepath}};
+    std::string line;
+    while (std::getline(file, line)) {
+        VariantKey key  = 0U;
+        auto [end, err] = std::from_chars(line.data(), line.data() + line.size(), key, 16);
+        if (err == std::errc{} && end != line.data()) { keys.push_back(key); }
+    }
+    return keys;
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::FindSlot(VariantKey key) const -> size_t {
+    size_t mask = slotKeys_.size() - 1U;
+    size_t slot = static_cast<size_t>((key * FIBONACCI_HASH_MULT) >> 32U) & mask;
+    while (slotKeys_[slot] != key && slotKeys_[slot] != EMPTY_KEY) { slot = (slot + 1U) & mask; }
+    return slot;
+}
+
+ENGINE_EXPORT void GpuProgramFamily::Grow() {
+    auto oldKeys     = std::move(slotKeys_);
+    auto oldVariants = std::move(slotVariants_);
+    slotKeys_.assign(oldKeys.size() * 2U, EMPTY_KEY);
+    slotVariants_.clear();
+    slotVariants_.resize(oldKeys.size() * 2U);
+    for (size_t i = 0; i < oldKeys.size(); ++i) {
+        if (oldKeys[i] == EMPTY_KEY) { continue; }
+        size_t slot         = FindSlot(oldKeys[i]);
+        slotKeys_[slot]     = oldKeys[i];
+        slotVariants_[slot] = std::move(oldVariants[i]);
+    }
+}
+
+ENGINE_EXPORT auto GpuProgramFamily::Compile(GlContext& gl, VariantKey key) const -> GpuProgramHandle {
+    auto defines = defines_;
+    defines.reserve(defines.size() + axes_.size());
+    std::string name = name_;
+    for (size_t i = 0; i < axes_.size(); ++i) {
+        auto const& axis = axes_[i];
+        VariantKey mask  = (VariantKey{1U} << AxisWidth(axis.numValues)) - 1U;
+        auto value       = static_cast<uint32_t>((key >> axisOffsets_[i]) & mask);
+        defines.push_back(axis.numValues == 2U ? ShaderDefine::B8(axis.name, value != 0U)
+                                               : ShaderDefine::UI32(axis.name, value));
+        name += fmt::format(" {}={}", axis.name, value);
+    }
+
+    // NOTE: the variant is compiled asynchronously if supported, and registered for hot reload as any program
+    auto program = LinkProgramFromFiles(gl, vertexFilepath_, fragmentFilepath_, std::move(defines), name);
+    if (!program) { XLOGE("GpuProgramFamily failed to compile variant: {}", name); }
+    return program;
+}
+
+} // namespace engine::gl
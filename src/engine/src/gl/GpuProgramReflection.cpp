@@ -0,0 +1,250 @@
+#include "engine/gl/GpuProgramReflection.hpp"
+#include "engine/Hash.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+using Reflection   = engine::gl::GpuProgramReflection;
+using ResourceKind = Reflection::ResourceKind;
+
+// NOTE: explicit locations are small, uniforms at bigger locations aren't shadowed
+constexpr GLint MAX_SHADOWED_LOCATION = 1024;
+constexpr size_t MIN_INDEX_CAPACITY   = 8U;
+
+auto TypeNumBytes [[nodiscard]] (GLenum type) -> uint16_t {
+    switch (type) {
+    case GL_FLOAT:
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_BOOL:
+        return 4U;
+    case GL_FLOAT_VEC2:
+    case GL_INT_VEC2:
+    case GL_UNSIGNED_INT_VEC2:
+    case GL_BOOL_VEC2:
+    case GL_DOUBLE:
+        return 8U;
+    case GL_FLOAT_VEC3:
+    case GL_INT_VEC3:
+    case GL_UNSIGNED_INT_VEC3:
+    case GL_BOOL_VEC3:
+        return 12U;
+    case GL_FLOAT_VEC4:
+    case GL_INT_VEC4:
+    case GL_UNSIGNED_INT_VEC4:
+    case GL_BOOL_VEC4:
+    case GL_FLOAT_MAT2:
+    case GL_DOUBLE_VEC2:
+        return 16U;
+    case GL_DOUBLE_VEC3:
+        return 24U;
+    case GL_FLOAT_MAT3:
+        return 36U;
+    case GL_DOUBLE_VEC4:
+        return 32U;
+    case GL_FLOAT_MAT4:
+        return 64U;
+    default:
+        // NOTE: samplers and images are set as a single int
+        return 4U;
+    }
+}
+
+auto ResourceName [[nodiscard]] (std::string const& buffer, GLsizei length) -> std::string_view {
+    auto name = std::string_view{buffer.data(), static_cast<size_t>(std::max(length, 0))};
+    if (name.ends_with("[0]")) { name.remove_suffix(3); }
+    return name;
+}
+
+auto IndexKey [[nodiscard]] (ResourceKind kind, uint64_t nameHash) -> uint64_t {
+    return engine::HashCombine(nameHash, static_cast<uint64_t>(kind));
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT void GpuProgramReflection::Reflect(GLuint program) {
+    Clear();
+    if (program == GL_NONE) { return; }
+
+    std::string nameBuffer;
+    GLint numResources  = 0;
+    GLint maxNameLength = 0;
+
+    // default block uniforms, members of blocks have no location
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numResources));
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+    nameBuffer.resize(std::max(maxNameLength, 1));
+    for (GLint i = 0; i < numResources; ++i) {
+        GLsizei nameLength = 0;
+        GLint arraySize    = 0;
+        GLenum type        = GL_NONE;
+        GLCALL(glGetActiveUniform(
+            program, i, nameBuffer.size(), &nameLength, &arraySize, &type, nameBuffer.data()));
+        GLint location;
+        GLCALL(location = glGetUniformLocation(program, nameBuffer.data()));
+        if (location < 0) { continue; }
+        resources_.push_back(Resource{
+            .nameHash  = ResourceNameHash(ResourceName(nameBuffer, nameLength)),
+            .location  = location,
+            .type      = type,
+            .arraySize = arraySize,
+            .kind      = ResourceKind::UNIFORM,
+        });
+        if (arraySize != 1 || location >= MAX_SHADOWED_LOCATION) { continue; }
+        if (shadows_.size() <= static_cast<size_t>(location)) { shadows_.resize(location + 1); }
+        shadows_[location] = Shadow{
+            .offset   = static_cast<uint32_t>(shadowValues_.size()),
+            .numBytes = TypeNumBytes(type),
+        };
+        shadowValues_.resize(shadowValues_.size() + shadows_[location].numBytes);
+    }
+
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &numResources));
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength));
+    nameBuffer.resize(std::max<size_t>(nameBuffer.size(), maxNameLength));
+    for (GLint i = 0; i < numResources; ++i) {
+        GLsizei nameLength = 0;
+        GLint binding      = -1;
+        GLint numBytes     = 0;
+        GLCALL(glGetActiveUniformBlockName(program, i, nameBuffer.size(), &nameLength, nameBuffer.data()));
+        GLCALL(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding));
+        GLCALL(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &numBytes));
+        resources_.push_back(Resource{
+            .nameHash      = ResourceNameHash(ResourceName(nameBuffer, nameLength)),
+            .location      = i,
+            .binding       = binding,
+            .numBlockBytes = numBytes,
+            .kind          = ResourceKind::UNIFORM_BLOCK,
+        });
+    }
+
+    // NOTE: storage blocks are queried only by program interface query of GL 4.3
+    if (GLAD_GL_VERSION_4_3) {
+        GLCALL(glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &numResources));
+        GLCALL(glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &maxNameLength));
+        nameBuffer.resize(std::max<size_t>(nameBuffer.size(), maxNameLength));
+        constexpr GLenum properties[] = {GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+        for (GLint i = 0; i < numResources; ++i) {
+            GLsizei nameLength = 0;
+            GLint values[2]    = {-1, 0};
+            GLCALL(glGetProgramResourceName(
+                program, GL_SHADER_STORAGE_BLOCK, i, nameBuffer.size(), &nameLength, nameBuffer.data()));
+            GLCALL(glGetProgramResourceiv(
+                program, GL_SHADER_STORAGE_BLOCK, i, std::size(properties), properties, std::size(values), nullptr,
+                values));
+            resources_.push_back(Resource{
+                .nameHash      = ResourceNameHash(ResourceName(nameBuffer, nameLength)),
+                .location      = i,
+                .binding       = values[0],
+                .numBlockBytes = values[1],
+                .kind          = ResourceKind::STORAGE_BLOCK,
+            });
+        }
+    }
+
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &numResources));
+    GLCALL(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength));
+    nameBuffer.resize(std::max<size_t>(nameBuffer.size(), maxNameLength));
+    for (GLint i = 0; i < numResources; ++i) {
+        GLsizei nameLength = 0;
+        GLint arraySize    = 0;
+        GLenum type        = GL_NONE;
+        GLCALL(glGetActiveAttrib(program, i, nameBuffer.size(), &nameLength, &arraySize, &type, nameBuffer.data()));
+        GLint location;
+        GLCALL(location = glGetAttribLocation(program, nameBuffer.data()));
+        if (location < 0) { continue; } // built-in, e.g. gl_VertexID
+        resources_.push_back(Resource{
+            .nameHash  = ResourceNameHash(ResourceName(nameBuffer, nameLength)),
+            .location  = location,
+            .type      = type,
+            .arraySize = arraySize,
+            .kind      = ResourceKind::ATTRIBUTE,
+        });
+    }
+
+    std::sort(resources_.begin(), resources_.end(), [](Resource const& a, Resource const& b) {
+        return a.kind != b.kind ? a.kind < b.kind : a.nameHash < b.nameHash;
+    });
+    BuildIndex();
+    isReflected_ = true;
+}
+
+ENGINE_EXPORT void GpuProgramReflection::Clear() {
+    resources_.clear();
+    index_.clear();
+    shadows_.clear();
+    shadowValues_.clear();
+    isReflected_ = false;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::Find(ResourceKind kind, uint64_t nameHash) const -> Resource const* {
+    if (index_.empty()) { return nullptr; }
+    size_t mask = index_.size() - 1U;
+    for (size_t slot = IndexKey(kind, nameHash) & mask; index_[slot] != 0U; slot = (slot + 1U) & mask) {
+        auto const& resource = resources_[index_[slot] - 1U];
+        if (resource.kind == kind && resource.nameHash == nameHash) { return &resource; }
+    }
+    return nullptr;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::UniformLocation(uint64_t nameHash) const -> GLint {
+    auto const* resource = Find(ResourceKind::UNIFORM, nameHash);
+    return resource ? resource->location : -1;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::UniformBlockIndex(uint64_t nameHash) const -> GLint {
+    auto const* resource = Find(ResourceKind::UNIFORM_BLOCK, nameHash);
+    return resource ? resource->location : -1;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::StorageBlockIndex(uint64_t nameHash) const -> GLint {
+    auto const* resource = Find(ResourceKind::STORAGE_BLOCK, nameHash);
+    return resource ? resource->location : -1;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::AttributeLocation(uint64_t nameHash) const -> GLint {
+    auto const* resource = Find(ResourceKind::ATTRIBUTE, nameHash);
+    return resource ? resource->location : -1;
+}
+
+ENGINE_EXPORT auto GpuProgramReflection::UpdateShadow(GLint location, void const* value, size_t numBytes) -> bool {
+    if (location < 0 || static_cast<size_t>(location) >= shadows_.size()) { return true; }
+    auto& shadow = shadows_[location];
+    if (shadow.numBytes == 0U) { return true; }
+    if (numBytes > shadow.numBytes) {
+        shadow.isSet = false;
+        return true;
+    }
+    uint8_t* shadowValue = shadowValues_.data() + shadow.offset;
+    if (shadow.isSet && std::memcmp(shadowValue, value, numBytes) == 0) { return false; }
+    std::memcpy(shadowValue, value, numBytes);
+    shadow.isSet = true;
+    return true;
+}
+
+ENGINE_EXPORT void GpuProgramReflection::InvalidateShadows(GLint location, size_t numLocations) {
+    if (location < 0) { return; }
+    size_t end = std::min(static_cast<size_t>(location) + numLocations, shadows_.size());
+    for (size_t i = static_cast<size_t>(location); i < end; ++i) { shadows_[i].isSet = false; }
+}
+
+ENGINE_EXPORT void GpuProgramReflection::BuildIndex() {
+    assert(resources_.size() < 0xFFFFU && "GpuProgramReflection index is limited to 16 bits");
+    size_t capacity = std::max(MIN_INDEX_CAPACITY, std::bit_ceil(resources_.size() * 2U));
+    index_.assign(capacity, 0U);
+    size_t mask = capacity - 1U;
+    for (size_t i = 0; i < resources_.size(); ++i) {
+        size_t slot = IndexKey(resources_[i].kind, resources_[i].nameHash) & mask;
+        while (index_[slot] != 0U) { slot = (slot + 1U) & mask; }
+        index_[slot] = static_cast<uint16_t>(i + 1U);
+    }
+}
+
+} // namespace engine::gl
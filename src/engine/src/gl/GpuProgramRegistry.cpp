@@ -1,30 +1,49 @@
 #include "engine/gl/GpuProgramRegistry.hpp"
+#include "engine/Assets.hpp"
+#include "engine/gl/Context.hpp"
 #include "engine/gl/GpuProgram.hpp"
 #include "engine/gl/Shader.hpp"
 #include "engine/platform/Filesystem.hpp"
+#include <algorithm>
 #include <utility>
 
 namespace {
 
-auto HasEnding [[nodiscard]] (std::string_view const str, std::string_view ending, size_t endOffset = 0) -> bool {
-    if (str.length() < ending.length() + endOffset) { return false; }
-    return str.compare(str.length() - ending.length() - endOffset, ending.length(), ending) == 0;
-}
-
 constexpr size_t DEFAULT_CAPACITY = 64;
 
+// Shader files first, then unique files of includes of both shaders, all paths are absolute
+auto CollectDependencies [[nodiscard]] (
+    std::string const& vertexFilepath, std::string const& fragmentFilepath,
+    engine::gl::shader::IncludeGraph const& vertexIncludes, engine::gl::shader::IncludeGraph const& fragmentIncludes)
+    -> std::vector<std::string> {
+    std::vector<std::string> dependencies{vertexFilepath, fragmentFilepath};
+    for (auto const* includes : {&vertexIncludes, &fragmentIncludes}) {
+        for (std::string_view includeFilepath : includes->files) {
+            std::error_code err;
+            auto absoluteFilepath = engine::platform::AbsolutePath(includeFilepath, err).string();
+            if (err) { continue; }
+            if (std::find(dependencies.begin(), dependencies.end(), absoluteFilepath) != dependencies.end()) {
+                continue;
+            }
+            dependencies.push_back(std::move(absoluteFilepath));
+        }
+    }
+    return dependencies;
+}
+
 } // namespace
 
 namespace engine::gl {
 
 GpuProgramRegistry::GpuProgramRegistry() {
     programs_.reserve(DEFAULT_CAPACITY);
-    pendingHotReload_.reserve(DEFAULT_CAPACITY);
+    dependents_.reserve(DEFAULT_CAPACITY);
+    pendingChanges_.reserve(DEFAULT_CAPACITY);
     filepathsToWatch_.reserve(DEFAULT_CAPACITY);
 }
 
 void GpuProgramRegistry::RegisterProgram(
-    std::weak_ptr<GpuProgram> program, std::string_view vertexFilepath, std::string_view fragmentFilepath,
+    GpuProgramHandle program, std::string_view vertexFilepath, std::string_view fragmentFilepath,
     std::vector<ShaderDefine>&& defines) {
     //assert(false && "Rename to GpuProgramRegistry move hot-reloading to new GpuProgramHotreloader");
     std::error_code err;
@@ -34,80 +53,135 @@ void GpuProgramRegistry::RegisterProgram(
     fragmentFullFilepath = platform::AbsolutePath(fragmentFilepath, err).string();
     assert(!err);
 
-    // TODO: issue, two copies of paths stored, once in programs_, once in filepathsToWatch_
-    filepathsToWatch_.insert(vertexFullFilepath);
-    filepathsToWatch_.insert(fragmentFullFilepath);
-
-    // try to replace expired weak_ptr
-    bool inserted = false;
-    if (std::size(programs_) > 0) {
-        for (auto& p : programs_) {
-            if (!p.program.expired()) { continue; }
-            p.program = program;
-            p.shadersFilepaths[0] = std::move(vertexFullFilepath);
-            p.shadersFilepaths[1] = std::move(fragmentFullFilepath);
-            p.shadersFilepaths[2] = {};
-            p.shadersFilepaths[3] = {};
-            p.defines = std::move(defines);
-            inserted = true;
-            break;
-        }
+    // try to reuse an unregistered entry
+    size_t programIdx = std::size(programs_);
+    for (size_t i = 0; i < std::size(programs_); ++i) {
+        auto& p = programs_[i];
+        if (p.program) { continue; }
+        p.program = program;
+        p.shadersFilepaths[0] = std::move(vertexFullFilepath);
+        p.shadersFilepaths[1] = std::move(fragmentFullFilepath);
+        p.shadersFilepaths[2] = {};
+        p.shadersFilepaths[3] = {};
+        p.defines = std::move(defines);
+        programIdx = i;
+        break;
     }
 
     // everything is alive, add a new entry
-    if (!inserted) {
+    if (programIdx == std::size(programs_)) {
         programs_.push_back(ProgramEntry {
             .program = program,
             .shadersFilepaths = {std::move(vertexFullFilepath), std::move(fragmentFullFilepath), {}, {}}, // TODO
             .defines = std::move(defines),
         });
     }
+
+    // NOTE: includes are found by preprocessing the shaders again, it's cheap compared to their compilation
+    using shader::ShaderType;
+    auto const& entry    = programs_[programIdx];
+    auto const& vertPath = entry.shadersFilepaths[0];
+    auto const& fragPath = entry.shadersFilepaths[1];
+    auto definesView     = CpuView{entry.defines.data(), entry.defines.size()};
+    shader::IncludeGraph vertexIncludes, fragmentIncludes;
+    std::ignore = shader::LoadShaderCode(vertPath, ShaderType::VERTEX, definesView, &vertexIncludes);
+    std::ignore = shader::LoadShaderCode(fragPath, ShaderType::FRAGMENT, definesView, &fragmentIncludes);
+    IndexDependencies(programIdx, CollectDependencies(vertPath, fragPath, vertexIncludes, fragmentIncludes), 2);
 }
 
-void GpuProgramRegistry::UnregisterProgram(GpuProgram const& program) {
-    for (auto& p : programs_) {
-        if (p.program.lock().get() != &program) { continue; }
-        p.program.reset();
+void GpuProgramRegistry::UnregisterProgram(GpuProgramHandle program) {
+    for (size_t i = 0; i < std::size(programs_); ++i) {
+        auto& p = programs_[i];
+        if (p.program != program) { continue; }
+        p.program = GpuProgramHandle{};
+        IndexDependencies(i, {}, 0);
     }
 }
 
+void GpuProgramRegistry::IndexDependencies(
+    size_t programIdx, std::vector<std::string>&& dependencies, size_t numShaders) {
+    auto& entry = programs_[programIdx];
+    for (auto const& filepath : entry.dependencies) {
+        auto find = dependents_.find(filepath);
+        if (find == dependents_.end()) { continue; }
+        auto& programs = find->second.programs;
+        programs.erase(std::remove(programs.begin(), programs.end(), programIdx), programs.end());
+    }
+    for (size_t i = 0; i < std::size(dependencies); ++i) {
+        auto& dependents = dependents_[dependencies[i]];
+        dependents.isInclude |= i >= numShaders;
+        auto& programs = dependents.programs;
+        if (std::find(programs.begin(), programs.end(), programIdx) == programs.end()) {
+            programs.push_back(programIdx);
+        }
+        if (filepathsToWatch_.insert(dependencies[i]).second) { newFilepathsToWatch_.push_back(dependencies[i]); }
+    }
+    entry.dependencies = std::move(dependencies);
+}
+
 void GpuProgramRegistry::OnFileChanged(std::string const& path, bool isDirectory) {
     XLOG("GpuProgramRegistry detected change {}", path.c_str());
-    bool isVert    = HasEnding(path, shader::VERTEX_FILE_EXTENSION);
-    bool isFrag    = HasEnding(path, shader::FRAGMENT_FILE_EXTENSION);
-    bool isCompute = HasEnding(path, shader::COMPUTE_FILE_EXTENSION);
-
-    for (size_t i = 0; i < std::size(programs_); ++i) {
-        auto& entry = programs_[i];
-        bool doRecompile = (isVert && std::filesystem::equivalent(entry.shadersFilepaths[0], path) || isFrag && std::filesystem::equivalent(entry.shadersFilepaths[1], path) || isCompute && std::filesystem::equivalent(entry.shadersFilepaths[0], path));
-        if (!doRecompile) { continue; }
-
-        pendingHotReload_.push_back(i);
-    }
+    if (isDirectory) { return; }
+    // NOTE: editors often write a file several times on save
+    if (std::find(pendingChanges_.begin(), pendingChanges_.end(), path) != pendingChanges_.end()) { return; }
+    pendingChanges_.push_back(path);
 }
 
 void GpuProgramRegistry::HotReloadPrograms(GlContext& gl) {
-    for (size_t idx : pendingHotReload_) {
+    if (pendingChanges_.empty()) { return; }
+    std::vector<size_t> pendingHotReload;
+    for (auto const& path : pendingChanges_) {
+        auto find = dependents_.find(path);
+        if (find == dependents_.end()) {
+            // watched paths are absolute already, but a path may come from elsewhere
+            std::error_code err;
+            auto absolutePath = platform::AbsolutePath(path, err).string();
+            if (err) { continue; }
+            find = dependents_.find(absolutePath);
+            if (find == dependents_.end()) { continue; }
+        }
+        if (find->second.isInclude && !shader::ReloadShaderInclude(find->first)) {
+            XLOGW("GpuProgramRegistry failed to reload include {}", find->first);
+        }
+        pendingHotReload.insert(pendingHotReload.end(), find->second.programs.begin(), find->second.programs.end());
+    }
+    pendingChanges_.clear();
+    ++generation_;
+    // a program depending on several changed files is recompiled once
+    std::sort(pendingHotReload.begin(), pendingHotReload.end());
+    pendingHotReload.erase(std::unique(pendingHotReload.begin(), pendingHotReload.end()), pendingHotReload.end());
+
+    for (size_t idx : pendingHotReload) {
         bool ok   = false;
         auto const& payload = programs_[idx];
-        if (payload.program.expired()) { continue; }
+        auto const* program = gl.ProgramPool().Get(payload.program);
+        if (program == nullptr) { continue; }
 
-        auto program = payload.program.lock();
         auto programType = program->Type();
         if (programType == GpuProgramType::GRAPHICAL) {
-            auto vert = shader::ShaderCreateInfo(payload.shadersFilepaths[0], shader::ShaderType::VERTEX);
-            auto frag = shader::ShaderCreateInfo(payload.shadersFilepaths[1], shader::ShaderType::VERTEX);
-            ok = RelinkProgram(
-                gl, vert, frag,
-                *program, CpuView{payload.defines.data(), payload.defines.size()}, false);
-            vert.Dispose();
-            frag.Dispose();
+            // NOTE: the old program is rendered, until the new one is linked, see ShaderCompileScheduler
+            using shader::ShaderType;
+            auto const& vertPath = payload.shadersFilepaths[0];
+            auto const& fragPath = payload.shadersFilepaths[1];
+            auto defines         = CpuView{payload.defines.data(), payload.defines.size()};
+            shader::IncludeGraph vertexIncludes, fragmentIncludes;
+            auto vertexCode   = shader::LoadShaderCode(vertPath, ShaderType::VERTEX, defines, &vertexIncludes);
+            auto fragmentCode = shader::LoadShaderCode(fragPath, ShaderType::FRAGMENT, defines, &fragmentIncludes);
+
+            uint64_t programKey = 0U;
+            if (gl.ProgramBinaries().IsEnabled()) {
+                programKey = gl.ProgramBinaries().ProgramKey(vertexCode, fragmentCode);
+            }
+            gl.CompileScheduler().Submit(
+                gl, payload.program, std::move(vertexCode), std::move(fragmentCode), programKey);
+            // NOTE: edited code may include other files now
+            IndexDependencies(idx, CollectDependencies(vertPath, fragPath, vertexIncludes, fragmentIncludes), 2);
+            ok = true;
         } else if (programType == GpuProgramType::COMPUTE) {
             assert(false && "GpuProgramRegistry::OnFileChanged not implemented for compute shaders");
         }
         if (!ok) { XLOGE("GpuProgramRegistry failed to hot-reload program: {:08X}", program->Id()); }
     }
-    pendingHotReload_.clear();
 }
 
 } // namespace engine::gl
@@ -1,10 +1,32 @@
 #include "engine/gl/GpuSampler.hpp"
+#include "engine/Hash.hpp"
 #include "engine/gl/TextureUnits.hpp"
 
 #include "engine_private/Prelude.hpp"
 
+#include <bit>
+
+namespace {
+
+// NOTE: +0.0f folds -0.0f into 0.0f, they compare equal, so they must hash equally
+auto HashFloat [[nodiscard]] (GLfloat value) -> uint64_t { return std::bit_cast<uint32_t>(value + 0.0f); }
+
+} // namespace
+
 namespace engine::gl {
 
+ENGINE_EXPORT auto SamplerDesc::Hash() const -> uint64_t {
+    uint64_t flags = (magnifyLinear ? 1U : 0U) | (minifyLinear ? 2U : 0U) | (minifyOverMips ? 4U : 0U)
+        | (mipsLinear ? 8U : 0U) | (depthCompare ? 16U : 0U);
+    uint64_t hash = HashCombine(flags, compareFunc);
+    hash          = HashCombine(hash, (uint64_t{wrapS} << 32U) | wrapT);
+    hash          = HashCombine(hash, wrapR);
+    hash          = HashCombine(hash, (HashFloat(minMip) << 32U) | HashFloat(maxMip));
+    hash          = HashCombine(hash, (HashFloat(mipBias) << 32U) | HashFloat(maxAnisotropy));
+    hash          = HashCombine(hash, (HashFloat(borderColor.r) << 32U) | HashFloat(borderColor.g));
+    return HashCombine(hash, (HashFloat(borderColor.b) << 32U) | HashFloat(borderColor.a));
+}
+
 ENGINE_EXPORT void GpuSampler::Dispose() {
     if (samplerId_ == GL_NONE) { return; }
     // LogDebugLabel(*this, "Sampler object was disposed");
@@ -16,6 +38,8 @@ ENGINE_EXPORT void GpuSampler::Dispose() {
 ENGINE_EXPORT auto GpuSampler::Allocate(GlContext& gl, std::string_view name) -> GpuSampler {
     GpuSampler sampler{};
     GLCALL(glGenSamplers(1, sampler.samplerId_.Ptr()));
+    // NOTE: the name may be reused from a deleted sampler, which GL unbound, but texture units still remember
+    gl.TextureUnits().ForgetSampler(sampler.samplerId_);
     if (!name.empty()) {
         // assert(GlCapabilities::IsInitialized());
         auto& textureUnits = gl.TextureUnits();
@@ -33,6 +57,19 @@ ENGINE_EXPORT auto GpuSampler::Allocate(GlContext& gl, std::string_view name) ->
     return sampler;
 }
 
+ENGINE_EXPORT auto GpuSampler::Allocate(GlContext& gl, SamplerDesc const& desc, std::string_view name)
+    -> GpuSampler {
+    return Allocate(gl, name)
+        .WithLinearMagnify(desc.magnifyLinear)
+        .WithLinearMinify(desc.minifyLinear)
+        .WithLinearMinifyOverMips(desc.minifyOverMips, desc.mipsLinear)
+        .WithWrap(desc.wrapS, desc.wrapT, desc.wrapR)
+        .WithMipConfig(desc.minMip, desc.maxMip, desc.mipBias)
+        .WithAnisotropicFilter(gl, desc.maxAnisotropy)
+        .WithDepthCompare(desc.depthCompare, desc.compareFunc)
+        .WithBorderColor(desc.borderColor);
+}
+
 ENGINE_EXPORT auto GpuSampler::WithDepthCompare(bool enable, GLenum compareFunc) && -> GpuSampler&& {
     {
         GLenum f = compareFunc;
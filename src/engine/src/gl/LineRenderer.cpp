@@ -44,34 +44,37 @@ ENGINE_EXPORT auto LineRenderer::Allocate(GlContext& gl, size_t maxLines) -> Lin
         ShaderDefine::I32("UNIFORM_MVP", UNIFORM_MVP_LOCATION),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
+    renderer.program_ = LinkProgramFromFiles(
         gl, "data/engine/shaders/lines.vert", "data/engine/shaders/color_palette.frag", std::move(defines),
         "LineRenderer");
-    assert(maybeProgram);
-    renderer.program_ = std::move(*maybeProgram);
+    assert(renderer.program_);
 
     return renderer;
 }
 
-ENGINE_EXPORT void LineRenderer::Dispose(GlContext const& gl) {
+ENGINE_EXPORT void LineRenderer::Dispose(GlContext& gl) {
 
 }
 
 ENGINE_EXPORT void LineRenderer::Render(GlContext& gl, glm::mat4 const& camera) const {
-    auto programGuard = UniformCtx{*program_};
+    if (vao_.IndexCount() <= 0) { return; }
+    auto programGuard = UniformCtx{gl.Program(program_)};
     programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(camera));
     RenderVao(vao_, GL_LINES);
 }
 
 ENGINE_EXPORT void LineRenderer::Fill(
-    std::vector<LineRendererInput::Line> const& lines, size_t numLines, size_t numLinesOffset) const {
+    std::vector<LineRendererInput::Line> const& lines, size_t numLines, size_t numLinesOffset) {
     using T               = typename std::decay<decltype(*lines.begin())>::type;
+    auto const maxLines   = static_cast<size_t>(attributeBuffer_.SizeBytes()) / sizeof(T);
+    numLinesOffset        = std::min(numLinesOffset, maxLines);
+    numLines              = std::min({numLines, std::size(lines), maxLines - numLinesOffset});
     auto const byteOffset = numLinesOffset * sizeof(T);
-    auto const numBytes   = std::min(
-        attributeBuffer_.SizeBytes() - byteOffset, // buffer limit
-        numLines * sizeof(T)                       // argument limit
-    );
-    attributeBuffer_.Fill(CpuMemory<GLvoid const>{lines.data(), numBytes}, byteOffset);
+    if (numLines > 0U) {
+        attributeBuffer_.Fill(CpuMemory<GLvoid const>{lines.data(), numLines * sizeof(T)}, byteOffset);
+    }
+    // NOTE: lines after the filled ones are left from previous frames, they aren't drawn
+    std::ignore = VaoMutableCtx{vao_}.MakeUnindexed(static_cast<GLsizei>((numLinesOffset + numLines) * 2U));
 }
 
 } // namespace engine::gl
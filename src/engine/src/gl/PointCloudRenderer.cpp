@@ -0,0 +1,191 @@
+#include "engine/gl/PointCloudRenderer.hpp"
+#include "engine/gl/FrameConstants.hpp"
+#include "engine/gl/Shader.hpp"
+#include "engine/gl/Uniform.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using Node = engine::PointCloud::Node;
+
+struct DrawConstants final {
+    alignas(16) glm::mat4 viewProj{1.0f};
+};
+static_assert(engine::gl::Std140Block<DrawConstants>);
+
+// A node is culled only if all its corners are outside of the same clip plane, so it's conservative
+auto IsNodeVisible [[nodiscard]] (Node const& node, glm::mat4 const& viewProj) -> bool {
+    uint32_t outsideAll = 0x3FU;
+    for (uint32_t corner = 0; corner < 8U; ++corner) {
+        auto offset      = glm::vec3((corner >> 2U) & 1U, (corner >> 1U) & 1U, corner & 1U) * node.size;
+        auto clip        = viewProj * glm::vec4(node.boundsMin + offset, 1.0f);
+        uint32_t outside = static_cast<uint32_t>(clip.x < -clip.w) | static_cast<uint32_t>(clip.x > clip.w) << 1U
+            | static_cast<uint32_t>(clip.y < -clip.w) << 2U | static_cast<uint32_t>(clip.y > clip.w) << 3U
+            | static_cast<uint32_t>(clip.z < -clip.w) << 4U | static_cast<uint32_t>(clip.z > clip.w) << 5U;
+        outsideAll &= outside;
+    }
+    return outsideAll == 0U;
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT auto PointCloudRenderer::Allocate(GlContext& gl, PointCloud cloud, Settings const& settings)
+    -> PointCloudRenderer {
+    constexpr GLint ATTRIB_POSITION_LOCATION = 0;
+    constexpr GLint ATTRIB_COLOR_LOCATION    = 1;
+
+    using T = PointCloud::Point;
+
+    PointCloudRenderer renderer;
+    renderer.settings_ = settings;
+
+    // NOTE: a page fits the biggest node, the margin keeps pages of the previous frames for a camera moving back
+    uint32_t const pageNumPoints = std::max(cloud.MaxPointsPerNode(), 1U);
+    size_t const numPages        = (settings.maxRenderedPoints + pageNumPoints - 1U) / pageNumPoints * 5U / 4U + 1U;
+    size_t const numPoolPoints   = numPages * pageNumPoints;
+    assert(numPoolPoints * sizeof(T) <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+
+    renderer.pointsBuffer_ = GpuBuffer::Allocate(
+        gl, GL_ARRAY_BUFFER, GpuBuffer::CLIENT_UPDATE, CpuMemory<void const>{nullptr, numPoolPoints * sizeof(T)},
+        "PointCloudRenderer/PagesVBO");
+    renderer.vao_ = Vao::Allocate(gl, "PointCloudRenderer/VAO");
+    std::ignore   = VaoMutableCtx{renderer.vao_}
+                      .MakeVertexAttribute(
+                          renderer.pointsBuffer_,
+                          {.location        = ATTRIB_POSITION_LOCATION,
+                           .valuesPerVertex = 3,
+                           .datatype        = GL_FLOAT,
+                           .stride          = sizeof(T),
+                           .offset          = offsetof(T, position)})
+                      .MakeVertexAttribute(
+                          renderer.pointsBuffer_,
+                          {.location        = ATTRIB_COLOR_LOCATION,
+                           .valuesPerVertex = 1,
+                           .datatype        = GL_UNSIGNED_INT,
+                           .stride          = sizeof(T),
+                           .offset          = offsetof(T, color)})
+                      .MakeUnindexed(numPoolPoints);
+
+    std::vector<ShaderDefine> defines = {
+        ShaderDefine::I32("ATTRIB_POSITION", ATTRIB_POSITION_LOCATION),
+        ShaderDefine::I32("ATTRIB_COLOR", ATTRIB_COLOR_LOCATION),
+        ShaderDefine::UI32("UBO_DRAW_CONSTANTS_BINDING", UBO_DRAW_CONSTANTS_BINDING),
+    };
+    renderer.program_ = LinkProgramFromFiles(
+        gl, "data/engine/shaders/point_cloud.vert", "data/engine/shaders/color_varying.frag", std::move(defines),
+        "PointCloudRenderer");
+    assert(renderer.program_);
+
+    renderer.pages_.resize(numPages);
+    renderer.freePages_.reserve(numPages);
+    for (size_t i = numPages; i > 0U; --i) { renderer.freePages_.push_back(static_cast<uint32_t>(i - 1U)); }
+    renderer.nodeToPage_.assign(cloud.Nodes().size(), NO_PAGE);
+    renderer.cloud_ = std::move(cloud);
+    return renderer;
+}
+
+ENGINE_EXPORT void PointCloudRenderer::Dispose(GlContext& gl) {
+
+}
+
+ENGINE_EXPORT auto PointCloudRenderer::AcquirePage() -> uint32_t {
+    if (!freePages_.empty()) {
+        uint32_t page = freePages_.back();
+        freePages_.pop_back();
+        return page;
+    }
+    // NOTE: linear search, there are only hundreds of pages, and evictions are bounded by the upload budget
+    uint32_t leastRecentPage = NO_PAGE;
+    uint64_t leastRecentUse  = frame_;
+    for (uint32_t i = 0; i < pages_.size(); ++i) {
+        if (pages_[i].lastUsedFrame < leastRecentUse) {
+            leastRecentPage = i;
+            leastRecentUse  = pages_[i].lastUsedFrame;
+        }
+    }
+    if (leastRecentPage == NO_PAGE) { return NO_PAGE; } // every page is drawn this frame
+    nodeToPage_[pages_[leastRecentPage].nodeIdx] = NO_PAGE;
+    pages_[leastRecentPage].nodeIdx               = NO_NODE;
+    return leastRecentPage;
+}
+
+ENGINE_EXPORT void PointCloudRenderer::Update(
+    glm::mat4 const& view, glm::mat4 const& proj, float viewportHeightPixels) {
+    ++frame_;
+    drawFirsts_.clear();
+    drawCounts_.clear();
+    numRenderedPoints_ = 0U;
+    auto const& nodes  = cloud_.Nodes();
+    if (nodes.empty()) { return; }
+
+    glm::mat4 const viewProj     = proj * view;
+    glm::vec3 const cameraPos    = glm::vec3{glm::inverse(view)[3]};
+    float const pixelsPerUnit    = proj[1][1] * 0.5f * viewportHeightPixels; // at distance of 1 unit
+    uint32_t const pageNumPoints = std::max(cloud_.MaxPointsPerNode(), 1U);
+
+    auto projectedSize = [&](Node const& node) {
+        glm::vec3 center = node.boundsMin + glm::vec3{0.5f * node.size};
+        // NOTE: distance to the bounding sphere, so a node around the camera is always refined
+        float distance = glm::length(center - cameraPos) - 0.87f * node.size;
+        return node.size * pixelsPerUnit / std::max(distance, 1e-3f);
+    };
+    auto byProjectedSize = [](std::pair<float, uint32_t> const& a, std::pair<float, uint32_t> const& b) {
+        return a.first < b.first;
+    };
+
+    // biggest on screen first, so when a budget is exhausted, only the finest details are missing
+    uint64_t numUploadsLeft = settings_.maxUploadedPoints;
+    traversal_.clear();
+    traversal_.emplace_back(projectedSize(nodes[0]), 0U);
+    while (!traversal_.empty()) {
+        std::pop_heap(traversal_.begin(), traversal_.end(), byProjectedSize);
+        auto [nodeSize, nodeIdx] = traversal_.back();
+        traversal_.pop_back();
+        auto const& node = nodes[nodeIdx];
+        if (!IsNodeVisible(node, viewProj)) { continue; }
+        if (numRenderedPoints_ + node.numPoints > settings_.maxRenderedPoints) { break; }
+
+        uint32_t page = nodeToPage_[nodeIdx];
+        if (page == NO_PAGE) {
+            // NOTE: children aren't visited either, they'd be drawn without the coarser points of their parent
+            if (node.numPoints > numUploadsLeft) { continue; }
+            page = AcquirePage();
+            if (page == NO_PAGE) { break; }
+            auto points = cloud_.NodePoints(nodeIdx);
+            pointsBuffer_.Fill(
+                CpuMemory<GLvoid const>{points.Begin(), points.NumBytes()},
+                static_cast<GLintptr>(page) * pageNumPoints * sizeof(PointCloud::Point));
+            pages_[page].nodeIdx = nodeIdx;
+            nodeToPage_[nodeIdx] = page;
+            numUploadsLeft -= node.numPoints;
+        }
+        pages_[page].lastUsedFrame = frame_;
+        drawFirsts_.push_back(static_cast<GLint>(page * pageNumPoints));
+        drawCounts_.push_back(static_cast<GLsizei>(node.numPoints));
+        numRenderedPoints_ += node.numPoints;
+
+        if (nodeSize < settings_.minNodeSizePixels) { continue; }
+        for (uint32_t child = node.firstChild; child < node.firstChild + node.numChildren; ++child) {
+            traversal_.emplace_back(projectedSize(nodes[child]), child);
+            std::push_heap(traversal_.begin(), traversal_.end(), byProjectedSize);
+        }
+    }
+}
+
+ENGINE_EXPORT void PointCloudRenderer::Render(GlContext& gl, glm::mat4 const& camera) const {
+    if (drawCounts_.empty()) { return; }
+    gl.UniformRing().PushAndBind(UBO_DRAW_CONSTANTS_BINDING, DrawConstants{.viewProj = camera});
+    auto programGuard = UniformCtx{gl.Program(program_)};
+    auto vaoGuard     = VaoCtx{vao_};
+    GLCALL(glPointSize(settings_.pointSizePixels));
+    // NOTE: one call for all nodes, each of them is a range of its page
+    GLCALL(glMultiDrawArrays(
+        GL_POINTS, drawFirsts_.data(), drawCounts_.data(), static_cast<GLsizei>(drawCounts_.size())));
+}
+
+} // namespace engine::gl
@@ -2,6 +2,7 @@
 
 // #include "engine/IcosphereMesh.hpp"
 #include "engine/BoxMesh.hpp"
+#include "engine/gl/FrameConstants.hpp"
 #include "engine/gl/GpuBuffer.hpp"
 #include "engine/gl/Shader.hpp"
 #include "engine/gl/Uniform.hpp"
@@ -10,13 +11,76 @@
 
 namespace {
 
-constexpr GLint UNIFORM_MVP_LOCATION = 0;
+struct DrawConstants final {
+    alignas(16) glm::mat4 viewProj{1.0f};
+};
+static_assert(engine::gl::Std140Block<DrawConstants>);
+
+struct SpriteDrawConstants final {
+    alignas(16) glm::mat4 view{1.0f};
+    alignas(16) glm::mat4 proj{1.0f};
+};
+static_assert(engine::gl::Std140Block<SpriteDrawConstants>);
+
+// Quad of 4 vertices, the vertex shader takes corners by gl_VertexID, there are no per-vertex attributes
+auto AllocateSprites [[nodiscard]] (
+    engine::gl::GlContext& gl, engine::gl::Vao& vao, engine::gl::GpuBuffer& instances, size_t maxPoints)
+    -> engine::gl::GpuProgramHandle {
+    using namespace engine;
+    using namespace engine::gl;
+    constexpr GLint ATTRIB_INSTANCE_POSITION_LOCATION = 0;
+    constexpr GLint ATTRIB_INSTANCE_SCALE_LOCATION    = 1;
+    constexpr GLint ATTRIB_INSTANCE_COLOR_LOCATION    = 2;
+
+    using T = PointRendererInput::CompactPoint;
+
+    instances = GpuBuffer::Allocate(
+        gl, GL_ARRAY_BUFFER, GpuBuffer::CLIENT_UPDATE, CpuMemory<void const>{nullptr, maxPoints * sizeof(T)},
+        "PointRenderer/CompactInstancesVBO");
+    vao = Vao::Allocate(gl, "PointRenderer/SpriteVAO");
+    std::ignore = VaoMutableCtx{vao}
+                      .MakeVertexAttribute(
+                          instances,
+                          {.location        = ATTRIB_INSTANCE_POSITION_LOCATION,
+                           .valuesPerVertex = 3,
+                           .datatype        = GL_FLOAT,
+                           .stride          = sizeof(T),
+                           .offset          = offsetof(T, position),
+                           .instanceDivisor = 1})
+                      .MakeVertexAttribute(
+                          instances,
+                          {.location        = ATTRIB_INSTANCE_SCALE_LOCATION,
+                           .valuesPerVertex = 1,
+                           .datatype        = GL_HALF_FLOAT,
+                           .stride          = sizeof(T),
+                           .offset          = offsetof(T, halfScale),
+                           .instanceDivisor = 1})
+                      .MakeVertexAttribute(
+                          instances,
+                          {.location        = ATTRIB_INSTANCE_COLOR_LOCATION,
+                           .valuesPerVertex = 1,
+                           .datatype        = GL_UNSIGNED_SHORT,
+                           .stride          = sizeof(T),
+                           .offset          = offsetof(T, colorIdx),
+                           .instanceDivisor = 1})
+                      .MakeUnindexed(4);
+
+    std::vector<ShaderDefine> defines = {
+        ShaderDefine::I32("ATTRIB_INSTANCE_POSITION", ATTRIB_INSTANCE_POSITION_LOCATION),
+        ShaderDefine::I32("ATTRIB_INSTANCE_SCALE", ATTRIB_INSTANCE_SCALE_LOCATION),
+        ShaderDefine::I32("ATTRIB_COLOR", ATTRIB_INSTANCE_COLOR_LOCATION),
+        ShaderDefine::UI32("UBO_DRAW_CONSTANTS_BINDING", UBO_DRAW_CONSTANTS_BINDING),
+    };
+    return LinkProgramFromFiles(
+        gl, "data/engine/shaders/point_sprite.vert", "data/engine/shaders/sphere_impostor.frag", std::move(defines),
+        "PointRenderer/Sprites");
+}
 
 } // namespace
 
 namespace engine::gl {
 
-ENGINE_EXPORT auto PointRenderer::Allocate(GlContext& gl, size_t maxPoints) -> PointRenderer {
+ENGINE_EXPORT auto PointRenderer::Allocate(GlContext& gl, size_t maxPoints, size_t maxCompactPoints) -> PointRenderer {
     constexpr GLint ATTRIB_POSITION_LOCATION        = 0;
     constexpr GLint ATTRIB_UV_LOCATION              = 1;
     constexpr GLint ATTRIB_NORMAL_LOCATION          = 2;
@@ -104,22 +168,26 @@ ENGINE_EXPORT auto PointRenderer::Allocate(GlContext& gl, size_t maxPoints) -> P
         ShaderDefine::I32("ATTRIB_NORMAL", ATTRIB_NORMAL_LOCATION),
         ShaderDefine::I32("ATTRIB_COLOR", ATTRIB_INSTANCE_COLOR_LOCATION),
         ShaderDefine::I32("ATTRIB_INSTANCE_MATRIX", ATTRIB_INSTANCE_MATRIX_LOCATION),
-        ShaderDefine::I32("UNIFORM_MVP", UNIFORM_MVP_LOCATION),
+        ShaderDefine::UI32("UBO_DRAW_CONSTANTS_BINDING", UBO_DRAW_CONSTANTS_BINDING),
     };
 
-    auto maybeProgram = LinkProgramFromFiles(
+    renderer.program_ = LinkProgramFromFiles(
         gl, "data/engine/shaders/instanced_simple.vert", "data/engine/shaders/color_palette.frag", std::move(defines),
         "PointRenderer");
-    assert(maybeProgram);
-    renderer.program_ = std::move(*maybeProgram);
+    assert(renderer.program_);
 
     renderer.lastInstance_ = maxPoints;
 
+    renderer.spriteProgram_ =
+        AllocateSprites(gl, renderer.spriteVao_, renderer.compactInstancesBuffer_, maxCompactPoints);
+    assert(renderer.spriteProgram_);
+    renderer.lastCompactInstance_ = maxCompactPoints;
+
     return renderer;
 }
 
 
-ENGINE_EXPORT void PointRenderer::Dispose(GlContext const& gl) {
+ENGINE_EXPORT void PointRenderer::Dispose(GlContext& gl) {
 
 }
 
@@ -129,12 +197,21 @@ ENGINE_EXPORT void PointRenderer::Render(
         // XLOGW("Limit of points is <= 0 in PointRenderer");
         return;
     }
-    auto programGuard = UniformCtx{*program_};
-    programGuard.SetUniformMatrix4x4(UNIFORM_MVP_LOCATION, glm::value_ptr(camera));
+    gl.UniformRing().PushAndBind(UBO_DRAW_CONSTANTS_BINDING, DrawConstants{.viewProj = camera});
+    auto programGuard = UniformCtx{gl.Program(program_)};
     RenderVaoInstanced(
         vao_, std::min(firstInstance, lastInstance_), std::min(lastInstance_ - firstInstance, numInstances));
 }
 
+ENGINE_EXPORT void PointRenderer::RenderSprites(
+    GlContext& gl, glm::mat4 const& view, glm::mat4 const& proj, int32_t firstInstance, int32_t numInstances) const {
+    if (lastCompactInstance_ <= 0 || firstInstance >= lastCompactInstance_ || numInstances <= 0) { return; }
+    gl.UniformRing().PushAndBind(UBO_DRAW_CONSTANTS_BINDING, SpriteDrawConstants{.view = view, .proj = proj});
+    auto programGuard = UniformCtx{gl.Program(spriteProgram_)};
+    RenderVaoInstanced(
+        spriteVao_, firstInstance, std::min(lastCompactInstance_ - firstInstance, numInstances), GL_TRIANGLE_STRIP);
+}
+
 ENGINE_EXPORT void PointRenderer::LimitInstances(int32_t numInstances) {
     lastInstance_ =
         std::min(numInstances, static_cast<int32_t>(instancesBuffer_.SizeBytes() / sizeof(PointRendererInput::Point)));
@@ -152,4 +229,15 @@ ENGINE_EXPORT void PointRenderer::Fill(
     instancesBuffer_.Fill(CpuMemory<GLvoid const>{points.data(), numBytes}, byteOffset);
 }
 
+ENGINE_EXPORT void PointRenderer::Fill(
+    std::vector<PointRendererInput::CompactPoint> const& points, int32_t numPoints, int32_t numPointsOffset) {
+    using T = PointRendererInput::CompactPoint;
+    if (std::size(points) == 0 || numPoints == 0) { return; }
+    auto const bufferBytes = static_cast<size_t>(compactInstancesBuffer_.SizeBytes());
+    auto const byteOffset  = numPointsOffset * sizeof(T);
+    if (byteOffset >= bufferBytes) { return; }
+    auto const numBytes = std::min(bufferBytes - byteOffset, numPoints * sizeof(T));
+    compactInstancesBuffer_.Fill(CpuMemory<GLvoid const>{points.data(), numBytes}, byteOffset);
+}
+
 } // namespace engine::gl
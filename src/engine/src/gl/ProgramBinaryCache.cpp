@@ -0,0 +1,179 @@
+#include "engine/gl/ProgramBinaryCache.hpp"
+#include "engine/Hash.hpp"
+#include "engine/platform/MappedFile.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr char ENTRY_MAGIC[8]    = {'X', 'P', 'R', 'G', 'B', 'I', 'N', '\0'};
+constexpr uint32_t ENTRY_VERSION = 1U;
+
+struct EntryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint64_t programKey;
+    uint64_t driverHash;
+    uint64_t binaryHash;
+    uint64_t numBinaryBytes;
+};
+
+auto HexName [[nodiscard]] (uint64_t hash) -> std::string {
+    std::string name(16, '0');
+    for (int32_t i = 0; i < 16; ++i) { name[i] = "0123456789abcdef"[(hash >> (60 - 4 * i)) & 0xFU]; }
+    return name;
+}
+
+auto GlString [[nodiscard]] (GLenum name) -> std::string_view {
+    GLubyte const* str;
+    GLCALL(str = glGetString(name));
+    return str ? std::string_view{reinterpret_cast<char const*>(str)} : std::string_view{};
+}
+
+void RemoveEntry(std::string const& filepath) {
+    std::error_code err;
+    std::filesystem::remove(filepath, err);
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT void ProgramBinaryCache::Initialize(std::string_view cacheDirectory) {
+    directory_.clear();
+    if (cacheDirectory.empty()) { return; }
+
+    GLint numBinaryFormats = 0;
+    GLCALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats));
+    if (numBinaryFormats <= 0) {
+        XLOGW("ProgramBinaryCache is disabled, driver doesn't support any program binary format", 0);
+        return;
+    }
+    binaryFormats_.resize(numBinaryFormats);
+    GLCALL(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, binaryFormats_.data()));
+
+    driverHash_ = 0U;
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+        auto str    = GlString(name);
+        driverHash_ = HashCombine(driverHash_, HashBytes(str.data(), str.size()));
+    }
+
+    namespace fs = std::filesystem;
+    std::error_code err;
+    auto driverDirectory = fs::path{cacheDirectory} / HexName(driverHash_);
+    fs::create_directories(driverDirectory, err);
+    if (err) {
+        XLOGE("ProgramBinaryCache failed to create directory: {} ({})", driverDirectory.string(), err.message());
+        return;
+    }
+    // binaries of other drivers (e.g. before a driver update) would never be loaded again
+    for (auto it = fs::directory_iterator{cacheDirectory, err}; !err && it != fs::end(it); it.increment(err)) {
+        std::error_code removeErr;
+        if (it->path().filename() == driverDirectory.filename() || !it->is_directory(removeErr)) { continue; }
+        XLOG("ProgramBinaryCache removes binaries of another driver: {}", it->path().string());
+        fs::remove_all(it->path(), removeErr);
+    }
+    directory_ = driverDirectory.string();
+    XLOG("ProgramBinaryCache is enabled: {}", directory_);
+}
+
+ENGINE_EXPORT auto ProgramBinaryCache::ProgramKey(std::string_view vertexCode, std::string_view fragmentCode) const
+    -> uint64_t {
+    uint64_t key = HashBytes(vertexCode.data(), vertexCode.size(), driverHash_);
+    return HashCombine(key, HashBytes(fragmentCode.data(), fragmentCode.size(), driverHash_));
+}
+
+ENGINE_EXPORT auto ProgramBinaryCache::Load(GLuint program, uint64_t programKey) const -> bool {
+    if (!IsEnabled()) { return false; }
+    auto filepath = EntryFilepath(programKey);
+    std::error_code err;
+    if (!std::filesystem::exists(filepath, err)) { return false; }
+
+    bool isValid = false;
+    {
+        auto mappedFile = platform::MappedFile::Map(filepath);
+        if (!mappedFile) { return false; }
+        auto fileData = mappedFile->Data();
+
+        EntryHeader header;
+        if (fileData.NumBytes() >= sizeof(header)) {
+            std::memcpy(&header, fileData.data, sizeof(header));
+            auto const* binary = fileData.data + sizeof(header);
+            isValid            = std::memcmp(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC)) == 0
+                && header.version == ENTRY_VERSION && header.programKey == programKey
+                && header.driverHash == driverHash_ && header.numBinaryBytes == fileData.NumBytes() - sizeof(header)
+                && header.binaryHash == HashBytes(binary, header.numBinaryBytes)
+                // NOTE: unknown format would be a GL error, rather than a failed link
+                && std::find(binaryFormats_.begin(), binaryFormats_.end(), static_cast<GLint>(header.binaryFormat))
+                    != binaryFormats_.end();
+            if (isValid) {
+                GLCALL(glProgramBinary(program, header.binaryFormat, binary, header.numBinaryBytes));
+                GLint isLinked = GL_FALSE;
+                GLCALL(glGetProgramiv(program, GL_LINK_STATUS, &isLinked));
+                // NOTE: driver may reject a valid binary anytime (e.g. after its settings change)
+                isValid = isLinked == GL_TRUE;
+            }
+        }
+    }
+
+    if (!isValid) {
+        XLOGW("ProgramBinaryCache removes invalid entry: {}", filepath);
+        RemoveEntry(filepath);
+    }
+    return isValid;
+}
+
+ENGINE_EXPORT void ProgramBinaryCache::Store(GLuint program, uint64_t programKey) const {
+    if (!IsEnabled()) { return; }
+    GLint numBinaryBytes = 0;
+    GLCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &numBinaryBytes));
+    if (numBinaryBytes <= 0) { return; }
+
+    std::vector<uint8_t> binary(numBinaryBytes);
+    GLenum binaryFormat = GL_NONE;
+    GLsizei numWritten  = 0;
+    GLCALL(glGetProgramBinary(program, numBinaryBytes, &numWritten, &binaryFormat, binary.data()));
+    if (numWritten <= 0) { return; }
+
+    EntryHeader header{
+        .version        = ENTRY_VERSION,
+        .binaryFormat   = binaryFormat,
+        .programKey     = programKey,
+        .driverHash     = driverHash_,
+        .binaryHash     = HashBytes(binary.data(), numWritten),
+        .numBinaryBytes = static_cast<uint64_t>(numWritten),
+    };
+    std::memcpy(header.magic, ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+
+    // NOTE: written into a temporary file first, so a crash never leaves a truncated entry behind
+    auto filepath = EntryFilepath(programKey);
+    auto tmpPath  = filepath + ".tmp";
+    {
+        std::ofstream file{tmpPath, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(binary.data()), numWritten);
+        if (!file) {
+            XLOGE("ProgramBinaryCache failed to write entry: {}", tmpPath);
+            RemoveEntry(tmpPath);
+            return;
+        }
+    }
+    std::error_code err;
+    std::filesystem::rename(tmpPath, filepath, err);
+    if (err) {
+        XLOGE("ProgramBinaryCache failed to move entry into place: {} ({})", filepath, err.message());
+        RemoveEntry(tmpPath);
+    }
+}
+
+ENGINE_EXPORT auto ProgramBinaryCache::EntryFilepath(uint64_t programKey) const -> std::string {
+    return directory_ + '/' + HexName(programKey) + ".bin";
+}
+
+} // namespace engine::gl
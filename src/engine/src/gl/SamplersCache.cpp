@@ -2,38 +2,64 @@
 
 #include "engine_private/Prelude.hpp"
 
+namespace {
+
+constexpr size_t MIN_NUM_SLOTS = 16U;
+
+} // namespace
+
 namespace engine::gl {
 
 ENGINE_STATIC GpuSampler const SamplersCache::nullSampler_{};
 
-ENGINE_EXPORT auto SamplersCache::FindSampler(std::string_view name) const -> GpuSampler const& {
-    auto findId = nameToId_.find(name);
-    if (findId == nameToId_.end()) {
-        XLOGE("Can't find key={} in SamplersCache, returning NULL sampler", name)
-        return nullSampler_;
-    };
-    return idToSampler_[findId->second];
+ENGINE_EXPORT auto SamplersCache::Acquire(GlContext& gl, SamplerDesc const& desc, std::string_view name)
+    -> CacheKey {
+    uint64_t hash = desc.Hash();
+    if (!slots_.empty()) {
+        size_t slot = FindSlot(desc, hash);
+        if (slots_[slot] != 0U) { return entries_[slots_[slot] - 1U].key; }
+    }
+
+    // keep load factor at most 1/2, probe sequences stay short
+    if (2U * (entries_.size() + 1U) > slots_.size()) { Grow(); }
+    auto key = samplers_.Emplace(GpuSampler::Allocate(gl, desc, name));
+    entries_.push_back(Entry{.desc = desc, .hash = hash, .key = key});
+    slots_[FindSlot(desc, hash)] = static_cast<uint32_t>(entries_.size());
+    return key;
 }
 
 ENGINE_EXPORT auto SamplersCache::GetSampler(CacheKey id) const -> GpuSampler const& {
-    if (id < 0 && id >= std::size(idToSampler_)) {
-        XLOGE("Can't find key={} in SamplersCache, returning NULL sampler", id);
+    auto const* sampler = samplers_.Get(id);
+    if (sampler == nullptr) {
+        XLOGE("Can't find key=0x{:08X} in SamplersCache, returning NULL sampler", id.bits);
         return nullSampler_;
     };
-    return idToSampler_[id];
+    return *sampler;
 }
 
-ENGINE_EXPORT auto SamplersCache::Store(std::string_view name, GpuSampler&& sampler) -> CacheKey {
-    idToSampler_.emplace_back(std::move(sampler));
-    size_t id = std::size(idToSampler_) - 1;
-    nameToId_.emplace(name, id);
-    return id;
+ENGINE_EXPORT void SamplersCache::Clear() {
+    XLOGE("SamplersCache::Clear(), dropped {} samplers", samplers_.NumItems());
+    samplers_.Clear();
+    entries_.clear();
+    slots_.clear();
 }
 
-ENGINE_EXPORT void SamplersCache::Clear() {
-    XLOGE("SamplersCache::Clear(), dropped {} samplers", std::size(idToSampler_));
-    nameToId_.clear();
-    idToSampler_.clear();
+ENGINE_EXPORT auto SamplersCache::FindSlot(SamplerDesc const& desc, uint64_t hash) const -> size_t {
+    size_t mask = slots_.size() - 1U;
+    size_t slot = static_cast<size_t>(hash) & mask;
+    while (slots_[slot] != 0U) {
+        auto const& entry = entries_[slots_[slot] - 1U];
+        if (entry.hash == hash && entry.desc == desc) { break; }
+        slot = (slot + 1U) & mask;
+    }
+    return slot;
+}
+
+ENGINE_EXPORT void SamplersCache::Grow() {
+    slots_.assign(std::max(MIN_NUM_SLOTS, slots_.size() * 2U), 0U);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        slots_[FindSlot(entries_[i].desc, entries_[i].hash)] = static_cast<uint32_t>(i + 1U);
+    }
 }
 
-} // namespace engine::gl
\ No newline at end of file
+} // namespace engine::gl
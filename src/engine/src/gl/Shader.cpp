@@ -3,97 +3,185 @@
 
 #include "engine_private/Prelude.hpp"
 
-#include <iostream>
-#include <regex>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
 
 namespace {
 
 using namespace engine::gl::shader;
 
-constexpr int64_t INCLUDE_LINE_NUMBER_BASE = 1'000'000;
+constexpr int64_t INCLUDE_LINE_NUMBER_BASE       = 1'000'000;
+constexpr size_t MAX_INCLUDE_DEPTH               = 32U;
+constexpr std::string_view INCLUDE_BEGIN_PATTERN = "#include \"";
 
-void AddInclude(
-    IncludeRegistry& out, char const* key, std::string&& text, int32_t recursionLimit, bool isMultiline = true) {
+void AddInclude(IncludeRegistry& out, char const* key, std::string&& text, bool isMultiline = true) {
     out[key] = IncludeEntry{
-        .text           = std::move(text),
-        .recursionLimit = recursionLimit,
-        .isMultiline    = isMultiline,
+        .text        = std::move(text),
+        .isMultiline = isMultiline,
     };
 }
 
-using ParsingIt = decltype(ShaderParsing::parts.begin());
-auto WriteShaderParsing(
-    std::stringstream& destination, ParsingIt begin, ParsingIt end, IncludeRegistry const& registry,
-    int64_t firstOriginalLine) {
-    int64_t originalLine = firstOriginalLine;
-    int64_t includeCount = 0;
-    bool isFirstInclude  = firstOriginalLine < INCLUDE_LINE_NUMBER_BASE;
-    while (begin != end) {
-        switch (begin->type) {
-        case ShaderParsing::PartType::ORIGINAL_CODE:
-            originalLine += std::count(std::begin(begin->text), std::end(begin->text), '\n');
-            destination << begin->text;
-            break;
-        case ShaderParsing::PartType::DELIMITER:
-            // ss << "\n//" << begin->text << '\n';
-            break;
-        case ShaderParsing::PartType::INCLUDE_KEY:
-            // TODO: conversion std::string_view to std::string
-            // !! EXTRA ALLOCATIONS
-            ++includeCount;
-            auto find = registry.find(std::string{begin->text});
-            if (find == registry.end()) {
-                destination << "// !! MISSING INCLUDE IN REGISTRY: " << begin->text << '\n';
-                XLOGW("Missing shader include in registry: {}", begin->text);
-                break;
-            }
-            auto const& expandedInclude = find->second;
-            if (expandedInclude.text.size() == 0) {
-                destination << "// !! EMPTY INCLUDE TEXT: " << begin->text << '\n';
-                XLOGW("Empty shader include text of: {}", begin->text);
-                break;
-            }
-            if (expandedInclude.isMultiline && isFirstInclude) {
-                destination << "#line " << includeCount * INCLUDE_LINE_NUMBER_BASE << '\n';
-            }
-            if (expandedInclude.isMultiline) { destination << "// included: " << begin->text << '\n'; }
-            destination << expandedInclude.text;
-            if (expandedInclude.isMultiline && isFirstInclude) {
-                destination << '\n' << "#line " << originalLine << '\n';
-            }
-            break;
+void AddIncludeFile(IncludeRegistry& out, char const* key, char const* filepath) {
+    out[key] = IncludeEntry{
+        .text        = engine::LoadTextFile(filepath),
+        .filepath    = filepath,
+        .isMultiline = true,
+    };
+}
+
+template <typename T> void AppendNumber(std::string& destination, T value) {
+    char buffer[64];
+    auto [end, _] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    destination.append(buffer, end);
+    if constexpr (std::is_floating_point_v<T>) {
+        // NOTE: otherwise integral values (e.g. 2) would be typed as int in GLSL
+        if (std::find_if(buffer, end, [](char c) { return c == '.' || c == 'e' || c == 'n'; }) == end) {
+            destination += ".0";
         }
-        ++begin;
     }
 }
 
-auto GenerateCodeRecursively
-    [[nodiscard]] (std::string_view code, IncludeRegistry const& includeRegistry, int32_t recursLimit) -> std::string {
-    std::stringstream ss0, ss1;
-    ss0 << code;
-    auto* readStream  = &ss0;
-    auto* writeStream = &ss1;
-    while (recursLimit-- > 0) {
-        // TODO: optimize string copy here
-        // clang still doesn't support C++20 readStream.view() for fuck's sake
-        std::string currentCode = readStream->str(); // must outlive parsing
-        auto parsing            = ParseParts(currentCode);
-        if (parsing.numIncludes <= 0) { break; }
-        writeStream->seekp(0);
-        WriteShaderParsing(
-            *writeStream, parsing.parts.begin(), parsing.parts.end(), includeRegistry, INCLUDE_LINE_NUMBER_BASE);
-        std::swap(readStream, writeStream);
+auto CountLines [[nodiscard]] (std::string_view text) -> int64_t {
+    return std::count(std::begin(text), std::end(text), '\n');
+}
+
+// NOTE: only line comments are recognized
+auto IsCommentedOut [[nodiscard]] (std::string_view code, size_t position) -> bool {
+    auto lineBegin = code.rfind('\n', position);
+    lineBegin      = lineBegin == std::string_view::npos ? 0U : lineBegin + 1;
+    return code.substr(lineBegin, position - lineBegin).find("//") != std::string_view::npos;
+}
+
+auto IsIdentifierChar [[nodiscard]] (char c) -> bool {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+auto ContainsIdentifier [[nodiscard]] (std::string_view code, std::string_view name) -> bool {
+    for (size_t pos = code.find(name); pos != std::string_view::npos; pos = code.find(name, pos + 1)) {
+        bool isBeginOk = pos == 0U || !IsIdentifierChar(code[pos - 1]);
+        bool isEndOk   = pos + name.size() == code.size() || !IsIdentifierChar(code[pos + name.size()]);
+        if (isBeginOk && isEndOk) { return true; }
     }
-    // readStream was written last
-    return readStream->str();
+    return false;
 }
 
-auto ExpandRegistryRecursively(IncludeRegistry& includeRegistry) {
-    for (auto& kv : includeRegistry) {
-        if (kv.second.recursionLimit <= 0) { continue; }
-        kv.second.text = GenerateCodeRecursively(kv.second.text, includeRegistry, kv.second.recursionLimit);
+// Removes lines "#define NAME value" of the [begin, end) range, if NAME isn't mentioned after the range
+// NOTE: programs often share a stage, but not defines (e.g. vertex attributes), so such stages end up identical
+void DropUnusedDefines(std::string& destination, size_t definesBegin, size_t definesEnd) {
+    constexpr std::string_view DEFINE_PATTERN = "#define ";
+    auto code                                 = std::string_view{destination}.substr(definesEnd);
+    size_t writePos                           = definesBegin;
+    for (size_t lineBegin = definesBegin; lineBegin < definesEnd;) {
+        size_t lineEnd = destination.find('\n', lineBegin) + 1;
+        auto line      = std::string_view{destination}.substr(lineBegin, lineEnd - lineBegin);
+        auto name      = line.substr(DEFINE_PATTERN.size());
+        name           = name.substr(0U, name.find(' '));
+        if (ContainsIdentifier(code, name)) {
+            std::copy(line.begin(), line.end(), destination.begin() + writePos);
+            writePos += line.size();
+        }
+        lineBegin = lineEnd;
     }
+    destination.erase(writePos, definesEnd - writePos);
+}
+
+struct CodeGeneration final {
+    std::string& destination;
+    IncludeRegistry const& registry;
+    IncludeGraph* graph;
+    std::vector<std::string_view>& includeStack;     // includes being expanded, to detect cycles
+    std::vector<std::string_view>& expandedIncludes; // multiline includes, which were already written
+};
+
+void ExpandIncludes(CodeGeneration& gen, std::string_view code, std::string_view includer, int64_t line);
+
+void ExpandInclude(CodeGeneration& gen, std::string_view key, std::string_view includer, int64_t line) {
+    auto& destination = gen.destination;
+    // NOTE: block comments keep the line numbering, and don't cut the rest of line, if include is inline
+    auto writeError = [&](std::string_view error) {
+        destination.append("/* !! ").append(error).append(": ").append(key).append(" */");
+    };
+
+    auto find = gen.registry.find(key);
+    if (find == gen.registry.end()) {
+        writeError("MISSING INCLUDE IN REGISTRY");
+        XLOGW("Missing shader include in registry: {}", key);
+        return;
+    }
+    std::string_view registryKey = find->first;
+    auto const& include          = find->second;
+    if (gen.graph) {
+        gen.graph->edges.push_back({includer, registryKey});
+        if (std::find(gen.graph->includes.begin(), gen.graph->includes.end(), registryKey)
+            == gen.graph->includes.end()) {
+            gen.graph->includes.push_back(registryKey);
+            // NOTE: different keys may refer to the same file
+            std::string_view filepath = find->second.filepath;
+            if (!filepath.empty()
+                && std::find(gen.graph->files.begin(), gen.graph->files.end(), filepath) == gen.graph->files.end()) {
+                gen.graph->files.push_back(filepath);
+            }
+        }
+    }
+    if (include.text.empty()) {
+        writeError("EMPTY INCLUDE TEXT");
+        XLOGW("Empty shader include text of: {}", key);
+        return;
+    }
+    if (std::find(gen.includeStack.begin(), gen.includeStack.end(), registryKey) != gen.includeStack.end()) {
+        writeError("INCLUDE CYCLE");
+        XLOGE("Shader include cycle: {} includes {}", includer, key);
+        return;
+    }
+    if (gen.includeStack.size() >= MAX_INCLUDE_DEPTH) {
+        writeError("INCLUDE DEPTH LIMIT");
+        XLOGE("Shader include depth limit {} is reached by: {}", MAX_INCLUDE_DEPTH, key);
+        return;
+    }
+
+    gen.includeStack.push_back(registryKey);
+    if (!include.isMultiline) {
+        ExpandIncludes(gen, include.text, registryKey, line);
+    } else if (
+        std::find(gen.expandedIncludes.begin(), gen.expandedIncludes.end(), registryKey)
+        != gen.expandedIncludes.end()) {
+        destination.append("/* already included: ").append(key).append(" */");
+    } else {
+        gen.expandedIncludes.push_back(registryKey);
+        int64_t includeFirstLine = static_cast<int64_t>(gen.expandedIncludes.size()) * INCLUDE_LINE_NUMBER_BASE;
+        if (!destination.empty() && destination.back() != '\n') { destination += '\n'; }
+        destination.append("#line ");
+        AppendNumber(destination, includeFirstLine);
+        destination.append("\n// included: ").append(key).append("\n");
+        ExpandIncludes(gen, include.text, registryKey, includeFirstLine + 1);
+        // restore numbering of the includer, the rest of the include line keeps its number
+        destination.append("\n#line ");
+        AppendNumber(destination, line);
+        destination += '\n';
+    }
+    gen.includeStack.pop_back();
+}
+
+void ExpandIncludes(CodeGeneration& gen, std::string_view code, std::string_view includer, int64_t line) {
+    size_t parseEnd = 0U;
+    while (parseEnd < code.size()) {
+        auto includeBegin = code.find(INCLUDE_BEGIN_PATTERN, parseEnd);
+        if (includeBegin == std::string_view::npos) { break; }
+        auto keyBegin = includeBegin + INCLUDE_BEGIN_PATTERN.size();
+        auto keyEnd   = code.find('"', keyBegin);
+        if (keyEnd == std::string_view::npos) { break; }
+
+        auto isCommentedOut = IsCommentedOut(code, includeBegin);
+        auto codeBefore     = code.substr(parseEnd, (isCommentedOut ? keyEnd + 1 : includeBegin) - parseEnd);
+        gen.destination.append(codeBefore);
+        line += CountLines(codeBefore);
+        parseEnd = keyEnd + 1;
+        if (isCommentedOut) { continue; }
+
+        ExpandInclude(gen, code.substr(keyBegin, keyEnd - keyBegin), includer, line);
+        while (parseEnd < code.size() && code[parseEnd] == ' ') { ++parseEnd; }
+    }
+    gen.destination.append(code.substr(std::min(parseEnd, code.size())));
 }
 
 } // namespace
@@ -101,135 +189,115 @@ auto ExpandRegistryRecursively(IncludeRegistry& includeRegistry) {
 namespace engine::gl::shader {
 
 ENGINE_EXPORT void LoadCommonIncludes(IncludeRegistry& out) {
-    AddInclude(out, "common/version/330", "#version 330 core", 0);
-    AddInclude(out, "common/version/420", "#version 420 core", 0);
-    AddInclude(out, "common/consts", LoadTextFile("data/engine/shaders/include/constants.inc"), 0);
-    AddInclude(out, "common/gradient_noise", LoadTextFile("data/engine/shaders/include/gradient_noise.inc"), 1);
-    AddInclude(
-        out, "common/screen_space_dither", LoadTextFile("data/engine/shaders/include/screen_space_dither.inc"), 0);
-    AddInclude(out, "common/struct/light", LoadTextFile("data/engine/shaders/include/struct_light.inc"), 0);
-    AddInclude(out, "common/struct/material", LoadTextFile("data/engine/shaders/include/struct_material.inc"), 0);
-    AddInclude(out, "common/ubo/material", LoadTextFile("data/engine/shaders/include/ubo_material.inc"), 1);
-
-    ExpandRegistryRecursively(out);
+    AddInclude(out, "common/version/330", "#version 330 core");
+    AddInclude(out, "common/version/420", "#version 420 core");
+    AddIncludeFile(out, "common/consts", "data/engine/shaders/include/constants.inc");
+    AddIncludeFile(out, "common/color_palette", "data/engine/shaders/include/color_palette.inc");
+    AddIncludeFile(out, "common/gradient_noise", "data/engine/shaders/include/gradient_noise.inc");
+    AddIncludeFile(out, "common/screen_space_dither", "data/engine/shaders/include/screen_space_dither.inc");
+    AddIncludeFile(out, "common/skinning", "data/engine/shaders/include/skinning.inc");
+    AddIncludeFile(out, "common/struct/light", "data/engine/shaders/include/struct_light.inc");
+    AddIncludeFile(out, "common/struct/material", "data/engine/shaders/include/struct_material.inc");
+    AddIncludeFile(out, "common/ubo/material", "data/engine/shaders/include/ubo_material.inc");
+    AddIncludeFile(out, "common/ubo/frame", "data/engine/shaders/include/ubo_frame.inc");
 }
 
 ENGINE_EXPORT void LoadVertexIncludes(IncludeRegistry& out) { }
 
 ENGINE_EXPORT void LoadFragmentIncludes(IncludeRegistry& out) {
     AddInclude(
-        out, "frag/gradient_noise/eval", "(1.0 / 255.0) * GradientNoise(gl_FragCoord.xy) - (0.5 / 255.0)", 0, false);
-    ExpandRegistryRecursively(out);
+        out, "frag/gradient_noise/eval", "(1.0 / 255.0) * GradientNoise(gl_FragCoord.xy) - (0.5 / 255.0)", false);
 }
 
-ENGINE_EXPORT auto ParseParts(std::string_view code) -> ShaderParsing {
-    ShaderParsing parse;
-    parse.parts.reserve(64);
+ENGINE_EXPORT void GenerateCode(
+    std::string& destination, std::string_view originalCode, IncludeRegistry const& includeRegistry,
+    CpuView<ShaderDefine const> defines, IncludeGraph* includeGraph) {
+    // NOTE: scratch memory is reused between shaders generated on the same thread
+    thread_local std::vector<std::string_view> includeStack{};
+    thread_local std::vector<std::string_view> expandedIncludes{};
+    includeStack.clear();
+    expandedIncludes.clear();
+    if (includeGraph) { includeGraph->Clear(); }
 
-    auto parseEnd = 0U;
-    auto push     = [&](std::string_view text, ShaderParsing::PartType type) {
-        if (std::size(text) == 0) { return; }
-        parse.parts.push_back({text, type});
-        if (type == ShaderParsing::PartType::INCLUDE_KEY) { ++parse.numIncludes; }
-    };
-    auto parseIncludes = [&](auto codeEnd) {
-        constexpr static std::string_view includeBeginPattern = "#include \"";
-        // NOTE: for some reason, include line must be ended with new line
-        // otherwise parsing goes wild, starts capturing last " into include path
-        constexpr static std::string_view includeEndPattern = "\"";
-
-        while (parseEnd < codeEnd) {
-            auto includeBegin = code.find(includeBeginPattern, parseEnd);
-            if (includeBegin == std::string_view::npos || includeBegin >= codeEnd) { break; }
-            auto backScan = includeBegin - 1;
-            while (backScan >= parseEnd && code[backScan] == ' ') {
-                --backScan;
-            }
-            if (backScan - 1 >= parseEnd && code[backScan] == '/' && code[backScan - 1] == '/') {
-                break; // include was commented out
-            }
-            auto includeEnd = code.find(includeEndPattern, includeBegin + std::size(includeBeginPattern));
-            if (includeEnd == std::string_view::npos || includeBegin >= codeEnd) { break; }
-            push(code.substr(parseEnd, includeBegin - parseEnd), ShaderParsing::PartType::ORIGINAL_CODE);
-            parseEnd = includeBegin + std::size(includeBeginPattern);
-            push(code.substr(parseEnd, includeEnd - parseEnd), ShaderParsing::PartType::INCLUDE_KEY);
-            parseEnd = includeEnd + std::size(includeEndPattern);
-            while (parseEnd < codeEnd && (code[parseEnd] == ' ' /* || code[parseEnd] == '\n' */)) {
-                ++parseEnd;
-            }
-        }
-        push(code.substr(parseEnd, codeEnd - parseEnd), ShaderParsing::PartType::ORIGINAL_CODE);
-    };
+    destination.clear();
+    // most of shader code is usually in includes
+    destination.reserve(originalCode.size() * 2U + 1024U);
 
-    auto versionEnd = code.find("#version");
+    auto versionEnd = originalCode.find("#version");
     if (versionEnd == std::string_view::npos) {
         XLOGW("Failed to parse shader version", 0);
         versionEnd = 0U;
     } else {
-        versionEnd = code.find('\n', versionEnd) + 1;
+        versionEnd = std::min(originalCode.find('\n', versionEnd), originalCode.size() - 1) + 1;
     }
-    push(code.substr(0U, versionEnd), ShaderParsing::PartType::ORIGINAL_CODE);
-    push("<post_version>", ShaderParsing::PartType::DELIMITER);
-    parseEnd = versionEnd;
-
-    parseIncludes(std::size(code));
-    parseEnd = std::size(code);
+    auto versionCode = originalCode.substr(0U, versionEnd);
+    destination.append(versionCode);
+    if (!destination.empty() && destination.back() != '\n') { destination += '\n'; }
+    size_t definesBegin = destination.size();
+    InjectDefines(destination, defines);
+    size_t definesEnd = destination.size();
+    // reset line counter for meaningful shader compilation errors
+    int64_t firstLine = CountLines(versionCode) + 1;
+    destination.append("#line ");
+    AppendNumber(destination, firstLine);
+    destination += '\n';
 
-    return parse;
+    CodeGeneration gen{
+        .destination      = destination,
+        .registry         = includeRegistry,
+        .graph            = includeGraph,
+        .includeStack     = includeStack,
+        .expandedIncludes = expandedIncludes,
+    };
+    ExpandIncludes(gen, originalCode.substr(versionEnd), std::string_view{}, firstLine);
+    // NOTE: defines precede the #line marker, so line numbers in compilation errors stay the same
+    DropUnusedDefines(destination, definesBegin, definesEnd);
 }
 
 ENGINE_EXPORT auto GenerateCode
     [[nodiscard]] (std::string_view originalCode, IncludeRegistry const& includeRegistry, CpuView<ShaderDefine const> defines)
     -> std::string {
-    auto parsing = shader::ParseParts(originalCode);
-    std::stringstream ss;
-    auto partIt = parsing.parts.begin();
-
-    assert(partIt->type == ShaderParsing::PartType::ORIGINAL_CODE);
-    ss << partIt->text;
-    ++partIt;
-    assert(partIt->type == ShaderParsing::PartType::DELIMITER && partIt->text == "<post_version>");
-    InjectDefines(ss, defines);
-    ss << "#line 2\n";
-    WriteShaderParsing(ss, partIt, parsing.parts.end(), includeRegistry, 2);
-    return ss.str();
-}
-
-ENGINE_EXPORT void InjectDefines(std::stringstream& destination, CpuView<ShaderDefine const> defines) {
-    if constexpr (engine::XDEBUG_BUILD) { destination << "#define DEBUG 1\n"; }
+    std::string code;
+    GenerateCode(code, originalCode, includeRegistry, defines);
+    return code;
+}
+
+ENGINE_EXPORT void InjectDefines(std::string& destination, CpuView<ShaderDefine const> defines) {
+    if constexpr (engine::XDEBUG_BUILD) { destination.append("#define DEBUG 1\n"); }
     size_t numDefines = defines.NumElements();
     for (size_t i = 0; i < numDefines; ++i) {
         ShaderDefine const& define = *defines[i];
-        destination << "#define" << ' ' << define.name << ' ';
+        destination.append("#define ").append(define.name) += ' ';
         switch (define.type) {
         case ShaderDefine::INT32:
-            destination << define.value.i32;
+            AppendNumber(destination, define.value.i32);
             break;
         case ShaderDefine::UINT32:
-            destination << define.value.ui32;
+            AppendNumber(destination, define.value.ui32);
             break;
         case ShaderDefine::FLOAT32:
-            destination << define.value.f32;
+            AppendNumber(destination, define.value.f32);
             break;
         case ShaderDefine::FLOAT64:
-            destination << define.value.f64;
+            AppendNumber(destination, define.value.f64);
             break;
         case ShaderDefine::BOOLEAN8:
-            destination << define.value.b8;
+            destination += define.value.b8 ? '1' : '0';
             break;
         }
-        destination << '\n';
+        destination += '\n';
     }
 }
 
 ENGINE_EXPORT auto InjectDefines(std::string_view code, CpuView<ShaderDefine const> defines) -> std::string {
-    std::stringstream ss;
-    auto versionEnd = code.find('\n') + 1;
-    ss << code.substr(0U, versionEnd);
-    InjectDefines(ss, defines);
-    ss << "#line 2\n"; // reset line counter for meaningful shader compilation errors
-    ss << code.substr(versionEnd);
-    return ss.str();
+    std::string result;
+    auto versionEnd = std::min(code.find('\n'), code.size() - 1) + 1;
+    result.reserve(code.size() + 1024U);
+    result.append(code.substr(0U, versionEnd));
+    InjectDefines(result, defines);
+    result.append("#line 2\n"); // reset line counter for meaningful shader compilation errors
+    result.append(code.substr(versionEnd));
+    return result;
 }
 
 } // namespace engine::gl::shader
@@ -0,0 +1,232 @@
+#include "engine/gl/ShaderCompileScheduler.hpp"
+#include "engine/gl/Context.hpp"
+#include "engine/gl/GpuProgram.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+namespace {
+
+// NOTE: without the extension, Poll compiles programs until the budget is spent (at least one program per frame)
+constexpr auto FRAME_COMPILE_BUDGET = std::chrono::milliseconds{8};
+
+using MaxShaderCompilerThreadsFn = void(GLAD_API_PTR*)(GLuint count);
+
+constexpr char const* PLACEHOLDER_VERTEX_CODE = R"(#version 330 core
+void main() { gl_Position = vec4(0.0, 0.0, 2.0, 1.0); }
+)";
+constexpr char const* PLACEHOLDER_FRAGMENT_CODE = R"(#version 330 core
+out vec4 fragColor;
+void main() { fragColor = vec4(1.0, 0.0, 1.0, 1.0); }
+)";
+
+void LinkShaders(GLuint program, GLuint vertexShader, GLuint fragmentShader) {
+    GLCALL(glAttachShader(program, vertexShader));
+    GLCALL(glAttachShader(program, fragmentShader));
+    // NOTE: allows to store the linked program into ProgramBinaryCache
+    GLCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GLCALL(glLinkProgram(program));
+}
+
+auto IsProgramLinked [[nodiscard]] (GLuint program) -> bool {
+    GLint isLinked = GL_FALSE;
+    GLCALL(glGetProgramiv(program, GL_LINK_STATUS, &isLinked));
+    return isLinked == GL_TRUE;
+}
+
+// Program which renders nothing, used when a new program fails and there's no previous version to keep
+auto LinkPlaceholderProgram [[nodiscard]] (engine::gl::ShaderObjectCache& shaderObjects) -> GLuint {
+    GLuint vertexShader   = shaderObjects.Acquire(GL_VERTEX_SHADER, PLACEHOLDER_VERTEX_CODE);
+    GLuint fragmentShader = shaderObjects.Acquire(GL_FRAGMENT_SHADER, PLACEHOLDER_FRAGMENT_CODE);
+    GLuint program;
+    GLCALL(program = glCreateProgram());
+    LinkShaders(program, vertexShader, fragmentShader);
+    GLCALL(glDetachShader(program, vertexShader));
+    GLCALL(glDetachShader(program, fragmentShader));
+    shaderObjects.Release(vertexShader);
+    shaderObjects.Release(fragmentShader);
+    return program;
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT void ShaderCompileScheduler::Initialize(GlExtensions const& extensions) {
+    isParallel_ = extensions.Supports(GlExtensions::KHR_parallel_shader_compile)
+        || extensions.Supports(GlExtensions::ARB_parallel_shader_compile);
+    if (!isParallel_) {
+        XLOGW("Parallel shader compilation isn't supported, programs are compiled on the render thread", 0);
+        return;
+    }
+    // NOTE: GLAD doesn't load it, the query is the same for both extensions, 0xFFFFFFFF lets driver pick
+    auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(
+        glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    if (maxThreads == nullptr) {
+        maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFn>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxThreads != nullptr) { GLCALL(maxThreads(0xFFFFFFFFU)); }
+    XLOG("Parallel shader compilation is enabled", 0);
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::Submit(
+    GlContext& gl, GpuProgramHandle target, std::string&& vertexCode, std::string&& fragmentCode,
+    uint64_t programKey, std::string_view name) {
+    auto* targetProgram = gl.ProgramPool().Get(target);
+    assert(targetProgram != nullptr);
+    // older code of the same program is outdated
+    // NOTE: a given away program stays in the target until the new one replaces it, but it's never queried or
+    // installed again, the target may delete it any time
+    auto jobsEnd = std::remove_if(jobs_.begin(), jobs_.end(), [&](Job& job) {
+        if (job.target != target) { return false; }
+        Cancel(gl, job);
+        return true;
+    });
+    jobs_.erase(jobsEnd, jobs_.end());
+
+    auto job = Job{
+        .target       = target,
+        .vertexCode   = std::move(vertexCode),
+        .fragmentCode = std::move(fragmentCode),
+        .name         = std::string{name},
+        .programKey   = programKey,
+    };
+    bool isNewProgram = targetProgram->Id() == GL_NONE;
+    if (isParallel_) {
+        Issue(gl, job);
+        // NOTE: driver blocks on the first use of a program which is still linking
+        if (isNewProgram) {
+            targetProgram->ReplaceProgram(job.program);
+            job.isGivenAway = true;
+        }
+        jobs_.push_back(std::move(job));
+        return;
+    }
+    if (isNewProgram) {
+        // nothing to keep rendering with meanwhile
+        Issue(gl, job);
+        Finish(gl, job);
+        return;
+    }
+    jobs_.push_back(std::move(job));
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::Poll(GlContext& gl) {
+    if (jobs_.empty()) { return; }
+    if (isParallel_) {
+        auto jobsEnd = std::remove_if(jobs_.begin(), jobs_.end(), [&](Job& job) {
+            if (!gl.ProgramPool().Contains(job.target)) {
+                Cancel(gl, job);
+                return true;
+            }
+            if (!IsCompleted(job)) { return false; }
+            Finish(gl, job);
+            return true;
+        });
+        jobs_.erase(jobsEnd, jobs_.end());
+        return;
+    }
+
+    auto start       = std::chrono::steady_clock::now();
+    size_t numIssued = 0;
+    while (numIssued < jobs_.size() && std::chrono::steady_clock::now() - start < FRAME_COMPILE_BUDGET) {
+        auto& job = jobs_[numIssued++];
+        if (!gl.ProgramPool().Contains(job.target)) { continue; }
+        Issue(gl, job);
+        Finish(gl, job);
+    }
+    jobs_.erase(jobs_.begin(), jobs_.begin() + numIssued);
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::WaitAll(GlContext& gl) {
+    for (auto& job : jobs_) {
+        if (!gl.ProgramPool().Contains(job.target)) {
+            Cancel(gl, job);
+            continue;
+        }
+        if (job.program == GL_NONE) { Issue(gl, job); }
+        Finish(gl, job);
+    }
+    jobs_.clear();
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::Issue(GlContext& gl, Job& job) const {
+    // NOTE: no status is queried here, any query would wait for the driver threads
+    job.vertexShader   = gl.ShaderObjects().Acquire(GL_VERTEX_SHADER, job.vertexCode);
+    job.fragmentShader = gl.ShaderObjects().Acquire(GL_FRAGMENT_SHADER, job.fragmentCode);
+    GLCALL(job.program = glCreateProgram());
+    LinkShaders(job.program, job.vertexShader, job.fragmentShader);
+    std::string{}.swap(job.vertexCode);
+    std::string{}.swap(job.fragmentCode);
+}
+
+ENGINE_EXPORT auto ShaderCompileScheduler::IsCompleted(Job const& job) const -> bool {
+    GLint isCompleted = GL_FALSE;
+    GLCALL(glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &isCompleted));
+    return isCompleted == GL_TRUE;
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::Finish(GlContext& gl, Job& job) const {
+    bool isLinked = IsProgramLinked(job.program);
+    if (!isLinked) {
+        LogShaderErrors(job.vertexShader);
+        LogShaderErrors(job.fragmentShader);
+        static char infoLog[512];
+        GLCALL(glGetProgramInfoLog(job.program, 512, nullptr, infoLog));
+        XLOGE("Failed to link graphics program name={}:\n{}", job.name, infoLog);
+    }
+    GLCALL(glDetachShader(job.program, job.vertexShader));
+    GLCALL(glDetachShader(job.program, job.fragmentShader));
+    gl.ShaderObjects().Release(job.vertexShader);
+    gl.ShaderObjects().Release(job.fragmentShader);
+    job.vertexShader   = GL_NONE;
+    job.fragmentShader = GL_NONE;
+
+    auto* target     = gl.ProgramPool().Get(job.target);
+    bool hasPrevious = target != nullptr && target->Id() != GL_NONE && target->Id() != job.program;
+    // NOTE: the previous program may be a superseded given away one, which failed to link too
+    if (!isLinked && hasPrevious) { hasPrevious = IsProgramLinked(target->Id()); }
+    if (target == nullptr || (!isLinked && hasPrevious)) {
+        // the previous version of the program stays in use
+        GLCALL(glDeleteProgram(job.program));
+        job.program = GL_NONE;
+        return;
+    }
+    if (!isLinked) {
+        // the program may be already given away, it must stay usable
+        // NOTE: a given away program is deleted by the target, otherwise it's still owned by the job
+        if (!job.isGivenAway) { GLCALL(glDeleteProgram(job.program)); }
+        target->ReplaceProgram(LinkPlaceholderProgram(gl.ShaderObjects()));
+        target->Reflect();
+        DebugLabel(gl, *target, job.name);
+        LogDebugLabel(gl, *target, "GpuProgram was replaced by placeholder");
+        job.program = GL_NONE;
+        return;
+    }
+
+    constexpr size_t maxDebugLabelSize = 256U;
+    static char debugLabel[maxDebugLabelSize];
+    size_t labelSize = job.name.empty() ? GetDebugLabel(gl, *target, CpuMemory{debugLabel, maxDebugLabelSize}) : 0U;
+    target->ReplaceProgram(job.program);
+    target->Reflect();
+    job.program = GL_NONE;
+    DebugLabel(gl, *target, job.name.empty() ? std::string_view{debugLabel, labelSize} : job.name);
+    LogDebugLabel(gl, *target, "GpuProgram was compiled");
+    if (job.programKey != 0U) { gl.ProgramBinaries().Store(target->Id(), job.programKey); }
+}
+
+ENGINE_EXPORT void ShaderCompileScheduler::Cancel(GlContext& gl, Job& job) const {
+    if (job.program == GL_NONE) { return; }
+    // NOTE: deleting the program detaches the shaders, the program may be already deleted by its released target
+    if (!job.isGivenAway) { GLCALL(glDeleteProgram(job.program)); }
+    gl.ShaderObjects().Release(job.vertexShader);
+    gl.ShaderObjects().Release(job.fragmentShader);
+    job.program = GL_NONE;
+}
+
+} // namespace engine::gl
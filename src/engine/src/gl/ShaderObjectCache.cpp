@@ -0,0 +1,70 @@
+#include "engine/gl/ShaderObjectCache.hpp"
+#include "engine/Hash.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+namespace engine::gl {
+
+ENGINE_EXPORT auto ShaderObjectCache::Acquire(GLenum shaderType, std::string_view code) -> GLuint {
+    uint64_t key       = HashCombine(HashBytes(code.data(), code.size()), shaderType);
+    auto [first, last] = shadersByKey_.equal_range(key);
+    for (auto it = first; it != last; ++it) {
+        auto& entry = entries_.at(it->second);
+        // NOTE: a hash collision isn't a hit, the code must be the same
+        if (entry.shaderType != shaderType || entry.code != code) { continue; }
+        if (entry.numUsers++ == 0U) { --numUnused_; }
+        return it->second;
+    }
+
+    GLuint shader = GL_NONE;
+    GLCALL(shader = glCreateShader(shaderType));
+    char const* codeRaw  = code.data();
+    GLint const codeSize = code.size();
+    GLCALL(glShaderSource(shader, 1, &codeRaw, &codeSize));
+    GLCALL(glCompileShader(shader));
+    shadersByKey_.emplace(key, shader);
+    entries_.emplace(shader, Entry{.key = key, .shaderType = shaderType, .numUsers = 1U, .code = std::string{code}});
+    return shader;
+}
+
+ENGINE_EXPORT void ShaderObjectCache::Release(GLuint shader) {
+    auto it = entries_.find(shader);
+    if (it == entries_.end()) {
+        XLOGE("ShaderObjectCache::Release, unknown shader 0x{:08X}", shader);
+        return;
+    }
+    assert(it->second.numUsers > 0U && "ShaderObjectCache released a shader more times than acquired");
+    if (--it->second.numUsers == 0U) { ++numUnused_; }
+}
+
+ENGINE_EXPORT void ShaderObjectCache::EvictUnused() {
+    if (numUnused_ == 0U) { return; }
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.numUsers > 0U) {
+            ++it;
+            continue;
+        }
+        GLCALL(glDeleteShader(it->first));
+        EraseKey(it->first, it->second.key);
+        it = entries_.erase(it);
+    }
+    numUnused_ = 0U;
+}
+
+ENGINE_EXPORT void ShaderObjectCache::Clear() {
+    for (auto& [shader, _] : entries_) { GLCALL(glDeleteShader(shader)); }
+    shadersByKey_.clear();
+    entries_.clear();
+    numUnused_ = 0U;
+}
+
+ENGINE_EXPORT void ShaderObjectCache::EraseKey(GLuint shader, uint64_t key) {
+    auto [first, last] = shadersByKey_.equal_range(key);
+    for (auto it = first; it != last; ++it) {
+        if (it->second != shader) { continue; }
+        shadersByKey_.erase(it);
+        return;
+    }
+}
+
+} // namespace engine::gl
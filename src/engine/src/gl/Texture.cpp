@@ -1,4 +1,5 @@
 #include "engine/gl/Texture.hpp"
+#include "engine/MipGeneration.hpp"
 #include "engine/gl/Context.hpp"
 
 #include "engine_private/Prelude.hpp"
@@ -14,8 +15,29 @@ static void GenerateMipmapsImpl(GLenum target, GLuint texture, GLint minLevel, G
 
 static void Fill2DImpl(GLenum target, engine::gl::TextureCtx::FillArgs const& args) {
     GLint offsetX = 0, offsetY = 0;
+    // NOTE: CPU images are tightly packed, default alignment of 4 would skew rows of e.g. RGB8 odd-width mips
+    // the previous alignment is restored, so other uploads still get the state they expect
+    GLint previousAlignment = 4;
+    GLCALL(glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment));
+    GLCALL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
     GLCALL(glTexSubImage2D(
         target, args.mipLevel, offsetX, offsetY, args.size.x, args.size.y, args.dataFormat, args.dataType, args.data));
+    GLCALL(glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment));
+}
+
+static void FillCompressed2DImpl(GLenum target, engine::gl::TextureCtx::FillCompressedArgs const& args) {
+    GLint offsetX = 0, offsetY = 0;
+    GLCALL(glCompressedTexSubImage2D(
+        target, args.mipLevel, offsetX, offsetY, args.size.x, args.size.y, args.compressedFormat, args.numBytes,
+        args.data));
+}
+
+static void Read2DImpl(GLenum target, engine::gl::TextureCtx::ReadArgs const& args) {
+    GLint previousAlignment = 4;
+    GLCALL(glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment));
+    GLCALL(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GLCALL(glGetTexImage(target, args.mipLevel, args.dataFormat, args.dataType, args.destination.data));
+    GLCALL(glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment));
 }
 
 } // namespace
@@ -51,7 +73,8 @@ ENGINE_EXPORT void Texture::Dispose() {
 }
 
 ENGINE_EXPORT auto Texture::Allocate2D(
-    GlContext& gl, GLenum textureType, glm::ivec2 size, GLenum internalFormat, std::string_view name) -> Texture {
+    GlContext& gl, GLenum textureType, glm::ivec2 size, GLenum internalFormat, int32_t numLevels,
+    std::string_view name) -> Texture {
     {
         GLenum t = textureType;
         assert(
@@ -61,12 +84,14 @@ ENGINE_EXPORT auto Texture::Allocate2D(
             || t == GL_TEXTURE_CUBE_MAP_NEGATIVE_Y || t == GL_TEXTURE_CUBE_MAP_POSITIVE_Z
             || t == GL_TEXTURE_CUBE_MAP_NEGATIVE_Z || t == GL_PROXY_TEXTURE_CUBE_MAP);
     }
+    assert(numLevels > 0 && numLevels <= MipChainLength(size));
 
     Texture texture{};
     GLCALL(glGenTextures(1, texture.textureId_.Ptr()));
     texture.target_         = textureType;
     texture.size_           = glm::ivec3(size.x, size.y, 0);
     texture.internalFormat_ = internalFormat;
+    texture.numLevels_      = numLevels;
 
     GLCALL(glBindTexture(texture.target_, texture.textureId_));
 
@@ -85,12 +110,16 @@ ENGINE_EXPORT auto Texture::Allocate2D(
             clientFormat = GL_DEPTH_COMPONENT;
             clientType   = GL_UNSIGNED_INT;
         };
-        GLCALL(glTexImage2D(
-            texture.target_, 0, texture.internalFormat_, texture.size_.x, texture.size_.y, border, clientFormat,
-            clientType, nullptr));
+        for (GLint level = 0; level < numLevels; ++level) {
+            auto levelSize = texture.LevelSize(level);
+            GLCALL(glTexImage2D(
+                texture.target_, level, texture.internalFormat_, levelSize.x, levelSize.y, border, clientFormat,
+                clientType, nullptr));
+        }
+        // NOTE: otherwise mutable texture is incomplete until all 1000 possible levels are specified
+        GLCALL(glTexParameteri(texture.target_, GL_TEXTURE_MAX_LEVEL, numLevels - 1));
     } else {
         // immutable texture (storage requirements can't change, but faster runtime check of texture completeness)
-        constexpr GLsizei numLevels = 1;
         GLCALL(glTexStorage2D(texture.target_, numLevels, texture.internalFormat_, texture.size_.x, texture.size_.y));
     }
     GLCALL(glTexParameteri(texture.target_, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
@@ -116,12 +145,17 @@ ENGINE_EXPORT auto Texture::AllocateZS(
             || f == GL_DEPTH_COMPONENT32F);
     }
 
-    Texture texture = Allocate2D(gl, GL_TEXTURE_2D, size, internalFormat, name);
+    Texture texture = Allocate2D(gl, GL_TEXTURE_2D, size, internalFormat, 1, name);
     glTexParameteri(
         texture.target_, GL_DEPTH_STENCIL_TEXTURE_MODE, sampleStencilOnly ? GL_STENCIL_INDEX : GL_DEPTH_COMPONENT);
     return texture;
 }
 
+ENGINE_EXPORT auto Texture::LevelSize(int32_t level) const -> glm::ivec3 {
+    assert(level >= 0 && level < numLevels_);
+    return glm::ivec3{MipLevelSize(glm::ivec2{size_}, level), std::max(0, size_.z >> level)};
+}
+
 ENGINE_EXPORT auto TextureCtx::GenerateMipmaps(GLint minLevel, GLint maxLevel) & -> TextureCtx& {
     GenerateMipmapsImpl(contextTarget_, contextTexture_, minLevel, maxLevel);
     return *this;
@@ -142,4 +176,24 @@ ENGINE_EXPORT auto TextureCtx::Fill2D(TextureCtx::FillArgs const& args) && -> Te
     return std::move(*this);
 }
 
+ENGINE_EXPORT auto TextureCtx::FillCompressed2D(TextureCtx::FillCompressedArgs const& args) & -> TextureCtx& {
+    FillCompressed2DImpl(contextTarget_, args);
+    return *this;
+}
+
+ENGINE_EXPORT auto TextureCtx::FillCompressed2D(TextureCtx::FillCompressedArgs const& args) && -> TextureCtx&& {
+    FillCompressed2DImpl(contextTarget_, args);
+    return std::move(*this);
+}
+
+ENGINE_EXPORT auto TextureCtx::Read2D(TextureCtx::ReadArgs const& args) & -> TextureCtx& {
+    Read2DImpl(contextTarget_, args);
+    return *this;
+}
+
+ENGINE_EXPORT auto TextureCtx::Read2D(TextureCtx::ReadArgs const& args) && -> TextureCtx&& {
+    Read2DImpl(contextTarget_, args);
+    return std::move(*this);
+}
+
 } // namespace engine::gl
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "engine_private/Prelude.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace {
@@ -81,10 +82,17 @@ ENGINE_EXPORT void GlTextureUnits::BindSampler(size_t slotIdx, GLuint sampler) {
             .objectType  = SnapshotObjectType::SAMPLER,
             .oldObject   = currentSamplerBindings_[slotIdx]});
     }
+    // NOTE: materials often share samplers, only the texture changes between draws
+    if (currentSamplerBindings_[slotIdx] == sampler) { return; }
     GLCALL(glBindSampler(slotIdx, sampler));
     currentSamplerBindings_[slotIdx] = sampler;
 }
 
+ENGINE_EXPORT void GlTextureUnits::ForgetSampler(GLuint sampler) {
+    if (sampler == GL_NONE) { return; }
+    std::replace(currentSamplerBindings_.begin(), currentSamplerBindings_.end(), sampler, GLuint{GL_NONE});
+}
+
 ENGINE_EXPORT void GlTextureUnits::Bind2D(size_t slotIdx, GLuint texture) {
     BindTexture(slotIdx, GL_TEXTURE_2D, texture);
 }
@@ -6,11 +6,15 @@ namespace engine::gl {
 
 ENGINE_STATIC bool UniformCtx::hasInstances_{false};
 ENGINE_STATIC GlHandle UniformCtx::contextProgram_{GL_NONE};
+ENGINE_STATIC GpuProgram const* UniformCtx::contextGpuProgram_{nullptr};
 
 ENGINE_EXPORT UniformCtx::UniformCtx(GpuProgram const& useProgram) noexcept {
     assert(!hasInstances_ && "Attempt to start a new UniformCtx, while another is alive in the scope");
     contextProgram_.UnsafeAssign(useProgram.programId_);
+    contextGpuProgram_ = &useProgram;
     GLCALL(glUseProgram(contextProgram_));
+    // NOTE: a program which was given away while compiling is reflected here, GL waits for its link anyway
+    if (!useProgram.reflection_.IsReflected()) { useProgram.Reflect(); }
     hasInstances_ = true;
 }
 
@@ -18,42 +22,71 @@ ENGINE_EXPORT UniformCtx::~UniformCtx() noexcept {
     if (!hasInstances_) { return; }
     // assert(hasInstances_);
     contextProgram_.UnsafeReset();
+    contextGpuProgram_ = nullptr;
     GLCALL(glUseProgram(0U));
     hasInstances_ = false;
 }
 
 ENGINE_EXPORT auto UniformCtx::GetUboLocation(GpuProgram const& program, std::string_view programUboName) -> GLint {
-    GLint blockIndex;
-    GLCALL(blockIndex = glGetUniformBlockIndex(program.Id(), programUboName.data()));
-    return blockIndex;
+    if (!program.reflection_.IsReflected()) { program.Reflect(); }
+    return program.reflection_.UniformBlockIndex(ResourceNameHash(programUboName));
 }
 
 ENGINE_EXPORT auto UniformCtx::GetUboLocation(std::string_view programUboName) const -> GLint {
-    GLint blockIndex;
-    GLCALL(blockIndex = glGetUniformBlockIndex(contextProgram_, programUboName.data()));
-    return blockIndex;
+    return contextGpuProgram_->reflection_.UniformBlockIndex(ResourceNameHash(programUboName));
 }
 
 ENGINE_EXPORT void UniformCtx::SetUbo(GLuint programLocation, GLuint bufferBinding) const {
     GLCALL(glUniformBlockBinding(contextProgram_, programLocation, bufferBinding));
 }
 
+ENGINE_EXPORT auto UniformCtx::Location(uint64_t uniformNameHash) const -> GLint {
+    return contextGpuProgram_->reflection_.UniformLocation(uniformNameHash);
+}
+
+ENGINE_EXPORT auto UniformCtx::IsChanged(GLint location, void const* value, size_t numBytes) const -> bool {
+    return contextGpuProgram_->reflection_.UpdateShadow(location, value, numBytes);
+}
+
+ENGINE_EXPORT void UniformCtx::InvalidateShadows(GLint location, GLsizei numLocations) const {
+    contextGpuProgram_->reflection_.InvalidateShadows(location, static_cast<size_t>(std::max(numLocations, 0)));
+}
+
 ENGINE_EXPORT void UniformCtx::SetUniformMatrix2x2(
     GLint location, GLfloat const* values, GLsizei numMatrices, GLboolean transpose) {
+    if (numMatrices == 1 && !transpose) {
+        if (!IsChanged(location, values, 4 * sizeof(GLfloat))) { return; }
+    } else {
+        // NOTE: each matrix of an array takes a location, a transposed one doesn't match the shadowed layout
+        InvalidateShadows(location, numMatrices);
+    }
     GLCALL(glUniformMatrix2fv(location, numMatrices, transpose, values));
 }
 
 ENGINE_EXPORT void UniformCtx::SetUniformMatrix3x3(
     GLint location, GLfloat const* values, GLsizei numMatrices, GLboolean transpose) {
+    if (numMatrices == 1 && !transpose) {
+        if (!IsChanged(location, values, 9 * sizeof(GLfloat))) { return; }
+    } else {
+        // NOTE: each matrix of an array takes a location, a transposed one doesn't match the shadowed layout
+        InvalidateShadows(location, numMatrices);
+    }
     GLCALL(glUniformMatrix3fv(location, numMatrices, transpose, values));
 }
 
 ENGINE_EXPORT void UniformCtx::SetUniformMatrix4x4(
     GLint location, GLfloat const* values, GLsizei numMatrices, GLboolean transpose) {
+    if (numMatrices == 1 && !transpose) {
+        if (!IsChanged(location, values, 16 * sizeof(GLfloat))) { return; }
+    } else {
+        // NOTE: each matrix of an array takes a location, a transposed one doesn't match the shadowed layout
+        InvalidateShadows(location, numMatrices);
+    }
     GLCALL(glUniformMatrix4fv(location, numMatrices, transpose, values));
 }
 
 ENGINE_EXPORT void UniformCtx::SetUniformTexture(GLint location, GLint textureSlot) {
+    if (!IsChanged(location, &textureSlot, sizeof(textureSlot))) { return; }
     GLCALL(glUniform1i(location, textureSlot));
 }
 
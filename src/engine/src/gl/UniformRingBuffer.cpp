@@ -0,0 +1,145 @@
+#include "engine/gl/UniformRingBuffer.hpp"
+#include "engine/gl/Context.hpp"
+#include "engine/gl/Debug.hpp"
+
+#include "engine_private/Prelude.hpp"
+
+#include <cstring>
+
+namespace {
+
+constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000U;
+
+auto AlignUp [[nodiscard]] (size_t value, size_t alignment) -> size_t {
+    return (value + alignment - 1U) / alignment * alignment;
+}
+
+} // namespace
+
+namespace engine::gl {
+
+ENGINE_EXPORT void UniformRingBuffer::Initialize(GlContext& gl, size_t numBytesPerFrame) {
+    assert(!IsInitialized());
+    offsetAlignment_ = static_cast<size_t>(std::max(gl.Capabilities().uboOffsetAlignment, 1));
+    Allocate(gl, numBytesPerFrame);
+}
+
+ENGINE_EXPORT void UniformRingBuffer::Allocate(GlContext const& gl, size_t numBytesPerFrame) {
+    numBytesPerFrame_ = AlignUp(numBytesPerFrame, offsetAlignment_);
+    auto numBytes     = static_cast<GLsizeiptr>(numBytesPerFrame_ * NUM_FRAMES);
+
+    GLCALL(glGenBuffers(1, buffer_.Ptr()));
+    GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, buffer_));
+    if (gl.Extensions().Supports(GlExtensions::ARB_buffer_storage)) {
+        // NOTE: coherent mapping makes writes visible to the following draws without any flush
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCALL(glBufferStorage(GL_UNIFORM_BUFFER, numBytes, nullptr, flags));
+        GLCALL(mapped_ = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, numBytes, flags)));
+    } else {
+        GLCALL(glBufferData(GL_UNIFORM_BUFFER, numBytes, nullptr, GL_STREAM_DRAW));
+    }
+    GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    DebugLabelUnsafe(gl, buffer_, GlObjectType::BUFFER, "UniformRingBuffer");
+    XLOG("UniformRingBuffer is allocated, {} bytes per frame, persistent={}", numBytesPerFrame_, mapped_ != nullptr);
+}
+
+ENGINE_EXPORT void UniformRingBuffer::Dispose() {
+    for (auto& fence : frameFences_) {
+        if (fence == nullptr) { continue; }
+        GLCALL(glDeleteSync(fence));
+        fence = nullptr;
+    }
+    DisposeOverflowBuffers();
+    if (buffer_ == GL_NONE) { return; }
+    if (mapped_ != nullptr) {
+        GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, buffer_));
+        GLCALL(glUnmapBuffer(GL_UNIFORM_BUFFER));
+        GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+        mapped_ = nullptr;
+    }
+    GLCALL(glDeleteBuffers(1, buffer_.Ptr()));
+    buffer_.UnsafeReset();
+}
+
+ENGINE_EXPORT void UniformRingBuffer::DisposeOverflowBuffers() {
+    // NOTE: GL keeps storage of a deleted buffer, until draws which read it are finished
+    if (overflowBuffers_.empty()) { return; }
+    GLCALL(glDeleteBuffers(static_cast<GLsizei>(overflowBuffers_.size()), overflowBuffers_.data()));
+    overflowBuffers_.clear();
+}
+
+ENGINE_EXPORT void UniformRingBuffer::BeginFrame(GlContext const& gl) {
+    assert(IsInitialized());
+    DisposeOverflowBuffers();
+    if (requiredBytesPerFrame_ > numBytesPerFrame_) {
+        // NOTE: the old buffer isn't reused, so there's no need to wait for frames in flight
+        size_t numBytesPerFrame = std::max(numBytesPerFrame_ * 2U, requiredBytesPerFrame_);
+        XLOGW("UniformRingBuffer overflowed, it grows to {} bytes per frame", numBytesPerFrame);
+        Dispose();
+        Allocate(gl, numBytesPerFrame);
+    }
+    requiredBytesPerFrame_ = 0U;
+
+    frameIdx_     = (frameIdx_ + 1U) % NUM_FRAMES;
+    frameOffset_  = 0U;
+    GLsync& fence = frameFences_[frameIdx_];
+    if (fence == nullptr) { return; }
+    GLenum waitResult;
+    GLCALL(waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS));
+    if (waitResult == GL_TIMEOUT_EXPIRED || waitResult == GL_WAIT_FAILED) {
+        XLOGW("UniformRingBuffer waited too long for GPU, constants may be overwritten in use", 0);
+    }
+    GLCALL(glDeleteSync(fence));
+    fence = nullptr;
+}
+
+ENGINE_EXPORT void UniformRingBuffer::EndFrame() {
+    assert(IsInitialized());
+    // NOTE: without persistent mapping, the driver synchronizes glBufferSubData itself
+    if (mapped_ == nullptr) { return; }
+    GLCALL(frameFences_[frameIdx_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+ENGINE_EXPORT auto UniformRingBuffer::PushBytes(void const* data, size_t numBytes) -> UniformRange {
+    assert(IsInitialized());
+    if (frameOffset_ + numBytes > numBytesPerFrame_) { return PushOverflow(data, numBytes); }
+    size_t offset = frameIdx_ * numBytesPerFrame_ + frameOffset_;
+    frameOffset_  = AlignUp(frameOffset_ + numBytes, offsetAlignment_);
+    if (mapped_ != nullptr) {
+        std::memcpy(mapped_ + offset, data, numBytes);
+    } else {
+        GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, buffer_));
+        GLCALL(glBufferSubData(GL_UNIFORM_BUFFER, offset, numBytes, data));
+        GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    }
+    return UniformRange{
+        .buffer   = buffer_,
+        .offset   = static_cast<GLintptr>(offset),
+        .numBytes = static_cast<GLsizeiptr>(numBytes),
+    };
+}
+
+ENGINE_EXPORT auto UniformRingBuffer::PushOverflow(void const* data, size_t numBytes) -> UniformRange {
+    // NOTE: the region of the next frame is large enough for the whole frame, the block is valid meanwhile
+    if (requiredBytesPerFrame_ == 0U) { requiredBytesPerFrame_ = frameOffset_; }
+    requiredBytesPerFrame_ += AlignUp(numBytes, offsetAlignment_);
+
+    GLuint buffer = GL_NONE;
+    GLCALL(glGenBuffers(1, &buffer));
+    GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, buffer));
+    GLCALL(glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(numBytes), data, GL_STREAM_DRAW));
+    GLCALL(glBindBuffer(GL_UNIFORM_BUFFER, 0));
+    overflowBuffers_.push_back(buffer);
+    return UniformRange{
+        .buffer   = buffer,
+        .offset   = 0,
+        .numBytes = static_cast<GLsizeiptr>(numBytes),
+    };
+}
+
+ENGINE_EXPORT void UniformRingBuffer::Bind(GLuint binding, UniformRange range) {
+    assert(range.buffer != GL_NONE && "Bad call to UniformRingBuffer::Bind, the range wasn't pushed");
+    GLCALL(glBindBufferRange(GL_UNIFORM_BUFFER, binding, range.buffer, range.offset, range.numBytes));
+}
+
+} // namespace engine::gl
@@ -1,41 +1,64 @@
 #include "engine/platform/FileChangeNotifier.hpp"
+#include "engine/Hash.hpp"
 #include "engine/platform/Filesystem.hpp"
+#include "engine/platform/MappedFile.hpp"
 #include "engine/platform/posix/FileChangeNotifier.hpp"
 
+#include <algorithm>
 #include <errno.h>
 #include <fcntl.h>
 #include <memory>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
-#include <sys/stat.h>
 #include <unistd.h>
 
 namespace {
 
-const std::unordered_map<int, char const*> POSIX_ERRORS = {
-    {EACCES, "EACCES"}, {EBADF, "EBADF"},   {EEXIST, "EEXIST"},   {EFAULT, "EFAULT"}, {ENAMETOOLONG, "ENAMETOOLONG"},
-    {ENOENT, "ENOENT"}, {ENOSPC, "ENOSPC"}, {ENOTDIR, "ENOTDIR"}, {EINVAL, "EINVAL"}, {EMFILE, "EMFILE"},
-    {ENOMEM, "ENOMEM"},
-};
-
-void NoPosixError() {
-    bool noError = errno == 0;
-    auto findErr = POSIX_ERRORS.find(errno);
-    errno        = 0;
-    if (findErr != POSIX_ERRORS.cend()) { XLOGE("POSIX errno {}", findErr->second); }
-    assert(noError);
+// NOTE: events of one save come within a few milliseconds, the window must stay below a frame of a human reaction
+constexpr auto DEBOUNCE_WINDOW = std::chrono::milliseconds{50};
+// IN_MOVED_TO and IN_CREATE report atomic saves (a temporary file renamed over the watched one)
+constexpr uint32_t DIRECTORY_EVENTS = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+auto ContentHash [[nodiscard]] (std::string const& filepath) -> std::optional<uint64_t> {
+    auto mappedFile = engine::platform::MappedFile::Map(filepath);
+    if (!mappedFile) { return std::nullopt; }
+    auto data = mappedFile->Data();
+    return engine::HashBytes(data.data, data.NumBytes());
+}
+
+void CloseDescriptor(int& descriptor) {
+    if (descriptor < 0) { return; }
+    close(descriptor);
+    descriptor = -1;
 }
 
 } // namespace
 
 namespace engine::platform {
 
+FileChangeNotifier::~FileChangeNotifier() noexcept { Shutdown(); }
+
 auto FileChangeNotifier::Initialize() noexcept -> bool {
-    errno              = 0;
     inotifyDescriptor_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
-    NoPosixError();
-    if (inotifyDescriptor_ >= 0) { return true; }
-    XLOGE("Failed to init FileChangeNotifier. inotify_init");
-    return false;
+    epollDescriptor_   = epoll_create1(EPOLL_CLOEXEC);
+    wakeupDescriptor_  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyDescriptor_ < 0 || epollDescriptor_ < 0 || wakeupDescriptor_ < 0) {
+        XLOGE("Failed to init FileChangeNotifier ({})", strerror(errno));
+        Shutdown();
+        return false;
+    }
+    for (int descriptor : {inotifyDescriptor_, wakeupDescriptor_}) {
+        epoll_event event{.events = EPOLLIN, .data = {.fd = descriptor}};
+        if (epoll_ctl(epollDescriptor_, EPOLL_CTL_ADD, descriptor, &event) != 0) {
+            XLOGE("Failed to init FileChangeNotifier, epoll_ctl ({})", strerror(errno));
+            Shutdown();
+            return false;
+        }
+    }
+    watchThread_ = std::thread{[this] { WatchLoop(); }};
+    return true;
 }
 
 auto FileChangeNotifier::IsInitialized() const noexcept -> bool { return inotifyDescriptor_ >= 0; }
@@ -43,29 +66,25 @@ auto FileChangeNotifier::IsInitialized() const noexcept -> bool { return inotify
 auto FileChangeNotifier::PollChanges() noexcept -> bool {
     assert(IsInitialized());
 
-    int bytesWritten = read(inotifyDescriptor_, eventBuffer_, std::size(eventBuffer_));
-    if (bytesWritten <= 0) { return false; }
-
-    int i = 0;
-    std::lock_guard const lock(fileWatchersMutex_);
-    while (i < bytesWritten) {
-        inotify_event* event = reinterpret_cast<inotify_event*>(&eventBuffer_[i]);
-        i += sizeof(inotify_event) + event->len;
-        // if (event->len == 0) { continue; }
-        bool isDirectory = (event->mask & IN_ISDIR) != 0;
-        if ((Bits(event->mask) & (Bits(IN_MODIFY) | Bits(IN_CLOSE_WRITE))) == 0) { continue; }
-        auto const findWatchers = descriptor2watchers_.find(event->wd);
-        auto changedPath        = findWatchers->second.filepath;
-        if (event->len > 0) { changedPath /= std::string_view{event->name, event->len}; }
-        auto changedPathStr = std::string(std::move(changedPath));
-        XLOG("FileChangeNotifier detected change: {}", changedPathStr.c_str());
-        for (auto& watcher : findWatchers->second.watchers) {
-            std::shared_ptr w{watcher.lock()};
-            if (!w) { continue; }
-            w->OnFileChanged(changedPathStr, isDirectory);
+    bool anyChanged = false;
+    std::string changedPath;
+    std::vector<std::shared_ptr<IFileWatcher>> watchers;
+    while (changedFiles_.try_dequeue(changedPath)) {
+        anyChanged = true;
+        XLOG("FileChangeNotifier detected change: {}", changedPath);
+        watchers.clear();
+        {
+            std::lock_guard const lock(fileWatchersMutex_);
+            auto findFile = files_.find(changedPath);
+            if (findFile == files_.end()) { continue; } // unsubscribed meanwhile
+            for (auto& watcher : findFile->second.watchers) {
+                if (auto w = watcher.lock()) { watchers.push_back(std::move(w)); }
+            }
         }
+        // NOTE: watchers are called without the lock, so they may subscribe other files
+        for (auto& watcher : watchers) { watcher->OnFileChanged(changedPath, false); }
     }
-    return bytesWritten > 0;
+    return anyChanged;
 }
 
 auto FileChangeNotifier::SubscribeWatcher(std::weak_ptr<IFileWatcher> watcher, std::string_view filepath) -> bool {
@@ -74,23 +93,13 @@ auto FileChangeNotifier::SubscribeWatcher(std::weak_ptr<IFileWatcher> watcher, s
     std::error_code err;
     auto absFilepath = AbsolutePath(filepath, err);
     if (err) { return false; }
+    auto absFilepathStr = absFilepath.string();
 
     std::lock_guard const lock(fileWatchersMutex_);
-    auto find = filename2descriptor_.find(absFilepath);
-    if (find == filename2descriptor_.cend()) {
-        // start watching new file
-        int watchDescriptor = inotify_add_watch(inotifyDescriptor_, absFilepath.c_str(), IN_MODIFY);
-        NoPosixError();
-        filename2descriptor_.emplace(absFilepath, watchDescriptor);
-        descriptor2watchers_.emplace(
-            watchDescriptor,
-            WatchedFile{
-                .watchers = std::vector{std::move(watcher)},
-                .filepath = std::move(absFilepath),
-            });
-    } else {
+    auto findFile = files_.find(absFilepathStr);
+    if (findFile != files_.end()) {
         // find first expired watcher
-        auto& watchers = descriptor2watchers_[find->second].watchers;
+        auto& watchers = findFile->second.watchers;
         auto findExpired =
             std::find_if(std::begin(watchers), std::end(watchers), [](auto const& w) { return w.expired(); });
         if (findExpired != std::end(watchers)) {
@@ -100,7 +109,26 @@ auto FileChangeNotifier::SubscribeWatcher(std::weak_ptr<IFileWatcher> watcher, s
             // add to the end
             watchers.push_back(std::move(watcher));
         }
+        return true;
     }
+
+    // start watching new file, its directory may be watched already (then the same descriptor is returned)
+    auto directory          = absFilepath.parent_path();
+    int directoryDescriptor = inotify_add_watch(inotifyDescriptor_, directory.c_str(), DIRECTORY_EVENTS);
+    if (directoryDescriptor < 0) {
+        XLOGE("FileChangeNotifier failed to watch directory: {} ({})", directory.string(), strerror(errno));
+        return false;
+    }
+    auto& watchedDirectory = directories_[directoryDescriptor];
+    watchedDirectory.path  = std::move(directory);
+    ++watchedDirectory.numFiles;
+    files_.emplace(
+        std::move(absFilepathStr),
+        WatchedFile{
+            .watchers            = std::vector{std::move(watcher)},
+            .directoryDescriptor = directoryDescriptor,
+            .contentHash         = ContentHash(absFilepath.string()).value_or(0U),
+        });
     return true;
 }
 
@@ -108,34 +136,21 @@ void FileChangeNotifier::UnsubscribeWatcher(IFileWatcher const& deleteWatcher) {
     assert(IsInitialized());
 
     std::lock_guard const lock(fileWatchersMutex_);
-    for (auto it = std::begin(descriptor2watchers_); it != std::end(descriptor2watchers_); ++it) {
-        for (auto& watcher : it->second.watchers) {
-            std::shared_ptr<IFileWatcher> w = watcher.lock();
-            if (!w) { continue; }
-            if (w.get() != &deleteWatcher) { continue; }
-            watcher.reset();
-            break;
-        }
-        if (it->second.watchers.size() == 0) {
-            CloseWatchDescriptor(it->first);
-            auto findFilename =
-                std::find_if(std::begin(filename2descriptor_), std::end(filename2descriptor_), [=](auto&& p) {
-                    return p.second == it->first;
-                });
-            descriptor2watchers_.erase(it);
-            filename2descriptor_.erase(findFilename);
+    for (auto it = std::begin(files_); it != std::end(files_);) {
+        auto& watchers = it->second.watchers;
+        std::erase_if(watchers, [&](auto const& watcher) {
+            auto w = watcher.lock();
+            return !w || w.get() == &deleteWatcher;
+        });
+        if (!watchers.empty()) {
+            ++it;
+            continue;
         }
+        auto toUnwatch = it++;
+        UnwatchFile(toUnwatch);
     }
 }
 
-void FileChangeNotifier::CloseWatchDescriptor(int watchDescriptor) {
-    assert(IsInitialized());
-    fcntl(inotifyDescriptor_, F_SETFL, fcntl(inotifyDescriptor_, F_GETFL) | O_NONBLOCK);
-    inotify_rm_watch(inotifyDescriptor_, watchDescriptor);
-    NoPosixError();
-    close(watchDescriptor);
-}
-
 auto FileChangeNotifier::UnsubscribeFile(std::string_view filepath) -> bool {
     assert(IsInitialized());
 
@@ -144,24 +159,119 @@ auto FileChangeNotifier::UnsubscribeFile(std::string_view filepath) -> bool {
     if (err) { return false; }
 
     std::lock_guard const lock(fileWatchersMutex_);
-    auto find = filename2descriptor_.find(absFilepath);
-    if (find != filename2descriptor_.cend()) {
-        CloseWatchDescriptor(find->second);
-        descriptor2watchers_.erase(find->second);
-        filename2descriptor_.erase(find);
-    }
+    auto findFile = files_.find(absFilepath.string());
+    if (findFile != files_.end()) { UnwatchFile(findFile); }
     return true;
 }
 
 void FileChangeNotifier::UnsubscribeAllWatchers() {
     std::lock_guard const lock(fileWatchersMutex_);
-    for (auto it = filename2descriptor_.begin(); it != filename2descriptor_.end(); ++it) {
-        CloseWatchDescriptor(it->second);
-        descriptor2watchers_.erase(it->second);
-        filename2descriptor_.erase(it);
+    for (auto const& [directoryDescriptor, _] : directories_) {
+        inotify_rm_watch(inotifyDescriptor_, directoryDescriptor);
+    }
+    directories_.clear();
+    files_.clear();
+}
+
+// NOTE: fileWatchersMutex_ must be locked
+void FileChangeNotifier::UnwatchFile(std::unordered_map<std::string, WatchedFile>::iterator file) {
+    auto findDirectory = directories_.find(file->second.directoryDescriptor);
+    files_.erase(file);
+    if (findDirectory == directories_.end() || --findDirectory->second.numFiles > 0) { return; }
+    inotify_rm_watch(inotifyDescriptor_, findDirectory->first);
+    directories_.erase(findDirectory);
+}
+
+void FileChangeNotifier::Shutdown() {
+    if (watchThread_.joinable()) {
+        uint64_t stop = 1U;
+        std::ignore   = write(wakeupDescriptor_, &stop, sizeof(stop));
+        watchThread_.join();
+    }
+    CloseDescriptor(wakeupDescriptor_);
+    CloseDescriptor(epollDescriptor_);
+    // NOTE: closing inotify descriptor removes all of its watches
+    CloseDescriptor(inotifyDescriptor_);
+    std::lock_guard const lock(fileWatchersMutex_);
+    directories_.clear();
+    files_.clear();
+}
+
+void FileChangeNotifier::WatchLoop() {
+    using Clock = std::chrono::steady_clock;
+    std::unordered_map<std::string, Clock::time_point> debounced; // path -> time to check the file
+    epoll_event events[2];
+    while (true) {
+        int timeoutMs = -1;
+        if (!debounced.empty()) {
+            auto nextCheck = std::min_element(debounced.begin(), debounced.end(), [](auto const& a, auto const& b) {
+                                 return a.second < b.second;
+                             })->second;
+            auto untilNext = std::chrono::ceil<std::chrono::milliseconds>(nextCheck - Clock::now()).count();
+            timeoutMs      = static_cast<int>(std::max<decltype(untilNext)>(untilNext, 0));
+        }
+
+        int numEvents = epoll_wait(epollDescriptor_, events, static_cast<int>(std::size(events)), timeoutMs);
+        if (numEvents < 0 && errno != EINTR) {
+            XLOGE("FileChangeNotifier stopped, epoll_wait ({})", strerror(errno));
+            return;
+        }
+        for (int i = 0; i < numEvents; ++i) {
+            if (events[i].data.fd == wakeupDescriptor_) { return; }
+            if (events[i].data.fd == inotifyDescriptor_) { ReadEvents(debounced); }
+        }
+
+        // files which weren't written during the whole window
+        auto now = Clock::now();
+        for (auto it = debounced.begin(); it != debounced.end();) {
+            if (it->second > now) {
+                ++it;
+                continue;
+            }
+            // NOTE: hashing is outside of the lock, a missing file is in the middle of an atomic save
+            auto contentHash = ContentHash(it->first);
+            if (contentHash) {
+                std::lock_guard const lock(fileWatchersMutex_);
+                auto findFile = files_.find(it->first);
+                if (findFile != files_.end() && findFile->second.contentHash != *contentHash) {
+                    findFile->second.contentHash = *contentHash;
+                    changedFiles_.enqueue(it->first);
+                }
+            }
+            it = debounced.erase(it);
+        }
+    }
+}
+
+void FileChangeNotifier::ReadEvents(
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point>& debounced) {
+    auto checkTime = std::chrono::steady_clock::now() + DEBOUNCE_WINDOW;
+    // NOTE: the descriptor is non-blocking, it's drained until nothing is left, not just one buffer of events
+    while (true) {
+        ssize_t bytesRead = read(inotifyDescriptor_, eventBuffer_, std::size(eventBuffer_));
+        if (bytesRead <= 0) { return; }
+
+        std::lock_guard const lock(fileWatchersMutex_);
+        for (ssize_t i = 0; i < bytesRead;) {
+            auto const* event = reinterpret_cast<inotify_event const*>(&eventBuffer_[i]);
+            i += sizeof(inotify_event) + event->len;
+            if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                // some events are lost, every file might have changed
+                XLOGW("FileChangeNotifier event queue overflow", 0);
+                for (auto const& [path, _] : files_) { debounced[path] = checkTime; }
+                continue;
+            }
+            if (event->len == 0 || (event->mask & DIRECTORY_EVENTS) == 0 || (event->mask & IN_ISDIR) != 0) {
+                continue;
+            }
+            auto findDirectory = directories_.find(event->wd);
+            if (findDirectory == directories_.end()) { continue; }
+            // NOTE: name is padded with null characters
+            auto changedPath = (findDirectory->second.path / std::string_view{event->name}).string();
+            if (files_.find(changedPath) == files_.end()) { continue; }
+            debounced[std::move(changedPath)] = checkTime;
+        }
     }
-    assert(filename2descriptor_.empty());
-    descriptor2watchers_.clear();
 }
 
-} // namespace engine::platform
\ No newline at end of file
+} // namespace engine::platform
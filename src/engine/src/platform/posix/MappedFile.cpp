@@ -0,0 +1,57 @@
+#include "engine/platform/MappedFile.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace engine::platform {
+
+auto MappedFile::Map(std::string_view filepath, bool willReadWhole) -> std::optional<MappedFile> {
+    // NOTE: string_view isn't guaranteed to be null-terminated
+    std::string const path{filepath};
+    int fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        XLOGE("Failed to open file for mapping: {} ({})", path, strerror(errno));
+        return std::nullopt;
+    }
+
+    struct stat fileStat {};
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        XLOGE("Failed to get file size for mapping: {} ({})", path, strerror(errno));
+        close(fileDescriptor);
+        return std::nullopt;
+    }
+
+    MappedFile mappedFile{};
+    // NOTE: mmap of 0 bytes is an error, an empty file is returned as an empty mapping
+    if (fileStat.st_size == 0) {
+        close(fileDescriptor);
+        return mappedFile;
+    }
+
+    void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    // NOTE: the mapping stays valid after the descriptor is closed
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED) {
+        XLOGE("Failed to map file: {} ({})", path, strerror(errno));
+        return std::nullopt;
+    }
+    // the whole file is usually consumed at once (e.g. uploaded to GPU), start reading it ahead
+    madvise(mapping, fileStat.st_size, willReadWhole ? MADV_WILLNEED : MADV_RANDOM);
+
+    mappedFile.data_     = static_cast<uint8_t const*>(mapping);
+    mappedFile.numBytes_ = static_cast<size_t>(fileStat.st_size);
+    return mappedFile;
+}
+
+void MappedFile::Unmap() {
+    if (data_ == nullptr) { return; }
+    munmap(const_cast<uint8_t*>(data_), numBytes_);
+    data_     = nullptr;
+    numBytes_ = 0U;
+}
+
+} // namespace engine::platform
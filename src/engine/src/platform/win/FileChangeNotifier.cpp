@@ -5,6 +5,8 @@ namespace { } // namespace
 
 namespace engine::platform {
 
+FileChangeNotifier::~FileChangeNotifier() noexcept = default;
+
 auto FileChangeNotifier::Initialize() noexcept -> bool {
     XLOGE("FileChangeNotifier::Initialize not implemented");
     return false;
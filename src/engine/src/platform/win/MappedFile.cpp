@@ -0,0 +1,63 @@
+#include "engine/platform/MappedFile.hpp"
+
+#include <filesystem>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+namespace engine::platform {
+
+auto MappedFile::Map(std::string_view filepath, bool willReadWhole) -> std::optional<MappedFile> {
+    // NOTE: paths are converted to UTF-16, so non-ASCII paths are opened regardless of the code page
+    auto const path = std::filesystem::path{filepath};
+    DWORD flags     = willReadWhole ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    HANDLE file     = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        XLOGE("Failed to open file for mapping: {} (error {})", path.string(), GetLastError());
+        return std::nullopt;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (GetFileSizeEx(file, &fileSize) == 0) {
+        XLOGE("Failed to get file size for mapping: {} (error {})", path.string(), GetLastError());
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    MappedFile mappedFile{};
+    // NOTE: a mapping of 0 bytes is an error, an empty file is returned as an empty mapping
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return mappedFile;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    // NOTE: the view keeps the file and the mapping object alive, after their handles are closed
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        XLOGE("Failed to create file mapping: {} (error {})", path.string(), GetLastError());
+        return std::nullopt;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        XLOGE("Failed to map file: {} (error {})", path.string(), GetLastError());
+        return std::nullopt;
+    }
+
+    mappedFile.data_     = static_cast<uint8_t const*>(view);
+    mappedFile.numBytes_ = static_cast<size_t>(fileSize.QuadPart);
+    return mappedFile;
+}
+
+void MappedFile::Unmap() {
+    if (data_ == nullptr) { return; }
+    UnmapViewOfFile(data_);
+    data_     = nullptr;
+    numBytes_ = 0U;
+}
+
+} // namespace engine::platform